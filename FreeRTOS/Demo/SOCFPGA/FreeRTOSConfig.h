@@ -73,6 +73,11 @@
 #define configTOTAL_HEAP_SIZE                   ((size_t)(4 * 1024 * 1024))
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
+/* Set by the build when FREERTOS_SLAB_HEAP selects heap_slab.c over heap_3 */
+#ifndef configUSE_SLAB_HEAP
+#define configUSE_SLAB_HEAP                     0
+#endif
+
 /* Run time and task stats gathering related definitions. */
 #define configGENERATE_RUN_TIME_STATS           0
 #define configUSE_TRACE_FACILITY                1
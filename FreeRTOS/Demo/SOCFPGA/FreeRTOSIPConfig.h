@@ -244,7 +244,8 @@
  * contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
  * lower value can save RAM, depending on the buffer management scheme used.  If
  * ipconfigCAN_FRAGMENT_OUTGOING_PACKETS is 1 then (ipconfigNETWORK_MTU - 28) must
- * be divisible by 8. */
+ * be divisible by 8.  The XGMAC port accepts jumbo frames up to an MTU of 9000,
+ * every network buffer then grows to hold a full jumbo frame. */
 #define ipconfigNETWORK_MTU                       1500U
 
 /* Set ipconfigUSE_DNS to 1 to include a basic DNS client/resolver.  DNS is used
@@ -354,10 +355,16 @@
 #define ipconfigTCP_MAY_LOG_PORT( xPort )    ((xPort) != 23U)
 
 /* AGX5-added */
-#define ipconfigZERO_COPY_RX_DRIVER               (0)
+/* Received frames are passed to the stack in the buffer the DMA wrote them
+ * to, the Rx descriptors are refilled from pre-allocated network buffers. */
+#define ipconfigZERO_COPY_RX_DRIVER               (1)
 
 #define ipconfigZERO_COPY_TX_DRIVER               (0)
 
+/* Let the XGMAC segment TCP frames larger than the MTU. Requires
+ * ipconfigZERO_COPY_TX_DRIVER and a TCP segment size above the MTU. */
+#define ipconfigUSE_TCP_TSO                       (0)
+
 /* Agx5 HAL hardware checksum is enabled */
 #define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM    (1)
 
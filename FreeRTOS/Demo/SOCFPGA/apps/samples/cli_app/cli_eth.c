@@ -19,12 +19,15 @@
  * - eth start &lt;IP_Protocol&gt; &lt;IP&gt;&lt;port&gt;
  * - eth send &lt;Message&gt;
  * - eth stop
+ * - eth stats
+ * - eth stats clear
  *
  * Typical usage:
  * - Use 'eth config' command to configure the IP address and port.
  * - Use 'eth start' command to start the server.
  * - Use 'eth send' command to send message over TCP/UDP.
  * - Use 'eth stop' command to stop the server.
+ * - Use 'eth stats' command to show the interface statistics.
  *
  * @section enet_commands Commands
  * @subsection eth_config eth config
@@ -65,6 +68,17 @@
  * stop the server
  * Usage: <br>
  *   eth stop
+ *
+ * @subsection eth_stats eth stats
+ * Show the network interface statistics <br>
+ *
+ * Usage: <br>
+ *   eth stats [clear]
+ *
+ * Shows the frame and byte counts, the dropped frames by reason, the XGMAC
+ * interrupt and MAC management counters and a histogram of the time from the
+ * receive interrupt to the hand-off of the frames to the TCP/IP stack.
+ * - clear     reset the statistics.
  */
 
 #include <stdio.h>
@@ -162,6 +176,13 @@ typedef struct
 CRNT_CONN ethHndlr;
 ETH_STATE crntState = ETH_STATE_INACTIVE;
 
+static NetworkInterfaceStats_t ethStats;
+static const char *const ethDropReason[ eEthDropCount ] =
+{
+    "rx error", "rx filtered", "rx no buffer", "rx oversize", "rx queue full",
+    "tx oversize", "tx link down", "tx no buffer", "tx ring full"
+};
+
 eDHCPCallbackAnswer_t xApplicationDHCPHook( eDHCPCallbackPhase_t eDHCPPhase,
         uint32_t ulIPAddress )
 {
@@ -356,6 +377,121 @@ static void eth_sm( ETH_STATE reqstate )
     }
 }
 
+/* @brief : print the network interface statistics*/
+static void eth_print_stats( void )
+{
+    uint32_t i;
+    uint64_t ns;
+
+    if (xNetworkInterfaceGetStats(&ethStats) != pdPASS)
+    {
+        ERROR("Ethernet interface is not initialized");
+        return;
+    }
+
+    printf("\r\nInterface:"
+            "\r\n  rx packets          %llu"
+            "\r\n  rx bytes            %llu"
+            "\r\n  tx packets          %llu"
+            "\r\n  tx bytes            %llu"
+            "\r\n  tx ring full        %lu"
+            "\r\n  rx ring full        %lu"
+            "\r\n  rx refill failures  %lu"
+            "\r\n  rx alloc failures   %lu",
+            (unsigned long long) ethStats.ullRxPackets,
+            (unsigned long long) ethStats.ullRxBytes,
+            (unsigned long long) ethStats.ullTxPackets,
+            (unsigned long long) ethStats.ullTxBytes,
+            (unsigned long) ethStats.ulTxRingFull,
+            (unsigned long) ethStats.ulRxRingFull,
+            (unsigned long) ethStats.ulRxRefillFailures,
+            (unsigned long) ethStats.ulRxAllocFailures);
+
+    printf("\r\n\nDropped frames:");
+    for (i = 0; i < eEthDropCount; i++)
+    {
+        printf("\r\n  %-18s  %lu", ethDropReason[ i ],
+                (unsigned long) ethStats.ulDrops[ i ]);
+    }
+
+    printf("\r\n\nInterrupts:"
+            "\r\n  total               %lu"
+            "\r\n  rx                  %lu"
+            "\r\n  tx                  %lu"
+            "\r\n  error               %lu"
+            "\r\n  per 1000 packets    %lu",
+            (unsigned long) ethStats.xIrq.irq_count,
+            (unsigned long) ethStats.xIrq.rx_irq_count,
+            (unsigned long) ethStats.xIrq.tx_irq_count,
+            (unsigned long) ethStats.xIrq.err_irq_count,
+            (unsigned long) ethStats.xIrq.irqs_per_kpkt);
+
+    printf("\r\n\nMAC counters:"
+            "\r\n  tx octets           %llu"
+            "\r\n  tx packets          %llu"
+            "\r\n  tx broadcast        %llu"
+            "\r\n  tx multicast        %llu"
+            "\r\n  tx underflow        %llu"
+            "\r\n  tx pause            %llu"
+            "\r\n  rx octets           %llu"
+            "\r\n  rx packets          %llu"
+            "\r\n  rx broadcast        %llu"
+            "\r\n  rx multicast        %llu"
+            "\r\n  rx crc errors       %llu"
+            "\r\n  rx length errors    %llu"
+            "\r\n  rx out of range     %llu"
+            "\r\n  rx fifo overflow    %llu"
+            "\r\n  rx pause            %llu"
+            "\r\n  rx discarded        %llu",
+            (unsigned long long) ethStats.xMmc.tx_octets,
+            (unsigned long long) ethStats.xMmc.tx_packets,
+            (unsigned long long) ethStats.xMmc.tx_broadcast,
+            (unsigned long long) ethStats.xMmc.tx_multicast,
+            (unsigned long long) ethStats.xMmc.tx_underflow,
+            (unsigned long long) ethStats.xMmc.tx_pause,
+            (unsigned long long) ethStats.xMmc.rx_octets,
+            (unsigned long long) ethStats.xMmc.rx_packets,
+            (unsigned long long) ethStats.xMmc.rx_broadcast,
+            (unsigned long long) ethStats.xMmc.rx_multicast,
+            (unsigned long long) ethStats.xMmc.rx_crc_errors,
+            (unsigned long long) ethStats.xMmc.rx_length_errors,
+            (unsigned long long) ethStats.xMmc.rx_out_of_range,
+            (unsigned long long) ethStats.xMmc.rx_fifo_overflow,
+            (unsigned long long) ethStats.xMmc.rx_pause,
+            (unsigned long long) ethStats.xMmc.rx_discarded);
+    printf("\r\n  rx runt             %lu"
+            "\r\n  rx jabber           %lu"
+            "\r\n  rx undersize        %lu"
+            "\r\n  rx oversize         %lu"
+            "\r\n  rx watchdog         %lu"
+            "\r\n  rx alignment        %lu",
+            (unsigned long) ethStats.xMmc.rx_runt,
+            (unsigned long) ethStats.xMmc.rx_jabber,
+            (unsigned long) ethStats.xMmc.rx_undersize,
+            (unsigned long) ethStats.xMmc.rx_oversize,
+            (unsigned long) ethStats.xMmc.rx_watchdog,
+            (unsigned long) ethStats.xMmc.rx_alignment);
+
+    printf("\r\n\nRx interrupt to stack latency:");
+    for (i = 0; i < ethSTATS_LATENCY_BUCKETS; i++)
+    {
+        if (ethStats.ulRxLatency[ i ] == 0)
+        {
+            continue;
+        }
+        ns = 0;
+        if (ethStats.ulCounterHz != 0)
+        {
+            ns = ((1ULL << i) * 1000000000ULL) / ethStats.ulCounterHz;
+        }
+        printf("\r\n  %s%10llu ns  %lu",
+                (i == (ethSTATS_LATENCY_BUCKETS - 1)) ? ">=" : "  ",
+                (unsigned long long) ns,
+                (unsigned long) ethStats.ulRxLatency[ i ]);
+    }
+    printf("\r\n");
+}
+
 /**
  * @func : cmd_eth
  * @brief : callback function to configure and run tcp/udp server
@@ -365,7 +501,7 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
         const char *command_string )
 {
     (void) write_buffer_len;
-    char tempString[ 4 ] = { 0 };
+    char tempString[ 8 ] = { 0 };
     char *ipBuf;
     int udpPort;
     const char *parameter1;
@@ -380,6 +516,7 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
     const char *config = "config";
     const char *send = "send";
     const char *stop = "stop";
+    const char *stats = "stats";
     const char *tcp = "tcp";
     const char *udp = "udp";
     int ret;
@@ -395,6 +532,11 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
     parameter2 = FreeRTOS_CLIGetParameter(command_string, 2,
             &parameter2_str_len);
 
+    if ((parameter1 == NULL) || (parameter1_str_len >= (BaseType_t) sizeof(tempString)))
+    {
+        ERROR("Wrong parameter.");
+        return pdFALSE;
+    }
     strncpy(tempString, parameter1, parameter1_str_len);
     if (strncmp(parameter1, "help", 4) == 0)
     {
@@ -405,17 +547,19 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
                 "\r\n   eth start <IP protocol> <client IP> <client port>"
                 "\r\n   eth send <data>"
                 "\r\n   eth stop"
+                "\r\n   eth stats [clear]"
                 "\r\n\n Typical usage:\n"
                 "\r\n- Use eth config to configure IP address and port"
                 "\r\n- Use eth start to establish a TCP/UDP server."
                 "\r\n- Use eth stop to stop the server."
+                "\r\n- Use eth stats to show the interface statistics."
                 "\r\n\nFor help on the specific commands do:"
                 "\r\n  eth <command> help\r\n"
                 );
 
         return pdFALSE;
     }
-    else if (strncmp(parameter2, "help", 4) == 0)
+    else if ((parameter2 != NULL) && (strncmp(parameter2, "help", 4) == 0))
     {
         if (strncmp(parameter1,"config",6) == 0)
         {
@@ -457,6 +601,16 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
                     "\r\neth stop"
                     );
         }
+        else if (strncmp(parameter1,"stats",5) == 0)
+        {
+            printf("\r\nShow the network interface statistics"
+                    "\r\n\nUsage:"
+                    "\r\n  eth stats [clear]"
+                    "\r\n\nShows the frame, drop, interrupt and MAC counters and the"
+                    "\r\nlatency from the Rx interrupt to the TCP/IP stack."
+                    "\r\n  clear       reset the statistics"
+                    );
+        }
         else
         {
             ERROR("Wrong parameter.");
@@ -517,6 +671,11 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
         parameter2 = FreeRTOS_CLIGetParameter(command_string, 2,
                 &parameter2_str_len);
         memset(tempString, 0, sizeof(tempString));
+        if ((parameter2 == NULL) || (parameter2_str_len >= (BaseType_t) sizeof(tempString)))
+        {
+            ERROR("Invalid arguments");
+            return pdFALSE;
+        }
         strncpy(tempString, parameter2, parameter2_str_len);
         if (strcmp(tempString, tcp) == 0)
         {
@@ -619,6 +778,18 @@ BaseType_t cmd_eth( char *write_buffer, size_t write_buffer_len,
             ERROR("No server running.");
         }
     }
+    else if (strcmp(tempString, stats) == 0)
+    {
+        if ((parameter2 != NULL) && (strncmp(parameter2, "clear", 5) == 0))
+        {
+            vNetworkInterfaceClearStats();
+            PRINT("Ethernet statistics cleared");
+        }
+        else
+        {
+            eth_print_stats();
+        }
+    }
     else
     {
         strncpy(write_buffer, "Invalid  command", strlen("Invalid  command "));
@@ -22,6 +22,8 @@
  * - fat write &lt;file_name&gt; &lt;string&gt;
  * - fat mkdir &lt;dir_name&gt;
  * - fat rmdir &lt;dir_name&gt;
+ * - fat cache &lt;partition&gt;
+ * - fat flush &lt;partition&gt;
  * - fat help
  *
  * Typical usage:
@@ -32,6 +34,8 @@
  * - Use 'fat mkdir' to create a directory.
  * - Use 'fat rmdir' to delete a directory.
  * - Use 'fat rm' to delete a file.
+ * - Use 'fat cache' to display the hit rate of the sector cache.
+ * - Use 'fat flush' to write the cached changes to the disk.
  * - Use 'fat unmount' to unmount the partition.
  *
  * @section fat_commands Commands
@@ -107,6 +111,24 @@
  *
  * It requires the following arguments:
  * - file_name -     The full path to the file (including mount point). Maximum length (excluding mount point) is 8 characters.  <br>
+ *
+ * @subsection fat_cache fat cache
+ * Display the counters of the sector cache  <br>
+ *
+ * Usage:  <br>
+ *   fat cache &lt;partition&gt;  <br>
+ *
+ * It requires the following arguments:
+ * - partition -     The name of the mounted partition. Only the SD/MMC partition (`/sd/`) is cached.  <br>
+ *
+ * @subsection fat_flush fat flush
+ * Write the changes held in the caches to the disk  <br>
+ *
+ * Usage:  <br>
+ *   fat flush &lt;partition&gt;  <br>
+ *
+ * It requires the following arguments:
+ * - partition -     The name of the mounted partition. Only the SD/MMC partition (`/sd/`) is cached.  <br>
  */
 
 #include <stdio.h>
@@ -166,6 +188,8 @@ BaseType_t fat_ops( char *write_buffer, size_t write_buffer_len,
                 "\r\n  fat write <file_name> <string>"
                 "\r\n  fat mkdir <dir_name>"
                 "\r\n  fat rmdir <dir_name>"
+                "\r\n  fat cache <partition>"
+                "\r\n  fat flush <partition>"
                 "\r\n  fat help"
                 "\r\n\nTypical usage:"
                 "\r\n- Use mount command to mount the fat partition"
@@ -487,6 +511,38 @@ BaseType_t fat_ops( char *write_buffer, size_t write_buffer_len,
             printf("Invalid mount point specified");
         }
     }
+    else if (strncmp(parameter1, "cache", 5) == 0)
+    {
+        if (strncmp( parameter2, "help", 4 ) == 0)
+        {
+            printf("\r\nDisplay the counters of the sector cache"
+                    "\r\n\nUsage:"
+                    "\r\n  fat cache </partition>"
+                    "\r\n\nIt requires the following arguments:"
+                    "\r\n  partition     The name of the mounted partition. Eg. (fat cache /sd/)"
+                    "\r\n                Only the sdmmc partition is cached. Reads served from the cache count as hits."
+                    );
+            return pdFALSE;
+        }
+
+        ff_cache_stats(get_disk_type(parameter2));
+    }
+    else if (strncmp(parameter1, "flush", 5) == 0)
+    {
+        if (strncmp( parameter2, "help", 4 ) == 0)
+        {
+            printf("\r\nWrite the cached changes to the disk"
+                    "\r\n\nUsage:"
+                    "\r\n  fat flush </partition>"
+                    "\r\n\nIt requires the following arguments:"
+                    "\r\n  partition     The name of the mounted partition. Eg. (fat flush /sd/)"
+                    "\r\n                Writes stay in the sector cache until flushed, evicted or the partition is unmounted."
+                    );
+            return pdFALSE;
+        }
+
+        ff_flush(get_disk_type(parameter2));
+    }
     else
     {
         printf("\r\n Incorrect Command \r\n");
@@ -0,0 +1,620 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Sector cache between FreeRTOS+FAT and the block device of a disk
+ */
+
+/*
+ * The cache takes the place of the read and write functions of the block
+ * device in the I/O manager of the disk and calls the original ones on a
+ * miss. Sectors are found through a hash of their number and evicted in
+ * least recently used order. A run of missing sectors is read with one
+ * request, extended by the read ahead window when the reads are sequential.
+ * Written sectors are kept dirty and written back in runs of adjacent
+ * sectors when flushed or evicted.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "ff_sddisk.h"
+#include "fatfs_cache.h"
+
+#define FATFS_CACHE_MAX_DISKS    2U
+
+/* Alignment of the sector buffers, the disk DMA maintains whole cache lines */
+#define FATFS_CACHE_ALIGN        64U
+
+#define FATFS_CACHE_IO_ERROR     (FF_ERR_IOMAN_DRIVER_FATAL_ERROR | FF_ERRFLAG)
+
+typedef struct fatfs_cache_entry
+{
+    uint32_t sector;
+    bool is_valid;
+    bool is_dirty;
+    bool is_readahead;                       /* read ahead and not used yet */
+    uint8_t *pdata;
+    struct fatfs_cache_entry *phash_next;
+    struct fatfs_cache_entry *plru_prev;     /* more recently used */
+    struct fatfs_cache_entry *plru_next;     /* less recently used */
+} fatfs_cache_entry_t;
+
+typedef struct
+{
+    FF_Disk_t *pdisk;                        /* NULL when the cache is free */
+    FF_ReadBlocks_t read_blocks;
+    FF_WriteBlocks_t write_blocks;
+    SemaphoreHandle_t lock;
+    uint32_t sector_size;
+    uint32_t count;
+    uint32_t hash_mask;
+    void *pmem;
+    uint8_t *pread_stage;                    /* merged reads */
+    uint8_t *pwrite_stage;                   /* merged write backs */
+    fatfs_cache_entry_t *pentries;
+    fatfs_cache_entry_t **phash;
+    fatfs_cache_entry_t *plru_head;
+    fatfs_cache_entry_t *plru_tail;
+    uint32_t next_sector;                    /* sector after the last read */
+    uint32_t ra_window;
+    fatfs_cache_stats_t stats;
+} fatfs_cache_t;
+
+static fatfs_cache_t fatfs_caches[FATFS_CACHE_MAX_DISKS];
+
+static fatfs_cache_t *cache_find(const FF_Disk_t *pxDisk)
+{
+    uint32_t i;
+
+    for (i = 0U; i < FATFS_CACHE_MAX_DISKS; i++)
+    {
+        if (fatfs_caches[i].pdisk == pxDisk)
+        {
+            return &fatfs_caches[i];
+        }
+    }
+    return NULL;
+}
+
+static fatfs_cache_entry_t *cache_lookup(const fatfs_cache_t *pcache,
+        uint32_t sector)
+{
+    fatfs_cache_entry_t *pentry = pcache->phash[sector & pcache->hash_mask];
+
+    while ((pentry != NULL) && (pentry->sector != sector))
+    {
+        pentry = pentry->phash_next;
+    }
+    return pentry;
+}
+
+static void cache_hash_remove(fatfs_cache_t *pcache,
+        fatfs_cache_entry_t *pentry)
+{
+    fatfs_cache_entry_t **pplink =
+            &pcache->phash[pentry->sector & pcache->hash_mask];
+
+    while (*pplink != pentry)
+    {
+        pplink = &(*pplink)->phash_next;
+    }
+    *pplink = pentry->phash_next;
+    pentry->phash_next = NULL;
+}
+
+/*
+ * @brief Move an entry to the most recently used end of the list
+ */
+static void cache_touch(fatfs_cache_t *pcache, fatfs_cache_entry_t *pentry)
+{
+    if (pcache->plru_head == pentry)
+    {
+        return;
+    }
+    pentry->plru_prev->plru_next = pentry->plru_next;
+    if (pentry->plru_next != NULL)
+    {
+        pentry->plru_next->plru_prev = pentry->plru_prev;
+    }
+    else
+    {
+        pcache->plru_tail = pentry->plru_prev;
+    }
+    pentry->plru_prev = NULL;
+    pentry->plru_next = pcache->plru_head;
+    pcache->plru_head->plru_prev = pentry;
+    pcache->plru_head = pentry;
+}
+
+/*
+ * @brief Write back the run of adjacent dirty sectors holding an entry
+ */
+static int32_t cache_write_run(fatfs_cache_t *pcache,
+        fatfs_cache_entry_t *pentry)
+{
+    fatfs_cache_entry_t *pnext;
+    uint32_t ss = pcache->sector_size;
+    uint32_t first = pentry->sector;
+    uint32_t back = 0U;
+    uint32_t n = 0U;
+    uint32_t i;
+    int32_t ret;
+
+    /*start early enough for the run to include the entry*/
+    while ((first != 0U) && (back < (FATFS_CACHE_RA_MAX - 1U)))
+    {
+        pnext = cache_lookup(pcache, first - 1U);
+        if ((pnext == NULL) || (pnext->is_dirty == false))
+        {
+            break;
+        }
+        first--;
+        back++;
+    }
+
+    pnext = cache_lookup(pcache, first);
+    while ((pnext != NULL) && (pnext->is_dirty == true) &&
+            (n < FATFS_CACHE_RA_MAX))
+    {
+        (void)memcpy(&pcache->pwrite_stage[n * ss], pnext->pdata, ss);
+        n++;
+        pnext = cache_lookup(pcache, first + n);
+    }
+
+    ret = pcache->write_blocks(pcache->pwrite_stage, first, n, pcache->pdisk);
+    if (ret != FF_ERR_NONE)
+    {
+        return ret;
+    }
+    for (i = 0U; i < n; i++)
+    {
+        cache_lookup(pcache, first + i)->is_dirty = false;
+    }
+    pcache->stats.written_back += n;
+    return FF_ERR_NONE;
+}
+
+/*
+ * @brief Take the least recently used entry for a sector
+ */
+static int32_t cache_alloc(fatfs_cache_t *pcache, uint32_t sector,
+        fatfs_cache_entry_t **ppentry)
+{
+    fatfs_cache_entry_t *pentry = pcache->plru_tail;
+    fatfs_cache_entry_t **pphead;
+    int32_t ret;
+
+    if (pentry->is_valid == true)
+    {
+        if (pentry->is_dirty == true)
+        {
+            ret = cache_write_run(pcache, pentry);
+            if (ret != FF_ERR_NONE)
+            {
+                return ret;
+            }
+        }
+        /*the window was too large for what is actually read*/
+        if ((pentry->is_readahead == true) &&
+                (pcache->ra_window > FATFS_CACHE_RA_MIN))
+        {
+            pcache->ra_window /= 2U;
+        }
+        cache_hash_remove(pcache, pentry);
+    }
+
+    pentry->sector = sector;
+    pentry->is_valid = true;
+    pentry->is_dirty = false;
+    pentry->is_readahead = false;
+    pphead = &pcache->phash[sector & pcache->hash_mask];
+    pentry->phash_next = *pphead;
+    *pphead = pentry;
+    cache_touch(pcache, pentry);
+
+    *ppentry = pentry;
+    return FF_ERR_NONE;
+}
+
+/*
+ * @brief Read a run of missing sectors, plus ra sectors ahead, in one request
+ */
+static int32_t cache_read_run(fatfs_cache_t *pcache, uint8_t *pbuf,
+        uint32_t first, uint32_t n, uint32_t ra)
+{
+    fatfs_cache_entry_t *pentry;
+    const uint8_t *psrc = pbuf;
+    uint32_t ss = pcache->sector_size;
+    uint32_t i;
+    int32_t ret;
+
+    if (ra != 0U)
+    {
+        ret = pcache->read_blocks(pcache->pread_stage, first, n + ra,
+                pcache->pdisk);
+        if (ret == FF_ERR_NONE)
+        {
+            (void)memcpy(pbuf, pcache->pread_stage, n * ss);
+            psrc = pcache->pread_stage;
+        }
+        else
+        {
+            /*the window may reach past the end of the disk*/
+            ra = 0U;
+        }
+    }
+    if (ra == 0U)
+    {
+        ret = pcache->read_blocks(pbuf, first, n, pcache->pdisk);
+        if (ret != FF_ERR_NONE)
+        {
+            return ret;
+        }
+    }
+
+    for (i = 0U; i < (n + ra); i++)
+    {
+        /*a sector read ahead may be cached already, and newer*/
+        if (cache_lookup(pcache, first + i) != NULL)
+        {
+            continue;
+        }
+        if (cache_alloc(pcache, first + i, &pentry) != FF_ERR_NONE)
+        {
+            break;
+        }
+        (void)memcpy(pentry->pdata, &psrc[i * ss], ss);
+        pentry->is_readahead = (i >= n);
+    }
+    pcache->stats.readahead += ra;
+    return FF_ERR_NONE;
+}
+
+static int32_t fatfs_cache_read(uint8_t *pucBuffer, uint32_t ulSectorNumber,
+        uint32_t ulSectorCount, FF_Disk_t *pxDisk)
+{
+    fatfs_cache_t *pcache = cache_find(pxDisk);
+    fatfs_cache_entry_t *pentry;
+    uint32_t ss;
+    uint32_t i = 0U;
+    uint32_t n;
+    uint32_t ra;
+    int32_t ret = FF_ERR_NONE;
+
+    if ((pcache == NULL) || (pxDisk == NULL))
+    {
+        return FATFS_CACHE_IO_ERROR;
+    }
+    ss = pcache->sector_size;
+    (void)xSemaphoreTake(pcache->lock, portMAX_DELAY);
+
+    if (ulSectorNumber == pcache->next_sector)
+    {
+        pcache->ra_window = (pcache->ra_window == 0U) ? FATFS_CACHE_RA_MIN :
+                (pcache->ra_window * 2U);
+        if (pcache->ra_window > FATFS_CACHE_RA_MAX)
+        {
+            pcache->ra_window = FATFS_CACHE_RA_MAX;
+        }
+    }
+    else
+    {
+        pcache->ra_window = 0U;
+    }
+    pcache->next_sector = ulSectorNumber + ulSectorCount;
+
+    if (ulSectorCount >= FATFS_CACHE_RA_MAX)
+    {
+        ret = pcache->read_blocks(pucBuffer, ulSectorNumber, ulSectorCount,
+                pxDisk);
+        if (ret == FF_ERR_NONE)
+        {
+            /*sectors only written to the cache are newer than the disk*/
+            for (i = 0U; i < ulSectorCount; i++)
+            {
+                pentry = cache_lookup(pcache, ulSectorNumber + i);
+                if ((pentry != NULL) && (pentry->is_dirty == true))
+                {
+                    (void)memcpy(&pucBuffer[i * ss], pentry->pdata, ss);
+                }
+            }
+            pcache->stats.bypassed += ulSectorCount;
+        }
+        (void)xSemaphoreGive(pcache->lock);
+        return ret;
+    }
+
+    while ((i < ulSectorCount) && (ret == FF_ERR_NONE))
+    {
+        pentry = cache_lookup(pcache, ulSectorNumber + i);
+        if (pentry != NULL)
+        {
+            (void)memcpy(&pucBuffer[i * ss], pentry->pdata, ss);
+            if (pentry->is_readahead == true)
+            {
+                pentry->is_readahead = false;
+                pcache->stats.readahead_hits++;
+            }
+            cache_touch(pcache, pentry);
+            pcache->stats.hits++;
+            i++;
+            continue;
+        }
+
+        /*merge the adjacent missing sectors into one request*/
+        n = 1U;
+        while (((i + n) < ulSectorCount) &&
+                (cache_lookup(pcache, ulSectorNumber + i + n) == NULL))
+        {
+            n++;
+        }
+        ra = 0U;
+        if ((i + n) == ulSectorCount)
+        {
+            ra = pcache->ra_window;
+            if ((n + ra) > FATFS_CACHE_RA_MAX)
+            {
+                ra = FATFS_CACHE_RA_MAX - n;
+            }
+            /*reading ahead must not evict what was just read*/
+            if (ra > (pcache->count / 2U))
+            {
+                ra = pcache->count / 2U;
+            }
+            if ((pxDisk->ulNumberOfSectors != 0U) &&
+                    ((ulSectorNumber + ulSectorCount + ra) >
+                    pxDisk->ulNumberOfSectors))
+            {
+                ra = 0U;
+            }
+        }
+        pcache->stats.misses += n;
+        ret = cache_read_run(pcache, &pucBuffer[i * ss], ulSectorNumber + i,
+                n, ra);
+        i += n;
+    }
+
+    (void)xSemaphoreGive(pcache->lock);
+    return ret;
+}
+
+static int32_t fatfs_cache_write(uint8_t *pucBuffer, uint32_t ulSectorNumber,
+        uint32_t ulSectorCount, FF_Disk_t *pxDisk)
+{
+    fatfs_cache_t *pcache = cache_find(pxDisk);
+    fatfs_cache_entry_t *pentry;
+    uint32_t ss;
+    uint32_t i;
+    int32_t ret = FF_ERR_NONE;
+
+    if ((pcache == NULL) || (pxDisk == NULL))
+    {
+        return FATFS_CACHE_IO_ERROR;
+    }
+    ss = pcache->sector_size;
+    (void)xSemaphoreTake(pcache->lock, portMAX_DELAY);
+
+    if (ulSectorCount >= FATFS_CACHE_RA_MAX)
+    {
+        ret = pcache->write_blocks(pucBuffer, ulSectorNumber, ulSectorCount,
+                pxDisk);
+        if (ret == FF_ERR_NONE)
+        {
+            /*keep the cached copies, now clean*/
+            for (i = 0U; i < ulSectorCount; i++)
+            {
+                pentry = cache_lookup(pcache, ulSectorNumber + i);
+                if (pentry != NULL)
+                {
+                    (void)memcpy(pentry->pdata, &pucBuffer[i * ss], ss);
+                    pentry->is_dirty = false;
+                }
+            }
+            pcache->stats.bypassed += ulSectorCount;
+        }
+        (void)xSemaphoreGive(pcache->lock);
+        return ret;
+    }
+
+    for (i = 0U; (i < ulSectorCount) && (ret == FF_ERR_NONE); i++)
+    {
+        pentry = cache_lookup(pcache, ulSectorNumber + i);
+        if (pentry == NULL)
+        {
+            ret = cache_alloc(pcache, ulSectorNumber + i, &pentry);
+            if (ret != FF_ERR_NONE)
+            {
+                break;
+            }
+        }
+        else
+        {
+            cache_touch(pcache, pentry);
+        }
+        (void)memcpy(pentry->pdata, &pucBuffer[i * ss], ss);
+        pentry->is_dirty = true;
+        pentry->is_readahead = false;
+    }
+
+    (void)xSemaphoreGive(pcache->lock);
+    return ret;
+}
+
+static void cache_free(fatfs_cache_t *pcache)
+{
+    if (pcache->lock != NULL)
+    {
+        vSemaphoreDelete(pcache->lock);
+    }
+    vPortFree(pcache->pmem);
+    vPortFree(pcache->pentries);
+    vPortFree(pcache->phash);
+    (void)memset(pcache, 0, sizeof(*pcache));
+}
+
+int32_t fatfs_cache_attach(FF_Disk_t *pxDisk, uint32_t sectors)
+{
+    fatfs_cache_t *pcache;
+    FF_IOManager_t *pxIOManager;
+    uint8_t *pdata;
+    uint32_t buckets = 1U;
+    uint32_t ss;
+    uint32_t i;
+
+    if ((pxDisk == NULL) || (pxDisk->pxIOManager == NULL) ||
+            (sectors < FATFS_CACHE_MIN_SECTORS))
+    {
+        return -EINVAL;
+    }
+    pxIOManager = pxDisk->pxIOManager;
+    ss = pxIOManager->usSectorSize;
+    if (ss == 0U)
+    {
+        return -EINVAL;
+    }
+    if (cache_find(pxDisk) != NULL)
+    {
+        return -EBUSY;
+    }
+    pcache = cache_find(NULL);
+    if (pcache == NULL)
+    {
+        return -EBUSY;
+    }
+
+    while (buckets < sectors)
+    {
+        buckets <<= 1U;
+    }
+    /*the sectors, then the staging areas of the merged requests*/
+    pcache->pmem = pvPortMalloc(((sectors + (2U * FATFS_CACHE_RA_MAX)) * ss) +
+            FATFS_CACHE_ALIGN);
+    pcache->pentries = (fatfs_cache_entry_t *)pvPortMalloc(sectors *
+            sizeof(fatfs_cache_entry_t));
+    pcache->phash = (fatfs_cache_entry_t **)pvPortMalloc(buckets *
+            sizeof(fatfs_cache_entry_t *));
+    pcache->lock = xSemaphoreCreateMutex();
+    if ((pcache->pmem == NULL) || (pcache->pentries == NULL) ||
+            (pcache->phash == NULL) || (pcache->lock == NULL))
+    {
+        cache_free(pcache);
+        return -ENOMEM;
+    }
+
+    pdata = (uint8_t *)(((uintptr_t)pcache->pmem + FATFS_CACHE_ALIGN - 1U) &
+            ~((uintptr_t)FATFS_CACHE_ALIGN - 1U));
+    pcache->pread_stage = &pdata[sectors * ss];
+    pcache->pwrite_stage = &pdata[(sectors + FATFS_CACHE_RA_MAX) * ss];
+    (void)memset(pcache->phash, 0, buckets * sizeof(fatfs_cache_entry_t *));
+    (void)memset(pcache->pentries, 0, sectors * sizeof(fatfs_cache_entry_t));
+    for (i = 0U; i < sectors; i++)
+    {
+        pcache->pentries[i].pdata = &pdata[i * ss];
+        pcache->pentries[i].plru_prev = (i != 0U) ?
+                &pcache->pentries[i - 1U] : NULL;
+        pcache->pentries[i].plru_next = ((i + 1U) < sectors) ?
+                &pcache->pentries[i + 1U] : NULL;
+    }
+    pcache->plru_head = &pcache->pentries[0];
+    pcache->plru_tail = &pcache->pentries[sectors - 1U];
+    pcache->sector_size = ss;
+    pcache->count = sectors;
+    pcache->hash_mask = buckets - 1U;
+    pcache->next_sector = UINT32_MAX;
+    pcache->ra_window = 0U;
+    (void)memset(&pcache->stats, 0, sizeof(pcache->stats));
+
+    pcache->read_blocks = pxIOManager->xBlkDevice.fnpReadBlocks;
+    pcache->write_blocks = pxIOManager->xBlkDevice.fnpWriteBlocks;
+    pcache->pdisk = pxDisk;
+    pxIOManager->xBlkDevice.fnpReadBlocks = fatfs_cache_read;
+    pxIOManager->xBlkDevice.fnpWriteBlocks = fatfs_cache_write;
+
+    return 0;
+}
+
+int32_t fatfs_cache_flush(FF_Disk_t *pxDisk)
+{
+    fatfs_cache_t *pcache;
+    fatfs_cache_entry_t *pentry;
+    uint32_t i;
+    int32_t ret = 0;
+
+    if (pxDisk == NULL)
+    {
+        return -EINVAL;
+    }
+    pcache = cache_find(pxDisk);
+    if (pcache == NULL)
+    {
+        return -EINVAL;
+    }
+
+    (void)xSemaphoreTake(pcache->lock, portMAX_DELAY);
+    for (i = 0U; i < pcache->count; i++)
+    {
+        pentry = &pcache->pentries[i];
+        if ((pentry->is_valid == true) && (pentry->is_dirty == true))
+        {
+            if (cache_write_run(pcache, pentry) != FF_ERR_NONE)
+            {
+                ret = -EIO;
+                break;
+            }
+        }
+    }
+    (void)xSemaphoreGive(pcache->lock);
+    return ret;
+}
+
+int32_t fatfs_cache_detach(FF_Disk_t *pxDisk)
+{
+    fatfs_cache_t *pcache;
+    FF_IOManager_t *pxIOManager;
+    int32_t ret;
+
+    ret = fatfs_cache_flush(pxDisk);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    pcache = cache_find(pxDisk);
+    pxIOManager = pxDisk->pxIOManager;
+    pxIOManager->xBlkDevice.fnpReadBlocks = pcache->read_blocks;
+    pxIOManager->xBlkDevice.fnpWriteBlocks = pcache->write_blocks;
+    cache_free(pcache);
+    return 0;
+}
+
+int32_t fatfs_cache_get_stats(FF_Disk_t *pxDisk, fatfs_cache_stats_t *pstats)
+{
+    fatfs_cache_t *pcache;
+    uint32_t i;
+
+    if ((pxDisk == NULL) || (pstats == NULL))
+    {
+        return -EINVAL;
+    }
+    pcache = cache_find(pxDisk);
+    if (pcache == NULL)
+    {
+        return -EINVAL;
+    }
+    (void)xSemaphoreTake(pcache->lock, portMAX_DELAY);
+    *pstats = pcache->stats;
+    pstats->occupied = 0U;
+    for (i = 0U; i < pcache->count; i++)
+    {
+        if (pcache->pentries[i].is_valid == true)
+        {
+            pstats->occupied++;
+        }
+    }
+    pstats->capacity = pcache->count;
+    (void)xSemaphoreGive(pcache->lock);
+    return 0;
+}
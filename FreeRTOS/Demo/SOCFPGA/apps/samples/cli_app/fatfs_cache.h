@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Header file for the sector cache of FAT disks
+ */
+
+#ifndef __FATFS_CACHE_H__
+#define __FATFS_CACHE_H__
+
+#include <stdint.h>
+#include "ff_sddisk.h"
+
+/* Default number of sectors cached for a disk */
+#define FATFS_CACHE_SECTORS        256U
+
+/* Smallest cache accepted by fatfs_cache_attach() */
+#define FATFS_CACHE_MIN_SECTORS    32U
+
+/*
+ * Read ahead window of sequential reads, in sectors. It starts at the
+ * minimum, doubles on every further sequential read up to the maximum and
+ * halves whenever a sector read ahead is evicted unused. Requests of the
+ * maximum or more go around the cache.
+ */
+#define FATFS_CACHE_RA_MIN         8U
+#define FATFS_CACHE_RA_MAX         64U
+
+/*
+ * @brief Counters of a disk cache, in sectors
+ */
+typedef struct
+{
+    uint32_t hits;              /* reads served from the cache */
+    uint32_t misses;            /* reads sent to the disk */
+    uint32_t readahead;         /* sectors read ahead of the requests */
+    uint32_t readahead_hits;    /* sectors read ahead then used */
+    uint32_t bypassed;          /* large requests sent to the disk as they are */
+    uint32_t written_back;      /* dirty sectors written to the disk */
+    uint32_t occupied;          /* sectors holding data of the disk */
+    uint32_t capacity;          /* sectors the cache can hold */
+} fatfs_cache_stats_t;
+
+/*
+ * @brief Put a sector cache between FreeRTOS+FAT and the block device of a disk
+ *
+ * Reads and writes of the disk go through the cache from then on. Writes
+ * stay in the cache until they are flushed, evicted or the cache is detached.
+ *
+ * @param[in] pxDisk  Mounted disk.
+ * @param[in] sectors Number of sectors to cache.
+ *
+ * @return
+ * -  0:      Cache attached.
+ * - -EINVAL: Invalid disk or fewer than FATFS_CACHE_MIN_SECTORS sectors.
+ * - -EBUSY:  The disk has a cache already or no cache is left.
+ * - -ENOMEM: Not enough memory for the cache.
+ */
+int32_t fatfs_cache_attach(FF_Disk_t *pxDisk, uint32_t sectors);
+
+/*
+ * @brief Flush the cache of a disk and remove it
+ *
+ * Call before the disk is deleted.
+ *
+ * @param[in] pxDisk Disk with a cache.
+ *
+ * @return
+ * -  0:      Cache removed.
+ * - -EINVAL: The disk has no cache.
+ * - -EIO:    Writing the dirty sectors failed, the cache is kept.
+ */
+int32_t fatfs_cache_detach(FF_Disk_t *pxDisk);
+
+/*
+ * @brief Write the dirty sectors of a disk cache to the disk
+ *
+ * Adjacent dirty sectors are written with a single request. Flush the
+ * buffers of FreeRTOS+FAT first with FF_FlushCache().
+ *
+ * @param[in] pxDisk Disk with a cache.
+ *
+ * @return
+ * -  0:      All sectors written.
+ * - -EINVAL: The disk has no cache.
+ * - -EIO:    Writing to the disk failed.
+ */
+int32_t fatfs_cache_flush(FF_Disk_t *pxDisk);
+
+/*
+ * @brief Get the counters of a disk cache
+ *
+ * @param[in]  pxDisk Disk with a cache.
+ * @param[out] pstats Counters since the cache was attached, and the current
+ *                    occupancy of the cache.
+ *
+ * @return
+ * -  0:      Counters copied.
+ * - -EINVAL: The disk has no cache.
+ */
+int32_t fatfs_cache_get_stats(FF_Disk_t *pxDisk, fatfs_cache_stats_t *pstats);
+
+#endif
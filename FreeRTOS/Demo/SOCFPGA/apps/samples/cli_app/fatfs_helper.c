@@ -10,7 +10,9 @@
 #include "FreeRTOS.h"
 #include "ff_sys.h"
 #include <stdio.h>
+#include <errno.h>
 #include "fatfs_helper.h"
+#include "fatfs_cache.h"
 
 #define MOUNTED        1
 #define UNMOUNTED      0
@@ -37,6 +39,10 @@ void ff_mount( const char *MountName, disk_type_t dtype)
             {
                 printf("\r\n sdmmc mounted successfully at /sd/");
                 sdmmc_mount_status = MOUNTED;
+                if (fatfs_cache_attach(sdmmcObj, FATFS_CACHE_SECTORS) != 0)
+                {
+                    printf("\r\n sector cache not available");
+                }
             }
             else
             {
@@ -224,6 +230,15 @@ void ff_un_mount( disk_type_t dtype)
     if (DiskObj != NULL)
     {
         FF_Unmount(DiskObj);
+        /*the cache holds the last writes of the unmount, the disk and its
+         *cache are kept until they reach the disk so the unmount can be
+         *retried*/
+        if ((dtype == DISK_TYPE_SDMMC) &&
+                (fatfs_cache_detach(DiskObj) == -EIO))
+        {
+            printf("\r Failed to write back the sector cache, unmount again to retry \n");
+            return;
+        }
         FF_SDDiskDelete(DiskObj);
         printf("\r Unmounting Successful \n");
         if( dtype == DISK_TYPE_SDMMC)
@@ -374,3 +389,56 @@ void ff_rm( const char *fileName, disk_type_t dtype)
         }
     }
 }
+
+void ff_cache_stats( disk_type_t dtype)
+{
+    fatfs_cache_stats_t stats;
+    uint64_t reads;
+    uint32_t permille = 0U;
+
+    if ((dtype != DISK_TYPE_SDMMC) || (sdmmcObj == NULL))
+    {
+        printf("\r No cached disk mounted \n");
+        return;
+    }
+    if (fatfs_cache_get_stats(sdmmcObj, &stats) != 0)
+    {
+        printf("\r No sector cache on this disk \n");
+        return;
+    }
+
+    reads = (uint64_t)stats.hits + stats.misses;
+    if (reads != 0UL)
+    {
+        permille = (uint32_t)(((uint64_t)stats.hits * 1000UL) / reads);
+    }
+    printf("\r\n Sector cache of %u sectors", stats.capacity);
+    printf("\r\n   in use          %u", stats.occupied);
+    printf("\r\n   hits            %u", stats.hits);
+    printf("\r\n   misses          %u", stats.misses);
+    printf("\r\n   hit rate        %u.%u%%", permille / 10U, permille % 10U);
+    printf("\r\n   read ahead      %u (%u used)", stats.readahead,
+            stats.readahead_hits);
+    printf("\r\n   bypassed        %u", stats.bypassed);
+    printf("\r\n   written back    %u\r\n", stats.written_back);
+}
+
+void ff_flush( disk_type_t dtype)
+{
+    if ((dtype != DISK_TYPE_SDMMC) || (sdmmcObj == NULL))
+    {
+        printf("\r No cached disk mounted \n");
+        return;
+    }
+
+    /*the buffers of FreeRTOS+FAT first, then the sector cache*/
+    if ((FF_FlushCache(sdmmcObj->pxIOManager) != FF_ERR_NONE) ||
+            (fatfs_cache_flush(sdmmcObj) != 0))
+    {
+        printf("\r Flush failed \n");
+    }
+    else
+    {
+        printf("\r Flushed to disk \n");
+    }
+}
@@ -25,6 +25,8 @@ void ff_un_mount( disk_type_t dtype );
 void ff_rm_dir( const char *dirPath, disk_type_t dtype);
 void ff_write( const char *FileName, const char *buffer, disk_type_t dtype);
 void ff_rm( const char *fileName, disk_type_t dtype);
+void ff_cache_stats( disk_type_t dtype);
+void ff_flush( disk_type_t dtype);
 
 #endif
 
@@ -130,6 +130,10 @@
     #define ipconfigIPERF_USE_ZERO_COPY    1
 #endif
 
+#ifndef ipconfigUSE_TCP_TSO
+    #define ipconfigUSE_TCP_TSO    0
+#endif
+
 #ifndef ipconfigIPERF_TX_BUFSIZE
     #define ipconfigIPERF_TX_BUFSIZE    ( 45 * 1024 )               /* Units of bytes. */
     #define ipconfigIPERF_TX_WINSIZE    ( 4 )                       /* Size in units of MSS */
@@ -218,6 +222,8 @@ typedef struct
         eTCP_Server_Status_t eTCP_Status;
         uint32_t ulSkipCount;
         uint64_t ullAmount;
+        uint64_t ullSendCount; /* Bytes sent in reverse mode. */
+        TickType_t xSendStart;
         TickType_t xRemainingTime;
         TimeOut_t xTimeOut;
     #endif /* ipconfigIPERF_VERSION == 3 */
@@ -362,6 +368,25 @@ static void vIPerfTCPClose( TcpClient_t * pxClient )
                            ( unsigned ) FreeRTOS_ntohs( pxClient->xRemoteAddr.sin_port ),
                            ( unsigned ) pxClient->ulRecvCount ) );
 
+        #if ( ipconfigIPERF_VERSION == 3 )
+            if( pxClient->ullSendCount != 0U )
+            {
+                uint32_t ulElapsedMs = ( uint32_t ) ( ( xTaskGetTickCount() - pxClient->xSendStart ) * portTICK_PERIOD_MS );
+
+                if( ulElapsedMs == 0U )
+                {
+                    ulElapsedMs = 1U;
+                }
+
+                /* Compare runs with ipconfigUSE_TCP_TSO set to 0 and 1 */
+                FreeRTOS_printf( ( "vIPerfTCPClose: Sent %u KB in %u ms, %u Mbit/s (TSO %s)\n",
+                                   ( unsigned ) ( pxClient->ullSendCount / 1024U ),
+                                   ( unsigned ) ulElapsedMs,
+                                   ( unsigned ) ( ( pxClient->ullSendCount * 8U ) / ( ( uint64_t ) ulElapsedMs * 1000U ) ),
+                                   ( ipconfigUSE_TCP_TSO != 0 ) ? "on" : "off" ) );
+            }
+        #endif
+
         FreeRTOS_FD_CLR( pxClient->xServerSocket, xSocketSet, eSELECT_ALL );
         FreeRTOS_closesocket( pxClient->xServerSocket );
         pxClient->xServerSocket = NULL;
@@ -420,6 +445,13 @@ static int vIPerfTCPSend( TcpClient_t * pxClient )
             break;
         }
 
+        if( pxClient->ullSendCount == 0U )
+        {
+            pxClient->xSendStart = xTaskGetTickCount();
+        }
+
+        pxClient->ullSendCount += ( uint64_t ) xResult;
+
         if( pxClient->bits.bTimed == pdFALSE_UNSIGNED )
         {
             pxClient->ullAmount -= ( uint64_t ) uxSize;
@@ -150,6 +150,7 @@ int mair_idx;
     /*Writeback the pagetable from cache to memory before TLB invalidate*/
     ptr = &l2_pagetable[ offset ];
     asm volatile ( "DC CVAC, %0" : : "r" ( ptr ) : "memory" );
+    asm volatile ( "DSB SY" );
 
     /*Force the TLB to be reloaded*/
     invalidte_tlb();
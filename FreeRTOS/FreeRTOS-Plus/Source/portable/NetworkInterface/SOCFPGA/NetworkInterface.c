@@ -54,6 +54,8 @@
 
 #include "socfpga_xgmac.h"
 #include "socfpga_xgmac_phy.h"
+#include "SocfpgaNetworkInterface.h"
+#include "SocfpgaBufferRing.h"
 /*-----------------------------------------------------------*/
 
 /* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
@@ -74,6 +76,114 @@
     #define niEMAC_HANDLER_TASK_PRIORITY    configMAX_PRIORITIES - 1U
 #endif
 
+#ifndef niEMAC_RX_TASK_PRIORITY
+/* Define the priority of the prvEMACRxTask() instances which serve the Rx
+ * rings of DMA channel 1 and above. */
+    #define niEMAC_RX_TASK_PRIORITY    niEMAC_HANDLER_TASK_PRIORITY
+#endif
+
+#ifndef niEMAC_RX_STEER_MODE
+/* How received frames are spread over the DMA channels when more than one is
+ * in use, one of xgmac_rx_steer_mode_t. VLAN user priorities are split evenly
+ * over the channels, the highest priorities on the highest channel. */
+    #define niEMAC_RX_STEER_MODE    XGMAC_RX_STEER_VLAN_PRIO
+#endif
+
+#ifndef niEMAC_TX_BURST_SIZE
+/* Maximum number of frames handed to the DMA with a single tail pointer write. */
+    #define niEMAC_TX_BURST_SIZE    16U
+#endif
+
+#ifndef niEMAC_RX_POLL_BUDGET
+/* Maximum number of Rx descriptors processed per wake-up of the handler task.
+ * The Rx interrupt stays masked until the ring is drained. */
+    #define niEMAC_RX_POLL_BUDGET    64U
+#endif
+
+#ifndef niEMAC_RX_REFILL_BATCH
+/* Rx descriptors refilled per write of the Rx tail pointer. */
+    #define niEMAC_RX_REFILL_BATCH    16U
+#endif
+
+#ifndef niEMAC_RX_BUFFER_CACHE_SIZE
+/* Network buffers kept ready per DMA channel to replace received ones. The
+ * cache is topped up once per poll, so a full poll budget does not allocate
+ * per frame. */
+    #define niEMAC_RX_BUFFER_CACHE_SIZE    niEMAC_RX_POLL_BUDGET
+#endif
+
+#ifndef niEMAC_RX_COALESCE_FRAMES
+/* Received frames per Rx interrupt, 1 raises an interrupt for every frame. */
+    #define niEMAC_RX_COALESCE_FRAMES    16U
+#endif
+
+#ifndef niEMAC_RX_COALESCE_WATCHDOG
+/* Rx watchdog count in units of niEMAC_RX_COALESCE_WATCHDOG_UNIT. It bounds the
+ * latency of frames that do not complete a group of niEMAC_RX_COALESCE_FRAMES. */
+    #define niEMAC_RX_COALESCE_WATCHDOG    64U
+#endif
+
+#ifndef niEMAC_RX_COALESCE_WATCHDOG_UNIT
+/* Rx watchdog unit, 0 to 3 selects 256 to 2048 system clock cycles. */
+    #define niEMAC_RX_COALESCE_WATCHDOG_UNIT    0U
+#endif
+
+#ifndef niEMAC_TX_COALESCE_FRAMES
+/* Transmitted frames per Tx interrupt. Completions of a smaller group are
+ * reaped when the handler task times out. */
+    #define niEMAC_TX_COALESCE_FRAMES    1U
+#endif
+
+#ifndef ipconfigUSE_TCP_TSO
+/* Let the XGMAC segment IPv4/TCP frames larger than the MTU. The stack only
+ * builds such frames when its segment size is configured above the MTU. */
+    #define ipconfigUSE_TCP_TSO    0
+#endif
+
+#ifndef niEMAC_MTU
+/* MTU programmed into the XGMAC, jumbo frames are used above 1500 bytes. */
+    #define niEMAC_MTU    ipconfigNETWORK_MTU
+#endif
+
+#if ( ( niEMAC_MTU < XGMAC_MIN_MTU ) || ( niEMAC_MTU > XGMAC_MAX_MTU ) )
+    #error "niEMAC_MTU is outside of the range supported by the XGMAC"
+#endif
+
+/* Largest frame the port sends or receives, and the size of the network
+ * buffers holding one including the alignment room. */
+#define niEMAC_FRAME_SIZE     XGMAC_FRAME_SIZE( niEMAC_MTU )
+#define niEMAC_BUFFER_SIZE    XGMAC_BUF_SIZE( niEMAC_MTU )
+
+#ifndef niEMAC_HW_TIMESTAMPING
+/* Timestamp frames in the XGMAC with the IEEE 1588 system time. Receive
+ * timestamps are looked up with xNetworkInterfaceGetRxTimestamp(). */
+    #define niEMAC_HW_TIMESTAMPING    0
+#endif
+
+#ifndef niEMAC_RX_TS_HISTORY
+/* Number of recent receive timestamps kept for the lookup. */
+    #define niEMAC_RX_TS_HISTORY    16U
+#endif
+
+#ifndef niEMAC_COLLECT_STATS
+/* Count frames, drops and the Rx latency for xNetworkInterfaceGetStats().
+ * The XGMAC interrupt and MMC counters are reported either way. */
+    #define niEMAC_COLLECT_STATS    1
+#endif
+
+#if ( niEMAC_COLLECT_STATS != 0 )
+    #define niEMAC_STAT_ADD( xField, xValue ) \
+    ( void ) __atomic_fetch_add( &( xInterfaceStats.xField ), ( xValue ), __ATOMIC_RELAXED )
+#else
+    #define niEMAC_STAT_ADD( xField, xValue )    do {} while( 0 )
+#endif
+
+#define niEMAC_STAT_DROP( eReason )    niEMAC_STAT_ADD( ulDrops[ eReason ], 1U )
+
+#if ( ( ipconfigUSE_TCP_TSO != 0 ) && ( ipconfigZERO_COPY_TX_DRIVER == 0 ) )
+    #error "ipconfigUSE_TCP_TSO requires ipconfigZERO_COPY_TX_DRIVER, the copy buffers only hold one MTU"
+#endif
+
 #define niBMSR_LINK_STATUS                  0x0004uL
 
 #ifndef PHY_LS_HIGH_CHECK_TIME_MS
@@ -111,22 +221,49 @@
       XGMAC_IF_ERR_EVENT )
 
 #define TX_BUFFER_COUNT       ( 512U )
-#define TX_BUFFER_SIZE        XGMAC_MAX_PACKET_SIZE
+#define TX_BUFFER_SIZE        niEMAC_BUFFER_SIZE
 
-#define RX_BUFFER_COUNT       ( 512U )
+/* Copied out Rx buffers keep the standard size whatever the MTU, a jumbo
+ * frame is received in several of them and gathered into a network buffer */
+#define RX_BUFFER_COUNT       ( 512U * XGMAC_NUM_DMA_CHANNELS )
 #define RX_BUFFER_SIZE        XGMAC_MAX_PACKET_SIZE
 
+#if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+    #define niEMAC_RX_DMA_BUFFER_SIZE    niEMAC_FRAME_SIZE
+#else
+    #define niEMAC_RX_DMA_BUFFER_SIZE    XGMAC_PACKET_SIZE
+#endif
+
 
 static NetworkInterface_t * AgxInterface = NULL;
 /*-----------------------------------------------------------*/
 
-/* Structure with TX data output buffer details*/
+#if ( niEMAC_HW_TIMESTAMPING != 0 )
+
+/* Receive timestamp of a frame handed to the IP task, keyed by the network
+ * buffer holding the frame. FreeRTOS+TCP has no timestamp field of its own. */
+    typedef struct
+    {
+    const uint8_t * pucFrame;
+    size_t uxLength;
+    xgmac_timestamp_t xTimestamp;
+    } RxTimestamp_t;
+
+    static RxTimestamp_t xRxTimestamps[ niEMAC_RX_TS_HISTORY ];
+    static UBaseType_t uxRxTimestampNext = 0U;
+
+    static void prvRecordRxTimestamp( const uint8_t * pucFrame,
+                                      size_t uxLength,
+                                      const xgmac_timestamp_t * pxTimestamp );
+#endif
+/*-----------------------------------------------------------*/
+
+/* Structure with TX data output buffer details. Buffers are taken by the IP
+ * task in xNetworkInterfaceOutput() and returned with xTxPoolMutex held. */
 typedef struct
 {
-uint8_t * pTxBuffer[ TX_BUFFER_COUNT ];
-uint16_t usHeadIndex;
-uint16_t usTailIndex;
-uint16_t usBufUsedCnt;
+uint8_t * pTxBuffer[ TX_BUFFER_COUNT + 1U ];
+BufferRing_t xRing;
 uint8_t ucIsInitiazed;
 } TxBufferPool_t;
 /*-----------------------------------------------------------*/
@@ -136,15 +273,32 @@ static TxBufferPool_t TxBufferPool = { NULL };
 static TxBufferPool_t * pxTxBufferPool = &TxBufferPool;
 #endif
 
-static SemaphoreHandle_t xTxBufSynchSem = NULL;
+/* Frames waiting for the next burst submission to the DMA. The array and the
+ * counters are only accessed from inside a critical section. */
+static xgmac_tx_buf_t xTxStagedBuffers[ niEMAC_TX_BURST_SIZE ];
+static UBaseType_t uxTxStagedCount = 0U;
+static UBaseType_t uxTxInFlightCount = 0U;
+
+/* Serialises burst submissions so that staged frames keep their order. */
+static SemaphoreHandle_t xTxFlushMutex = NULL;
+
+/* Keeps a single producer on the Tx buffer pool. It is separate from
+ * xTxFlushMutex so that completions are reaped while a burst waits for free
+ * descriptors, which only the reaping gives back. */
+static SemaphoreHandle_t xTxPoolMutex = NULL;
+
+#if ( ipconfigUSE_TCP_TSO != 0 )
+/* Set once the XGMAC accepted XGMAC_SET_TSO. */
+static BaseType_t xTsoActive = pdFALSE;
+#endif
 
-/* Structure with RX data output buffer details*/
+/* Structure with RX data output buffer details. Buffers are only taken while
+ * the Rx descriptors are set up, a received frame is copied out and its
+ * buffer stays on the descriptor. */
 typedef struct
 {
-uint8_t * pRxBuffer[ RX_BUFFER_COUNT ];
-uint16_t usHeadIndex;
-uint16_t usTailIndex;
-uint16_t usBufUsedCnt;
+uint8_t * pRxBuffer[ RX_BUFFER_COUNT + 1U ];
+BufferRing_t xRing;
 uint8_t ucIsInitiazed;
 } RxBufferPool_t;
 /*-----------------------------------------------------------*/
@@ -154,8 +308,6 @@ static RxBufferPool_t RxBufferPool = { NULL };
 static RxBufferPool_t * pxRxBufferPool = &RxBufferPool;
 #endif
 
-static SemaphoreHandle_t xRxBufSynchSem = NULL;
-
 BaseType_t prvUpdateRxDMADescriptors( uint8_t * pucRxBuffer,
                                       NetworkInterface_t * pxInterface );
 
@@ -190,6 +342,21 @@ BaseType_t prvReinitRxBufferPool( RxBufferPool_t * pRxBufferPool );
  */
 void prvEMACHandlerTask( void * pvParameters );
 
+/*
+ * A deferred Rx handler for DMA channel 1 and above.
+ */
+void prvEMACRxTask( void * pvParameters );
+
+/*
+ * Program the Rx steering over the DMA channels
+ */
+static void prvConfigureRxSteering( xgmac_handle_t pXGMACHandle );
+static BaseType_t prvIsTsoFrame( const uint8_t * pucFrame,
+                                 size_t uxLength );
+static void prvSetTsoFields( xgmac_tx_buf_t * pxTxBuf );
+static void prvFillRxBufferCache( uint8_t ucChannel );
+static NetworkBufferDescriptor_t * prvGetRxBufferFromCache( uint8_t ucChannel );
+
 static void prvHandleErrorEvents( uint8_t ucErrStatus,
                                   uint8_t ucErrChnlNum,
                                   NetworkInterface_t * pxInterface );
@@ -198,16 +365,57 @@ BaseType_t xNetworkInterfaceOutput( NetworkInterface_t * pxInterface,
                                     NetworkBufferDescriptor_t * const pxNetworkBuffer,
                                     BaseType_t bReleaseAfterSend );
 
+/*
+ * Hand all staged Tx frames to the DMA in one burst. Returns without sending
+ * when another task is flushing and xBlockTime expires.
+ */
+static void prvFlushTxBuffers( xgmac_handle_t pXGMACHandle,
+                               TickType_t xBlockTime );
+
+static void prvReleaseTxBuffer( uint8_t * pucBuffer );
+
 /* Holds the handle of the task used as a deferred interrupt processor */
 static TaskHandle_t xEMACTaskHandle = NULL;
 
+/* Handles of the tasks serving the Rx ring of each DMA channel. Channel 0 is
+ * served by prvEMACHandlerTask itself. */
+static TaskHandle_t xEMACRxTaskHandles[ XGMAC_NUM_DMA_CHANNELS ] = { NULL };
+
+/* Pre-allocated replacement buffers per DMA channel. Each cache is only used
+ * by the task that serves the Rx ring of its channel. */
+static NetworkBufferDescriptor_t * pxRxBufferCache[ XGMAC_NUM_DMA_CHANNELS ][ niEMAC_RX_BUFFER_CACHE_SIZE ];
+static UBaseType_t uxRxBufferCacheCount[ XGMAC_NUM_DMA_CHANNELS ] = { 0U };
+
+/* Network buffer collecting a frame that spans several Rx DMA buffers, and
+ * the number of bytes collected so far, per DMA channel */
+static NetworkBufferDescriptor_t * pxRxGatherBuffer[ XGMAC_NUM_DMA_CHANNELS ] = { NULL };
+static size_t uxRxGatherLength[ XGMAC_NUM_DMA_CHANNELS ] = { 0U };
+
+static NetworkBufferDescriptor_t * prvGatherRxFrame( uint8_t ucChannel,
+                                                     const uint8_t * pucData,
+                                                     size_t uxLength,
+                                                     uint32_t ulPacketStatus,
+                                                     size_t * puxFrameLength );
+
+#if ( niEMAC_COLLECT_STATS != 0 )
+    static NetworkInterfaceStats_t xInterfaceStats;
+
+/* Generic timer count at the first Rx interrupt not yet followed by a hand-off
+ * to the stack, per DMA channel, 0 when there is none. */
+    static uint64_t ullRxIrqStamp[ XGMAC_NUM_DMA_CHANNELS ] = { 0U };
+
+    static void prvRecordRxLatency( uint8_t ucChannel,
+                                    int lDelivered );
+#endif
+
 void prvEMACIRQHanlderCallback( xgmac_int_status_t xIntrStatus,
                                 void * pvIrqData );
 
 /*
  * NetworkInterfaceInput function to receive a new packet and send it to IP_task
  */
-BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface );
+BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface,
+                                     uint8_t ucChannel );
 
 /*
  * prvNetworkInterfaceDown function to stop EMAC and DMA for recovery from error
@@ -253,7 +461,6 @@ typedef enum XGMAC_STATE
  */
 
 static xgmac_config_t xEmacConfig[ EMAC_MAX_INSTANCE ] __attribute__( ( aligned( 64 ) ) );
-static SemaphoreHandle_t xSemaphoreCounterTx;
 /*-----------------------------------------------------------*/
 
 /* Initialize PHY parameters */
@@ -285,8 +492,17 @@ uint8_t * pucBufferPool = NULL;
 
     eXGMACState = XGMAC_EMACInit;
 
-    xSemaphoreCounterTx = xSemaphoreCreateCounting( 512, 0 );
-    configASSERT( xSemaphoreCounterTx != NULL );
+    if( xTxFlushMutex == NULL )
+    {
+        xTxFlushMutex = xSemaphoreCreateMutex();
+        configASSERT( xTxFlushMutex != NULL );
+    }
+
+    if( xTxPoolMutex == NULL )
+    {
+        xTxPoolMutex = xSemaphoreCreateMutex();
+        configASSERT( xTxPoolMutex != NULL );
+    }
 
     AgxInterface = pxInterface;
 
@@ -314,6 +530,40 @@ uint8_t * pucBufferPool = NULL;
                 break;
             }
 
+            /* Coalesce interrupts and poll the Rx ring with the Rx interrupt masked */
+            {
+            xgmac_coalesce_t xCoalesce;
+            bool xPollMode = true;
+
+                xCoalesce.rx_frames = niEMAC_RX_COALESCE_FRAMES;
+                xCoalesce.rx_watchdog = niEMAC_RX_COALESCE_WATCHDOG;
+                xCoalesce.rx_watchdog_unit = niEMAC_RX_COALESCE_WATCHDOG_UNIT;
+                xCoalesce.tx_frames = niEMAC_TX_COALESCE_FRAMES;
+
+                if( ( xgmac_ioctl( pXGMACHandle, XGMAC_SET_COALESCE, &xCoalesce ) != 0 ) ||
+                    ( xgmac_ioctl( pXGMACHandle, XGMAC_SET_RX_POLL_MODE, &xPollMode ) != 0 ) )
+                {
+                    FreeRTOS_printf( ( "SOCFPGA_XGMAC: Interrupt Coalescing Setup Failed....\n" ) );
+                    eXGMACState = XGMAC_Failed;
+                    break;
+                }
+            }
+
+            /* Size the frames and the Rx DMA buffers before the DMA is set up */
+            {
+            xgmac_mtu_config_t xMtu;
+
+                xMtu.mtu = niEMAC_MTU;
+                xMtu.rx_buf_size = niEMAC_RX_DMA_BUFFER_SIZE;
+
+                if( xgmac_ioctl( pXGMACHandle, XGMAC_SET_MTU, &xMtu ) != 0 )
+                {
+                    FreeRTOS_printf( ( "SOCFPGA_XGMAC: MTU Setup Failed....\n" ) );
+                    eXGMACState = XGMAC_Failed;
+                    break;
+                }
+            }
+
             /* Transition to PHY Init */
             eXGMACState = XGMAC_PHYInit;
 
@@ -426,6 +676,34 @@ uint8_t * pucBufferPool = NULL;
                 break;
             }
 
+            prvConfigureRxSteering( pXGMACHandle );
+
+            #if ( ipconfigUSE_TCP_TSO != 0 )
+            {
+            bool xTso = true;
+
+                if( xgmac_ioctl( pXGMACHandle, XGMAC_SET_TSO, &xTso ) != 0 )
+                {
+                    FreeRTOS_printf( ( "SOCFPGA_XGMAC: TSO not available, frames are sent as built\n" ) );
+                }
+                else
+                {
+                    xTsoActive = pdTRUE;
+                }
+            }
+            #endif
+
+            #if ( niEMAC_HW_TIMESTAMPING != 0 )
+            {
+            bool xTimestamping = true;
+
+                if( xgmac_ioctl( pXGMACHandle, XGMAC_SET_TIMESTAMPING, &xTimestamping ) != 0 )
+                {
+                    FreeRTOS_printf( ( "SOCFPGA_XGMAC: Hardware timestamping not available\n" ) );
+                }
+            }
+            #endif
+
             /* Transition to Wait for PHY */
             eXGMACState = XGMAC_PHYWait;
 
@@ -451,6 +729,31 @@ uint8_t * pucBufferPool = NULL;
                     eXGMACState = XGMAC_Failed;
                     break;
                 }
+
+                xEMACRxTaskHandles[ XGMAC_DMA_CH0 ] = xEMACTaskHandle;
+            }
+
+            for( uint8_t ucChannel = 1U; ucChannel < XGMAC_NUM_DMA_CHANNELS; ucChannel++ )
+            {
+                if( xEMACRxTaskHandles[ ucChannel ] == NULL )
+                {
+                    ( void ) xTaskCreate( prvEMACRxTask, "EMACRx",
+                                          configEMAC_TASK_STACK_SIZE,
+                                          ( void * ) ( uintptr_t ) ucChannel,
+                                          niEMAC_RX_TASK_PRIORITY,
+                                          &( xEMACRxTaskHandles[ ucChannel ] ) );
+
+                    if( xEMACRxTaskHandles[ ucChannel ] == NULL )
+                    {
+                        eXGMACState = XGMAC_Failed;
+                        break;
+                    }
+                }
+            }
+
+            if( eXGMACState == XGMAC_Failed )
+            {
+                break;
             }
 
             /* Transition to EMAC Ready */
@@ -484,11 +787,10 @@ BaseType_t xNetworkInterfaceOutput( NetworkInterface_t * pxInterface,
 {
 int instance = ( int ) ( ( uintptr_t ) pxInterface->pvArgument );
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
-int32_t xStatus;
-
-xgmac_tx_buf_t xDMATxBuffer;
 uint8_t * pucBuffer;
 uint32_t ulDataLength = 0;
+BaseType_t xStaged;
+BaseType_t xFlushNow;
 
     if( pXGMACHandle == NULL )
     {
@@ -501,24 +803,48 @@ uint32_t ulDataLength = 0;
     {
         iptraceNETWORK_INTERFACE_TRANSMIT();
 
-        /* Check Buffer size and adjust to Max packet size */
         ulDataLength = pxNetworkBuffer->xDataLength;
 
-        if( ulDataLength > XGMAC_MAX_PACKET_SIZE )
+        if( pxNetworkBuffer->pucEthernetBuffer == NULL )
         {
-            ulDataLength = XGMAC_MAX_PACKET_SIZE;
+            FreeRTOS_printf( ( "Ethernet Buffer is NULL\n" ) );
+            return pdFALSE;
         }
 
-        if( pxNetworkBuffer->pucEthernetBuffer == NULL )
+        /* Only a TSO frame may be longer than the MTU, the XGMAC cuts it into
+         * segments that fit */
+        if( ( ulDataLength > ( niEMAC_MTU + XGMAC_FRAME_OVERHEAD ) ) &&
+            ( prvIsTsoFrame( pxNetworkBuffer->pucEthernetBuffer, ulDataLength ) == pdFALSE ) )
         {
-            FreeRTOS_printf( ( "Ethernet Buffer is NULL\n" ) );
+            /* A truncated frame is useless to the peer, drop it */
+            FreeRTOS_printf( ( "SOCFPGA_XGMAC: Dropping a %lu byte frame above the MTU\n",
+                               ( unsigned long ) ulDataLength ) );
+
+            niEMAC_STAT_DROP( eEthDropTxOversize );
+
+            if( bReleaseAfterSend != pdFALSE )
+            {
+                vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+            }
+
             return pdFALSE;
         }
 
         #if ( ipconfigZERO_COPY_TX_DRIVER == 0 )
             /* Get Tx Buffer Index from DMA Tx Buffer Pool */
-            pucBuffer = pucGetTXBuffer( pxTxBufferPool, XGMAC_MAX_PACKET_SIZE );
-            configASSERT( pucBuffer != NULL );
+            pucBuffer = pucGetTXBuffer( pxTxBufferPool, ulDataLength );
+
+            if( pucBuffer == NULL )
+            {
+                niEMAC_STAT_DROP( eEthDropTxNoBuffer );
+
+                if( bReleaseAfterSend != pdFALSE )
+                {
+                    vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+                }
+
+                return pdFALSE;
+            }
 
             /* Copy the bytes from NW buffer to XGMAC Tx Buffer  */
             ( void ) memcpy( pucBuffer, pxNetworkBuffer->pucEthernetBuffer, ulDataLength );
@@ -528,26 +854,56 @@ uint32_t ulDataLength = 0;
             bReleaseAfterSend = pdFALSE;
         #endif
 
-        xDMATxBuffer.buf = pucBuffer;
-        xDMATxBuffer.size = ulDataLength;
-
-        /* The TCP/IP buffer should be released back to stack after tx done
-         * hence set the flag. This will be used in DMA TRansmit Done */
-        xDMATxBuffer.release_buf = 1;
-
-        if( pXGMACHandle == NULL )
+        /* Stage the frame. It is handed to the DMA right away when nothing is
+         * in flight, otherwise it is batched with the frames that follow and
+         * sent when the burst is full or on the next Tx done event. */
+        do
         {
-            return pdFALSE;
-        }
+            taskENTER_CRITICAL();
+            {
+                if( uxTxStagedCount < niEMAC_TX_BURST_SIZE )
+                {
+                    xTxStagedBuffers[ uxTxStagedCount ].buf = pucBuffer;
+                    xTxStagedBuffers[ uxTxStagedCount ].size = ulDataLength;
+
+                    /* The TCP/IP buffer should be released back to stack after tx done
+                     * hence set the flag. This will be used in DMA TRansmit Done */
+                    xTxStagedBuffers[ uxTxStagedCount ].release_buf = 1;
+
+                    /* A network buffer is contiguous, it is never gathered */
+                    xTxStagedBuffers[ uxTxStagedCount ].segs = NULL;
+                    xTxStagedBuffers[ uxTxStagedCount ].num_segs = 0U;
+                    xTxStagedBuffers[ uxTxStagedCount ].ts_request = 0U;
+                    prvSetTsoFields( &xTxStagedBuffers[ uxTxStagedCount ] );
+                    uxTxStagedCount++;
+                    xStaged = pdTRUE;
+                }
+                else
+                {
+                    xStaged = pdFALSE;
+                }
+
+                xFlushNow = ( ( uxTxStagedCount >= niEMAC_TX_BURST_SIZE ) ||
+                              ( uxTxInFlightCount == 0U ) ) ? pdTRUE : pdFALSE;
+            }
+            taskEXIT_CRITICAL();
 
-        /* XGMAC transmit function */
-        xStatus = xgmac_dma_transmit( pXGMACHandle, &( xDMATxBuffer ) );
+            if( xStaged == pdFALSE )
+            {
+                /* Make room by sending what is already staged */
+                prvFlushTxBuffers( pXGMACHandle, portMAX_DELAY );
+            }
+        } while( xStaged == pdFALSE );
 
-        if( xStatus != 0 )
+        if( xFlushNow != pdFALSE )
         {
-            bReleaseAfterSend = pdTRUE;
+            prvFlushTxBuffers( pXGMACHandle, portMAX_DELAY );
         }
     }
+    else
+    {
+        niEMAC_STAT_DROP( eEthDropTxLinkDown );
+    }
 
     if( bReleaseAfterSend != pdFALSE )
     {
@@ -559,6 +915,113 @@ uint32_t ulDataLength = 0;
 }
 /*-----------------------------------------------------------*/
 
+static void prvFlushTxBuffers( xgmac_handle_t pXGMACHandle,
+                               TickType_t xBlockTime )
+{
+xgmac_tx_buf_t xBurst[ niEMAC_TX_BURST_SIZE ];
+UBaseType_t uxCount;
+UBaseType_t uxIndex;
+int32_t xQueued;
+
+    if( xSemaphoreTake( xTxFlushMutex, xBlockTime ) != pdPASS )
+    {
+        return;
+    }
+
+    /* Take ownership of the staged frames and account for them as in flight
+     * before the DMA can complete them. */
+    taskENTER_CRITICAL();
+    {
+        uxCount = uxTxStagedCount;
+
+        for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+        {
+            xBurst[ uxIndex ] = xTxStagedBuffers[ uxIndex ];
+        }
+
+        uxTxStagedCount = 0U;
+        uxTxInFlightCount += uxCount;
+    }
+    taskEXIT_CRITICAL();
+
+    if( uxCount > 0U )
+    {
+        xQueued = xgmac_dma_transmit_burst( pXGMACHandle, XGMAC_DMA_CH0, xBurst,
+                                            ( uint32_t ) uxCount );
+
+        if( xQueued < 0 )
+        {
+            xQueued = 0;
+        }
+
+        for( uxIndex = 0U; uxIndex < ( UBaseType_t ) xQueued; uxIndex++ )
+        {
+            niEMAC_STAT_ADD( ullTxPackets, 1U );
+            niEMAC_STAT_ADD( ullTxBytes, xBurst[ uxIndex ].size );
+        }
+
+        if( ( UBaseType_t ) xQueued < uxCount )
+        {
+            niEMAC_STAT_ADD( ulTxRingFull, 1U );
+            niEMAC_STAT_ADD( ulDrops[ eEthDropTxRingFull ],
+                             ( uint32_t ) ( uxCount - ( UBaseType_t ) xQueued ) );
+
+            FreeRTOS_printf( ( "SOCFPGA_XGMAC: Dropped %lu Tx frames\n",
+                               ( unsigned long ) ( uxCount - ( UBaseType_t ) xQueued ) ) );
+
+            taskENTER_CRITICAL();
+            {
+                uxTxInFlightCount -= ( uxCount - ( UBaseType_t ) xQueued );
+            }
+            taskEXIT_CRITICAL();
+
+            ( void ) xSemaphoreTake( xTxPoolMutex, portMAX_DELAY );
+
+            for( uxIndex = ( UBaseType_t ) xQueued; uxIndex < uxCount; uxIndex++ )
+            {
+                prvReleaseTxBuffer( xBurst[ uxIndex ].buf );
+            }
+
+            ( void ) xSemaphoreGive( xTxPoolMutex );
+        }
+    }
+
+    ( void ) xSemaphoreGive( xTxFlushMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseTxBuffer( uint8_t * pucBuffer )
+{
+    #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
+    {
+    NetworkBufferDescriptor_t * pxBuffer;
+
+        pxBuffer = pxPacketBuffer_to_NetworkBuffer( ( void * ) pucBuffer );
+
+        if( pxBuffer != NULL )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+        }
+        else
+        {
+            FreeRTOS_printf( ( "Tx Done Get Buff: Can not find network buffer\n" ) );
+        }
+    }
+    #else  /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) */
+    {
+    BaseType_t xReturn;
+
+        xReturn = pucReleaseTXBuffer( pxTxBufferPool, pucBuffer );
+
+        if( xReturn != pdPASS )
+        {
+            FreeRTOS_printf( ( "Tx Done Get Buff: Can not release pool buffer  \n" ) );
+        }
+    }
+    #endif /* ipconfigZERO_COPY_TX_DRIVER */
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t prvPhyCheckLinkStatus( TickType_t xMaxTimeTicks,
                                   NetworkInterface_t * pxInterface )
 {
@@ -596,12 +1059,34 @@ BaseType_t xReturn;
 static void prvPassEthMessages( NetworkBufferDescriptor_t * pxDescriptor )
 {
 IPStackEvent_t xRxEvent;
+uint32_t ulPackets = 0U;
+uint64_t ullBytes = 0U;
 
     xRxEvent.eEventType = eNetworkRxEvent;
     xRxEvent.pvData = (void*) pxDescriptor;
 
+    #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+    {
+    NetworkBufferDescriptor_t * pxBuffer;
+
+        /* Count before the chain is handed over to the IP task */
+        for( pxBuffer = pxDescriptor; pxBuffer != NULL; pxBuffer = pxBuffer->pxNextBuffer )
+        {
+            ulPackets++;
+            ullBytes += pxBuffer->xDataLength;
+        }
+    }
+    #else
+    {
+        ulPackets = 1U;
+        ullBytes = pxDescriptor->xDataLength;
+    }
+    #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
     if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 1000U ) != pdPASS )
     {
+        niEMAC_STAT_ADD( ulDrops[ eEthDropRxQueueFull ], ulPackets );
+
         /* The buffer could not be sent to the stack so must be released again.
          * This is a deferred handler task, not a real interrupt, so it is ok to
          * use the task level function here. */
@@ -625,12 +1110,18 @@ IPStackEvent_t xRxEvent;
     }
     else
     {
+        niEMAC_STAT_ADD( ullRxPackets, ulPackets );
+        niEMAC_STAT_ADD( ullRxBytes, ullBytes );
         iptraceNETWORK_INTERFACE_RECEIVE();
     }
+
+    ( void ) ulPackets;
+    ( void ) ullBytes;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface )
+BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface,
+                                     uint8_t ucChannel )
 {
     #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
         NetworkBufferDescriptor_t * pxFirstDescriptor = NULL;
@@ -645,20 +1136,34 @@ uint8_t * pucEthernetBuffer;
 uint8_t * pucRefillRxBuffer;
 uint32_t ulPacketStatus;
 volatile int msgCount = 0;
+UBaseType_t uxProcessed = 0U;
+uint8_t * pucRefillBatch[ niEMAC_RX_REFILL_BATCH ];
+UBaseType_t uxRefillCount = 0U;
+NetworkBufferDescriptor_t * pxGatheredDesc;
+
+    prvFillRxBufferCache( ucChannel );
 
     do
     {
     NetworkBufferDescriptor_t * pxCurrentBufferDesc, * pxNewBufferDesc = NULL;
     BaseType_t xSendPacket = pdTRUE;
 
+        /* Leave the rest of the ring for the next wake-up */
+        if( uxProcessed >= niEMAC_RX_POLL_BUDGET )
+        {
+            break;
+        }
+
         /* XGMAC receive function */
-        xStatus = xgmac_dma_receive( pXGMACHandle, &( xDMARxBufferIn ) );
+        xStatus = xgmac_dma_receive( pXGMACHandle, ucChannel, &( xDMARxBufferIn ) );
 
         if( xStatus != 0 )
         {
             break;
         }
 
+        uxProcessed++;
+
         pucEthernetBuffer = xDMARxBufferIn.buf;
         xReceivedPacketLength = ( size_t ) ( xDMARxBufferIn.size );
         pucRefillRxBuffer = pucEthernetBuffer;
@@ -671,22 +1176,51 @@ volatile int msgCount = 0;
         /* Check the validity of the received packet and send only if valid else discard here */
         /* Check if packet has errors and discard if true */
         ulPacketStatus = xDMARxBufferIn.packet_status;
+        pxGatheredDesc = NULL;
+
+        if( ( ulPacketStatus & ( RDES3_NORM_WR_FD_MASK | RDES3_NORM_WR_LD_MASK ) ) !=
+            ( RDES3_NORM_WR_FD_MASK | RDES3_NORM_WR_LD_MASK ) )
+        {
+            /* Part of a frame larger than the Rx DMA buffers. It is copied
+             * out so the DMA buffer is given back as it is. */
+            pxGatheredDesc = prvGatherRxFrame( ucChannel, pucEthernetBuffer,
+                                               xReceivedPacketLength, ulPacketStatus,
+                                               &xReceivedPacketLength );
+
+            if( pxGatheredDesc == NULL )
+            {
+                xSendPacket = pdFALSE;
+            }
+            else
+            {
+                pucEthernetBuffer = pxGatheredDesc->pucEthernetBuffer;
+            }
+        }
 
-        if( ( ulPacketStatus &
-              ( RDES3_NORM_WR_LD_MASK | RDES3_NORM_WR_ES_MASK ) ) ==
-            XGMAC_RX_PACKET_ERROR )
+        if( xSendPacket == pdFALSE )
+        {
+            /* The rest of the frame is still to come, or it is dropped */
+        }
+        else if( ( ulPacketStatus &
+                   ( RDES3_NORM_WR_LD_MASK | RDES3_NORM_WR_ES_MASK ) ) ==
+                 XGMAC_RX_PACKET_ERROR )
         {
+            niEMAC_STAT_DROP( eEthDropRxError );
             xSendPacket = pdFALSE;
         }
         else if( eConsiderFrameForProcessing( pucEthernetBuffer ) !=
                  eProcessBuffer )
         {
+            niEMAC_STAT_DROP( eEthDropRxFiltered );
             xSendPacket = pdFALSE;
         }
+        else if( pxGatheredDesc != NULL )
+        {
+            /* The frame is already in a network buffer of its own */
+        }
         else
         {
-            pxNewBufferDesc = pxGetNetworkBufferWithDescriptor(
-                XGMAC_MAX_PACKET_SIZE, ( TickType_t ) 0 );
+            pxNewBufferDesc = prvGetRxBufferFromCache( ucChannel );
 
             if( pxNewBufferDesc == NULL )
             {
@@ -694,43 +1228,68 @@ volatile int msgCount = 0;
                  * will be dropped
                  */
                 FreeRTOS_printf( ( "Unable to allocate a Network Buffer\n" ) );
+                niEMAC_STAT_DROP( eEthDropRxNoBuffer );
                 xSendPacket = pdFALSE;
             }
         }
 
+        if( ( xSendPacket == pdFALSE ) && ( pxGatheredDesc != NULL ) )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxGatheredDesc );
+        }
+
         if( xSendPacket != pdFALSE )
         {
-            #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+            if( pxGatheredDesc != NULL )
             {
-                pxCurrentBufferDesc = pxPacketBuffer_to_NetworkBuffer(
-                    pucEthernetBuffer );
-                configASSERT( pxCurrentBufferDesc != NULL );
-
-
-                pucRefillRxBuffer = pxNewBufferDesc->pucEthernetBuffer;
+                pxCurrentBufferDesc = pxGatheredDesc;
             }
-            #else
+            else
             {
-                /* In zero copy mode both descriptors are the same. */
-                pxCurrentBufferDesc = pxNewBufferDesc;
-
-                if( pxCurrentBufferDesc == NULL )
+                #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
                 {
-                    break;
-                }
+                    pxCurrentBufferDesc = pxPacketBuffer_to_NetworkBuffer(
+                        pucEthernetBuffer );
+                    configASSERT( pxCurrentBufferDesc != NULL );
 
-                if( pxNewBufferDesc != NULL )
+
+                    pucRefillRxBuffer = pxNewBufferDesc->pucEthernetBuffer;
+                }
+                #else
                 {
-                    /* Update the Buf1 address in Desc0 field as this replaces old buffer  */
-                    ( void ) memcpy( pxNewBufferDesc->pucEthernetBuffer,
-                                     pucEthernetBuffer,
-                                     xReceivedPacketLength );
+                    /* In zero copy mode both descriptors are the same. */
+                    pxCurrentBufferDesc = pxNewBufferDesc;
+
+                    if( pxCurrentBufferDesc == NULL )
+                    {
+                        break;
+                    }
+
+                    if( pxNewBufferDesc != NULL )
+                    {
+                        /* Update the Buf1 address in Desc0 field as this replaces old buffer  */
+                        ( void ) memcpy( pxNewBufferDesc->pucEthernetBuffer,
+                                         pucEthernetBuffer,
+                                         xReceivedPacketLength );
+                    }
                 }
+                #endif /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
             }
-            #endif /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
+
             /*Subtract 4 bytes of CRC from recieved packet*/
             pxCurrentBufferDesc->xDataLength = ( xReceivedPacketLength - 4U );
 
+            #if ( niEMAC_HW_TIMESTAMPING != 0 )
+            {
+                if( xDMARxBufferIn.ts_valid )
+                {
+                    prvRecordRxTimestamp( pxCurrentBufferDesc->pucEthernetBuffer,
+                                          pxCurrentBufferDesc->xDataLength,
+                                          &( xDMARxBufferIn.timestamp ) );
+                }
+            }
+            #endif
+
             pxCurrentBufferDesc->pxInterface = AgxInterface;
             pxCurrentBufferDesc->pxEndPoint = FreeRTOS_MatchingEndpoint(
                 pxCurrentBufferDesc->pxInterface,
@@ -766,18 +1325,38 @@ volatile int msgCount = 0;
             msgCount++;
         }
 
-        if( ( pXGMACHandle == NULL ) || ( pucRefillRxBuffer == NULL ) )
+        if( pucRefillRxBuffer == NULL )
+        {
+            break;
+        }
+
+        /* Descriptors are handed back to the DMA in batches, with one tail
+         * pointer write per batch */
+        pucRefillBatch[ uxRefillCount ] = pucRefillRxBuffer;
+        uxRefillCount++;
+
+        if( uxRefillCount == niEMAC_RX_REFILL_BATCH )
         {
-            return 0;
+            if( xgmac_refill_rx_descriptors( pXGMACHandle, ucChannel, pucRefillBatch,
+                                             ( uint32_t ) uxRefillCount ) != 0 )
+            {
+                FreeRTOS_printf( ( "SOCFPGA_XGMAC: Refill Rx Descriptor Failed....\n" ) );
+                niEMAC_STAT_ADD( ulRxRefillFailures, 1U );
+            }
+
+            uxRefillCount = 0U;
         }
+    } while( true );
 
-        /* Update the descriptor with new address and rest other fields */
-        if( xgmac_refill_rx_descriptor( pXGMACHandle, pucRefillRxBuffer ) != 0 )
+    if( uxRefillCount > 0U )
+    {
+        if( xgmac_refill_rx_descriptors( pXGMACHandle, ucChannel, pucRefillBatch,
+                                         ( uint32_t ) uxRefillCount ) != 0 )
         {
             FreeRTOS_printf( ( "SOCFPGA_XGMAC: Refill Rx Descriptor Failed....\n" ) );
-            break;
+            niEMAC_STAT_ADD( ulRxRefillFailures, 1U );
         }
-    } while( true );
+    }
 
     #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
     {
@@ -788,6 +1367,31 @@ volatile int msgCount = 0;
     }
     #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
+    #if ( niEMAC_COLLECT_STATS != 0 )
+    {
+        prvRecordRxLatency( ucChannel, msgCount );
+    }
+    #endif
+
+    if( uxProcessed >= niEMAC_RX_POLL_BUDGET )
+    {
+        /* Budget used up, keep the Rx interrupt masked and poll again after
+         * the other pending events have been served */
+        ( void ) xTaskNotify( xEMACRxTaskHandles[ ucChannel ], XGMAC_IF_RX_EVENT, eSetBits );
+    }
+    else
+    {
+        /* Ring drained, re-arm the Rx interrupt. A frame that arrived while it
+         * was masked does not raise it, so check the ring once more */
+        ( void ) xgmac_ioctl( pXGMACHandle, XGMAC_ENABLE_RX_IRQ, &ucChannel );
+
+        if( xgmac_dma_rx_pending( pXGMACHandle, ucChannel ) != false )
+        {
+            ( void ) xgmac_ioctl( pXGMACHandle, XGMAC_DISABLE_RX_IRQ, &ucChannel );
+            ( void ) xTaskNotify( xEMACRxTaskHandles[ ucChannel ], XGMAC_IF_RX_EVENT, eSetBits );
+        }
+    }
+
     return msgCount;
 }
 /*-----------------------------------------------------------*/
@@ -825,7 +1429,7 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 __attribute__( ( aligned( 64 ) ) )
 
 static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS *
-                                 XGMAC_MAX_PACKET_SIZE ];
+                                 niEMAC_BUFFER_SIZE ];
 
 void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] )
 
@@ -841,7 +1445,7 @@ uint32_t ul;
         *( ( uintptr_t * ) ucRAMBuffer ) =
             ( uintptr_t ) ( &( pxNetworkBuffers[ ul ] ) );
 
-        ucRAMBuffer += XGMAC_MAX_PACKET_SIZE;
+        ucRAMBuffer += niEMAC_BUFFER_SIZE;
     }
 }
 /*-----------------------------------------------------------*/
@@ -884,6 +1488,7 @@ BaseType_t xStatus = xReadPhyStatus( pxInterface );
 
         case XGMAC_ERR_RX_BUF_UNAVAILABLE:
             FreeRTOS_printf( ( "Receive Buffer Unavailable Error on DMA Channel %d\n", ucErrChnlNum ) );
+            niEMAC_STAT_ADD( ulRxRingFull, 1U );
             break;
 
         case XGMAC_ERR_CNTXT_DESC:
@@ -919,14 +1524,14 @@ int32_t xStatus;
 int instance = ( int ) ( ( uintptr_t ) pxInterface->pvArgument );
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
-    for( uint16_t usIndex = 0U; usIndex < ( uint32_t ) XGMAC_NUM_RX_DESC; usIndex++ )
+    for( uint32_t ulIndex = 0U; ulIndex < ( ( uint32_t ) XGMAC_NUM_RX_DESC * XGMAC_NUM_DMA_CHANNELS ); ulIndex++ )
     {
         #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
             TickType_t uxBlockTimeTicks = pdMS_TO_TICKS( 100UL );
             NetworkBufferDescriptor_t * pxBufferDescriptor;
 
             pxBufferDescriptor = pxGetNetworkBufferWithDescriptor(
-                XGMAC_MAX_PACKET_SIZE, uxBlockTimeTicks );
+                niEMAC_FRAME_SIZE, uxBlockTimeTicks );
 
             if( pxBufferDescriptor != NULL )
             {
@@ -946,7 +1551,10 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
                 return pdFAIL;
             }
         #endif /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
-        xStatus = xgmac_refill_rx_descriptor( pXGMACHandle, pucBufAddr );
+        /* Fill the rings one after the other */
+        xStatus = xgmac_refill_rx_descriptor( pXGMACHandle,
+                                              ( uint8_t ) ( ulIndex / XGMAC_NUM_RX_DESC ),
+                                              pucBufAddr );
 
         if( xStatus != 0 )
         {
@@ -961,53 +1569,47 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 BaseType_t prvNetworkInterfaceOutDone( NetworkInterface_t * pxInterface )
 {
 uint8_t * pucReleaseBuffer = NULL;
-int32_t xStatus;
+UBaseType_t uxReleased = 0U;
 int instance = ( int ) ( ( uintptr_t ) pxInterface->pvArgument );
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
-    while( xSemaphoreTake( xSemaphoreCounterTx, 0U ) == pdTRUE )
+    /* A single Tx interrupt covers a whole burst, so reap every descriptor the
+     * DMA has released. Buffers go back to the pool with xTxPoolMutex held,
+     * which keeps a single producer on the lock-free Tx pool. A flush blocked
+     * on a full ring holds xTxFlushMutex, and waits for this reaping. */
+    if( xSemaphoreTake( xTxPoolMutex, portMAX_DELAY ) != pdPASS )
     {
-        xStatus = xgmac_dma_tx_done( pXGMACHandle, &pucReleaseBuffer );
-
-        if( xStatus != 0 )
-        {
-            break;
-        }
+        return pdFAIL;
+    }
 
+    while( xgmac_dma_tx_done( pXGMACHandle, XGMAC_DMA_CH0, &pucReleaseBuffer ) == 0 )
+    {
+        /* Only the last descriptor of a frame returns its buffer, a TSO frame
+         * also occupies context, header and payload descriptors. */
         if( pucReleaseBuffer != NULL )
         {
-            #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
-            {
-            NetworkBufferDescriptor_t * pxBuffer;
-            void * pvBuffer;
-
-                pvBuffer = ( void * ) pucReleaseBuffer;
-
-                if( pvBuffer != NULL )
-                {
-                    pxBuffer = pxPacketBuffer_to_NetworkBuffer( pvBuffer );
+            uxReleased++;
+            prvReleaseTxBuffer( pucReleaseBuffer );
+        }
+    }
 
-                    if( pxBuffer != NULL )
-                    {
-                        vReleaseNetworkBufferAndDescriptor( pxBuffer );
-                    }
-                    else
-                    {
-                        FreeRTOS_printf( ( "Tx Done Get Buff: Can not find network buffer\n" ) );
-                    }
-                }
-            }
-            #else  /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) */
-                BaseType_t xReturn;
-                xReturn = pucReleaseTXBuffer( pxTxBufferPool, pucReleaseBuffer );
+    ( void ) xSemaphoreGive( xTxPoolMutex );
 
-                if( xReturn != pdPASS )
-                {
-                    FreeRTOS_printf( ( "Tx Done Get Buff: Can not release pool buffer  \n" ) );
-                }
-            #endif /* ipconfigZERO_COPY_TX_DRIVER */
+    taskENTER_CRITICAL();
+    {
+        if( uxReleased > uxTxInFlightCount )
+        {
+            uxReleased = uxTxInFlightCount;
         }
+
+        uxTxInFlightCount -= uxReleased;
     }
+    taskEXIT_CRITICAL();
+
+    /* Frames staged while the previous burst was in flight go out now. When
+     * another task is flushing, they go out with the completion of its burst,
+     * this task must not wait behind it or the ring is never reaped. */
+    prvFlushTxBuffers( pXGMACHandle, 0U );
 
     return pdPASS;
 }
@@ -1016,7 +1618,6 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 BaseType_t prvCreateTxBufferPool( TxBufferPool_t * pTxBufferPool )
 {
 uint8_t * pTxBuf;
-BaseType_t xReturn = pdPASS;
 
     /* Allocate Transmit Buffer Pool */
     pTxBuf = ( uint8_t * ) pvPortMalloc( ( size_t ) TX_BUFFER_COUNT * ( size_t ) TX_BUFFER_SIZE );
@@ -1024,40 +1625,21 @@ BaseType_t xReturn = pdPASS;
     /* Return failure if unable to allocate buffer */
     if( pTxBuf == NULL )
     {
-        xReturn = pdFAIL;
-        return xReturn;
+        return pdFAIL;
     }
 
-    /* Assign Tx Buffer Addresses to Tx Pool Structure  */
-    for( uint32_t i = 0U; i < TX_BUFFER_COUNT; i++ )
-    {
-        pTxBufferPool->pTxBuffer[ i ] = ( uint8_t * ) &( pTxBuf[ i * TX_BUFFER_SIZE ] );
-    }
-
-    /* Assign Head and Tail to start of the location */
-    pTxBufferPool->usHeadIndex = 0;
-    pTxBufferPool->usTailIndex = 0;
-
-    /* Initial available buffer count */
-    pTxBufferPool->usBufUsedCnt = 0;
+    prvInitBufferRing( &( pTxBufferPool->xRing ), pTxBufferPool->pTxBuffer,
+                       TX_BUFFER_COUNT, pTxBuf, TX_BUFFER_SIZE );
 
     pTxBufferPool->ucIsInitiazed = 1;
 
-    xTxBufSynchSem = xSemaphoreCreateMutex();
-
-    if( xTxBufSynchSem == NULL )
-    {
-        xReturn = pdFAIL;
-    }
-
-    return xReturn;
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
 BaseType_t prvCreateRxBufferPool( RxBufferPool_t * pRxBufferPool )
 {
 uint8_t * pRxBuf;
-BaseType_t xReturn = pdPASS;
 
     /* Allocate Receive Buffer Pool */
     pRxBuf = ( uint8_t * ) pvPortAlignedAlloc(64, ( size_t ) RX_BUFFER_COUNT * ( size_t ) RX_BUFFER_SIZE );
@@ -1065,42 +1647,22 @@ BaseType_t xReturn = pdPASS;
     /* Return failure if unable to allocate buffer */
     if( pRxBuf == NULL )
     {
-        xReturn = pdFAIL;
-        return xReturn;
+        return pdFAIL;
     }
 
-    /* Assign Rx Buffer Addresses to Rx Pool Structure  */
-    for( uint32_t i = 0U; i < RX_BUFFER_COUNT; i++ )
-    {
-        pRxBufferPool->pRxBuffer[ i ] = ( uint8_t * ) &( pRxBuf[ i * RX_BUFFER_SIZE ] );
-    }
-
-    /* Assign Head and Tail to start of the location */
-    pRxBufferPool->usHeadIndex = 0;
-    pRxBufferPool->usTailIndex = 0;
-
-    /* Initial available buffer count */
-    pRxBufferPool->usBufUsedCnt = 0;
+    prvInitBufferRing( &( pRxBufferPool->xRing ), pRxBufferPool->pRxBuffer,
+                       RX_BUFFER_COUNT, pRxBuf, RX_BUFFER_SIZE );
 
     pRxBufferPool->ucIsInitiazed = 1;
 
-    xRxBufSynchSem = xSemaphoreCreateMutex();
-
-    if( xRxBufSynchSem == NULL )
-    {
-        xReturn = pdFAIL;
-    }
-
-    return xReturn;
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
 uint8_t * pucGetTXBuffer( TxBufferPool_t * pTxBufferPool,
                           size_t xWantedSize )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-uint8_t * pucBufAddr = NULL;
-uint16_t usIndex;
+uint8_t * pucBufAddr;
 
     if( xWantedSize > TX_BUFFER_SIZE )
     {
@@ -1108,25 +1670,11 @@ uint16_t usIndex;
         return NULL;
     }
 
-    if( xSemaphoreTake( xTxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
-    {
-        if( pTxBufferPool->usBufUsedCnt == ( uint16_t ) TX_BUFFER_COUNT )
-        {
-            FreeRTOS_printf( ( "Tx Buffer Pool Fully Used \n" ) );
-            return NULL;
-        }
-
-        /*Get the buffer from the head of the buffer pool */
-        usIndex = pTxBufferPool->usHeadIndex;
-        pTxBufferPool->usHeadIndex++;
-        pucBufAddr = pTxBufferPool->pTxBuffer[ usIndex ];
+    pucBufAddr = prvBufferRingGet( &( pTxBufferPool->xRing ) );
 
-        /* Update Head and Buffer Count in use */
-        pTxBufferPool->usHeadIndex %= ( uint16_t ) TX_BUFFER_COUNT;
-        pTxBufferPool->usBufUsedCnt++;
-
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xTxBufSynchSem );
+    if( pucBufAddr == NULL )
+    {
+        FreeRTOS_printf( ( "Tx Buffer Pool Fully Used \n" ) );
     }
 
     return pucBufAddr;
@@ -1136,9 +1684,7 @@ uint16_t usIndex;
 uint8_t * pucGetRXBuffer( RxBufferPool_t * pRxBufferPool,
                           size_t xWantedSize )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-uint8_t * pucBufAddr = NULL;
-uint16_t usIndex;
+uint8_t * pucBufAddr;
 
     if( xWantedSize > RX_BUFFER_SIZE )
     {
@@ -1146,25 +1692,11 @@ uint16_t usIndex;
         return NULL;
     }
 
-    if( xSemaphoreTake( xRxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
-    {
-        if( pRxBufferPool->usBufUsedCnt == ( uint16_t ) RX_BUFFER_COUNT )
-        {
-            FreeRTOS_printf( ( "Rx Buffer Pool Fully Used \n" ) );
-            return NULL;
-        }
-
-        /*Get the buffer from the head of the buffer pool */
-        usIndex = pRxBufferPool->usHeadIndex;
-        pRxBufferPool->usHeadIndex++;
-        pucBufAddr = pRxBufferPool->pRxBuffer[ usIndex ];
-
-        /* Update Head and Buffer Count in use */
-        pRxBufferPool->usHeadIndex %= ( uint16_t ) RX_BUFFER_COUNT;
-        pRxBufferPool->usBufUsedCnt++;
+    pucBufAddr = prvBufferRingGet( &( pRxBufferPool->xRing ) );
 
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xRxBufSynchSem );
+    if( pucBufAddr == NULL )
+    {
+        FreeRTOS_printf( ( "Rx Buffer Pool Fully Used \n" ) );
     }
 
     return pucBufAddr;
@@ -1174,35 +1706,14 @@ uint16_t usIndex;
 BaseType_t pucReleaseTXBuffer( TxBufferPool_t * pTxBufferPool,
                                void * pvBuffer )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-BaseType_t xReturn = pdFAIL;
-uint16_t usIndex;
-
-    if( xSemaphoreTake( xTxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
+    /* The buffer is handed out as-is, the next frame overwrites it */
+    if( prvBufferRingPut( &( pTxBufferPool->xRing ), ( uint8_t * ) pvBuffer ) != pdPASS )
     {
-        if( pTxBufferPool->usBufUsedCnt == 0U )
-        {
-            FreeRTOS_printf( ( "Tx Buffer Pool is Already Empty \n" ) );
-            return xReturn;
-        }
-
-        /* Add the buffer to the tail of the pool */
-        ( void ) memset( pvBuffer, '\0', TX_BUFFER_SIZE );
-        usIndex = pTxBufferPool->usTailIndex;
-        pTxBufferPool->usTailIndex++;
-        pTxBufferPool->pTxBuffer[ usIndex ] = ( uint8_t * ) pvBuffer;
-
-        /* Update tail and free count */
-        pTxBufferPool->usTailIndex %= ( uint16_t ) TX_BUFFER_COUNT;
-        pTxBufferPool->usBufUsedCnt--;
-
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xTxBufSynchSem );
-
-        xReturn = pdPASS;
+        FreeRTOS_printf( ( "Tx Buffer Pool is Already Empty \n" ) );
+        return pdFAIL;
     }
 
-    return xReturn;
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
@@ -1231,19 +1742,35 @@ void prvEMACIRQHanlderCallback( xgmac_int_status_t xIntrStatus,
 BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 uint32_t ulISREvent = 0U;
 xgmac_err_info_t * pxIntData = ( xgmac_err_info_t * ) pvIrqData;
+TaskHandle_t xTaskToNotify = xEMACTaskHandle;
 
     if( xEMACTaskHandle != NULL )
     {
         if( xIntrStatus == XGMAC_RX_EVENT )
         {
-            /* Notify prvEMACHandlerTask of Receive event */
+            /* Notify the task serving the Rx ring of the channel */
             ulISREvent = XGMAC_IF_RX_EVENT;
+
+            if( ( pxIntData->err_ch < XGMAC_NUM_DMA_CHANNELS ) &&
+                ( xEMACRxTaskHandles[ pxIntData->err_ch ] != NULL ) )
+            {
+                xTaskToNotify = xEMACRxTaskHandles[ pxIntData->err_ch ];
+            }
+
+            #if ( niEMAC_COLLECT_STATS != 0 )
+            {
+                if( ( pxIntData->err_ch < XGMAC_NUM_DMA_CHANNELS ) &&
+                    ( ullRxIrqStamp[ pxIntData->err_ch ] == 0U ) )
+                {
+                    __asm volatile ( "MRS %0, CNTVCT_EL0" : "=r" ( ullRxIrqStamp[ pxIntData->err_ch ] ) );
+                }
+            }
+            #endif
         }
         else if( xIntrStatus == XGMAC_TX_DONE_EVENT )
         {
             /* Notify prvEMACHandlerTask of Transmit completion event */
             ulISREvent = XGMAC_IF_TX_EVENT;
-            ( void ) xSemaphoreGiveFromISR( xSemaphoreCounterTx, NULL );
         }
 /*-----------------------------------------------------------*/
 
@@ -1261,7 +1788,7 @@ xgmac_err_info_t * pxIntData = ( xgmac_err_info_t * ) pvIrqData;
             /*do nothing*/
         }
 
-        ( void ) xTaskNotifyFromISR( xEMACTaskHandle, ulISREvent, eSetBits,
+        ( void ) xTaskNotifyFromISR( xTaskToNotify, ulISREvent, eSetBits,
                                      &( xHigherPriorityTaskWoken ) );
         portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
     }
@@ -1308,13 +1835,22 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
         if( ( ulISREvents & XGMAC_IF_RX_EVENT ) != 0U )
         {
-            ( void ) prvNetworkInterfaceInput( pxInterface );
+            ( void ) prvNetworkInterfaceInput( pxInterface, XGMAC_DMA_CH0 );
         }
 
         if( ( ulISREvents & XGMAC_IF_TX_EVENT ) != 0U )
         {
             ( void ) prvNetworkInterfaceOutDone( pxInterface );
         }
+        else if( ulISREvents == 0U )
+        {
+            /* Nothing happened for a while, reap and flush anything left behind */
+            ( void ) prvNetworkInterfaceOutDone( pxInterface );
+        }
+        else
+        {
+            /*do nothing*/
+        }
 
         if( ( ulISREvents & XGMAC_IF_ERR_EVENT ) != 0U )
         {
@@ -1370,3 +1906,386 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
     }
 }
 /*-----------------------------------------------------------*/
+
+void prvEMACRxTask( void * pvParameters )
+{
+uint8_t ucChannel = ( uint8_t ) ( ( uintptr_t ) pvParameters );
+uint32_t ulISREvents = 0U;
+
+    for( ; ; )
+    {
+        /* Only Rx events are sent to this task, the rest goes to prvEMACHandlerTask */
+        ( void ) xTaskNotifyWait( 0U,                 /* ulBitsToClearOnEntry */
+                                  XGMAC_IF_ALL_EVENT, /* ulBitsToClearOnExit */
+                                  &( ulISREvents ),   /* pulNotificationValue */
+                                  portMAX_DELAY );
+
+        if( ( ( ulISREvents & XGMAC_IF_RX_EVENT ) != 0U ) && ( AgxInterface != NULL ) )
+        {
+            ( void ) prvNetworkInterfaceInput( AgxInterface, ucChannel );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvConfigureRxSteering( xgmac_handle_t pXGMACHandle )
+{
+    #if ( XGMAC_NUM_DMA_CHANNELS > 1U )
+    {
+    /* The Toeplitz key commonly used as the RSS default */
+    static const uint8_t ucRSSKey[ XGMAC_RSS_KEY_SIZE ] =
+    {
+        0x6dU, 0x5aU, 0x56U, 0xdaU, 0x25U, 0x5bU, 0x0eU, 0xc2U,
+        0x41U, 0x67U, 0x25U, 0x3dU, 0x43U, 0xa3U, 0x8fU, 0xb0U,
+        0xd0U, 0xcaU, 0x2bU, 0xcbU, 0xaeU, 0x7bU, 0x30U, 0xb4U,
+        0x77U, 0xcbU, 0x2dU, 0xa3U, 0x80U, 0x30U, 0xf2U, 0x0cU,
+        0x6aU, 0x42U, 0xb7U, 0x3bU, 0xbeU, 0xacU, 0x01U, 0xfaU
+    };
+    xgmac_rx_steering_t xSteering;
+    int32_t xStatus;
+
+        xSteering.mode = niEMAC_RX_STEER_MODE;
+
+        for( uint8_t ucPrio = 0U; ucPrio < XGMAC_NUM_PRIORITIES; ucPrio++ )
+        {
+            xSteering.prio_to_chnl[ ucPrio ] = ( uint8_t ) ( ( ucPrio * XGMAC_NUM_DMA_CHANNELS ) /
+                                                             XGMAC_NUM_PRIORITIES );
+        }
+
+        ( void ) memcpy( xSteering.rss_key, ucRSSKey, sizeof( ucRSSKey ) );
+
+        xStatus = xgmac_ioctl( pXGMACHandle, XGMAC_SET_RX_STEERING, &xSteering );
+
+        if( xStatus != 0 )
+        {
+            /* Flow hashing is optional in the IP, fall back to a single ring */
+            FreeRTOS_printf( ( "SOCFPGA_XGMAC: Rx steering mode %d failed (%ld), using channel 0\n",
+                               ( int ) xSteering.mode, ( long ) xStatus ) );
+            xSteering.mode = XGMAC_RX_STEER_NONE;
+            ( void ) xgmac_ioctl( pXGMACHandle, XGMAC_SET_RX_STEERING, &xSteering );
+        }
+    }
+    #else /* if ( XGMAC_NUM_DMA_CHANNELS > 1U ) */
+    {
+        /* A single channel receives everything */
+        ( void ) pXGMACHandle;
+    }
+    #endif /* if ( XGMAC_NUM_DMA_CHANNELS > 1U ) */
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsTsoFrame( const uint8_t * pucFrame,
+                                 size_t uxLength )
+{
+BaseType_t xIsTso = pdFALSE;
+
+    #if ( ipconfigUSE_TCP_TSO != 0 )
+    {
+        /* Only IPv4/TCP frames that do not fit in one MTU are segmented, and
+         * only once the XGMAC has TSO enabled */
+        if( ( xTsoActive != pdFALSE ) &&
+            ( uxLength > ( ipSIZE_OF_ETH_HEADER + niEMAC_MTU ) ) &&
+            ( pucFrame[ 12 ] == 0x08U ) && ( pucFrame[ 13 ] == 0x00U ) &&
+            ( pucFrame[ ipSIZE_OF_ETH_HEADER + 9U ] == ipPROTOCOL_TCP ) )
+        {
+            xIsTso = pdTRUE;
+        }
+    }
+    #else
+    {
+        ( void ) pucFrame;
+        ( void ) uxLength;
+    }
+    #endif /* if ( ipconfigUSE_TCP_TSO != 0 ) */
+
+    return xIsTso;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetTsoFields( xgmac_tx_buf_t * pxTxBuf )
+{
+    pxTxBuf->tso_mss = 0U;
+    pxTxBuf->tso_hdr_len = 0U;
+    pxTxBuf->tso_tcp_hdr_len = 0U;
+
+    #if ( ipconfigUSE_TCP_TSO != 0 )
+    {
+    const uint8_t * pucFrame = pxTxBuf->buf;
+    uint32_t ulIpHdrLen;
+    uint32_t ulTcpHdrLen;
+
+        if( prvIsTsoFrame( pucFrame, pxTxBuf->size ) == pdFALSE )
+        {
+            return;
+        }
+
+        ulIpHdrLen = ( uint32_t ) ( pucFrame[ ipSIZE_OF_ETH_HEADER ] & 0x0FU ) * 4U;
+        ulTcpHdrLen = ( uint32_t ) ( pucFrame[ ipSIZE_OF_ETH_HEADER + ulIpHdrLen + 12U ] >> 4 ) * 4U;
+
+        /* Each segment repeats the IP and TCP headers, options included, and
+         * must fit in the MTU of the interface */
+        pxTxBuf->tso_mss = ( uint16_t ) ( niEMAC_MTU - ulIpHdrLen - ulTcpHdrLen );
+        pxTxBuf->tso_tcp_hdr_len = ( uint8_t ) ulTcpHdrLen;
+        pxTxBuf->tso_hdr_len = ( uint16_t ) ( ipSIZE_OF_ETH_HEADER + ulIpHdrLen + ulTcpHdrLen );
+    }
+    #endif /* if ( ipconfigUSE_TCP_TSO != 0 ) */
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillRxBufferCache( uint8_t ucChannel )
+{
+NetworkBufferDescriptor_t * pxBuffer;
+
+    while( uxRxBufferCacheCount[ ucChannel ] < niEMAC_RX_BUFFER_CACHE_SIZE )
+    {
+        pxBuffer = pxGetNetworkBufferWithDescriptor( niEMAC_FRAME_SIZE, ( TickType_t ) 0 );
+
+        if( pxBuffer == NULL )
+        {
+            /* The stack is short of buffers, try again on the next poll */
+            niEMAC_STAT_ADD( ulRxAllocFailures, 1U );
+            break;
+        }
+
+        pxRxBufferCache[ ucChannel ][ uxRxBufferCacheCount[ ucChannel ] ] = pxBuffer;
+        uxRxBufferCacheCount[ ucChannel ]++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t * prvGetRxBufferFromCache( uint8_t ucChannel )
+{
+    if( uxRxBufferCacheCount[ ucChannel ] == 0U )
+    {
+        return NULL;
+    }
+
+    uxRxBufferCacheCount[ ucChannel ]--;
+
+    return pxRxBufferCache[ ucChannel ][ uxRxBufferCacheCount[ ucChannel ] ];
+}
+/*-----------------------------------------------------------*/
+
+#if ( niEMAC_HW_TIMESTAMPING != 0 )
+
+    static void prvRecordRxTimestamp( const uint8_t * pucFrame,
+                                      size_t uxLength,
+                                      const xgmac_timestamp_t * pxTimestamp )
+    {
+        /* The Rx tasks of all channels share the history */
+        taskENTER_CRITICAL();
+        {
+            xRxTimestamps[ uxRxTimestampNext ].pucFrame = pucFrame;
+            xRxTimestamps[ uxRxTimestampNext ].uxLength = uxLength;
+            xRxTimestamps[ uxRxTimestampNext ].xTimestamp = *pxTimestamp;
+            uxRxTimestampNext = ( uxRxTimestampNext + 1U ) % niEMAC_RX_TS_HISTORY;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xNetworkInterfaceGetRxTimestamp( const void * pvFrameData,
+                                                uint64_t * pullSeconds,
+                                                uint32_t * pulNanoseconds )
+    {
+    const uint8_t * pucData = ( const uint8_t * ) pvFrameData;
+    BaseType_t xResult = pdFAIL;
+    UBaseType_t uxIndex;
+
+        if( ( pucData == NULL ) || ( pullSeconds == NULL ) || ( pulNanoseconds == NULL ) )
+        {
+            return pdFAIL;
+        }
+
+        taskENTER_CRITICAL();
+        {
+            /* Any pointer into the frame matches, so a UDP receive handler can
+             * pass its payload pointer */
+            for( uxIndex = 0U; uxIndex < niEMAC_RX_TS_HISTORY; uxIndex++ )
+            {
+                if( ( xRxTimestamps[ uxIndex ].pucFrame != NULL ) &&
+                    ( pucData >= xRxTimestamps[ uxIndex ].pucFrame ) &&
+                    ( pucData < ( xRxTimestamps[ uxIndex ].pucFrame + xRxTimestamps[ uxIndex ].uxLength ) ) )
+                {
+                    *pullSeconds = xRxTimestamps[ uxIndex ].xTimestamp.sec;
+                    *pulNanoseconds = xRxTimestamps[ uxIndex ].xTimestamp.nsec;
+                    xResult = pdPASS;
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( niEMAC_HW_TIMESTAMPING != 0 ) */
+
+static NetworkBufferDescriptor_t * prvGatherRxFrame( uint8_t ucChannel,
+                                                     const uint8_t * pucData,
+                                                     size_t uxLength,
+                                                     uint32_t ulPacketStatus,
+                                                     size_t * puxFrameLength )
+{
+NetworkBufferDescriptor_t * pxBuffer;
+
+    if( ( ulPacketStatus & RDES3_NORM_WR_FD_MASK ) != 0U )
+    {
+        /* A new frame, the last part of the previous one was lost */
+        if( pxRxGatherBuffer[ ucChannel ] != NULL )
+        {
+            niEMAC_STAT_DROP( eEthDropRxError );
+            vReleaseNetworkBufferAndDescriptor( pxRxGatherBuffer[ ucChannel ] );
+        }
+
+        pxRxGatherBuffer[ ucChannel ] = prvGetRxBufferFromCache( ucChannel );
+        uxRxGatherLength[ ucChannel ] = 0U;
+
+        if( pxRxGatherBuffer[ ucChannel ] == NULL )
+        {
+            niEMAC_STAT_DROP( eEthDropRxNoBuffer );
+        }
+    }
+
+    pxBuffer = pxRxGatherBuffer[ ucChannel ];
+
+    if( pxBuffer == NULL )
+    {
+        /* No buffer for the frame, its remaining parts are dropped */
+        return NULL;
+    }
+
+    if( ( uxRxGatherLength[ ucChannel ] + uxLength ) > niEMAC_FRAME_SIZE )
+    {
+        /* Longer than the MTU allows */
+        niEMAC_STAT_DROP( eEthDropRxOversize );
+        vReleaseNetworkBufferAndDescriptor( pxBuffer );
+        pxRxGatherBuffer[ ucChannel ] = NULL;
+        return NULL;
+    }
+
+    ( void ) memcpy( &( pxBuffer->pucEthernetBuffer[ uxRxGatherLength[ ucChannel ] ] ),
+                     pucData, uxLength );
+    uxRxGatherLength[ ucChannel ] += uxLength;
+
+    if( ( ulPacketStatus & RDES3_NORM_WR_LD_MASK ) == 0U )
+    {
+        return NULL;
+    }
+
+    *puxFrameLength = uxRxGatherLength[ ucChannel ];
+    pxRxGatherBuffer[ ucChannel ] = NULL;
+
+    return pxBuffer;
+}
+/*-----------------------------------------------------------*/
+
+#if ( niEMAC_COLLECT_STATS != 0 )
+
+    static void prvRecordRxLatency( uint8_t ucChannel,
+                                    int lDelivered )
+    {
+    uint64_t ullStamp;
+    uint64_t ullNow;
+    uint64_t ullDelta;
+    UBaseType_t uxBucket = 0U;
+
+        /* The Rx interrupt is masked while the ring is polled, the next one
+         * stamps the frames that arrive after this hand-off */
+        ullStamp = __atomic_exchange_n( &( ullRxIrqStamp[ ucChannel ] ), 0U, __ATOMIC_RELAXED );
+
+        if( ( ullStamp == 0U ) || ( lDelivered <= 0 ) )
+        {
+            return;
+        }
+
+        __asm volatile ( "MRS %0, CNTVCT_EL0" : "=r" ( ullNow ) );
+        ullDelta = ullNow - ullStamp;
+
+        if( ullDelta != 0U )
+        {
+            uxBucket = ( UBaseType_t ) ( 63 - __builtin_clzll( ullDelta ) );
+        }
+
+        if( uxBucket >= ethSTATS_LATENCY_BUCKETS )
+        {
+            uxBucket = ethSTATS_LATENCY_BUCKETS - 1U;
+        }
+
+        niEMAC_STAT_ADD( ulRxLatency[ uxBucket ], 1U );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( niEMAC_COLLECT_STATS != 0 ) */
+
+BaseType_t xNetworkInterfaceGetStats( NetworkInterfaceStats_t * pxStats )
+{
+xgmac_handle_t pXGMACHandle;
+uint64_t ullCounterHz;
+
+    if( ( pxStats == NULL ) || ( AgxInterface == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ ( int ) ( ( uintptr_t ) AgxInterface->pvArgument ) ].hxgmac;
+
+    if( pXGMACHandle == NULL )
+    {
+        return pdFAIL;
+    }
+
+    #if ( niEMAC_COLLECT_STATS != 0 )
+    {
+        /* Each counter is read as a whole, but the snapshot is not taken
+         * atomically across counters */
+        ( void ) memcpy( pxStats, &xInterfaceStats, sizeof( *pxStats ) );
+    }
+    #else
+    {
+        ( void ) memset( pxStats, 0, sizeof( *pxStats ) );
+    }
+    #endif
+
+    __asm volatile ( "MRS %0, CNTFRQ_EL0" : "=r" ( ullCounterHz ) );
+    pxStats->ulCounterHz = ( uint32_t ) ullCounterHz;
+
+    if( ( xgmac_ioctl( pXGMACHandle, XGMAC_GET_IRQ_STATS, &( pxStats->xIrq ) ) != 0 ) ||
+        ( xgmac_ioctl( pXGMACHandle, XGMAC_GET_MMC_STATS, &( pxStats->xMmc ) ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+void vNetworkInterfaceClearStats( void )
+{
+xgmac_handle_t pXGMACHandle;
+
+    #if ( niEMAC_COLLECT_STATS != 0 )
+    {
+        taskENTER_CRITICAL();
+        {
+            ( void ) memset( &xInterfaceStats, 0, sizeof( xInterfaceStats ) );
+        }
+        taskEXIT_CRITICAL();
+    }
+    #endif
+
+    if( AgxInterface == NULL )
+    {
+        return;
+    }
+
+    pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ ( int ) ( ( uintptr_t ) AgxInterface->pvArgument ) ].hxgmac;
+
+    if( pXGMACHandle != NULL )
+    {
+        ( void ) xgmac_ioctl( pXGMACHandle, XGMAC_CLEAR_IRQ_STATS, NULL );
+        ( void ) xgmac_ioctl( pXGMACHandle, XGMAC_CLEAR_MMC_STATS, NULL );
+    }
+}
+/*-----------------------------------------------------------*/
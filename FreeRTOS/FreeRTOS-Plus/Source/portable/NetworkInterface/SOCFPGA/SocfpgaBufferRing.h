@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Free buffer ring of the SoC FPGA network interface buffer pools
+ */
+
+#ifndef SOCFPGA_BUFFER_RING_H
+#define SOCFPGA_BUFFER_RING_H
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+/* *INDENT-ON* */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "FreeRTOS.h"
+
+/* The free buffers of a pool are kept in a single-producer/single-consumer
+ * ring. The consumer takes buffers at ulHeadIndex and the producer returns
+ * them at ulTailIndex, each index is written by one side only so no lock is
+ * needed. One slot stays unused to tell a full ring from an empty one. */
+typedef struct
+{
+_Atomic uint32_t ulHeadIndex;
+_Atomic uint32_t ulTailIndex;
+uint32_t ulSlots;
+uint8_t ** ppucSlots;
+} BufferRing_t;
+/*-----------------------------------------------------------*/
+
+/* Fill the ring with ulCount buffers of xBufferSize bytes carved out of
+ * pucBuffers. ppucSlots must have room for ulCount + 1 entries. */
+static inline void prvInitBufferRing( BufferRing_t * pxRing,
+                                      uint8_t ** ppucSlots,
+                                      uint32_t ulCount,
+                                      uint8_t * pucBuffers,
+                                      size_t xBufferSize )
+{
+    pxRing->ppucSlots = ppucSlots;
+    pxRing->ulSlots = ulCount + 1U;
+
+    /* Every buffer starts out free */
+    for( uint32_t i = 0U; i < ulCount; i++ )
+    {
+        ppucSlots[ i ] = &( pucBuffers[ i * xBufferSize ] );
+    }
+
+    atomic_store_explicit( &( pxRing->ulHeadIndex ), 0U, memory_order_relaxed );
+    atomic_store_explicit( &( pxRing->ulTailIndex ), ulCount, memory_order_release );
+}
+/*-----------------------------------------------------------*/
+
+/* Take a free buffer, NULL when the ring is empty. Consumer side only. */
+static inline uint8_t * prvBufferRingGet( BufferRing_t * pxRing )
+{
+uint32_t ulHead;
+uint32_t ulTail;
+uint8_t * pucBuffer;
+
+    ulHead = atomic_load_explicit( &( pxRing->ulHeadIndex ), memory_order_relaxed );
+
+    /* Pairs with the release store of the producer, the slot is valid once
+     * the new tail is seen */
+    ulTail = atomic_load_explicit( &( pxRing->ulTailIndex ), memory_order_acquire );
+
+    if( ulHead == ulTail )
+    {
+        return NULL;
+    }
+
+    pucBuffer = pxRing->ppucSlots[ ulHead ];
+
+    ulHead++;
+
+    if( ulHead == pxRing->ulSlots )
+    {
+        ulHead = 0U;
+    }
+
+    /* The slot may be reused by the producer from here on */
+    atomic_store_explicit( &( pxRing->ulHeadIndex ), ulHead, memory_order_release );
+
+    return pucBuffer;
+}
+/*-----------------------------------------------------------*/
+
+/* Return a buffer, pdFAIL when the ring is already full. Producer side
+ * only. */
+static inline BaseType_t prvBufferRingPut( BufferRing_t * pxRing,
+                                           uint8_t * pucBuffer )
+{
+uint32_t ulHead;
+uint32_t ulTail;
+uint32_t ulNext;
+
+    ulTail = atomic_load_explicit( &( pxRing->ulTailIndex ), memory_order_relaxed );
+    ulHead = atomic_load_explicit( &( pxRing->ulHeadIndex ), memory_order_acquire );
+
+    ulNext = ulTail + 1U;
+
+    if( ulNext == pxRing->ulSlots )
+    {
+        ulNext = 0U;
+    }
+
+    /* Full, more buffers returned than were taken */
+    if( ulNext == ulHead )
+    {
+        return pdFAIL;
+    }
+
+    pxRing->ppucSlots[ ulTail ] = pucBuffer;
+    atomic_store_explicit( &( pxRing->ulTailIndex ), ulNext, memory_order_release );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+}
+#endif
+/* *INDENT-ON* */
+
+#endif /* SOCFPGA_BUFFER_RING_H */
@@ -25,8 +25,8 @@
  * http://www.FreeRTOS.org
  */
 
-#ifndef NETWORK_INTERFACE_H
-#define NETWORK_INTERFACE_H
+#ifndef SOCFPGA_NETWORK_INTERFACE_H
+#define SOCFPGA_NETWORK_INTERFACE_H
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -36,6 +36,45 @@ extern "C"
 /* *INDENT-ON* */
 
 #include "FreeRTOS_IP.h"
+#include "socfpga_xgmac.h"
+
+/* Reasons for which a frame is dropped by the network interface. */
+typedef enum
+{
+    eEthDropRxError = 0,     /* Descriptor reported a receive error. */
+    eEthDropRxFiltered,      /* Frame not accepted by eConsiderFrameForProcessing(). */
+    eEthDropRxNoBuffer,      /* No network buffer to pass the frame to the stack. */
+    eEthDropRxOversize,      /* Frame larger than a network buffer. */
+    eEthDropRxQueueFull,     /* IP task event queue full. */
+    eEthDropTxOversize,      /* Frame larger than the configured MTU. */
+    eEthDropTxLinkDown,      /* Link was down when the frame was sent. */
+    eEthDropTxNoBuffer,      /* No Tx copy buffer available. */
+    eEthDropTxRingFull,      /* Tx descriptor ring full. */
+    eEthDropCount
+} eEthDropReason_t;
+
+/* Number of buckets in the Rx latency histogram. Bucket n counts the frames
+ * delivered between 2^n and 2^(n+1) counter ticks after the Rx interrupt, the
+ * last bucket also holds everything slower. */
+#define ethSTATS_LATENCY_BUCKETS    24
+
+/* Statistics of the network interface, see xNetworkInterfaceGetStats(). */
+typedef struct xNetworkInterfaceStats
+{
+    uint64_t ullRxPackets;                           /* Frames passed to the stack. */
+    uint64_t ullRxBytes;
+    uint64_t ullTxPackets;                           /* Frames queued to the XGMAC. */
+    uint64_t ullTxBytes;
+    uint32_t ulDrops[ eEthDropCount ];               /* Dropped frames, by eEthDropReason_t. */
+    uint32_t ulTxRingFull;                           /* Flushes that found the Tx ring full. */
+    uint32_t ulRxRingFull;                           /* Rx buffer unavailable interrupts. */
+    uint32_t ulRxRefillFailures;                     /* Rx descriptor refills that failed. */
+    uint32_t ulRxAllocFailures;                      /* Network buffer allocations for Rx that failed. */
+    uint32_t ulRxLatency[ ethSTATS_LATENCY_BUCKETS ]; /* Rx interrupt to stack hand-off latency. */
+    uint32_t ulCounterHz;                            /* Frequency of the latency counter. */
+    xgmac_irq_stats_t xIrq;                          /* XGMAC interrupt statistics. */
+    xgmac_mmc_stats_t xMmc;                          /* XGMAC MMC hardware counters. */
+} NetworkInterfaceStats_t;
 
 /* INTERNAL API FUNCTIONS. */
 
@@ -56,6 +95,23 @@ BaseType_t xGetPhyLinkStatus( struct xNetworkInterface * pxInterface );
 NetworkInterface_t * pxFillInterfaceDescriptor( BaseType_t xEMACIndex,
                                                 NetworkInterface_t * pxInterface );
 
+/* Get the XGMAC receive timestamp of a recently received frame. pvFrameData
+ * may point anywhere inside the frame, such as the payload passed to a
+ * FREERTOS_SO_UDP_RECV_HANDLER callback. Only available when
+ * niEMAC_HW_TIMESTAMPING is enabled, returns pdFAIL when the frame is no
+ * longer in the timestamp history. */
+BaseType_t xNetworkInterfaceGetRxTimestamp( const void * pvFrameData,
+                                            uint64_t * pullSeconds,
+                                            uint32_t * pulNanoseconds );
+
+/* Take a snapshot of the interface statistics, including the XGMAC
+ * interrupt and MMC counters. Returns pdFAIL when the interface has not been
+ * initialised. */
+BaseType_t xNetworkInterfaceGetStats( NetworkInterfaceStats_t * pxStats );
+
+/* Reset the interface statistics and the XGMAC counters. */
+void vNetworkInterfaceClearStats( void );
+
 #define MAC_IS_MULTICAST( pucMACAddressBytes )    ( ( pucMACAddressBytes[ 0 ] & 1U ) != 0U )
 #define MAC_IS_UNICAST( pucMACAddressBytes )      ( ( pucMACAddressBytes[ 0 ] & 1U ) == 0U )
 
@@ -65,4 +121,4 @@ NetworkInterface_t * pxFillInterfaceDescriptor( BaseType_t xEMACIndex,
 #endif
 /* *INDENT-ON* */
 
-#endif /* NETWORK_INTERFACE_H */
+#endif /* SOCFPGA_NETWORK_INTERFACE_H */
@@ -7,10 +7,12 @@
 
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "socfpga_cache.h"
 
 /**
  * @brief change the cache setting of page
@@ -30,8 +32,7 @@ extern void config_page_caching( void * addr,
 extern size_t get_smallest_ever_remaining_heap_size();
 extern size_t get_remaining_heap_size();
 
-static uintptr_t _coherent_bytes_left = 0;
-static uintptr_t _coherent_pointer = 0;
+#if ( configUSE_SLAB_HEAP == 0 )
 
 size_t xPortGetFreeHeapSize( void )
 {
@@ -45,46 +46,402 @@ size_t xPortGetMinimumEverFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
-#define GRANULE_SIZE    0x200000
+#endif /* configUSE_SLAB_HEAP */
 
-void * pvPortMallocCoherent( size_t xWantedSize )
+/*
+ * Coherent memory allocator.
+ *
+ * Caching can only be turned off for whole 2 MB pages, so uncached memory
+ * is taken from the heap in granules of that size and split in 64 KB pages:
+ * - blocks of up to half a page come in power of two size classes from a
+ *   cache line up. A page is carved into blocks of a single class, the free
+ *   blocks of a class are kept on a list.
+ * - blocks of a page up to a granule are power of two runs of pages.
+ * - larger blocks get whole granules of their own.
+ * Blocks are aligned to their size, 2 MB at most, so a block never crosses
+ * a boundary of its own size. Granules go back to the heap once all their
+ * pages are free, one empty granule is kept to absorb alloc/free cycles.
+ */
+#define GRANULE_SIZE                   0x200000
+#define COHERENT_PAGE_SHIFT            16
+#define COHERENT_PAGE_SIZE             ( 1UL << COHERENT_PAGE_SHIFT )
+#define COHERENT_PAGES_PER_GRANULE     ( GRANULE_SIZE / COHERENT_PAGE_SIZE )
+#define COHERENT_MIN_SHIFT             6
+#define COHERENT_NUM_CLASSES           ( COHERENT_PAGE_SHIFT - COHERENT_MIN_SHIFT )
+
+#ifndef configCOHERENT_MAX_GRANULES
+    #define configCOHERENT_MAX_GRANULES    16
+#endif
+
+/* Page map entries, small class indexes are below COHERENT_NUM_CLASSES */
+#define COHERENT_PAGE_FREE             0xFFU
+#define COHERENT_PAGE_RUN              0x80U /* first page of a run, ORed with the order */
+#define COHERENT_PAGE_TAIL             0xC0U /* other pages of a run */
+
+typedef struct CoherentBlock
 {
-void * pvReturn;
-int lnumPages = xWantedSize / GRANULE_SIZE;
+    struct CoherentBlock * pxNext;
+    struct CoherentBlock * pxPrev;
+} CoherentBlock_t;
 
-    vTaskSuspendAll();
+typedef struct CoherentGranule
+{
+    uint8_t * pucBase;      /* NULL when the entry is unused */
+    size_t xGranules;       /* above 1 for a block of its own */
+    uint32_t ulFreePages;
+    uint8_t aucPageMap[ COHERENT_PAGES_PER_GRANULE ];
+    uint16_t ausBlocksUsed[ COHERENT_PAGES_PER_GRANULE ];
+} CoherentGranule_t;
+
+static CoherentGranule_t xCoherentGranules[ configCOHERENT_MAX_GRANULES ];
+static CoherentBlock_t * pxCoherentFreeLists[ COHERENT_NUM_CLASSES ];
+static CoherentHeapStats_t xCoherentStats;
+
+/*-----------------------------------------------------------*/
+
+static CoherentGranule_t * prvCoherentNewGranules( size_t xGranules )
+{
+CoherentGranule_t * pxGranule = NULL;
+uint8_t * pucBase;
+size_t x;
+
+    for( x = 0; x < configCOHERENT_MAX_GRANULES; x++ )
     {
-        if( ( _coherent_bytes_left == 0 ) || ( xWantedSize > _coherent_bytes_left ) )
+        if( xCoherentGranules[ x ].pucBase == NULL )
         {
-            pvReturn = aligned_alloc( GRANULE_SIZE, GRANULE_SIZE
-                                      + ( lnumPages * GRANULE_SIZE ) );
+            pxGranule = &xCoherentGranules[ x ];
+            break;
+        }
+    }
 
-            if( pvReturn != NULL )
-            {
-                config_page_caching( pvReturn, 0 );
+    if( pxGranule == NULL )
+    {
+        return NULL;
+    }
 
-                if( ( xWantedSize % GRANULE_SIZE ) != 0 )
-                {
-                    _coherent_bytes_left = GRANULE_SIZE - ( xWantedSize % GRANULE_SIZE );
-                    _coherent_pointer = ( uintptr_t ) pvReturn + xWantedSize;
-                }
-                else
+    pucBase = aligned_alloc( GRANULE_SIZE, xGranules * GRANULE_SIZE );
+
+    if( pucBase == NULL )
+    {
+        return NULL;
+    }
+
+    for( x = 0; x < xGranules; x++ )
+    {
+        config_page_caching( pucBase + ( x * GRANULE_SIZE ), 0 );
+    }
+
+    /* Lines left by cached accesses must not be evicted over DMA data. The
+     * mapping is uncached first, a flush done before could be refilled by
+     * speculative accesses through the cached mapping. */
+    cache_flush( pucBase, xGranules * GRANULE_SIZE );
+
+    pxGranule->pucBase = pucBase;
+    pxGranule->xGranules = xGranules;
+    pxGranule->ulFreePages = COHERENT_PAGES_PER_GRANULE;
+    memset( pxGranule->aucPageMap, COHERENT_PAGE_FREE, sizeof( pxGranule->aucPageMap ) );
+    memset( pxGranule->ausBlocksUsed, 0, sizeof( pxGranule->ausBlocksUsed ) );
+    xCoherentStats.xCoherentBytes += xGranules * GRANULE_SIZE;
+    xCoherentStats.xNumberOfGranules += xGranules;
+
+    return pxGranule;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoherentReleaseGranules( CoherentGranule_t * pxGranule )
+{
+size_t x;
+
+    for( x = 0; x < pxGranule->xGranules; x++ )
+    {
+        config_page_caching( pxGranule->pucBase + ( x * GRANULE_SIZE ), 1 );
+    }
+
+    free( pxGranule->pucBase );
+    xCoherentStats.xCoherentBytes -= pxGranule->xGranules * GRANULE_SIZE;
+    xCoherentStats.xNumberOfGranules -= pxGranule->xGranules;
+    pxGranule->pucBase = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static CoherentGranule_t * prvCoherentFindGranule( const uint8_t * pucAddr )
+{
+size_t x;
+
+    for( x = 0; x < configCOHERENT_MAX_GRANULES; x++ )
+    {
+        if( ( xCoherentGranules[ x ].pucBase != NULL ) &&
+            ( pucAddr >= xCoherentGranules[ x ].pucBase ) &&
+            ( pucAddr < ( xCoherentGranules[ x ].pucBase +
+                          ( xCoherentGranules[ x ].xGranules * GRANULE_SIZE ) ) ) )
+        {
+            return &xCoherentGranules[ x ];
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Find a free run of 2^uxOrder pages aligned to its size and mark it with
+ * ucMark, a new granule is taken when none is free. */
+static uint8_t * prvCoherentAllocPages( UBaseType_t uxOrder,
+                                        uint8_t ucMark,
+                                        CoherentGranule_t ** ppxGranule,
+                                        uint32_t * pulPage )
+{
+CoherentGranule_t * pxGranule = NULL;
+uint32_t ulPages = 1UL << uxOrder;
+uint32_t ulPage = 0;
+uint32_t ulRun;
+size_t x;
+
+    for( x = 0; ( x < configCOHERENT_MAX_GRANULES ) && ( pxGranule == NULL ); x++ )
+    {
+        if( ( xCoherentGranules[ x ].pucBase == NULL ) ||
+            ( xCoherentGranules[ x ].xGranules != 1 ) ||
+            ( xCoherentGranules[ x ].ulFreePages < ulPages ) )
+        {
+            continue;
+        }
+
+        for( ulPage = 0; ulPage < COHERENT_PAGES_PER_GRANULE; ulPage += ulPages )
+        {
+            for( ulRun = 0; ulRun < ulPages; ulRun++ )
+            {
+                if( xCoherentGranules[ x ].aucPageMap[ ulPage + ulRun ] != COHERENT_PAGE_FREE )
                 {
-                    _coherent_bytes_left = 0;
-                    _coherent_pointer = 0;
+                    break;
                 }
             }
+
+            if( ulRun == ulPages )
+            {
+                pxGranule = &xCoherentGranules[ x ];
+                break;
+            }
         }
-        else
+    }
+
+    if( pxGranule == NULL )
+    {
+        pxGranule = prvCoherentNewGranules( 1 );
+
+        if( pxGranule == NULL )
         {
-            pvReturn = ( void * ) _coherent_pointer;
-            _coherent_pointer += xWantedSize;
-            _coherent_bytes_left += xWantedSize;
+            return NULL;
         }
 
-        traceMALLOC( pvReturn, xWantedSize );
+        ulPage = 0;
+    }
+
+    pxGranule->aucPageMap[ ulPage ] = ucMark;
+
+    for( ulRun = 1; ulRun < ulPages; ulRun++ )
+    {
+        pxGranule->aucPageMap[ ulPage + ulRun ] = COHERENT_PAGE_TAIL;
+    }
+
+    pxGranule->ulFreePages -= ulPages;
+    *ppxGranule = pxGranule;
+    *pulPage = ulPage;
+
+    return pxGranule->pucBase + ( ( size_t ) ulPage << COHERENT_PAGE_SHIFT );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoherentFreePages( CoherentGranule_t * pxGranule,
+                                  uint32_t ulPage,
+                                  uint32_t ulPages )
+{
+uint32_t ulRun;
+size_t x;
+
+    for( ulRun = 0; ulRun < ulPages; ulRun++ )
+    {
+        pxGranule->aucPageMap[ ulPage + ulRun ] = COHERENT_PAGE_FREE;
+    }
+
+    pxGranule->ulFreePages += ulPages;
+
+    if( pxGranule->ulFreePages != COHERENT_PAGES_PER_GRANULE )
+    {
+        return;
+    }
+
+    /* Keep a single empty granule */
+    for( x = 0; x < configCOHERENT_MAX_GRANULES; x++ )
+    {
+        if( ( &xCoherentGranules[ x ] != pxGranule ) &&
+            ( xCoherentGranules[ x ].pucBase != NULL ) &&
+            ( xCoherentGranules[ x ].xGranules == 1 ) &&
+            ( xCoherentGranules[ x ].ulFreePages == COHERENT_PAGES_PER_GRANULE ) )
+        {
+            prvCoherentReleaseGranules( pxGranule );
+            break;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoherentListRemove( UBaseType_t uxClass,
+                                   CoherentBlock_t * pxBlock )
+{
+    if( pxBlock->pxPrev != NULL )
+    {
+        pxBlock->pxPrev->pxNext = pxBlock->pxNext;
+    }
+    else
+    {
+        pxCoherentFreeLists[ uxClass ] = pxBlock->pxNext;
+    }
+
+    if( pxBlock->pxNext != NULL )
+    {
+        pxBlock->pxNext->pxPrev = pxBlock->pxPrev;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoherentListPush( UBaseType_t uxClass,
+                                 CoherentBlock_t * pxBlock )
+{
+    pxBlock->pxPrev = NULL;
+    pxBlock->pxNext = pxCoherentFreeLists[ uxClass ];
+
+    if( pxBlock->pxNext != NULL )
+    {
+        pxBlock->pxNext->pxPrev = pxBlock;
+    }
+
+    pxCoherentFreeLists[ uxClass ] = pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvCoherentAllocSmall( UBaseType_t uxClass )
+{
+CoherentGranule_t * pxGranule;
+CoherentBlock_t * pxBlock;
+uint8_t * pucPage;
+uint32_t ulPage;
+size_t xBlockSize = ( size_t ) 1 << ( uxClass + COHERENT_MIN_SHIFT );
+size_t xOffset;
+
+    if( pxCoherentFreeLists[ uxClass ] == NULL )
+    {
+        pucPage = prvCoherentAllocPages( 0, ( uint8_t ) uxClass, &pxGranule, &ulPage );
+
+        if( pucPage == NULL )
+        {
+            return NULL;
+        }
+
+        /* Pushed backwards so blocks are handed out in address order */
+        for( xOffset = COHERENT_PAGE_SIZE; xOffset > 0; xOffset -= xBlockSize )
+        {
+            prvCoherentListPush( uxClass, ( CoherentBlock_t * ) ( pucPage + xOffset - xBlockSize ) );
+        }
+    }
+
+    pxBlock = pxCoherentFreeLists[ uxClass ];
+    prvCoherentListRemove( uxClass, pxBlock );
+    pxGranule = prvCoherentFindGranule( ( uint8_t * ) pxBlock );
+    ulPage = ( uint32_t ) ( ( ( uint8_t * ) pxBlock - pxGranule->pucBase ) >> COHERENT_PAGE_SHIFT );
+    pxGranule->ausBlocksUsed[ ulPage ]++;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoherentFreeSmall( CoherentGranule_t * pxGranule,
+                                  uint32_t ulPage,
+                                  void * pv )
+{
+UBaseType_t uxClass = pxGranule->aucPageMap[ ulPage ];
+size_t xBlockSize = ( size_t ) 1 << ( uxClass + COHERENT_MIN_SHIFT );
+uint8_t * pucPage = pxGranule->pucBase + ( ( size_t ) ulPage << COHERENT_PAGE_SHIFT );
+size_t xOffset;
+
+    prvCoherentListPush( uxClass, ( CoherentBlock_t * ) pv );
+    pxGranule->ausBlocksUsed[ ulPage ]--;
+
+    if( pxGranule->ausBlocksUsed[ ulPage ] == 0 )
+    {
+        /* Every block of the page is on the list, give the page back */
+        for( xOffset = 0; xOffset < COHERENT_PAGE_SIZE; xOffset += xBlockSize )
+        {
+            prvCoherentListRemove( uxClass, ( CoherentBlock_t * ) ( pucPage + xOffset ) );
+        }
+
+        prvCoherentFreePages( pxGranule, ulPage, 1 );
+    }
+
+    xCoherentStats.xAllocatedBytes -= xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortMallocCoherentAligned( size_t xAlignment,
+                                    size_t xWantedSize )
+{
+void * pvReturn = NULL;
+CoherentGranule_t * pxGranule;
+uint32_t ulPage;
+UBaseType_t uxShift = COHERENT_MIN_SHIFT;
+size_t xSize;
+
+    xSize = ( xWantedSize > xAlignment ) ? xWantedSize : xAlignment;
+
+    if( ( xWantedSize != 0 ) && ( xAlignment <= GRANULE_SIZE ) &&
+        ( ( xAlignment & ( xAlignment - 1 ) ) == 0 ) &&
+        ( xSize <= ( ( size_t ) configCOHERENT_MAX_GRANULES * GRANULE_SIZE ) ) )
+    {
+        while( ( ( size_t ) 1 << uxShift ) < xSize )
+        {
+            uxShift++;
+        }
+
+        vTaskSuspendAll();
+        {
+            if( uxShift < COHERENT_PAGE_SHIFT )
+            {
+                pvReturn = prvCoherentAllocSmall( uxShift - COHERENT_MIN_SHIFT );
+            }
+            else if( ( ( size_t ) 1 << uxShift ) <= GRANULE_SIZE )
+            {
+                pvReturn = prvCoherentAllocPages( uxShift - COHERENT_PAGE_SHIFT,
+                                                  ( uint8_t ) ( COHERENT_PAGE_RUN | ( uxShift - COHERENT_PAGE_SHIFT ) ),
+                                                  &pxGranule, &ulPage );
+            }
+            else
+            {
+                /* A block of its own, rounded up to granules */
+                uxShift = 0;
+                pxGranule = prvCoherentNewGranules( ( xSize + GRANULE_SIZE - 1 ) / GRANULE_SIZE );
+
+                if( pxGranule != NULL )
+                {
+                    pxGranule->ulFreePages = 0;
+                    pvReturn = pxGranule->pucBase;
+                }
+            }
+
+            if( pvReturn != NULL )
+            {
+                xCoherentStats.xAllocatedBytes += ( uxShift != 0 ) ?
+                                                  ( ( size_t ) 1 << uxShift ) :
+                                                  ( pxGranule->xGranules * GRANULE_SIZE );
+                xCoherentStats.xNumberOfSuccessfulAllocations++;
+
+                if( xCoherentStats.xAllocatedBytes > xCoherentStats.xMaxAllocatedBytes )
+                {
+                    xCoherentStats.xMaxAllocatedBytes = xCoherentStats.xAllocatedBytes;
+                }
+            }
+
+            traceMALLOC( pvReturn, xWantedSize );
+        }
+        ( void ) xTaskResumeAll();
     }
-    ( void ) xTaskResumeAll();
 
     #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
     {
@@ -99,6 +456,71 @@ int lnumPages = xWantedSize / GRANULE_SIZE;
 }
 /*-----------------------------------------------------------*/
 
+void * pvPortMallocCoherent( size_t xWantedSize )
+{
+    return pvPortMallocCoherentAligned( 1, xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeCoherent( void * pv )
+{
+CoherentGranule_t * pxGranule;
+uint32_t ulPage;
+uint8_t ucMark;
+
+    if( pv == NULL )
+    {
+        return;
+    }
+
+    vTaskSuspendAll();
+    {
+        pxGranule = prvCoherentFindGranule( ( uint8_t * ) pv );
+        configASSERT( pxGranule != NULL );
+
+        if( pxGranule != NULL )
+        {
+            ulPage = ( uint32_t ) ( ( ( uint8_t * ) pv - pxGranule->pucBase ) >> COHERENT_PAGE_SHIFT );
+            ucMark = pxGranule->aucPageMap[ ulPage ];
+
+            if( pxGranule->xGranules > 1 )
+            {
+                xCoherentStats.xAllocatedBytes -= pxGranule->xGranules * GRANULE_SIZE;
+                prvCoherentReleaseGranules( pxGranule );
+            }
+            else if( ucMark < COHERENT_NUM_CLASSES )
+            {
+                prvCoherentFreeSmall( pxGranule, ulPage, pv );
+            }
+            else
+            {
+                configASSERT( ( ucMark & COHERENT_PAGE_TAIL ) == COHERENT_PAGE_RUN );
+                ucMark &= ( uint8_t ) ~COHERENT_PAGE_RUN;
+                xCoherentStats.xAllocatedBytes -= COHERENT_PAGE_SIZE << ucMark;
+                prvCoherentFreePages( pxGranule, ulPage, 1UL << ucMark );
+            }
+
+            xCoherentStats.xNumberOfSuccessfulFrees++;
+        }
+
+        traceFREE( pv, 0 );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetCoherentHeapStats( CoherentHeapStats_t * pxHeapStats )
+{
+    vTaskSuspendAll();
+    {
+        *pxHeapStats = xCoherentStats;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SLAB_HEAP == 0 )
+
 void * pvPortAlignedAlloc( size_t xAlignemnt,
                            size_t xWantedSize )
 {
@@ -123,3 +545,5 @@ void * pvReturn;
     return pvReturn;
 }
 /*-----------------------------------------------------------*/
+
+#endif /* configUSE_SLAB_HEAP */
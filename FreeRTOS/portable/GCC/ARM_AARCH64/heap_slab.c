@@ -0,0 +1,542 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ */
+
+/*
+ * Slab heap, a bounded time replacement of heap_3.
+ *
+ * heap_3 runs the newlib allocator with the scheduler suspended, for as long
+ * as newlib takes to search its free lists. This heap serves pvPortMalloc()
+ * from a static pool of configTOTAL_HEAP_SIZE bytes instead:
+ * - the pool is split in 16 KB pages, runs of 2^n pages are handed out by a
+ *   buddy allocator, a page alloc or free touches at most one list per order.
+ * - blocks of up to half a page come from power of two size classes. A class
+ *   keeps the pages carved in its blocks that still have free blocks on a
+ *   list, each page has its own list of free blocks, so an allocation or a
+ *   free is a handful of list operations.
+ * - blocks larger than configSLAB_MAX_RUN_SIZE, or aligned to more than a
+ *   page, are left to newlib as heap_3 did. They are meant for buffers set up
+ *   once at init.
+ * Blocks are aligned to their size rounded up to a power of two, up to a
+ * page. All the lists are guarded by one global lock, slabLOCK(), held only
+ * around those few list operations. A class taking a page from the pool
+ * takes it again, nested. The port runs on a single core so the lock is a
+ * critical section, the scheduler is never suspended.
+ *
+ * Select it with FREERTOS_SLAB_HEAP in the build, which also sets
+ * configUSE_SLAB_HEAP so heap_3_extra.c leaves the heap size functions and
+ * pvPortAlignedAlloc() to this file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configSLAB_MAX_RUN_SIZE
+    #define configSLAB_MAX_RUN_SIZE    ( 256U * 1024U )
+#endif
+
+#define slabPAGE_SHIFT            14
+#define slabPAGE_SIZE             ( ( size_t ) 1 << slabPAGE_SHIFT )
+#define slabNUM_PAGES             ( configTOTAL_HEAP_SIZE / slabPAGE_SIZE )
+#define slabMIN_SHIFT             4
+#define slabNUM_CLASSES           ( slabPAGE_SHIFT - slabMIN_SHIFT )
+#define slabMAX_ORDERS            16
+
+/* Page states, size class indexes are below slabNUM_CLASSES */
+#define slabPAGE_FREE             0xFFU /* first page of a free run */
+#define slabPAGE_RUN              0xFEU /* first page of an allocated run */
+#define slabPAGE_TAIL             0xFDU /* other pages of a run */
+
+#define slabLOCK()                taskENTER_CRITICAL()
+#define slabUNLOCK()              taskEXIT_CRITICAL()
+
+_Static_assert( ( slabNUM_PAGES != 0 ) && ( ( slabNUM_PAGES >> ( slabMAX_ORDERS - 1 ) ) <= 1 ),
+                "configTOTAL_HEAP_SIZE does not fit the slab heap" );
+
+typedef struct SlabFreeBlock
+{
+    struct SlabFreeBlock * pxNext;
+} SlabFreeBlock_t;
+
+typedef struct SlabPage
+{
+    struct SlabPage * pxNext;       /* in the free list of its order or the list of its class */
+    struct SlabPage * pxPrev;
+    SlabFreeBlock_t * pxFreeBlocks; /* blocks of a class page freed so far */
+    uint16_t usUsed;                /* blocks of a class page in use */
+    uint16_t usCarved;              /* blocks of a class page handed out at least once */
+    uint8_t ucOrder;                /* size of a run, 2^ucOrder pages */
+    uint8_t ucState;
+} SlabPage_t;
+
+static uint8_t ucHeap[ slabNUM_PAGES * slabPAGE_SIZE ] __attribute__( ( aligned( slabPAGE_SIZE ) ) );
+static SlabPage_t xPages[ slabNUM_PAGES ];
+static SlabPage_t * pxFreeRuns[ slabMAX_ORDERS ];
+static SlabPage_t * pxClassPages[ slabNUM_CLASSES ];
+static BaseType_t xHeapInitialised = pdFALSE;
+
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xNumberOfSuccessfulAllocations = 0U;
+static size_t xNumberOfSuccessfulFrees = 0U;
+
+extern size_t get_smallest_ever_remaining_heap_size();
+extern size_t get_remaining_heap_size();
+
+/*-----------------------------------------------------------*/
+
+static void prvListInsert( SlabPage_t ** ppxHead,
+                           SlabPage_t * pxPage )
+{
+    pxPage->pxPrev = NULL;
+    pxPage->pxNext = *ppxHead;
+
+    if( pxPage->pxNext != NULL )
+    {
+        pxPage->pxNext->pxPrev = pxPage;
+    }
+
+    *ppxHead = pxPage;
+}
+/*-----------------------------------------------------------*/
+
+static void prvListRemove( SlabPage_t ** ppxHead,
+                           SlabPage_t * pxPage )
+{
+    if( pxPage->pxPrev != NULL )
+    {
+        pxPage->pxPrev->pxNext = pxPage->pxNext;
+    }
+    else
+    {
+        *ppxHead = pxPage->pxNext;
+    }
+
+    if( pxPage->pxNext != NULL )
+    {
+        pxPage->pxNext->pxPrev = pxPage->pxPrev;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+size_t xPage;
+UBaseType_t uxOrder;
+
+    for( xPage = 0; xPage < slabNUM_PAGES; xPage++ )
+    {
+        xPages[ xPage ].ucState = slabPAGE_TAIL;
+    }
+
+    xPage = 0;
+
+    /* Cover the pool with the largest aligned runs that fit */
+    while( xPage < slabNUM_PAGES )
+    {
+        uxOrder = slabMAX_ORDERS - 1;
+
+        while( ( ( xPage & ( ( ( size_t ) 1 << uxOrder ) - 1 ) ) != 0 ) ||
+               ( ( xPage + ( ( size_t ) 1 << uxOrder ) ) > slabNUM_PAGES ) )
+        {
+            uxOrder--;
+        }
+
+        xPages[ xPage ].ucOrder = ( uint8_t ) uxOrder;
+        xPages[ xPage ].ucState = slabPAGE_FREE;
+        prvListInsert( &pxFreeRuns[ uxOrder ], &xPages[ xPage ] );
+        xPage += ( size_t ) 1 << uxOrder;
+    }
+
+    xFreeBytesRemaining = sizeof( ucHeap );
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    xHeapInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAccountAlloc( size_t xSize )
+{
+    xFreeBytesRemaining -= xSize;
+    xNumberOfSuccessfulAllocations++;
+
+    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+    {
+        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Take a run of 2^uxOrder pages, splitting a larger run when needed. */
+static SlabPage_t * prvAllocRun( UBaseType_t uxOrder )
+{
+SlabPage_t * pxPage = NULL;
+SlabPage_t * pxBuddy;
+UBaseType_t uxFound;
+
+    slabLOCK();
+    {
+        if( xHeapInitialised == pdFALSE )
+        {
+            prvHeapInit();
+        }
+
+        for( uxFound = uxOrder; uxFound < slabMAX_ORDERS; uxFound++ )
+        {
+            if( pxFreeRuns[ uxFound ] != NULL )
+            {
+                pxPage = pxFreeRuns[ uxFound ];
+                prvListRemove( &pxFreeRuns[ uxFound ], pxPage );
+                break;
+            }
+        }
+
+        if( pxPage != NULL )
+        {
+            /* Give back the upper halves */
+            while( uxFound > uxOrder )
+            {
+                uxFound--;
+                pxBuddy = pxPage + ( ( size_t ) 1 << uxFound );
+                pxBuddy->ucOrder = ( uint8_t ) uxFound;
+                pxBuddy->ucState = slabPAGE_FREE;
+                prvListInsert( &pxFreeRuns[ uxFound ], pxBuddy );
+            }
+
+            pxPage->ucOrder = ( uint8_t ) uxOrder;
+            pxPage->ucState = slabPAGE_RUN;
+        }
+    }
+    slabUNLOCK();
+
+    return pxPage;
+}
+/*-----------------------------------------------------------*/
+
+/* Give back a run, merging it with its free buddies. */
+static void prvFreeRun( SlabPage_t * pxPage )
+{
+size_t xPage = ( size_t ) ( pxPage - xPages );
+size_t xBuddy;
+UBaseType_t uxOrder = pxPage->ucOrder;
+
+    slabLOCK();
+    {
+        while( uxOrder < ( slabMAX_ORDERS - 1 ) )
+        {
+            xBuddy = xPage ^ ( ( size_t ) 1 << uxOrder );
+
+            if( ( xBuddy >= slabNUM_PAGES ) ||
+                ( xPages[ xBuddy ].ucState != slabPAGE_FREE ) ||
+                ( xPages[ xBuddy ].ucOrder != uxOrder ) )
+            {
+                break;
+            }
+
+            prvListRemove( &pxFreeRuns[ uxOrder ], &xPages[ xBuddy ] );
+            xPages[ xPage | xBuddy ].ucState = slabPAGE_TAIL;
+            xPage &= xBuddy;
+            uxOrder++;
+        }
+
+        xPages[ xPage ].ucOrder = ( uint8_t ) uxOrder;
+        xPages[ xPage ].ucState = slabPAGE_FREE;
+        prvListInsert( &pxFreeRuns[ uxOrder ], &xPages[ xPage ] );
+    }
+    slabUNLOCK();
+}
+/*-----------------------------------------------------------*/
+
+static void * prvAllocBlock( UBaseType_t uxClass )
+{
+SlabPage_t * pxPage;
+SlabFreeBlock_t * pxBlock = NULL;
+size_t xBlockSize = ( size_t ) 1 << ( uxClass + slabMIN_SHIFT );
+uint16_t usBlocks = ( uint16_t ) ( slabPAGE_SIZE / xBlockSize );
+
+    slabLOCK();
+    {
+        pxPage = pxClassPages[ uxClass ];
+
+        if( pxPage == NULL )
+        {
+            /* Blocks are carved as they are handed out, so a new page costs
+             * no more than a split run */
+            pxPage = prvAllocRun( 0 );
+
+            if( pxPage != NULL )
+            {
+                pxPage->pxFreeBlocks = NULL;
+                pxPage->usUsed = 0;
+                pxPage->usCarved = 0;
+                pxPage->ucState = ( uint8_t ) uxClass;
+                prvListInsert( &pxClassPages[ uxClass ], pxPage );
+            }
+        }
+
+        if( pxPage != NULL )
+        {
+            if( pxPage->pxFreeBlocks != NULL )
+            {
+                pxBlock = pxPage->pxFreeBlocks;
+                pxPage->pxFreeBlocks = pxBlock->pxNext;
+            }
+            else
+            {
+                pxBlock = ( SlabFreeBlock_t * ) ( ucHeap +
+                                                  ( ( size_t ) ( pxPage - xPages ) << slabPAGE_SHIFT ) +
+                                                  ( ( size_t ) pxPage->usCarved * xBlockSize ) );
+                pxPage->usCarved++;
+            }
+
+            pxPage->usUsed++;
+
+            if( pxPage->usUsed == usBlocks )
+            {
+                prvListRemove( &pxClassPages[ uxClass ], pxPage );
+            }
+
+            prvAccountAlloc( xBlockSize );
+        }
+    }
+    slabUNLOCK();
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeBlock( SlabPage_t * pxPage,
+                          void * pv )
+{
+UBaseType_t uxClass = pxPage->ucState;
+size_t xBlockSize = ( size_t ) 1 << ( uxClass + slabMIN_SHIFT );
+uint16_t usBlocks = ( uint16_t ) ( slabPAGE_SIZE / xBlockSize );
+
+    slabLOCK();
+    {
+        ( ( SlabFreeBlock_t * ) pv )->pxNext = pxPage->pxFreeBlocks;
+        pxPage->pxFreeBlocks = ( SlabFreeBlock_t * ) pv;
+
+        if( pxPage->usUsed == usBlocks )
+        {
+            prvListInsert( &pxClassPages[ uxClass ], pxPage );
+        }
+
+        pxPage->usUsed--;
+
+        if( pxPage->usUsed == 0 )
+        {
+            prvListRemove( &pxClassPages[ uxClass ], pxPage );
+            prvFreeRun( pxPage );
+        }
+
+        xFreeBytesRemaining += xBlockSize;
+        xNumberOfSuccessfulFrees++;
+    }
+    slabUNLOCK();
+}
+/*-----------------------------------------------------------*/
+
+static void * prvAllocLarge( size_t xAlignment,
+                             size_t xWantedSize )
+{
+void * pvReturn;
+
+    vTaskSuspendAll();
+    {
+        pvReturn = aligned_alloc( xAlignment, ( xWantedSize + xAlignment - 1U ) & ~( xAlignment - 1U ) );
+    }
+    ( void ) xTaskResumeAll();
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortAlignedAlloc( size_t xAlignemnt,
+                           size_t xWantedSize )
+{
+void * pvReturn = NULL;
+SlabPage_t * pxPage;
+UBaseType_t uxShift = slabMIN_SHIFT;
+size_t xSize;
+
+    xSize = ( xWantedSize > xAlignemnt ) ? xWantedSize : xAlignemnt;
+
+    if( ( xWantedSize != 0U ) && ( ( xAlignemnt & ( xAlignemnt - 1U ) ) == 0U ) )
+    {
+        if( ( xSize > configSLAB_MAX_RUN_SIZE ) || ( xAlignemnt > slabPAGE_SIZE ) )
+        {
+            pvReturn = prvAllocLarge( xAlignemnt, xWantedSize );
+        }
+        else
+        {
+            while( ( ( size_t ) 1 << uxShift ) < xSize )
+            {
+                uxShift++;
+            }
+
+            if( uxShift < slabPAGE_SHIFT )
+            {
+                pvReturn = prvAllocBlock( uxShift - slabMIN_SHIFT );
+            }
+            else
+            {
+                pxPage = prvAllocRun( uxShift - slabPAGE_SHIFT );
+
+                if( pxPage != NULL )
+                {
+                    slabLOCK();
+                    {
+                        prvAccountAlloc( ( size_t ) 1 << uxShift );
+                    }
+                    slabUNLOCK();
+                    pvReturn = ucHeap + ( ( size_t ) ( pxPage - xPages ) << slabPAGE_SHIFT );
+                }
+            }
+        }
+    }
+
+    traceMALLOC( pvReturn, xWantedSize );
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if( pvReturn == NULL )
+        {
+            vApplicationMallocFailedHook();
+        }
+    }
+    #endif
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    return pvPortAlignedAlloc( portBYTE_ALIGNMENT, xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+SlabPage_t * pxPage;
+
+    if( pv == NULL )
+    {
+        return;
+    }
+
+    if( ( ( uint8_t * ) pv < ucHeap ) || ( ( uint8_t * ) pv >= ( ucHeap + sizeof( ucHeap ) ) ) )
+    {
+        vTaskSuspendAll();
+        {
+            free( pv );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    else
+    {
+        pxPage = &xPages[ ( size_t ) ( ( uint8_t * ) pv - ucHeap ) >> slabPAGE_SHIFT ];
+
+        if( pxPage->ucState < slabNUM_CLASSES )
+        {
+            prvFreeBlock( pxPage, pv );
+        }
+        else
+        {
+            configASSERT( pxPage->ucState == slabPAGE_RUN );
+
+            slabLOCK();
+            {
+                xFreeBytesRemaining += slabPAGE_SIZE << pxPage->ucOrder;
+                xNumberOfSuccessfulFrees++;
+            }
+            slabUNLOCK();
+            prvFreeRun( pxPage );
+        }
+    }
+
+    traceFREE( pv, 0 );
+}
+/*-----------------------------------------------------------*/
+
+/* Both heaps are reported, the pool and what newlib has left for the large
+ * blocks. The minimum is the sum of the minimum of each. */
+size_t xPortGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining + get_remaining_heap_size();
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining + get_smallest_ever_remaining_heap_size();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+    /* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+size_t xBlocks = 0;
+size_t xMaxSize = 0;
+size_t xMinSize = 0;
+SlabPage_t * pxPage;
+UBaseType_t uxOrder;
+
+    slabLOCK();
+    {
+        if( xHeapInitialised == pdFALSE )
+        {
+            prvHeapInit();
+        }
+
+        for( uxOrder = 0; uxOrder < slabMAX_ORDERS; uxOrder++ )
+        {
+            for( pxPage = pxFreeRuns[ uxOrder ]; pxPage != NULL; pxPage = pxPage->pxNext )
+            {
+                xBlocks++;
+            }
+
+            if( pxFreeRuns[ uxOrder ] != NULL )
+            {
+                xMaxSize = slabPAGE_SIZE << uxOrder;
+
+                if( xMinSize == 0U )
+                {
+                    xMinSize = xMaxSize;
+                }
+            }
+        }
+
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+        pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+        pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+    }
+    slabUNLOCK();
+}
+/*-----------------------------------------------------------*/
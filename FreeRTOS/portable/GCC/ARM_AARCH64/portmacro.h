@@ -207,4 +207,24 @@ number of bits implemented by the interrupt controller. */
 extern void vPortSocfpgaTimerInit( void );
 extern void interrupt_irq_handler( unsigned int ulInterruptID );
 BaseType_t xPortIsInsideInterrupt( void );
+
+/* Usage of the coherent (uncached) memory heap */
+typedef struct xCoherentHeapStats
+{
+    size_t xCoherentBytes;                 /* Uncached memory taken from the heap. */
+    size_t xAllocatedBytes;                /* Memory in use, rounded up to the size classes. */
+    size_t xMaxAllocatedBytes;             /* The highest value of xAllocatedBytes. */
+    size_t xNumberOfGranules;              /* Number of 2 MB granules taken from the heap. */
+    size_t xNumberOfSuccessfulAllocations; /* Number of allocations that returned memory. */
+    size_t xNumberOfSuccessfulFrees;       /* Number of blocks freed. */
+} CoherentHeapStats_t;
+
+/* Allocation of uncached memory shared with DMA masters. Blocks are aligned
+ * to their size rounded up to a power of two, 2 MB at most. The functions
+ * must be called from a task. */
+void * pvPortMallocCoherent( size_t xWantedSize );
+void * pvPortMallocCoherentAligned( size_t xAlignment,
+                                    size_t xWantedSize );
+void vPortFreeCoherent( void * pv );
+void vPortGetCoherentHeapStats( CoherentHeapStats_t * pxHeapStats );
 #endif /* PORTMACRO_H */
@@ -11,6 +11,21 @@
 #define __SOCFPGA_CACHE_H__
 #include <stddef.h>
 
+/*
+ * The range functions work by VA on the lines overlapping the region, to
+ * the point of coherency, whatever its size. This reaches the caches of
+ * every core and the shared L3. The functions wait for the maintenance to
+ * complete before returning. The _nosync variants do not, several ranges
+ * can then be issued back to back and waited for with a single
+ * cache_sync().
+ *
+ * cache_write_back_all() and cache_flush_all() work on the whole data cache
+ * of the calling core by set/way instead. They are cheaper for very large
+ * buffers but are not coherency maintenance: the other cores and the shared
+ * L3 are not reached, and unrelated dirty data is cleaned too. Use them only
+ * where maintaining the local core alone is known to be enough.
+ */
+
 /**
  * @brief Force write-back of a specified cache region to main memory.
  *
@@ -49,4 +64,48 @@ void cache_force_invalidate(void *addr, size_t sz);
  */
 void cache_flush(void *addr, size_t sz);
 
+/**
+ * @brief Write back a region without waiting for completion.
+ *
+ * @param[in] addr Starting address of the memory region.
+ * @param[in] sz Size of the memory region, in bytes.
+ */
+void cache_force_write_back_nosync(void *addr, size_t sz);
+
+/**
+ * @brief Invalidate a region without waiting for completion.
+ *
+ * @param[in] addr Starting address of the memory region.
+ * @param[in] sz Size of the memory region, in bytes.
+ */
+void cache_force_invalidate_nosync(void *addr, size_t sz);
+
+/**
+ * @brief Flush a region without waiting for completion.
+ *
+ * @param[in] addr Starting address of the memory region.
+ * @param[in] sz Size of the memory region, in bytes.
+ */
+void cache_flush_nosync(void *addr, size_t sz);
+
+/**
+ * @brief Wait for the maintenance issued by the _nosync functions.
+ */
+void cache_sync(void);
+
+/**
+ * @brief Write back the whole data cache of the calling core by set/way.
+ *
+ * Local to the calling core, see the note at the top of this file.
+ */
+void cache_write_back_all(void);
+
+/**
+ * @brief Write back and invalidate the whole data cache of the calling core
+ * by set/way.
+ *
+ * Local to the calling core, see the note at the top of this file.
+ */
+void cache_flush_all(void);
+
 #endif
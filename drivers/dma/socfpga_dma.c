@@ -20,9 +20,27 @@
 #define MAX_CHANNEL_NUM               (4U)
 #define MAX_LLI_PER_CHANNEL           10U
 #define CH_SUSPEND_TIMEOUT_COUNT      (1000U)
+#define CH_STOP_POLL_COUNT            (100U)
+/* Periods of a cyclic transfer are made of whole cache lines */
+#define DMA_CACHE_LINE_SIZE           64U
 /* Max block size available is 32767 */
 #define MAX_BLOCK_SIZE    0x7FFFU
 
+/* Interrupts that end the transfer of a queued job with an error */
+#define DMA_QUEUE_ERR_MASK    (DMA_CH_INTSTATUS_LLI_WR_SLV_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_LLI_RD_SLV_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_LLI_WR_DEC_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_LLI_RD_DEC_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_DST_SLV_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_SRC_SLV_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_DST_DEC_ERR_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_SRC_DEC_ERR_INTSTAT_MASK)
+
+/* Interrupts used by the job queue and cyclic transfers */
+#define DMA_QUEUE_INT_MASK    (DMA_CH_INTSTATUS_BLOCK_TFR_DONE_INTSTAT_MASK | \
+            DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK | \
+            DMA_QUEUE_ERR_MASK)
+
 /* DMA channel registers */
 struct dma_channel_reg_list
 {
@@ -75,6 +93,38 @@ struct dma_ch_cntxt
     uint64_t interrupt_en;
     /* Callback function for interrupts */
     dma_callback_t xp_dma_callback;
+    /* Channel runs the job queue */
+    BaseType_t queue_active;
+    /* Ring of DMA_QUEUE_MAX_BLOCKS descriptors for the job queue */
+    struct dma_channel_reg_list *queue_lli;
+    /* Descriptor terminating the chain, the next job starts here */
+    uint32_t lli_head;
+    /* Descriptors used by queued jobs */
+    uint32_t lli_used;
+    /* Queued jobs, completed from job_tail */
+    struct dma_queued_job
+    {
+        dma_job_callback_t callback;
+        void *cb_data;
+        uint32_t last_lli;
+        uint32_t num_lli;
+    } jobs[DMA_MAX_QUEUED_JOBS];
+    uint32_t job_tail;
+    uint32_t job_count;
+    /* Channel runs a cyclic transfer over the job queue ring */
+    BaseType_t cyclic_active;
+    /* Control word of the cyclic descriptors, without valid and IOC bits */
+    uint64_t cyclic_ctl;
+    uint64_t cyclic_buf;
+    uint32_t cyclic_period_len;
+    uint32_t cyclic_num_periods;
+    uint32_t cyclic_lli_per_period;
+    uint32_t cyclic_num_lli;
+    /* Next descriptor expected to complete */
+    uint32_t cyclic_next_lli;
+    dma_period_callback_t cyclic_callback;
+    void *cyclic_cb_data;
+    dma_cyclic_status_t cyclic_status;
 };
 
 static struct dma_ch_cntxt hdma_default[DMA_MAX_INSTANCE][MAX_CHANNEL_NUM];
@@ -83,6 +133,10 @@ static struct dma_ch_cntxt hdma_default[DMA_MAX_INSTANCE][MAX_CHANNEL_NUM];
 static struct dma_channel_reg_list plinked_list_chain[DMA_MAX_INSTANCE]
 [MAX_CHANNEL_NUM * MAX_LLI_PER_CHANNEL] __attribute__ ((aligned (64)));
 
+/* Descriptor rings of the job queues */
+static struct dma_channel_reg_list pqueue_lli_ring[DMA_MAX_INSTANCE]
+[MAX_CHANNEL_NUM * DMA_QUEUE_MAX_BLOCKS] __attribute__ ((aligned (64)));
+
 void pdma_irq_handler(void *data);
 
 /*
@@ -111,6 +165,36 @@ static dma_ch_state_t dma_get_channel_status(dma_handle_t hdma)
     }
     return ret;
 }
+
+/*
+ * @brief Make descriptor writes visible to the DMAC before going on
+ */
+static inline void dma_sync_lli(struct dma_channel_reg_list *plli)
+{
+    cache_force_write_back((void *)plli, sizeof(*plli));
+    __asm__ volatile ("dsb sy" ::: "memory");
+}
+
+/*
+ * @brief Link the job queue descriptors into a ring, all of them invalid
+ */
+static void dma_queue_init_ring(dma_handle_t hdma)
+{
+    uint32_t i;
+
+    for (i = 0U; i < DMA_QUEUE_MAX_BLOCKS; i++)
+    {
+        hdma->queue_lli[i].ctl = 0UL;
+        hdma->queue_lli[i].llp = (uint64_t)(uintptr_t)&hdma->queue_lli[(i + 1U) %
+                DMA_QUEUE_MAX_BLOCKS];
+    }
+    cache_force_write_back((void *)hdma->queue_lli,
+            DMA_QUEUE_MAX_BLOCKS * sizeof(hdma->queue_lli[0U]));
+    __asm__ volatile ("dsb sy" ::: "memory");
+    hdma->lli_head = 0U;
+    hdma->lli_used = 0U;
+}
+
 dma_handle_t dma_open(uint32_t instance, uint32_t ch)
 {
     int32_t status;
@@ -156,6 +240,8 @@ dma_handle_t dma_open(uint32_t instance, uint32_t ch)
     phandle->channel_num = ch;
     phandle->linked_list_base = &plinked_list_chain[instance][(ch *
                     MAX_LLI_PER_CHANNEL)];
+    phandle->queue_lli = &pqueue_lli_ring[instance][(ch * DMA_QUEUE_MAX_BLOCKS)];
+    dma_queue_init_ring(phandle);
     phandle->is_open = 1;
     /*Setup and enable interrupts in GIC*/
     int_ret = interrupt_register_isr(phandle->intr_id, pdma_irq_handler, phandle);
@@ -190,6 +276,43 @@ static void dma_get_burst_len(dma_handle_t const hdma, dma_burst_len_t *src_burs
     }
 }
 
+/**
+ * @brief Get the control word of the descriptors of a transfer
+ */
+static uint64_t dma_get_block_ctl(dma_handle_t const hdma,
+        dma_xfer_width_t src_width, dma_xfer_width_t dst_width, uint32_t flags)
+{
+    uint64_t ctl;
+    dma_burst_len_t src_burst_len, dst_burst_len;
+
+    dma_get_burst_len(hdma, &src_burst_len, &dst_burst_len);
+    if ((flags & DMA_XFER_PERI_SINGLE) != 0U)
+    {
+        if (hdma->direction == DMA_PERI_TO_MEM_DMAC)
+        {
+            src_burst_len = DMA_BURST_LEN_1;
+        }
+        if (hdma->direction == DMA_MEM_TO_PERI_DMAC)
+        {
+            dst_burst_len = DMA_BURST_LEN_1;
+        }
+    }
+    ctl = (((uint64_t)src_width << DMA_CH_CTL_SRC_TR_WIDTH_POS) |
+            ((uint64_t)dst_width << DMA_CH_CTL_DST_TR_WIDTH_POS));
+    ctl |= (((uint64_t)src_burst_len << DMA_CH_CTL_SRC_MSIZE_POS) |
+            ((uint64_t)dst_burst_len << DMA_CH_CTL_DST_MSIZE_POS));
+    ctl |= (DMA_CH_CTL_DST_STAT_EN_MASK | DMA_CH_CTL_SRC_STAT_EN_MASK);
+    if ((flags & DMA_XFER_SRC_FIXED) != 0U)
+    {
+        ctl |= DMA_CH_CTL_SINC_MASK;
+    }
+    if ((flags & DMA_XFER_DST_FIXED) != 0U)
+    {
+        ctl |= DMA_CH_CTL_DINC_MASK;
+    }
+    return ctl;
+}
+
 int32_t dma_config(dma_handle_t const hdma, dma_config_t *pcfg)
 {
 
@@ -205,7 +328,8 @@ int32_t dma_config(dma_handle_t const hdma, dma_config_t *pcfg)
     }
     if (hdma->channel_state != DMA_CH_IDLE)
     {
-        ERROR("DMAC Channel is in active state");
+        /* Expected while a job queue drains, the DMA engine retries */
+        DEBUG("DMAC Channel is in active state");
         return -EBUSY;
     }
 
@@ -214,6 +338,8 @@ int32_t dma_config(dma_handle_t const hdma, dma_config_t *pcfg)
 
     hdma->direction = pcfg->ch_dir;
     hdma->config |= ((uint64_t)(pcfg->ch_dir) << DMA_CH_CFG2_TT_FC_POS);
+    hdma->config |= (((uint64_t)pcfg->ch_prio << DMA_CH_CFG2_CH_PRIOR_POS) &
+            DMA_CH_CFG2_CH_PRIOR_MASK);
     if (pcfg->ch_dir == DMA_MEM_TO_PERI_DMAC)
     {
         hdma->config |= ((uint64_t)pcfg->peri_id << DMA_CH_CFG2_DST_PER_POS);
@@ -242,7 +368,6 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
     uint64_t val;
     uint64_t transfer_size;
     uint32_t i;
-    dma_burst_len_t src_burst_len, dst_burst_len;
     struct dma_channel_reg_list *plinked_list;
     dma_xfer_cfg_t *ptransfer_cfg;
     if (hdma == NULL)
@@ -270,8 +395,8 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
         ERROR("DMAC Channel is in active state ");
         return -EBUSY;
     }
-    (void)memset(hdma->linked_list_base, 0, (sizeof(struct
-            dma_channel_reg_list) * MAX_LLI_PER_CHANNEL));
+    /* Only the descriptors of this transfer are written, the last one ends
+     * the chain */
     plinked_list = hdma->linked_list_base;
     if (plinked_list == NULL)
     {
@@ -287,14 +412,8 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
 
     for (i = 0U; i < num_xfers; i++)
     {
-        dma_get_burst_len(hdma, &src_burst_len, &dst_burst_len);
-        transfer_size = (((uint64_t)src_width << DMA_CH_CTL_SRC_TR_WIDTH_POS) |
-                ((uint64_t)dst_width << DMA_CH_CTL_DST_TR_WIDTH_POS));
-        transfer_size |=
-                (((uint64_t)src_burst_len <<
-                DMA_CH_CTL_SRC_MSIZE_POS) | ((uint64_t)dst_burst_len << DMA_CH_CTL_DST_MSIZE_POS));
-        transfer_size |= ((DMA_CH_CTL_DST_STAT_EN_MASK |
-                DMA_CH_CTL_SRC_STAT_EN_MASK) | DMA_CH_CTL_IOC_BLKTFR_MASK);
+        transfer_size = dma_get_block_ctl(hdma, src_width, dst_width, 0U) |
+                DMA_CH_CTL_IOC_BLKTFR_MASK;
 
         if (((1UL << (uint64_t)src_width) == 0U) || (ptransfer_cfg == NULL))
         {
@@ -302,6 +421,7 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
             return -EFAULT;
         }
 
+        (void)memset(plinked_list, 0, sizeof(*plinked_list));
         plinked_list->sar = ptransfer_cfg->src;
         plinked_list->dar = ptransfer_cfg->dst;
         plinked_list->ctl = transfer_size;
@@ -333,7 +453,7 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
     }
 
     cache_force_write_back((void *)hdma->linked_list_base,
-            ((MAX_LLI_PER_CHANNEL)*sizeof(plinked_list[0U])));
+            (num_xfers * sizeof(plinked_list[0U])));
 
     hdma->interrupt_en = TFR_DONE_MASK;
     val = RD_REG64(hdma->base_address + DMA_DMAC_CFGREG);
@@ -391,6 +511,594 @@ int32_t dma_start_transfer(dma_handle_t const hdma)
     hdma->channel_state = DMA_CH_ACTIVE;
     return 0;
 }
+/*
+ * @brief Complete all queued jobs with the given status and reset the queue
+ *
+ * The channel must be disabled.
+ */
+static void dma_queue_flush(dma_handle_t hdma, int32_t status)
+{
+    struct dma_queued_job *pjob;
+
+    hdma->queue_active = pdFALSE;
+    while (hdma->job_count > 0U)
+    {
+        pjob = &hdma->jobs[hdma->job_tail];
+        hdma->job_tail = (hdma->job_tail + 1U) % DMA_MAX_QUEUED_JOBS;
+        hdma->job_count--;
+        if (pjob->callback != NULL)
+        {
+            pjob->callback(hdma, pjob->cb_data, status);
+        }
+    }
+    dma_queue_init_ring(hdma);
+}
+
+/*
+ * @brief Wait for the channel to leave the wait of a drained queue
+ *
+ * @return 0 once the channel is disabled, -EBUSY if it is still enabled
+ */
+static int32_t dma_queue_wait_disabled(dma_handle_t hdma)
+{
+    uint64_t ch_en = (1UL << (hdma->channel_num + CHENREG_CH_EN_POS));
+    uint32_t wait_count;
+
+    for (wait_count = 0U; wait_count < CH_STOP_POLL_COUNT; wait_count++)
+    {
+        if ((RD_REG64(hdma->base_address + DMA_DMAC_CHENREG) & ch_en) == 0UL)
+        {
+            return 0;
+        }
+    }
+    return -EBUSY;
+}
+
+/*
+ * @brief Start the channel on the first descriptor of the job queue
+ *
+ * The channel must be disabled, see dma_queue_wait_disabled().
+ */
+static void dma_queue_start(dma_handle_t hdma, uint32_t first_lli)
+{
+    uint64_t val;
+
+    hdma->interrupt_en = DMA_QUEUE_INT_MASK;
+    val = RD_REG64(hdma->base_address + DMA_DMAC_CFGREG);
+    val |= (DMA_DMAC_CFGREG_INT_EN_MASK | DMA_DMAC_CFGREG_DMAC_EN_MASK);
+    WR_REG64(hdma->base_address + DMA_DMAC_CFGREG, val);
+    WR_REG64((hdma->ch_offset + DMA_CH_CFG2), hdma->config);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTCLEARREG, DMA_QUEUE_INT_MASK);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTSTATUS_ENABLEREG, hdma->interrupt_en);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTSIGNAL_ENABLEREG, hdma->interrupt_en);
+    WR_REG64(hdma->ch_offset + DMA_CH_LLP,
+            ((uint64_t)(uintptr_t)&hdma->queue_lli[first_lli]));
+
+    val = RD_REG64(hdma->base_address + DMA_DMAC_CHENREG);
+    val |= (1UL << (hdma->channel_num + CHENREG_CH_EN_POS));
+    val |= (1UL << (hdma->channel_num + CHENREG_CH_EN_WE_POS));
+    WR_REG64(hdma->base_address + DMA_DMAC_CHENREG, val);
+
+    hdma->queue_active = pdTRUE;
+    hdma->channel_state = DMA_CH_ACTIVE;
+}
+
+int32_t dma_submit_job(dma_handle_t const hdma, const dma_job_t *job)
+{
+    uint64_t ctl;
+    uint64_t block_ts;
+    uint32_t i;
+    uint32_t first;
+    uint32_t idx;
+    dma_xfer_cfg_t *ptransfer_cfg;
+    struct dma_channel_reg_list *plli;
+    struct dma_queued_job *pjob;
+    UBaseType_t int_mask;
+
+    if ((hdma == NULL) || (job == NULL))
+    {
+        ERROR("DMAC handle and job cannot be NULL ");
+        return -EINVAL;
+    }
+    if ((job->num_xfers == 0U) || (job->num_xfers >= DMA_QUEUE_MAX_BLOCKS))
+    {
+        ERROR("Number of transfers must be between 1 and %d", DMA_QUEUE_MAX_BLOCKS - 1U);
+        return -EINVAL;
+    }
+    if (hdma->is_open != 1)
+    {
+        ERROR("DMAC channel should be opened before submitting a job \n");
+        return -EIO;
+    }
+
+    /* Check the blocks before anything is written to the ring */
+    ptransfer_cfg = job->xfer_list;
+    for (i = 0U; i < job->num_xfers; i++)
+    {
+        if (ptransfer_cfg == NULL)
+        {
+            ERROR("Transfer list shorter than the number of transfers");
+            return -EFAULT;
+        }
+        block_ts = ((uint64_t)ptransfer_cfg->blk_size >> (uint64_t)job->src_width);
+        if ((block_ts == 0UL) || ((block_ts - 1UL) > MAX_BLOCK_SIZE))
+        {
+            ERROR("Transfer block size out of range");
+            return -EINVAL;
+        }
+        ptransfer_cfg = ptransfer_cfg->next_trnsfr_cfg;
+    }
+    ctl = dma_get_block_ctl(hdma, job->src_width, job->dst_width,
+            job->flags);
+
+    /* Masks the DMA interrupt, also when called from a job callback */
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if ((hdma->channel_state != DMA_CH_IDLE) && (hdma->queue_active == pdFALSE))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        DEBUG("DMAC Channel is in active state ");
+        return -EBUSY;
+    }
+    if (hdma->cyclic_active == pdTRUE)
+    {
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        ERROR("DMAC Channel runs a cyclic transfer ");
+        return -EBUSY;
+    }
+    if ((hdma->job_count == DMA_MAX_QUEUED_JOBS) ||
+            ((hdma->lli_used + job->num_xfers) >= DMA_QUEUE_MAX_BLOCKS))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        return -EBUSY;
+    }
+
+    /* A channel released by a drained queue may not have stopped yet, it is
+     * left alone and the job is not queued */
+    if ((hdma->queue_active == pdFALSE) && (dma_queue_wait_disabled(hdma) != 0))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        DEBUG("DMAC channel %d still enabled", hdma->channel_num);
+        return -EBUSY;
+    }
+
+    /* Terminate the chain after the new job first, then fill in the job.
+     * Its first descriptor is the old terminator the DMAC may be waiting
+     * on, it is made valid last. */
+    first = hdma->lli_head;
+    idx = (first + job->num_xfers) % DMA_QUEUE_MAX_BLOCKS;
+    hdma->queue_lli[idx].ctl = 0UL;
+    dma_sync_lli(&hdma->queue_lli[idx]);
+
+    ptransfer_cfg = job->xfer_list;
+    idx = first;
+    for (i = 0U; i < job->num_xfers; i++)
+    {
+        plli = &hdma->queue_lli[idx];
+        plli->sar = ptransfer_cfg->src;
+        plli->dar = ptransfer_cfg->dst;
+        plli->block_ts = ((uint64_t)ptransfer_cfg->blk_size >>
+                (uint64_t)job->src_width) - 1UL;
+        plli->chn_src_stat = 0U;
+        plli->chn_dst_stat = 0U;
+        plli->chn_llp_status = 0UL;
+        plli->ctl = ctl;
+        if (i == (job->num_xfers - 1U))
+        {
+            /* Interrupt when the job is done */
+            plli->ctl |= DMA_CH_CTL_IOC_BLKTFR_MASK;
+        }
+        if (i != 0U)
+        {
+            plli->ctl |= DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK;
+        }
+        dma_sync_lli(plli);
+        idx = (idx + 1U) % DMA_QUEUE_MAX_BLOCKS;
+        ptransfer_cfg = ptransfer_cfg->next_trnsfr_cfg;
+    }
+    hdma->queue_lli[first].ctl |= DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK;
+    dma_sync_lli(&hdma->queue_lli[first]);
+
+    pjob = &hdma->jobs[(hdma->job_tail + hdma->job_count) % DMA_MAX_QUEUED_JOBS];
+    pjob->callback = job->callback;
+    pjob->cb_data = job->cb_data;
+    pjob->num_lli = job->num_xfers;
+    pjob->last_lli = (first + job->num_xfers - 1U) % DMA_QUEUE_MAX_BLOCKS;
+    hdma->job_count++;
+    hdma->lli_used += job->num_xfers;
+    hdma->lli_head = (first + job->num_xfers) % DMA_QUEUE_MAX_BLOCKS;
+
+    if (hdma->queue_active == pdFALSE)
+    {
+        dma_queue_start(hdma, first);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return 0;
+}
+
+uint32_t dma_get_queued_jobs(dma_handle_t const hdma)
+{
+    if (hdma == NULL)
+    {
+        return 0U;
+    }
+    return hdma->job_count;
+}
+
+/*
+ * @brief Job queue part of the DMA interrupt handler
+ */
+static void dma_queue_irq(dma_handle_t phandle, uint64_t status)
+{
+    uint64_t val;
+    struct dma_queued_job *pjob;
+    struct dma_channel_reg_list *plli;
+    BaseType_t all_done = pdFALSE;
+    uint32_t num_pending;
+
+    WR_REG64((phandle->ch_offset + DMA_CH_INTCLEARREG), status);
+
+    if ((status & DMA_QUEUE_ERR_MASK) != 0UL)
+    {
+        ERROR("DMA channel %d transfer error 0x%llx", phandle->channel_num,
+                (unsigned long long)status);
+        val = RD_REG64(phandle->base_address + DMA_DMAC_CHENREG);
+        val &= ~(1UL << (phandle->channel_num + CHENREG_CH_EN_POS));
+        val |= (1UL << (phandle->channel_num + CHENREG_CH_EN_WE_POS));
+        WR_REG64(phandle->base_address + DMA_DMAC_CHENREG, val);
+        phandle->channel_state = DMA_CH_IDLE;
+        dma_queue_flush(phandle, -EIO);
+        return;
+    }
+
+    if ((status & DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK) != 0UL)
+    {
+        /* Waiting on the terminator means every queued block is done */
+        val = RD_REG64(phandle->ch_offset + DMA_CH_LLP);
+        if (val == (uint64_t)(uintptr_t)&phandle->queue_lli[phandle->lli_head])
+        {
+            all_done = pdTRUE;
+        }
+    }
+
+    /* The DMAC clears the valid bit of a descriptor when it writes back its
+     * status, so a job is done once its last descriptor is written back.
+     * Only the jobs queued before this interrupt are looked at, a job a
+     * callback queues has not run yet even when all_done is set. */
+    num_pending = phandle->job_count;
+    while (num_pending > 0U)
+    {
+        pjob = &phandle->jobs[phandle->job_tail];
+        if (all_done == pdFALSE)
+        {
+            plli = &phandle->queue_lli[pjob->last_lli];
+            cache_force_invalidate((void *)plli, sizeof(*plli));
+            if ((plli->ctl & DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK) != 0UL)
+            {
+                break;
+            }
+        }
+        phandle->job_tail = (phandle->job_tail + 1U) % DMA_MAX_QUEUED_JOBS;
+        phandle->job_count--;
+        phandle->lli_used -= pjob->num_lli;
+        num_pending--;
+        if (pjob->callback != NULL)
+        {
+            pjob->callback(phandle, pjob->cb_data, 0);
+        }
+    }
+
+    if ((status & DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK) != 0UL)
+    {
+        if ((all_done == pdFALSE) || (phandle->job_count > 0U))
+        {
+            /* The descriptor was read while a job was being appended, or a
+             * callback queued another job. The DMAC waits on the old
+             * terminator, which is the first descriptor of the new job and
+             * valid now, so the chain goes on from there. */
+            WR_REG64(phandle->ch_offset + DMA_CH_BLK_TFR_RESUMEREQREG,
+                    DMA_CH_BLK_TFR_RESUMEREQREG_BLK_TFR_RESUMEREQ_MASK);
+        }
+        else
+        {
+            /* Queue drained, release the channel so it can be configured
+             * again. The next job restarts it. */
+            val = RD_REG64(phandle->base_address + DMA_DMAC_CHENREG);
+            val &= ~(1UL << (phandle->channel_num + CHENREG_CH_EN_POS));
+            val |= (1UL << (phandle->channel_num + CHENREG_CH_EN_WE_POS));
+            WR_REG64(phandle->base_address + DMA_DMAC_CHENREG, val);
+
+            /* A job queued from the callback below needs the channel
+             * stopped, nothing else would retry it */
+            if (dma_queue_wait_disabled(phandle) != 0)
+            {
+                WARN("DMA channel %d did not stop", phandle->channel_num);
+            }
+            phandle->queue_active = pdFALSE;
+            phandle->channel_state = DMA_CH_IDLE;
+            if (phandle->xp_dma_callback != NULL)
+            {
+                phandle->xp_dma_callback(phandle);
+            }
+        }
+    }
+}
+
+/*
+ * @brief Control word of a cyclic descriptor, the last descriptor of a
+ * period raises the interrupt
+ */
+static inline uint64_t dma_cyclic_lli_ctl(dma_handle_t hdma, uint32_t idx)
+{
+    uint64_t ctl = hdma->cyclic_ctl | DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK;
+
+    if (((idx + 1U) % hdma->cyclic_lli_per_period) == 0U)
+    {
+        ctl |= DMA_CH_CTL_IOC_BLKTFR_MASK;
+    }
+    return ctl;
+}
+
+int32_t dma_setup_cyclic(dma_handle_t const hdma, const dma_cyclic_cfg_t *pcfg)
+{
+    uint64_t val;
+    uint64_t mem;
+    uint32_t max_blk;
+    uint32_t num_periods;
+    uint32_t lli_per_period;
+    uint32_t period;
+    uint32_t offset;
+    uint32_t blk;
+    uint32_t idx;
+    uint32_t flags;
+    struct dma_channel_reg_list *plli;
+
+    if ((hdma == NULL) || (pcfg == NULL))
+    {
+        ERROR("DMAC handle and cyclic configuration cannot be NULL ");
+        return -EINVAL;
+    }
+    if (hdma->is_open != 1)
+    {
+        ERROR("DMAC channel should be opened before setup transfer \n");
+        return -EIO;
+    }
+    if ((hdma->channel_state != DMA_CH_IDLE) || (hdma->job_count > 0U))
+    {
+        ERROR("DMAC Channel is in active state ");
+        return -EBUSY;
+    }
+    if ((hdma->direction != DMA_MEM_TO_PERI_DMAC) &&
+            (hdma->direction != DMA_PERI_TO_MEM_DMAC))
+    {
+        ERROR("Cyclic transfers need a peripheral channel");
+        return -EINVAL;
+    }
+    if ((pcfg->src_width > DMA_ID_XFER_WIDTH_MAX) ||
+            (pcfg->dst_width > DMA_ID_XFER_WIDTH_MAX) ||
+            (pcfg->period_len == 0U) ||
+            ((pcfg->period_len % DMA_CACHE_LINE_SIZE) != 0U) ||
+            ((pcfg->buf % DMA_CACHE_LINE_SIZE) != 0UL) ||
+            ((pcfg->buf_len % pcfg->period_len) != 0U))
+    {
+        ERROR("Cyclic buffer and period must be made of whole cache lines");
+        return -EINVAL;
+    }
+
+    max_blk = (MAX_BLOCK_SIZE + 1U) << (uint32_t)pcfg->src_width;
+    num_periods = pcfg->buf_len / pcfg->period_len;
+    lli_per_period = (pcfg->period_len + max_blk - 1U) / max_blk;
+    if ((num_periods < 2U) ||
+            ((num_periods * lli_per_period) > DMA_QUEUE_MAX_BLOCKS))
+    {
+        ERROR("Cyclic transfer needs 2 to %d descriptors", DMA_QUEUE_MAX_BLOCKS);
+        return -EINVAL;
+    }
+
+    /* The peripheral side keeps its address */
+    flags = (hdma->direction == DMA_PERI_TO_MEM_DMAC) ? DMA_XFER_SRC_FIXED :
+            DMA_XFER_DST_FIXED;
+    flags |= (pcfg->flags & DMA_XFER_PERI_SINGLE);
+    hdma->cyclic_ctl = dma_get_block_ctl(hdma, pcfg->src_width,
+            pcfg->dst_width, flags);
+    hdma->cyclic_buf = pcfg->buf;
+    hdma->cyclic_period_len = pcfg->period_len;
+    hdma->cyclic_num_periods = num_periods;
+    hdma->cyclic_lli_per_period = lli_per_period;
+    hdma->cyclic_num_lli = num_periods * lli_per_period;
+    hdma->cyclic_next_lli = 0U;
+    hdma->cyclic_callback = pcfg->callback;
+    hdma->cyclic_cb_data = pcfg->cb_data;
+    (void)memset(&hdma->cyclic_status, 0, sizeof(hdma->cyclic_status));
+
+    /* One ring over the whole buffer, the last descriptor links back to
+     * the first */
+    idx = 0U;
+    for (period = 0U; period < num_periods; period++)
+    {
+        for (offset = 0U; offset < pcfg->period_len; offset += blk)
+        {
+            blk = pcfg->period_len - offset;
+            if (blk > max_blk)
+            {
+                blk = max_blk;
+            }
+            mem = pcfg->buf + ((uint64_t)period * pcfg->period_len) + offset;
+            plli = &hdma->queue_lli[idx];
+            (void)memset(plli, 0, sizeof(*plli));
+            plli->sar = (hdma->direction == DMA_PERI_TO_MEM_DMAC) ?
+                    pcfg->peri_addr : mem;
+            plli->dar = (hdma->direction == DMA_PERI_TO_MEM_DMAC) ?
+                    mem : pcfg->peri_addr;
+            plli->block_ts = ((uint64_t)blk >> (uint64_t)pcfg->src_width) - 1UL;
+            plli->llp = (uint64_t)(uintptr_t)&hdma->queue_lli[(idx + 1U) %
+                    hdma->cyclic_num_lli];
+            plli->ctl = dma_cyclic_lli_ctl(hdma, idx);
+            idx++;
+        }
+    }
+    cache_force_write_back((void *)hdma->queue_lli,
+            hdma->cyclic_num_lli * sizeof(hdma->queue_lli[0U]));
+    cache_flush((void *)(uintptr_t)pcfg->buf, pcfg->buf_len);
+    __asm__ volatile ("dsb sy" ::: "memory");
+
+    hdma->interrupt_en = DMA_QUEUE_INT_MASK;
+    val = RD_REG64(hdma->base_address + DMA_DMAC_CFGREG);
+    val |= (DMA_DMAC_CFGREG_INT_EN_MASK | DMA_DMAC_CFGREG_DMAC_EN_MASK);
+    WR_REG64(hdma->base_address + DMA_DMAC_CFGREG, val);
+    WR_REG64((hdma->ch_offset + DMA_CH_CFG2), hdma->config);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTCLEARREG, DMA_QUEUE_INT_MASK);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTSTATUS_ENABLEREG, hdma->interrupt_en);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTSIGNAL_ENABLEREG, hdma->interrupt_en);
+    WR_REG64(hdma->ch_offset + DMA_CH_LLP,
+            ((uint64_t)(uintptr_t)&hdma->queue_lli[0U]));
+    hdma->cyclic_active = pdTRUE;
+    return 0;
+}
+
+int32_t dma_cyclic_release(dma_handle_t const hdma, uint32_t num_periods)
+{
+    UBaseType_t int_mask;
+    int32_t ret = 0;
+
+    if (hdma == NULL)
+    {
+        ERROR("DMAC handle cannot be NULL ");
+        return -EINVAL;
+    }
+    if (hdma->cyclic_active != pdTRUE)
+    {
+        return -EIO;
+    }
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if (num_periods > hdma->cyclic_status.pending)
+    {
+        ret = -EINVAL;
+    }
+    else
+    {
+        hdma->cyclic_status.pending -= num_periods;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return ret;
+}
+
+int32_t dma_cyclic_get_status(dma_handle_t const hdma, dma_cyclic_status_t *status)
+{
+    UBaseType_t int_mask;
+    uint64_t addr;
+
+    if ((hdma == NULL) || (status == NULL))
+    {
+        ERROR("DMAC handle and status cannot be NULL ");
+        return -EINVAL;
+    }
+    if (hdma->cyclic_active != pdTRUE)
+    {
+        return -EIO;
+    }
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    *status = hdma->cyclic_status;
+    /* Current address of the memory side of the channel */
+    addr = RD_REG64(hdma->ch_offset + ((hdma->direction == DMA_PERI_TO_MEM_DMAC) ?
+            DMA_CH_DAR : DMA_CH_SAR));
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    if ((addr >= hdma->cyclic_buf) && ((addr - hdma->cyclic_buf) <
+            ((uint64_t)hdma->cyclic_num_periods * hdma->cyclic_period_len)))
+    {
+        status->position = (uint32_t)(addr - hdma->cyclic_buf);
+    }
+    else
+    {
+        /* Between two blocks, at the start of the next period */
+        status->position = (hdma->cyclic_next_lli / hdma->cyclic_lli_per_period) *
+                hdma->cyclic_period_len;
+    }
+    return 0;
+}
+
+/*
+ * @brief Cyclic transfer part of the DMA interrupt handler
+ */
+static void dma_cyclic_irq(dma_handle_t phandle, uint64_t status)
+{
+    uint64_t val;
+    uint32_t i;
+    uint32_t idx;
+    uint32_t period;
+    struct dma_channel_reg_list *plli;
+
+    WR_REG64((phandle->ch_offset + DMA_CH_INTCLEARREG), status);
+
+    if ((status & DMA_QUEUE_ERR_MASK) != 0UL)
+    {
+        ERROR("DMA channel %d cyclic transfer error 0x%llx", phandle->channel_num,
+                (unsigned long long)status);
+        val = RD_REG64(phandle->base_address + DMA_DMAC_CHENREG);
+        val &= ~(1UL << (phandle->channel_num + CHENREG_CH_EN_POS));
+        val |= (1UL << (phandle->channel_num + CHENREG_CH_EN_WE_POS));
+        WR_REG64(phandle->base_address + DMA_DMAC_CHENREG, val);
+        phandle->channel_state = DMA_CH_IDLE;
+        phandle->cyclic_active = pdFALSE;
+        dma_queue_init_ring(phandle);
+        if (phandle->cyclic_callback != NULL)
+        {
+            phandle->cyclic_callback(phandle, phandle->cyclic_cb_data,
+                    phandle->cyclic_next_lli / phandle->cyclic_lli_per_period, -EIO);
+        }
+        return;
+    }
+
+    /* A descriptor is done once the DMAC has written back its cleared valid
+     * bit. Re-arm it right away for the next lap of the ring. */
+    for (i = 0U; i < phandle->cyclic_num_lli; i++)
+    {
+        idx = phandle->cyclic_next_lli;
+        plli = &phandle->queue_lli[idx];
+        cache_force_invalidate((void *)plli, sizeof(*plli));
+        if ((plli->ctl & DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK) != 0UL)
+        {
+            break;
+        }
+        plli->ctl = dma_cyclic_lli_ctl(phandle, idx);
+        dma_sync_lli(plli);
+        phandle->cyclic_next_lli = (idx + 1U) % phandle->cyclic_num_lli;
+
+        if (((idx + 1U) % phandle->cyclic_lli_per_period) != 0U)
+        {
+            continue;
+        }
+        period = idx / phandle->cyclic_lli_per_period;
+        phandle->cyclic_status.periods_done++;
+        if (phandle->cyclic_status.pending == phandle->cyclic_num_periods)
+        {
+            phandle->cyclic_status.overruns++;
+        }
+        else
+        {
+            phandle->cyclic_status.pending++;
+        }
+        if (phandle->direction == DMA_PERI_TO_MEM_DMAC)
+        {
+            /* Drop stale lines, none of them is dirty */
+            cache_flush((void *)(uintptr_t)(phandle->cyclic_buf +
+                    ((uint64_t)period * phandle->cyclic_period_len)),
+                    phandle->cyclic_period_len);
+        }
+        if (phandle->cyclic_callback != NULL)
+        {
+            phandle->cyclic_callback(phandle, phandle->cyclic_cb_data, period, 0);
+        }
+    }
+
+    if ((status & DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK) != 0UL)
+    {
+        /* The channel caught up with a descriptor before it was re-armed */
+        phandle->cyclic_status.stalls++;
+        WR_REG64(phandle->ch_offset + DMA_CH_BLK_TFR_RESUMEREQREG,
+                DMA_CH_BLK_TFR_RESUMEREQREG_BLK_TFR_RESUMEREQ_MASK);
+    }
+}
+
 int32_t dma_stop_transfer(dma_handle_t const hdma)
 {
     uint64_t val;
@@ -401,6 +1109,13 @@ int32_t dma_stop_transfer(dma_handle_t const hdma)
         ERROR("DMAC handle cannot be NULL ");
         return -EINVAL;
     }
+    if ((hdma->channel_state == DMA_CH_IDLE) && (hdma->cyclic_active == pdTRUE))
+    {
+        /* Cyclic transfer set up but never started */
+        hdma->cyclic_active = pdFALSE;
+        dma_queue_init_ring(hdma);
+        return 0;
+    }
     if (hdma->channel_state == DMA_CH_IDLE)
     {
         ERROR("DMAC Channel not in active state ");
@@ -431,6 +1146,15 @@ int32_t dma_stop_transfer(dma_handle_t const hdma)
     }
     /* Set the channel state to idle as the transfer is stopped */
     hdma->channel_state = DMA_CH_IDLE;
+    if (hdma->queue_active == pdTRUE)
+    {
+        dma_queue_flush(hdma, -ECANCELED);
+    }
+    if (hdma->cyclic_active == pdTRUE)
+    {
+        hdma->cyclic_active = pdFALSE;
+        dma_queue_init_ring(hdma);
+    }
     return 0;
 }
 
@@ -454,6 +1178,16 @@ void pdma_irq_handler(void *data)
     uint64_t val;
     dma_handle_t phandle = (dma_handle_t)data;
     val = RD_REG64(phandle->ch_offset + DMA_CH_INTSTATUS);
+    if (phandle->cyclic_active == pdTRUE)
+    {
+        dma_cyclic_irq(phandle, val);
+        return;
+    }
+    if (phandle->queue_active == pdTRUE)
+    {
+        dma_queue_irq(phandle, val);
+        return;
+    }
     if ((val & TFR_DONE_MASK) == TFR_DONE_MASK)
     {
         WR_REG64((phandle->ch_offset + DMA_CH_INTCLEARREG), TFR_DONE_MASK);
@@ -20,7 +20,9 @@
  *
  * @details This driver provides methods to perform DMA operations.
  * The driver supports memory to memory DMA transfer and memory to
- * peripheral dma transfer. For example usage, refer to
+ * peripheral dma transfer. Transfers are either set up and started one at
+ * a time, or queued as jobs with dma_submit_job() which chains them to the
+ * transfer in progress. For example usage, refer to
  * @ref dma_sample "DMA sample application".
  * @ingroup drivers
  * @{
@@ -61,6 +63,33 @@
 #define DMA_INSTANCE0    0U /*!<DMA Instance 0*/
 #define DMA_INSTANCE1    1U /*!<DMA Instance 1*/
 
+/**
+ * @brief Maximum number of jobs queued on a channel with dma_submit_job()
+ */
+#define DMA_MAX_QUEUED_JOBS    16U
+
+/**
+ * @brief Number of blocks shared by the jobs queued on a channel. One
+ * block is kept back to terminate the chain.
+ */
+#define DMA_QUEUE_MAX_BLOCKS    64U
+
+/**
+ * @brief Job flags, the source address stays fixed for all the blocks
+ */
+#define DMA_XFER_SRC_FIXED    (1U << 0)
+
+/**
+ * @brief Job flags, the destination address stays fixed for all the blocks
+ */
+#define DMA_XFER_DST_FIXED    (1U << 1)
+
+/**
+ * @brief Job flags, the peripheral side moves one data item per request,
+ * for peripherals whose handshake does not guarantee a full burst
+ */
+#define DMA_XFER_PERI_SINGLE    (1U << 2)
+
 /**
  * @brief DMA Channel IDs
  */
@@ -95,6 +124,26 @@ typedef struct dma_ch_cntxt *dma_handle_t;
  */
 typedef void (*dma_callback_t)(dma_handle_t pdma_handle);
 
+/**
+ * Function pointer for the completion callback of a queued job. Called from
+ * the DMA interrupt with the DMA handle, the user data of the job and the
+ * job status: 0 on success, -EIO on a transfer error or -ECANCELED when the
+ * transfer was stopped before the job completed.
+ * @ingroup dma_fns
+ */
+typedef void (*dma_job_callback_t)(dma_handle_t pdma_handle, void *cb_data,
+        int32_t status);
+
+/**
+ * Function pointer for the period callback of a cyclic transfer. Called from
+ * the DMA interrupt with the DMA handle, the user data, the index of the
+ * period that completed and the status: 0 on success or -EIO on a transfer
+ * error, which stops the cyclic transfer.
+ * @ingroup dma_fns
+ */
+typedef void (*dma_period_callback_t)(dma_handle_t pdma_handle, void *cb_data,
+        uint32_t period, int32_t status);
+
 /**
  * @addtogroup dma_enums
  * @{
@@ -229,7 +278,7 @@ typedef struct dma_cfg
     dma_xfer_type_t ch_dir; /*!< DMA channel transfer direction */
     uint8_t ch_prio; /*!< DMA channel priority */
     dma_peri_id_t peri_id; /*!< Peripheral ID for the DMA channel */
-    dma_callback_t callback; /*!< Callback function for DMA interrupts */
+    dma_callback_t callback; /*!< Callback function for DMA interrupts, called when the transfer completes or the job queue drains */
 
 } dma_config_t;
 
@@ -247,6 +296,54 @@ typedef struct dma_xfer_cfg
     struct dma_xfer_cfg *next_trnsfr_cfg; /*!< Pointer to the next block transfer configuration*/
 
 } dma_xfer_cfg_t;
+
+/**
+ * @brief Job submitted to the transfer queue of a DMA channel.
+ *
+ * The blocks are copied into the channel linked list at submission, the
+ * job and its block list may be reused once dma_submit_job() returns.
+ */
+typedef struct dma_job
+{
+    dma_xfer_cfg_t *xfer_list; /*!< Blocks of the job, linked through next_trnsfr_cfg */
+    uint32_t num_xfers; /*!< Number of blocks in xfer_list */
+    dma_xfer_width_t src_width; /*!< Source transfer width */
+    dma_xfer_width_t dst_width; /*!< Destination transfer width */
+    uint32_t flags; /*!< DMA_XFER_SRC_FIXED, DMA_XFER_DST_FIXED and DMA_XFER_PERI_SINGLE, 0 for incrementing addresses */
+    dma_job_callback_t callback; /*!< Called when the job completes, may be NULL */
+    void *cb_data; /*!< User data passed to the callback */
+} dma_job_t;
+
+/**
+ * @brief Cyclic transfer configuration parameters for the DMA.
+ *
+ * The buffer is split into periods of equal size that the channel fills,
+ * or drains, in a loop until the transfer is stopped.
+ */
+typedef struct dma_cyclic_cfg
+{
+    uint64_t buf; /*!< Memory buffer address, cache line aligned */
+    uint64_t peri_addr; /*!< Peripheral data register address, kept fixed */
+    uint32_t buf_len; /*!< Size of the buffer in bytes, a multiple of period_len */
+    uint32_t period_len; /*!< Size of a period in bytes, a multiple of the cache line size */
+    dma_xfer_width_t src_width; /*!< Source transfer width */
+    dma_xfer_width_t dst_width; /*!< Destination transfer width */
+    uint32_t flags; /*!< DMA_XFER_PERI_SINGLE or 0, the peripheral address is always fixed */
+    dma_period_callback_t callback; /*!< Called when a period completes, may be NULL */
+    void *cb_data; /*!< User data passed to the callback */
+} dma_cyclic_cfg_t;
+
+/**
+ * @brief Status of a cyclic transfer.
+ */
+typedef struct dma_cyclic_status
+{
+    uint32_t periods_done; /*!< Periods completed since the transfer was set up */
+    uint32_t pending; /*!< Completed periods not yet released by the application */
+    uint32_t overruns; /*!< Periods that completed while every period was pending, the oldest data was overwritten */
+    uint32_t stalls; /*!< Times the channel waited for a descriptor not yet re-armed, the peripheral may have dropped data */
+    uint32_t position; /*!< Offset in the buffer the channel is transferring at */
+} dma_cyclic_status_t;
 /**
  * @}
  */
@@ -333,10 +430,112 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
  */
 int32_t dma_start_transfer(dma_handle_t const hdma);
 
+/**
+ * @brief Queue a job on a DMA channel
+ *
+ * Appends the blocks of the job to the linked list the channel is working
+ * on and starts the channel if it is idle, so jobs run back to back without
+ * waiting for the previous one to complete. Jobs complete in the order they
+ * were submitted, each with its own callback. The cost of a submission
+ * depends on the number of blocks of the job only. The channel returns to
+ * idle when its last queued job completes.
+ *
+ * The channel must be configured with dma_config() and must not be used with
+ * dma_setup_transfer() while jobs are queued. Safe to call from a task or
+ * from a job callback.
+ *
+ * @param[in] hdma Handle to the channel returned by the Open()
+ * @param[in] job  The job to queue
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma or job is NULL, the job has no blocks, more than
+ *            DMA_QUEUE_MAX_BLOCKS - 1 blocks or a block is too large.
+ * - -EFAULT: if the block list is shorter than num_xfers.
+ * - -EIO:    if the channel is not open.
+ * - -EBUSY:  if a transfer set up with dma_setup_transfer() is in progress,
+ *            the queue has no room for the job, or the channel of a
+ *            drained queue has not stopped yet.
+ */
+int32_t dma_submit_job(dma_handle_t const hdma, const dma_job_t *job);
+
+/**
+ * @brief Get the number of queued jobs that have not completed
+ *
+ * @param[in] hdma Handle to the channel returned by the Open()
+ *
+ * @return
+ * - The number of jobs queued with dma_submit_job() and not yet completed.
+ * - 0, if hdma is NULL.
+ */
+uint32_t dma_get_queued_jobs(dma_handle_t const hdma);
+
+/**
+ * @brief Setup a cyclic DMA transfer
+ *
+ * Builds a ring of descriptors over the buffer whose last descriptor links
+ * back to the first, so the channel streams without gaps until
+ * dma_stop_transfer() is called. The callback is called at the end of every
+ * period; with two periods this is a half and full buffer notification.
+ * The interrupt re-arms the descriptors of the completed period, each period
+ * must therefore take longer than the interrupt latency.
+ *
+ * For peripheral to memory transfers the cache lines of a period are
+ * invalidated before its callback. For memory to peripheral transfers the
+ * application writes a period back to memory after filling it.
+ *
+ * The channel must be configured with dma_config() for a memory to
+ * peripheral or peripheral to memory transfer. The transfer is started with
+ * dma_start_transfer().
+ *
+ * @param[in] hdma Handle to the channel returned by the Open()
+ * @param[in] pcfg The cyclic transfer configuration
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma or pcfg is NULL, the channel direction is memory to
+ *            memory, there are fewer than two periods, or the sizes do not
+ *            fit DMA_QUEUE_MAX_BLOCKS descriptors.
+ * - -EIO:    if the channel is not open.
+ * - -EBUSY:  if another transfer is in progress or jobs are queued.
+ */
+int32_t dma_setup_cyclic(dma_handle_t const hdma, const dma_cyclic_cfg_t *pcfg);
+
+/**
+ * @brief Release periods of a cyclic transfer
+ *
+ * The application releases a period once it has consumed, or refilled, its
+ * data. A period completing while every period is pending is counted as an
+ * overrun.
+ *
+ * @param[in] hdma        Handle to the channel returned by the Open()
+ * @param[in] num_periods Number of periods released, oldest first
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma is NULL or more periods are released than pending
+ * - -EIO:    if no cyclic transfer is set up
+ */
+int32_t dma_cyclic_release(dma_handle_t const hdma, uint32_t num_periods);
+
+/**
+ * @brief Get the status of a cyclic transfer
+ *
+ * @param[in]  hdma   Handle to the channel returned by the Open()
+ * @param[out] status The status of the transfer
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma or status is NULL
+ * - -EIO:    if no cyclic transfer is set up
+ */
+int32_t dma_cyclic_get_status(dma_handle_t const hdma, dma_cyclic_status_t *status);
+
 /**
  * @brief Stop a data transfer in progress
  *
- * This will stop a data transfer which is in progress
+ * This will stop a data transfer which is in progress. Jobs still queued
+ * with dma_submit_job() complete with -ECANCELED. A cyclic transfer ends.
  *
  * @param[in] hdma Handle to the channel returned by the Open()
  *
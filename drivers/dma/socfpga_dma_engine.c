@@ -0,0 +1,534 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * DMA engine service, schedules requests over the channels of both DMA
+ * controllers
+ */
+#include <errno.h>
+#include "socfpga_defines.h"
+#include "socfpga_dma.h"
+#include "socfpga_dma_engine.h"
+#include "osal_log.h"
+
+#define DMA_ENGINE_NUM_INSTANCES       2U
+#define DMA_ENGINE_CH_PER_INSTANCE     4U
+
+/* States of the engine initialization */
+#define DMA_ENGINE_STATE_NONE          0U
+#define DMA_ENGINE_STATE_INIT          1U
+#define DMA_ENGINE_STATE_READY         2U
+
+struct dma_engine_request
+{
+    dma_engine_req_t req;
+    uint32_t channel;
+    struct dma_engine_request *next;
+};
+
+struct dma_engine_channel
+{
+    dma_handle_t hdma;
+    /* Configuration of the channel, valid when configured is set */
+    BaseType_t configured;
+    dma_xfer_type_t ch_dir;
+    dma_peri_id_t peri_id;
+    uint8_t ch_prio;
+    /* Requests queued on the channel by the engine */
+    uint32_t queued;
+    uint32_t completed;
+    /* Busy time accounting in generic timer ticks */
+    uint64_t busy_start;
+    uint64_t busy_ticks;
+};
+
+struct dma_engine
+{
+    BaseType_t initialized;
+    struct dma_engine_channel channels[DMA_ENGINE_NUM_CHANNELS];
+    struct dma_engine_request requests[DMA_ENGINE_MAX_REQUESTS];
+    struct dma_engine_request *free_list;
+    struct dma_engine_request *wait_head[DMA_ENGINE_PRIO_COUNT];
+    struct dma_engine_request *wait_tail[DMA_ENGINE_PRIO_COUNT];
+    uint32_t waiting[DMA_ENGINE_PRIO_COUNT];
+    uint32_t queue_depth;
+    uint32_t queue_depth_max;
+    uint32_t submitted;
+    uint32_t rejected;
+    uint32_t fallbacks;
+    uint32_t errors;
+    uint64_t period_start;
+};
+
+static struct dma_engine dma_engine_ctx;
+static volatile uint32_t dma_engine_state = DMA_ENGINE_STATE_NONE;
+
+static void dma_engine_job_done(dma_handle_t hdma, void *cb_data, int32_t status);
+static void dma_engine_channel_idle(dma_handle_t hdma);
+
+/*
+ * @brief Read the generic timer
+ */
+static inline uint64_t dma_engine_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+/*
+ * @brief Check whether a channel is set up for the direction and peripheral
+ */
+static BaseType_t dma_engine_ch_matches(const struct dma_engine_channel *pch,
+        const dma_engine_req_t *req)
+{
+    if ((pch->configured == pdFALSE) || (pch->ch_dir != req->ch_dir))
+    {
+        return pdFALSE;
+    }
+    if ((req->ch_dir != DMA_MEM_TO_MEM_DMAC) && (pch->peri_id != req->peri_id))
+    {
+        return pdFALSE;
+    }
+    return pdTRUE;
+}
+
+/*
+ * @brief Pick a channel for a request
+ *
+ * Returns the channel index, or -1 when the request has to wait. Channels
+ * set in tried are skipped.
+ */
+static int32_t dma_engine_pick_channel(const dma_engine_req_t *req,
+        uint32_t tried, BaseType_t *fallback)
+{
+    struct dma_engine_channel *pch;
+    uint32_t load[DMA_ENGINE_NUM_INSTANCES] = { 0U };
+    uint32_t inst;
+    uint32_t pass;
+    uint32_t i;
+    uint32_t score;
+    uint32_t best_score;
+    int32_t best = -1;
+
+    for (i = 0U; i < DMA_ENGINE_NUM_CHANNELS; i++)
+    {
+        pch = &dma_engine_ctx.channels[i];
+        load[i / DMA_ENGINE_CH_PER_INSTANCE] += pch->queued;
+
+        /* Requests for a peripheral stay on the channel already serving it
+         * so they complete in order */
+        if ((req->ch_dir != DMA_MEM_TO_MEM_DMAC) && (pch->queued > 0U) &&
+                (dma_engine_ch_matches(pch, req) == pdTRUE))
+        {
+            *fallback = pdFALSE;
+            if ((pch->queued >= DMA_MAX_QUEUED_JOBS) || ((tried & (1UL << i)) != 0U))
+            {
+                return -1;
+            }
+            return (int32_t)i;
+        }
+    }
+
+    /* The least loaded controller first, the other one when all its
+     * channels are saturated */
+    inst = (load[0] <= load[1]) ? 0U : 1U;
+    for (pass = 0U; (pass < DMA_ENGINE_NUM_INSTANCES) && (best < 0); pass++)
+    {
+        best_score = UINT32_MAX;
+        for (i = inst * DMA_ENGINE_CH_PER_INSTANCE;
+                i < ((inst + 1U) * DMA_ENGINE_CH_PER_INSTANCE); i++)
+        {
+            pch = &dma_engine_ctx.channels[i];
+            if ((pch->hdma == NULL) || ((tried & (1UL << i)) != 0U) ||
+                    (pch->queued >= DMA_MAX_QUEUED_JOBS))
+            {
+                continue;
+            }
+            if (dma_engine_ch_matches(pch, req) == pdTRUE)
+            {
+                score = pch->queued * 2U;
+            }
+            else if (pch->queued == 0U)
+            {
+                /* An idle channel, prefer one that needs no new setup */
+                score = 1U;
+            }
+            else
+            {
+                continue;
+            }
+            if (score < best_score)
+            {
+                best_score = score;
+                best = (int32_t)i;
+            }
+        }
+        *fallback = (pass > 0U) ? pdTRUE : pdFALSE;
+        inst = (inst + 1U) % DMA_ENGINE_NUM_INSTANCES;
+    }
+    return best;
+}
+
+/*
+ * @brief Queue a request on a channel
+ */
+static int32_t dma_engine_start(struct dma_engine_request *preq, uint32_t ch)
+{
+    struct dma_engine_channel *pch = &dma_engine_ctx.channels[ch];
+    dma_config_t cfg;
+    dma_job_t job;
+    BaseType_t matches;
+    int32_t ret;
+
+    /* The priority is loaded when the channel starts, so a channel already
+     * set up for the peripheral takes the priority of a request that finds
+     * it idle */
+    matches = dma_engine_ch_matches(pch, &preq->req);
+    if ((matches == pdFALSE) ||
+            ((pch->queued == 0U) && (pch->ch_prio != (uint8_t)preq->req.prio)))
+    {
+        cfg.instance = (uint8_t)(ch / DMA_ENGINE_CH_PER_INSTANCE);
+        cfg.ch_dir = preq->req.ch_dir;
+        cfg.ch_prio = (uint8_t)preq->req.prio;
+        cfg.peri_id = preq->req.peri_id;
+        cfg.callback = dma_engine_channel_idle;
+        ret = dma_config(pch->hdma, &cfg);
+        if (ret == 0)
+        {
+            pch->configured = pdTRUE;
+            pch->ch_dir = preq->req.ch_dir;
+            pch->peri_id = preq->req.peri_id;
+            pch->ch_prio = cfg.ch_prio;
+        }
+        else if (matches == pdFALSE)
+        {
+            /* Still draining, dispatched again once it is idle */
+            return ret;
+        }
+        /* A matching channel that has not stopped yet keeps its priority */
+    }
+
+    job.xfer_list = preq->req.xfer_list;
+    job.num_xfers = preq->req.num_xfers;
+    job.src_width = preq->req.src_width;
+    job.dst_width = preq->req.dst_width;
+    job.flags = preq->req.flags;
+    job.callback = dma_engine_job_done;
+    job.cb_data = preq;
+    ret = dma_submit_job(pch->hdma, &job);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    preq->channel = ch;
+    if (pch->queued == 0U)
+    {
+        pch->busy_start = dma_engine_now();
+    }
+    pch->queued++;
+    return 0;
+}
+
+/*
+ * @brief Complete a request that could not be started
+ */
+static void dma_engine_fail(struct dma_engine_request *preq, int32_t status)
+{
+    dma_engine_ctx.errors++;
+    if (preq->req.callback != NULL)
+    {
+        preq->req.callback(NULL, preq->req.cb_data, status);
+    }
+    preq->next = dma_engine_ctx.free_list;
+    dma_engine_ctx.free_list = preq;
+}
+
+/*
+ * @brief Dispatch waiting requests, highest priority class first
+ *
+ * Called with the DMA interrupts masked.
+ */
+static void dma_engine_dispatch(void)
+{
+    struct dma_engine_request *preq;
+    BaseType_t fallback;
+    uint32_t tried;
+    int32_t prio;
+    int32_t ch;
+    int32_t ret;
+
+    for (prio = (int32_t)DMA_ENGINE_PRIO_COUNT - 1; prio >= 0; prio--)
+    {
+        while (dma_engine_ctx.wait_head[prio] != NULL)
+        {
+            preq = dma_engine_ctx.wait_head[prio];
+            tried = 0U;
+            ret = -EBUSY;
+            ch = dma_engine_pick_channel(&preq->req, tried, &fallback);
+            while (ch >= 0)
+            {
+                ret = dma_engine_start(preq, (uint32_t)ch);
+                if (ret != -EBUSY)
+                {
+                    break;
+                }
+                tried |= (1UL << (uint32_t)ch);
+                ch = dma_engine_pick_channel(&preq->req, tried, &fallback);
+            }
+            if (ret == -EBUSY)
+            {
+                /* Keep the order within the class, try the next class */
+                break;
+            }
+
+            dma_engine_ctx.wait_head[prio] = preq->next;
+            if (dma_engine_ctx.wait_head[prio] == NULL)
+            {
+                dma_engine_ctx.wait_tail[prio] = NULL;
+            }
+            dma_engine_ctx.waiting[prio]--;
+            dma_engine_ctx.queue_depth--;
+            if (ret != 0)
+            {
+                dma_engine_fail(preq, ret);
+            }
+            else if (fallback == pdTRUE)
+            {
+                dma_engine_ctx.fallbacks++;
+            }
+        }
+    }
+}
+
+/*
+ * @brief Completion of a request, called from the DMA interrupt
+ */
+static void dma_engine_job_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    struct dma_engine_request *preq = (struct dma_engine_request *)cb_data;
+    struct dma_engine_channel *pch = &dma_engine_ctx.channels[preq->channel];
+    UBaseType_t int_mask;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    pch->queued--;
+    pch->completed++;
+    if (pch->queued == 0U)
+    {
+        pch->busy_ticks += dma_engine_now() - pch->busy_start;
+    }
+    if (status != 0)
+    {
+        dma_engine_ctx.errors++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (preq->req.callback != NULL)
+    {
+        preq->req.callback(hdma, preq->req.cb_data, status);
+    }
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    preq->next = dma_engine_ctx.free_list;
+    dma_engine_ctx.free_list = preq;
+    dma_engine_dispatch();
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
+
+/*
+ * @brief A channel queue drained, waiting requests may need the channel
+ * set up for them
+ */
+static void dma_engine_channel_idle(dma_handle_t hdma)
+{
+    UBaseType_t int_mask;
+
+    (void)hdma;
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    dma_engine_dispatch();
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
+
+int32_t dma_engine_init(void)
+{
+    UBaseType_t int_mask;
+    uint32_t state;
+    uint32_t i;
+    uint32_t opened = 0U;
+
+    /* The first caller opens the channels, concurrent callers wait for it */
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    state = dma_engine_state;
+    if (state == DMA_ENGINE_STATE_NONE)
+    {
+        dma_engine_state = DMA_ENGINE_STATE_INIT;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (state != DMA_ENGINE_STATE_NONE)
+    {
+        while (dma_engine_state == DMA_ENGINE_STATE_INIT)
+        {
+            osal_task_delay(1U);
+        }
+        return (dma_engine_state == DMA_ENGINE_STATE_READY) ? 0 : -EIO;
+    }
+    (void)memset(&dma_engine_ctx, 0, sizeof(dma_engine_ctx));
+
+    for (i = 0U; i < DMA_ENGINE_NUM_CHANNELS; i++)
+    {
+        dma_engine_ctx.channels[i].hdma = dma_open(i / DMA_ENGINE_CH_PER_INSTANCE,
+                i % DMA_ENGINE_CH_PER_INSTANCE);
+        if (dma_engine_ctx.channels[i].hdma == NULL)
+        {
+            WARN("DMA engine: channel %d of instance %d not available",
+                    i % DMA_ENGINE_CH_PER_INSTANCE, i / DMA_ENGINE_CH_PER_INSTANCE);
+            continue;
+        }
+        opened++;
+    }
+    if (opened == 0U)
+    {
+        ERROR("DMA engine: no DMA channel available");
+        dma_engine_state = DMA_ENGINE_STATE_NONE;
+        return -EIO;
+    }
+
+    for (i = 0U; i < DMA_ENGINE_MAX_REQUESTS; i++)
+    {
+        dma_engine_ctx.requests[i].next = dma_engine_ctx.free_list;
+        dma_engine_ctx.free_list = &dma_engine_ctx.requests[i];
+    }
+    dma_engine_ctx.period_start = dma_engine_now();
+    dma_engine_ctx.initialized = pdTRUE;
+    dma_engine_state = DMA_ENGINE_STATE_READY;
+    return 0;
+}
+
+int32_t dma_engine_submit(const dma_engine_req_t *req)
+{
+    struct dma_engine_request *preq;
+    UBaseType_t int_mask;
+
+    if ((req == NULL) || (req->xfer_list == NULL) || (req->num_xfers == 0U) ||
+            (req->prio >= DMA_ENGINE_PRIO_COUNT) ||
+            (req->ch_dir >= DMA_INVALID_XFER_TYPE))
+    {
+        return -EINVAL;
+    }
+    if (dma_engine_ctx.initialized != pdTRUE)
+    {
+        return -EIO;
+    }
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    preq = dma_engine_ctx.free_list;
+    if (preq == NULL)
+    {
+        dma_engine_ctx.rejected++;
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        return -ENOSPC;
+    }
+    dma_engine_ctx.free_list = preq->next;
+    preq->req = *req;
+    preq->next = NULL;
+
+    /* Queue behind the waiting requests of the class, then let the
+     * dispatcher place what it can */
+    if (dma_engine_ctx.wait_tail[req->prio] != NULL)
+    {
+        dma_engine_ctx.wait_tail[req->prio]->next = preq;
+    }
+    else
+    {
+        dma_engine_ctx.wait_head[req->prio] = preq;
+    }
+    dma_engine_ctx.wait_tail[req->prio] = preq;
+    dma_engine_ctx.waiting[req->prio]++;
+    dma_engine_ctx.queue_depth++;
+    dma_engine_ctx.submitted++;
+    dma_engine_dispatch();
+    if (dma_engine_ctx.queue_depth > dma_engine_ctx.queue_depth_max)
+    {
+        dma_engine_ctx.queue_depth_max = dma_engine_ctx.queue_depth;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return 0;
+}
+
+int32_t dma_engine_get_stats(dma_engine_stats_t *stats)
+{
+    struct dma_engine_channel *pch;
+    UBaseType_t int_mask;
+    uint64_t now;
+    uint64_t period;
+    uint64_t busy;
+    uint32_t i;
+
+    if (stats == NULL)
+    {
+        return -EINVAL;
+    }
+    if (dma_engine_ctx.initialized != pdTRUE)
+    {
+        return -EIO;
+    }
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    now = dma_engine_now();
+    period = now - dma_engine_ctx.period_start;
+    stats->queue_depth = dma_engine_ctx.queue_depth;
+    stats->queue_depth_max = dma_engine_ctx.queue_depth_max;
+    for (i = 0U; i < DMA_ENGINE_PRIO_COUNT; i++)
+    {
+        stats->waiting[i] = dma_engine_ctx.waiting[i];
+    }
+    stats->submitted = dma_engine_ctx.submitted;
+    stats->rejected = dma_engine_ctx.rejected;
+    stats->fallbacks = dma_engine_ctx.fallbacks;
+    stats->errors = dma_engine_ctx.errors;
+    for (i = 0U; i < DMA_ENGINE_NUM_CHANNELS; i++)
+    {
+        pch = &dma_engine_ctx.channels[i];
+        busy = pch->busy_ticks;
+        if (pch->queued > 0U)
+        {
+            busy += now - pch->busy_start;
+        }
+        stats->channel[i].available = (pch->hdma != NULL) ? 1U : 0U;
+        stats->channel[i].queued_jobs = pch->queued;
+        stats->channel[i].completed = pch->completed;
+        stats->channel[i].utilisation = (period != 0UL) ?
+                (uint32_t)((busy * 1000UL) / period) : 0U;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return 0;
+}
+
+void dma_engine_reset_stats(void)
+{
+    struct dma_engine_channel *pch;
+    UBaseType_t int_mask;
+    uint64_t now;
+    uint32_t i;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    now = dma_engine_now();
+    dma_engine_ctx.period_start = now;
+    dma_engine_ctx.queue_depth_max = dma_engine_ctx.queue_depth;
+    dma_engine_ctx.submitted = 0U;
+    dma_engine_ctx.rejected = 0U;
+    dma_engine_ctx.fallbacks = 0U;
+    dma_engine_ctx.errors = 0U;
+    for (i = 0U; i < DMA_ENGINE_NUM_CHANNELS; i++)
+    {
+        pch = &dma_engine_ctx.channels[i];
+        pch->completed = 0U;
+        pch->busy_ticks = 0UL;
+        pch->busy_start = now;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Header file for the DMA engine service
+ */
+
+#ifndef __SOCFPGA_DMA_ENGINE_H__
+#define __SOCFPGA_DMA_ENGINE_H__
+
+/**
+ * @file socfpga_dma_engine.h
+ * @brief Header file for the DMA engine service
+ */
+
+#include <stdint.h>
+#include "socfpga_dma.h"
+
+/**
+ * @defgroup dma_engine DMA Engine
+ * @ingroup dma
+ * @brief Channel scheduling service on top of the DMA driver
+ *
+ * @details The DMA engine owns the channels of both DMA controllers.
+ * Clients submit block lists with a priority class instead of opening a
+ * channel themselves. A request is queued on the channel with the fewest
+ * pending jobs, on the least loaded controller first, and falls back to the
+ * other controller when the channels of the first are saturated. Requests
+ * that find no room wait in the engine, higher priority classes first, and
+ * are dispatched from the completion interrupt.
+ *
+ * Requests for the same peripheral stay on one channel so they complete in
+ * order. Memory to memory requests may run on any channel. The priority
+ * class is also the hardware priority of the channel. It is loaded when the
+ * channel starts, so a request queued behind others runs at the priority
+ * of the request that started the channel.
+ * @{
+ */
+
+/**
+ * @brief Number of DMA channels managed by the engine
+ */
+#define DMA_ENGINE_NUM_CHANNELS    8U
+
+/**
+ * @brief Number of requests the engine can hold, running or waiting
+ */
+#define DMA_ENGINE_MAX_REQUESTS    64U
+
+/**
+ * @brief Priority class of a DMA engine request
+ */
+typedef enum
+{
+    DMA_ENGINE_PRIO_LOW = 0, /*!< Background transfers */
+    DMA_ENGINE_PRIO_NORMAL, /*!< Default class */
+    DMA_ENGINE_PRIO_HIGH, /*!< Latency sensitive transfers, dispatched first */
+    DMA_ENGINE_PRIO_COUNT /*!< Number of priority classes */
+} dma_engine_prio_t;
+
+/**
+ * @brief DMA engine request
+ *
+ * The request is copied by dma_engine_submit(). The block list is read
+ * when the request is dispatched to a channel, it must stay valid until
+ * the callback is called.
+ */
+typedef struct
+{
+    dma_xfer_type_t ch_dir; /*!< Transfer direction */
+    dma_peri_id_t peri_id; /*!< Peripheral handshake, ignored for memory to memory */
+    dma_engine_prio_t prio; /*!< Priority class */
+    dma_xfer_cfg_t *xfer_list; /*!< Blocks of the request */
+    uint32_t num_xfers; /*!< Number of blocks in xfer_list */
+    dma_xfer_width_t src_width; /*!< Source transfer width */
+    dma_xfer_width_t dst_width; /*!< Destination transfer width */
+    uint32_t flags; /*!< Job flags, see DMA_XFER_SRC_FIXED */
+    dma_job_callback_t callback; /*!< Completion callback, called from interrupt context, may be NULL */
+    void *cb_data; /*!< User data passed to the callback */
+} dma_engine_req_t;
+
+/**
+ * @brief Per channel statistics of the DMA engine
+ */
+typedef struct
+{
+    uint8_t available; /*!< 1 if the engine owns the channel */
+    uint32_t queued_jobs; /*!< Jobs queued on the channel */
+    uint32_t completed; /*!< Requests completed on the channel */
+    uint32_t utilisation; /*!< Time the channel was busy since the last reset, in permille */
+} dma_engine_ch_stats_t;
+
+/**
+ * @brief DMA engine statistics
+ */
+typedef struct
+{
+    uint32_t queue_depth; /*!< Requests waiting for a channel */
+    uint32_t queue_depth_max; /*!< Highest queue_depth since the last reset */
+    uint32_t waiting[DMA_ENGINE_PRIO_COUNT]; /*!< Waiting requests per priority class */
+    uint32_t submitted; /*!< Requests accepted */
+    uint32_t rejected; /*!< Requests refused because the engine was full */
+    uint32_t fallbacks; /*!< Requests dispatched to the more loaded controller */
+    uint32_t errors; /*!< Requests completed with an error */
+    dma_engine_ch_stats_t channel[DMA_ENGINE_NUM_CHANNELS]; /*!< Channel statistics, DMA_INSTANCE0 channels first */
+} dma_engine_stats_t;
+
+/**
+ * @brief Initialize the DMA engine
+ *
+ * Opens the channels of both DMA controllers. Channels already opened with
+ * dma_open() are left to their owner. Must be called from a task. Calls
+ * after the first one return at once, concurrent calls wait for the first
+ * one to finish.
+ *
+ * @return
+ * - 0, on success
+ * - -EIO: if no channel could be opened
+ */
+int32_t dma_engine_init(void);
+
+/**
+ * @brief Submit a request to the DMA engine
+ *
+ * Queues the request on a channel, or keeps it until a channel has room.
+ * Safe to call from a task or from a completion callback.
+ *
+ * @param[in] req The request
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if req is NULL or its parameters are invalid
+ * - -EIO:    if the engine is not initialized
+ * - -ENOSPC: if the engine holds DMA_ENGINE_MAX_REQUESTS requests already
+ */
+int32_t dma_engine_submit(const dma_engine_req_t *req);
+
+/**
+ * @brief Get the DMA engine statistics
+ *
+ * @param[out] stats The statistics
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if stats is NULL
+ * - -EIO:    if the engine is not initialized
+ */
+int32_t dma_engine_get_stats(dma_engine_stats_t *stats);
+
+/**
+ * @brief Reset the DMA engine statistics
+ *
+ * Resets the counters and starts a new utilisation period. The queue
+ * depths are not affected.
+ */
+void dma_engine_reset_stats(void);
+
+/**
+ * @}
+ */
+#endif /* __SOCFPGA_DMA_ENGINE_H__ */
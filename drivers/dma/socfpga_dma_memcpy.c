@@ -0,0 +1,459 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * memcpy and memset offloaded to the DMA engine
+ */
+#include <errno.h>
+#include <string.h>
+#include "socfpga_defines.h"
+#include "socfpga_cache.h"
+#include "socfpga_dma.h"
+#include "socfpga_dma_engine.h"
+#include "socfpga_dma_memcpy.h"
+#include "osal.h"
+#include "osal_log.h"
+
+#define DMA_MEMOP_CACHE_LINE    64U
+#define DMA_MEMOP_MAX_BLOCKS    (DMA_QUEUE_MAX_BLOCKS - 1U)
+#define DMA_MEMOP_MAX_BEATS     32768U
+
+struct dma_memop
+{
+    /* Source of a fill, the fill value repeated over a cache line */
+    uint8_t pattern[DMA_MEMOP_CACHE_LINE] __attribute__((aligned(DMA_MEMOP_CACHE_LINE)));
+    dma_xfer_cfg_t blocks[DMA_MEMOP_MAX_BLOCKS];
+    /* Cache line aligned part of the destination written by the DMA */
+    void *dma_dst;
+    size_t dma_len;
+    dma_memop_callback_t callback;
+    void *cb_data;
+    struct dma_memop *next;
+};
+
+struct dma_memop_blocking
+{
+    osal_semaphore_t done_sem;
+    int32_t status;
+};
+
+static struct dma_memop dma_memop_pool[DMA_MEMOP_MAX_OPS];
+static struct dma_memop *dma_memop_free_list;
+static BaseType_t dma_memop_initialized;
+static size_t dma_memop_threshold = DMA_MEMOP_DEFAULT_THRESHOLD;
+
+/*
+ * @brief Initialize the operation pool and the DMA engine on first use
+ */
+static int32_t dma_memop_init(void)
+{
+    UBaseType_t int_mask;
+    uint32_t i;
+
+    if (dma_memop_initialized == pdTRUE)
+    {
+        return 0;
+    }
+    if (dma_engine_init() != 0)
+    {
+        return -EIO;
+    }
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if (dma_memop_initialized != pdTRUE)
+    {
+        for (i = 0U; i < DMA_MEMOP_MAX_OPS; i++)
+        {
+            dma_memop_pool[i].next = dma_memop_free_list;
+            dma_memop_free_list = &dma_memop_pool[i];
+        }
+        dma_memop_initialized = pdTRUE;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return 0;
+}
+
+static struct dma_memop *dma_memop_alloc(void)
+{
+    struct dma_memop *pop;
+    UBaseType_t int_mask;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    pop = dma_memop_free_list;
+    if (pop != NULL)
+    {
+        dma_memop_free_list = pop->next;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return pop;
+}
+
+static void dma_memop_free(struct dma_memop *pop)
+{
+    UBaseType_t int_mask;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    pop->next = dma_memop_free_list;
+    dma_memop_free_list = pop;
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
+
+/*
+ * @brief Largest transfer width the address is aligned to
+ */
+static dma_xfer_width_t dma_memop_width(uint64_t addr)
+{
+    if ((addr & 7UL) == 0UL)
+    {
+        return DMA_ID_XFER_WIDTH8;
+    }
+    if ((addr & 3UL) == 0UL)
+    {
+        return DMA_TRANSFER_WIDTH4;
+    }
+    if ((addr & 1UL) == 0UL)
+    {
+        return DMA_TRANSFER_WIDTH2;
+    }
+    return DMA_TRANSFER_WIDTH1;
+}
+
+/*
+ * @brief Split the destination into the partial cache line at its start,
+ * the whole cache lines the DMA writes and the partial line at its end
+ */
+static void dma_memop_split(const uint8_t *dst, size_t len, size_t *phead,
+        size_t *pmid)
+{
+    size_t head;
+
+    head = (DMA_MEMOP_CACHE_LINE - ((uint64_t)dst % DMA_MEMOP_CACHE_LINE)) %
+            DMA_MEMOP_CACHE_LINE;
+    *phead = head;
+    *pmid = 0U;
+    if ((len >= dma_memop_threshold) && (len > head))
+    {
+        *pmid = (len - head) & ~((size_t)DMA_MEMOP_CACHE_LINE - 1U);
+    }
+}
+
+/*
+ * @brief Run an operation, or part of it, on the CPU
+ */
+static void dma_memop_cpu(uint8_t *dst, const uint8_t *src, int32_t value,
+        size_t len)
+{
+    if (src != NULL)
+    {
+        (void)memcpy(dst, src, len);
+    }
+    else
+    {
+        (void)memset(dst, value, len);
+    }
+}
+
+/*
+ * @brief Completion of the DMA part of an operation, called from the DMA
+ * interrupt
+ *
+ * The destination was cleaned and invalidated before the transfer, no
+ * cache maintenance is done here. The lines the CPU fetched during the
+ * transfer are dropped from a task by dma_memop_sync().
+ */
+static void dma_memop_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    struct dma_memop *pop = (struct dma_memop *)cb_data;
+    dma_memop_callback_t callback = pop->callback;
+    void *user_data = pop->cb_data;
+
+    (void)hdma;
+    dma_memop_free(pop);
+    if (callback != NULL)
+    {
+        callback(user_data, status);
+    }
+}
+
+/*
+ * @brief Split the cache line aligned part of the destination into blocks
+ * and submit it to the DMA engine
+ *
+ * src is NULL for a fill from the operation pattern.
+ */
+static int32_t dma_memop_submit(struct dma_memop *pop, uint8_t *dst,
+        const uint8_t *src, size_t len)
+{
+    dma_engine_req_t req;
+    uint64_t src_addr;
+    size_t max_blk;
+    size_t blk;
+    uint32_t num_blocks = 0U;
+
+    (void)memset(&req, 0, sizeof(req));
+    if (src == NULL)
+    {
+        src_addr = (uint64_t)pop->pattern;
+        req.src_width = DMA_ID_XFER_WIDTH8;
+        req.flags = DMA_XFER_SRC_FIXED;
+        cache_force_write_back(pop->pattern, sizeof(pop->pattern));
+    }
+    else
+    {
+        src_addr = (uint64_t)src;
+        req.src_width = dma_memop_width(src_addr);
+        cache_force_write_back((void *)src, len);
+    }
+    req.dst_width = DMA_ID_XFER_WIDTH8;
+
+    max_blk = (size_t)DMA_MEMOP_MAX_BEATS << (uint32_t)req.src_width;
+    if (len > (max_blk * DMA_MEMOP_MAX_BLOCKS))
+    {
+        return -EINVAL;
+    }
+    while (len > 0U)
+    {
+        blk = (len > max_blk) ? max_blk : len;
+        pop->blocks[num_blocks].src = src_addr;
+        pop->blocks[num_blocks].dst = (uint64_t)dst;
+        pop->blocks[num_blocks].blk_size = (uint32_t)blk;
+        pop->blocks[num_blocks].next_trnsfr_cfg = NULL;
+        if (num_blocks > 0U)
+        {
+            pop->blocks[num_blocks - 1U].next_trnsfr_cfg = &pop->blocks[num_blocks];
+        }
+        num_blocks++;
+        if (src != NULL)
+        {
+            src_addr += blk;
+        }
+        dst += blk;
+        len -= blk;
+    }
+
+    /* Clean and invalidate the destination so no dirty line is evicted
+     * over the DMA data */
+    cache_flush(pop->dma_dst, pop->dma_len);
+
+    req.ch_dir = DMA_MEM_TO_MEM_DMAC;
+    req.prio = DMA_ENGINE_PRIO_NORMAL;
+    req.xfer_list = pop->blocks;
+    req.num_xfers = num_blocks;
+    req.callback = dma_memop_done;
+    req.cb_data = pop;
+    return dma_engine_submit(&req);
+}
+
+/*
+ * @brief Run an operation, on the DMA when it is large enough and a DMA
+ * channel takes it, on the CPU otherwise
+ *
+ * src is NULL for a fill with value. pon_dma, when not NULL, tells whether
+ * the DMA runs the operation.
+ */
+static int32_t dma_memop_start(uint8_t *dst, const uint8_t *src,
+        int32_t value, size_t len, dma_memop_callback_t cb, void *cb_data,
+        BaseType_t *pon_dma)
+{
+    struct dma_memop *pop = NULL;
+    size_t head;
+    size_t tail;
+    size_t mid;
+    int32_t ret;
+
+    if (pon_dma != NULL)
+    {
+        *pon_dma = pdFALSE;
+    }
+    dma_memop_split(dst, len, &head, &mid);
+    if ((mid != 0U) && (dma_memop_init() == 0))
+    {
+        pop = dma_memop_alloc();
+    }
+    if (pop != NULL)
+    {
+        tail = len - head - mid;
+        pop->dma_dst = dst + head;
+        pop->dma_len = mid;
+        pop->callback = cb;
+        pop->cb_data = cb_data;
+
+        /* The partial cache lines at both ends are written by the CPU */
+        dma_memop_cpu(dst, src, value, head);
+        if (src != NULL)
+        {
+            dma_memop_cpu(dst + head + mid, src + head + mid, value, tail);
+            ret = dma_memop_submit(pop, dst + head, src + head, mid);
+        }
+        else
+        {
+            dma_memop_cpu(dst + head + mid, NULL, value, tail);
+            (void)memset(pop->pattern, value, sizeof(pop->pattern));
+            ret = dma_memop_submit(pop, dst + head, NULL, mid);
+        }
+        if (ret == 0)
+        {
+            if (pon_dma != NULL)
+            {
+                *pon_dma = pdTRUE;
+            }
+            return 0;
+        }
+        dma_memop_free(pop);
+        if (ret == -EINVAL)
+        {
+            return ret;
+        }
+
+        /* The engine is full, the CPU does the rest */
+        dma_memop_cpu(dst + head, (src != NULL) ? (src + head) : NULL, value,
+                mid);
+    }
+    else
+    {
+        /* Below the threshold, no operation left or no DMA channel */
+        dma_memop_cpu(dst, src, value, len);
+    }
+    if (cb != NULL)
+    {
+        cb(cb_data, 0);
+    }
+    return 0;
+}
+
+int32_t dma_memcpy_async(void *dst, const void *src, size_t len,
+        dma_memop_callback_t cb, void *cb_data)
+{
+    if ((dst == NULL) || (src == NULL))
+    {
+        ERROR("Source and destination cannot be NULL");
+        return -EINVAL;
+    }
+    return dma_memop_start((uint8_t *)dst, (const uint8_t *)src, 0, len, cb,
+            cb_data, NULL);
+}
+
+int32_t dma_memset_async(void *dst, int32_t value, size_t len,
+        dma_memop_callback_t cb, void *cb_data)
+{
+    if (dst == NULL)
+    {
+        ERROR("Destination cannot be NULL");
+        return -EINVAL;
+    }
+    return dma_memop_start((uint8_t *)dst, NULL, value, len, cb, cb_data,
+            NULL);
+}
+
+void dma_memop_sync(void *dst, size_t len)
+{
+    uint64_t start;
+    uint64_t end;
+
+    if ((dst == NULL) || (len == 0U))
+    {
+        return;
+    }
+
+    /* Lines the CPU may have speculatively fetched during the transfer. The
+     * DMA part was flushed before it, none of its lines is dirty; lines the
+     * CPU wrote instead are cleaned rather than lost. */
+    start = ((uint64_t)dst + DMA_MEMOP_CACHE_LINE - 1U) &
+            ~((uint64_t)DMA_MEMOP_CACHE_LINE - 1U);
+    end = ((uint64_t)dst + len) & ~((uint64_t)DMA_MEMOP_CACHE_LINE - 1U);
+    if (end > start)
+    {
+        cache_flush((void *)start, (size_t)(end - start));
+    }
+}
+
+static void dma_memop_blocking_done(void *cb_data, int32_t status)
+{
+    struct dma_memop_blocking *pwait = (struct dma_memop_blocking *)cb_data;
+
+    pwait->status = status;
+    osal_semaphore_post(pwait->done_sem);
+}
+
+/*
+ * @brief Run an operation in chunks the DMA engine accepts and wait for
+ * each of them
+ */
+static int32_t dma_memop_blocking(uint8_t *dst, const uint8_t *src,
+        int32_t value, size_t len)
+{
+    osal_semaphore_def_t sem_mem;
+    struct dma_memop_blocking wait;
+    BaseType_t on_dma;
+    size_t chunk;
+    int32_t ret = 0;
+
+    if (len < dma_memop_threshold)
+    {
+        return dma_memop_start(dst, src, value, len, NULL, NULL, NULL);
+    }
+
+    wait.done_sem = osal_semaphore_create(&sem_mem);
+    if (wait.done_sem == NULL)
+    {
+        return -ENOMEM;
+    }
+    while ((len > 0U) && (ret == 0))
+    {
+        /* Chunks within the limit of a byte aligned source */
+        chunk = (len > (DMA_MEMOP_MAX_SIZE / 8U)) ? (DMA_MEMOP_MAX_SIZE / 8U) : len;
+        wait.status = 0;
+        ret = dma_memop_start(dst, src, value, chunk, dma_memop_blocking_done,
+                &wait, &on_dma);
+        if (ret == 0)
+        {
+            /* Posted right away when the CPU did the chunk */
+            (void)osal_semaphore_wait(wait.done_sem, OSAL_TIMEOUT_WAIT_FOREVER);
+            ret = wait.status;
+        }
+        if (on_dma == pdTRUE)
+        {
+            /* Here rather than in the interrupt */
+            dma_memop_sync(dst, chunk);
+        }
+        dst += chunk;
+        if (src != NULL)
+        {
+            src += chunk;
+        }
+        len -= chunk;
+    }
+    (void)osal_semaphore_delete(wait.done_sem);
+    return ret;
+}
+
+int32_t dma_memcpy(void *dst, const void *src, size_t len)
+{
+    if ((dst == NULL) || (src == NULL))
+    {
+        ERROR("Source and destination cannot be NULL");
+        return -EINVAL;
+    }
+    return dma_memop_blocking((uint8_t *)dst, (const uint8_t *)src, 0, len);
+}
+
+int32_t dma_memset(void *dst, int32_t value, size_t len)
+{
+    if (dst == NULL)
+    {
+        ERROR("Destination cannot be NULL");
+        return -EINVAL;
+    }
+    return dma_memop_blocking((uint8_t *)dst, NULL, value, len);
+}
+
+void dma_memop_set_threshold(size_t threshold)
+{
+    dma_memop_threshold = threshold;
+}
+
+size_t dma_memop_get_threshold(void)
+{
+    return dma_memop_threshold;
+}
@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Header file for DMA memory copy and fill offload
+ */
+
+#ifndef __SOCFPGA_DMA_MEMCPY_H__
+#define __SOCFPGA_DMA_MEMCPY_H__
+
+/**
+ * @file socfpga_dma_memcpy.h
+ * @brief Header file for DMA memory copy and fill offload
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @defgroup dma_memcpy DMA Memory Operations
+ * @ingroup dma
+ * @brief memcpy and memset offloaded to the DMA engine
+ *
+ * @details Copies and fills of at least the threshold size are run by the
+ * DMA engine as memory to memory transfers. Smaller ones are done by the
+ * CPU right away, and so are larger ones when no operation is left or the
+ * DMA engine has no channel for them. The cache lines of the destination
+ * are cleaned and invalidated before the transfer, the source is cleaned
+ * before it. No cache maintenance is done in the completion interrupt.
+ * The CPU may prefetch lines of the destination while the DMA writes it, so
+ * they are dropped once more after the transfer: dma_memcpy() and
+ * dma_memset() do it from the calling task, the callers of the asynchronous
+ * functions must call dma_memop_sync() on the destination from a task after
+ * the completion callback and before reading the destination. The partial
+ * cache lines at both ends of the destination are written by the CPU, so
+ * data sharing those lines is not affected.
+ *
+ * While an asynchronous operation is in progress the caller must not access
+ * the destination, nor modify the source.
+ * @{
+ */
+
+/**
+ * @brief Default size from which operations are offloaded to the DMA
+ */
+#define DMA_MEMOP_DEFAULT_THRESHOLD    (16U * 1024U)
+
+/**
+ * @brief Maximum number of operations on the DMA at a time, the CPU runs
+ * the operations above it
+ */
+#define DMA_MEMOP_MAX_OPS              8U
+
+/**
+ * @brief Largest asynchronous operation with an 8 byte aligned source.
+ * Smaller alignments reduce the limit proportionally. The blocking
+ * functions have no limit.
+ */
+#define DMA_MEMOP_MAX_SIZE             (63U * 32768U * 8U)
+
+/**
+ * @brief Completion callback of an asynchronous operation
+ *
+ * Called from the DMA interrupt, or from the calling task before the call
+ * returns when the operation was done by the CPU. The destination may still
+ * hold stale cache lines, see dma_memop_sync().
+ *
+ * @param[in] cb_data The user data given with the operation
+ * @param[in] status  0 on success, a negative errno value on failure
+ */
+typedef void (*dma_memop_callback_t)(void *cb_data, int32_t status);
+
+/**
+ * @brief Copy memory, asynchronously when offloaded to the DMA
+ *
+ * @param[in] dst     Destination address
+ * @param[in] src     Source address
+ * @param[in] len     Number of bytes to copy
+ * @param[in] cb      Completion callback, may be NULL
+ * @param[in] cb_data User data for the callback
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if dst or src is NULL, or len is above the size limit
+ */
+int32_t dma_memcpy_async(void *dst, const void *src, size_t len,
+        dma_memop_callback_t cb, void *cb_data);
+
+/**
+ * @brief Fill memory, asynchronously when offloaded to the DMA
+ *
+ * @param[in] dst     Destination address
+ * @param[in] value   Fill value, the lowest 8 bits are used
+ * @param[in] len     Number of bytes to fill
+ * @param[in] cb      Completion callback, may be NULL
+ * @param[in] cb_data User data for the callback
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if dst is NULL or len is above the size limit
+ */
+int32_t dma_memset_async(void *dst, int32_t value, size_t len,
+        dma_memop_callback_t cb, void *cb_data);
+
+/**
+ * @brief Drop the stale cache lines of the destination of an asynchronous
+ * operation
+ *
+ * Must be called from a task once the completion callback has reported the
+ * operation, before the destination is read. The whole cache lines of the
+ * destination are cleaned and invalidated, the partial lines at both ends
+ * are left alone. Harmless when the CPU did the operation.
+ *
+ * @param[in] dst Destination address given with the operation
+ * @param[in] len Number of bytes given with the operation
+ */
+void dma_memop_sync(void *dst, size_t len);
+
+/**
+ * @brief Copy memory and wait for the copy to complete
+ *
+ * Must be called from a task.
+ *
+ * @param[in] dst Destination address
+ * @param[in] src Source address
+ * @param[in] len Number of bytes to copy
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if dst or src is NULL
+ * - -EIO:    if the DMA transfer failed
+ */
+int32_t dma_memcpy(void *dst, const void *src, size_t len);
+
+/**
+ * @brief Fill memory and wait for the fill to complete
+ *
+ * Must be called from a task.
+ *
+ * @param[in] dst   Destination address
+ * @param[in] value Fill value, the lowest 8 bits are used
+ * @param[in] len   Number of bytes to fill
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if dst is NULL
+ * - -EIO:    if the DMA transfer failed
+ */
+int32_t dma_memset(void *dst, int32_t value, size_t len);
+
+/**
+ * @brief Set the size from which operations are offloaded to the DMA
+ *
+ * @param[in] threshold Size in bytes, 0 offloads every operation
+ */
+void dma_memop_set_threshold(size_t threshold);
+
+/**
+ * @brief Get the size from which operations are offloaded to the DMA
+ *
+ * @return The threshold in bytes
+ */
+size_t dma_memop_get_threshold(void);
+
+/**
+ * @}
+ */
+#endif /* __SOCFPGA_DMA_MEMCPY_H__ */
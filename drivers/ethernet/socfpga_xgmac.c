@@ -88,14 +88,15 @@
 
 #define SOCFGPA_CACHE_LINE_WIDTH    64U
 
-struct xgmac_desc_t
-{
-    xgmac_base_addr_t xgmac_inst_base_addr;       /*!< XGMAC instance base address */
-    xgmac_base_addr_t xgmac_inst_dma_base_addr;    /*!< XGMAC DMA base address */
-    int32_t instance;                           /*!< Instance number */
-    uint8_t csum_mode;                      /*!< Checksum mode */
-    uint8_t phy_type;                           /*!< PHY type */
+/* Reads of the descriptor after a timestamped frame to wait for its context */
+#define XGMAC_RX_CTXT_POLL_COUNT    16U
+
+#define XGMAC_PTP_CMD_TIMEOUT_MS    10U
+#define XGMAC_PTP_MAX_ADJ_PPB       32000000
 
+/* Per DMA channel state. Each channel owns one MTL Tx and one MTL Rx queue */
+struct xgmac_chnl_desc_t
+{
     xgmac_buf_desc_t *tx_bd_ring;        /*!< Transmit buffer descriptor ring */
     xgmac_buf_desc_t *rx_bd_ring;        /*!< Receive buffer descriptor ring */
 
@@ -109,8 +110,32 @@ struct xgmac_desc_t
 
     volatile int32_t tx_desc_head;                /*!< Transmit descriptor head index */
     volatile int32_t tx_desc_tail;                /*!< Transmit descriptor tail index */
-    volatile int32_t rx_desc_head;                /*!< Receive descriptor head index */
-    volatile int32_t rx_desc_tail;                /*!< Receive descriptor tail index */
+    volatile int32_t rx_desc_head;                /*!< Next receive descriptor to refill */
+    volatile int32_t rx_desc_tail;                /*!< Next receive descriptor to receive */
+    volatile uint32_t rx_unfilled;                /*!< Received descriptors not yet refilled */
+    uint8_t rx_ctxt[XGMAC_NUM_RX_DESC];           /*!< Received timestamp context descriptors */
+    uint32_t rx_frame_len;                        /*!< Bytes of the current frame in earlier Rx buffers */
+
+    xgmac_timestamp_t tx_ts;            /*!< Timestamp of the last completed Tx frame */
+    bool tx_ts_valid;                   /*!< The last completed Tx frame was timestamped */
+
+    osal_semaphore_t tx_sem;           /*!< Transmit synchronization semaphore */
+    osal_semaphore_t tx_mutex;           /*!< Transmit synchronization mutex */
+
+    uint16_t rx_coal_count;             /*!< Rx descriptors refilled since the last IOC */
+    uint16_t tx_coal_count;             /*!< Tx descriptors queued since the last IOC */
+    volatile bool rx_irq_masked;        /*!< RI is currently masked */
+};
+
+struct xgmac_desc_t
+{
+    xgmac_base_addr_t xgmac_inst_base_addr;       /*!< XGMAC instance base address */
+    xgmac_base_addr_t xgmac_inst_dma_base_addr;    /*!< XGMAC DMA base address */
+    int32_t instance;                           /*!< Instance number */
+    uint8_t csum_mode;                      /*!< Checksum mode */
+    uint8_t phy_type;                           /*!< PHY type */
+
+    struct xgmac_chnl_desc_t chnl[XGMAC_NUM_DMA_CHANNELS]; /*!< DMA channel state */
 
     xgmac_callback_t callback;           /*!< Callback function */
     void *pcntxt;                          /*!< User context pointer */
@@ -120,9 +145,14 @@ struct xgmac_desc_t
     int8_t is_started;                            /*!< Indicates if device is started */
     int8_t is_ready;                              /*!< Indicates if device is ready */
 
-    osal_semaphore_t tx_sem;           /*!< Transmit synchronization semaphore */
-    osal_semaphore_t tx_mutex;           /*!< Transmit synchronization mutex */
-
+    xgmac_coalesce_t coalesce;          /*!< Interrupt coalescing thresholds */
+    bool rx_poll_mode;                  /*!< Mask RI in the ISR when it is reported */
+    bool tso_enabled;                   /*!< TCP segmentation offload enabled on the DMA channels */
+    bool ts_enabled;                    /*!< IEEE 1588 timestamping enabled */
+    uint32_t ptp_addend;                /*!< Timestamp addend for the nominal clock rate */
+    uint32_t mtu;                       /*!< Largest payload of a received frame */
+    uint32_t rx_buf_size;               /*!< Size of the buffers given to the Rx DMA */
+    xgmac_irq_stats_t irq_stats;        /*!< Interrupt statistics */
 };
 
 static struct xgmac_desc_t *xgmac_descriptors = NULL;
@@ -132,8 +162,8 @@ static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr);
 static Basetype_t dma_set_descriptors(xgmac_handle_t hxgmac);
 static void dma_channel_init(xgmac_handle_t hxgmac, const
         xgmac_dev_config_str_t *xgmac_dev_config);
-void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac);
-void dma_setup_rx_descriptor_list(xgmac_handle_t hxgmac);
+void dma_setup_tx_descriptor_list(struct xgmac_chnl_desc_t *pchnl);
+void dma_setup_rx_descriptor_list(struct xgmac_chnl_desc_t *pchnl);
 static Basetype_t dma_enable_interrupts(xgmac_handle_t hxgmac, const
         xgmac_dev_config_str_t *xgmac_dev_config);
 static Basetype_t dma_disable_interrupts(xgmac_handle_t hxgmac, const
@@ -142,6 +172,25 @@ static Basetype_t dma_register_isr(xgmac_handle_t hxgmac);
 static Basetype_t dma_un_register_isr(xgmac_handle_t hxgmac);
 void socfpga_xgmac_dma_isr(void *param);
 
+static void mac_set_frame_limit(xgmac_handle_t hxgmac)
+{
+    xgmacmac_rx_config_t rx_config;
+
+    rx_config = *(xgmac_dev_config_str.mac_rx_config);
+
+    /*
+     * Jumbo frames raise the watchdog limit, the giant packet limit then
+     * flags frames which are longer than the MTU allows
+     */
+    if (hxgmac->mtu > XGMAC_STD_MTU)
+    {
+        rx_config.je = true;
+        rx_config.gpslce = true;
+        rx_config.gpsl = (uint16_t)(hxgmac->mtu + XGMAC_FRAME_OVERHEAD);
+    }
+    xgmac_config_mac_rx(hxgmac->xgmac_inst_base_addr, &rx_config);
+}
+
 static socfpga_hpu_interrupt_t get_emac_intr_id(int32_t instance)
 {
     socfpga_hpu_interrupt_t intr_id;
@@ -168,10 +217,12 @@ xgmac_handle_t xgmac_emac_init(xgmac_config_t *cfg)
 {
     int32_t xgmac_instance = cfg->instance;
     xgmac_handle_t hxgmac;
+    uint8_t chnl;
 
     if (xgmac_descriptors == NULL)
     {
-        xgmac_descriptors = (struct xgmac_desc_t *)pvPortMallocCoherent(
+        xgmac_descriptors = (struct xgmac_desc_t *)pvPortMallocCoherentAligned(
+                XGMAC_DMA_ALIGN_BYTES,
                 sizeof(struct xgmac_desc_t) * XGMAC_MAX_INSTANCE);
         if (xgmac_descriptors == NULL)
         {
@@ -216,13 +267,24 @@ xgmac_handle_t xgmac_emac_init(xgmac_config_t *cfg)
     /* Enable Hardware checksum */
     hxgmac->csum_mode = XGMAC_CSUM_BY_HW;
 
-    /* Initialize Tx and Rx BD Ring to zero */
-    hxgmac->tx_bd_ring = NULL;
-    hxgmac->rx_bd_ring = NULL;
+    for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+    {
+        /* Initialize Tx and Rx BD Ring to zero */
+        hxgmac->chnl[chnl].tx_bd_ring = NULL;
+        hxgmac->chnl[chnl].rx_bd_ring = NULL;
+
+        /* Initialize TransmitSemaphore and TransmitMutex to NULL */
+        hxgmac->chnl[chnl].tx_sem = NULL;
+        hxgmac->chnl[chnl].tx_mutex = NULL;
+    }
+
+    /* One interrupt per frame until coalescing is configured */
+    hxgmac->coalesce.rx_frames = 1U;
+    hxgmac->coalesce.tx_frames = 1U;
 
-    /* Initialize TransmitSemaphore and TransmitMutex to NULL */
-    hxgmac->tx_sem = NULL;
-    hxgmac->tx_mutex = NULL;
+    /* Standard frames until XGMAC_SET_MTU is requested */
+    hxgmac->mtu = XGMAC_STD_MTU;
+    hxgmac->rx_buf_size = XGMAC_FRAME_SIZE(XGMAC_STD_MTU);
 
     hxgmac->is_initialized = TRUE;
 
@@ -235,6 +297,7 @@ int32_t xgmac_emac_start(xgmac_handle_t hxgmac)
     int32_t xgmac_instance = hxgmac->instance;
     xgmac_base_addr_t emac_base_addr;
     xgmac_base_addr_t mtl_base_addr;
+    uint8_t chnl;
 
     uint8_t bytes[24] =
     {
@@ -255,10 +318,17 @@ int32_t xgmac_emac_start(xgmac_handle_t hxgmac)
 
     /* Program MAC register configurations */
     xgmac_mac_init(emac_base_addr, &xgmac_dev_config_str);
+    mac_set_frame_limit(hxgmac);
 
     /* Program MTL configuration registers for Tx and Rx */
     xgmac_mtl_init(mtl_base_addr, &xgmac_dev_config_str);
 
+    /* Map each Rx queue to the DMA channel of the same index */
+    for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+    {
+        xgmac_map_rxq_to_dma(emac_base_addr, chnl, chnl, false);
+    }
+
     /* Setup the MAC Address in MAC High and MAC Low Registers */
     xgmac_set_macaddress(emac_base_addr, (void *)bytes, MAC_ADRRESS_INDEX1);
 
@@ -341,286 +411,1290 @@ xgmac_err_info_t *xgmac_get_err_info(xgmac_handle_t hxgmac)
     return &(hxgmac->err_info);
 }
 
-int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, xgmac_tx_buf_t *dma_tx_buf)
+static void dma_fill_tx_descriptor(xgmac_handle_t hxgmac, struct xgmac_chnl_desc_t *pchnl,
+        int32_t head_indx, const xgmac_tx_buf_t *dma_tx_buf, bool irq_on_completion)
 {
-    TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
     xgmac_buf_desc_t *pdma_tx_desc;
-    int32_t head_indx = hxgmac->tx_desc_head;
     uint32_t data_length;
-    uint32_t last_tx_desc;
-    xgmac_base_addr_t dma_base_addr;
-    uint8_t ckecksum_insertion;
     uint32_t low_addr, high_addr;
     uintptr_t buffer_addr;
-    int32_t ret_status = 0;
 
-    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
+    pdma_tx_desc = &(pchnl->tx_bd_ring[head_indx]);
+
+    /* Assign NW Buffer address to Desc0 address */
+    buffer_addr = (uintptr_t)dma_tx_buf->buf;
+    low_addr = (uint32_t)buffer_addr;
+    high_addr = (uint32_t)(buffer_addr >> 32);
 
-    /* Do while once and break in case of error */
-    do
+    /* The Application will set this flag if it wants to release buffers after Tx done.
+     * Hence copy the buffer address later to be used in TX Done function */
+    if (dma_tx_buf->release_buf != 0U)
     {
-        if (hxgmac->tx_sem == NULL)
-        {
-            ret_status = -EIO;
-            break;
-        }
+        pchnl->ptx_dma_buf1_ap[head_indx] = (uint8_t *)buffer_addr;
+    }
+    else
+    {
+        pchnl->ptx_dma_buf1_ap[head_indx] = NULL;
+    }
+
+    /* Assign BufferAP address to Desc0 and Desc1  */
+    pdma_tx_desc->des0 = low_addr;
+    pdma_tx_desc->des1 = high_addr;
+
+    data_length = dma_tx_buf->size;
+    xgmac_flush_buffer((void *)(uintptr_t)buffer_addr, data_length);
+
+    /* Set Buffer-1 Length */
+    pdma_tx_desc->des2 = (data_length & TDES2_NORM_RD_HL_B1L_MASL);
+
+    /* Interrupt On Completion is only requested for the last descriptor of a burst */
+    if (irq_on_completion == true)
+    {
+        pdma_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
+    }
+
+    if ((dma_tx_buf->ts_request != 0U) && (hxgmac->ts_enabled == true))
+    {
+        pdma_tx_desc->des2 |= TDES2_NORM_RD_TTSE_TMWD_MASK;
+    }
+
+    /* Prepare transmit descriptors to give to DMA. */
+    pdma_tx_desc->des3 = 0U;
+
+    /* Set the IPv4 checksum */
+    if (hxgmac->csum_mode == XGMAC_CSUM_BY_HW)
+    {
+        pdma_tx_desc->des3 |= TDES3_NORM_RD_CIC_TPL_MASK;
+    }
+
+    /* Set first and last descriptor mask */
+    /* Set Own bit of the Tx descriptor to give the buffer back to DMA */
+    pdma_tx_desc->des3 |= TDES3_NORM_RD_FD_MASK |
+            TDES3_NORM_RD_LD_MASK | TDES3_NORM_RD_OWN_MASK;
+}
 
-        if (osal_semaphore_wait(hxgmac->tx_sem, block_time_ticks) != pdPASS)
+static int32_t dma_fill_tso_descriptors(struct xgmac_chnl_desc_t *pchnl,
+        int32_t head_indx, const xgmac_tx_buf_t *dma_tx_buf, bool irq_on_completion)
+{
+    xgmac_buf_desc_t *pdma_tx_desc;
+    uintptr_t buffer_addr;
+    uint32_t payload_len;
+    uint32_t chunk_len;
+    uint32_t offset;
+
+    buffer_addr = (uintptr_t)dma_tx_buf->buf;
+    xgmac_flush_buffer((void *)buffer_addr, dma_tx_buf->size);
+    payload_len = dma_tx_buf->size - dma_tx_buf->tso_hdr_len;
+
+    /* Context descriptor with the segment size for this frame */
+    pdma_tx_desc = &(pchnl->tx_bd_ring[head_indx]);
+    pchnl->ptx_dma_buf1_ap[head_indx] = NULL;
+    pdma_tx_desc->des0 = 0U;
+    pdma_tx_desc->des1 = 0U;
+    pdma_tx_desc->des2 = (uint32_t)dma_tx_buf->tso_mss & XGMAC_TDES2_CTXT_MSS_MASK;
+    pdma_tx_desc->des3 = TDES3_NORM_RD_OWN_MASK | TDES3_NORM_RD_CTXT_MASK |
+            XGMAC_TDES3_CTXT_TCMSSV_MASK;
+    head_indx = (head_indx + 1) % XGMAC_NUM_TX_DESC;
+
+    /* First descriptor holds the headers replicated into every segment */
+    pdma_tx_desc = &(pchnl->tx_bd_ring[head_indx]);
+    pchnl->ptx_dma_buf1_ap[head_indx] = NULL;
+    pdma_tx_desc->des0 = (uint32_t)buffer_addr;
+    pdma_tx_desc->des1 = (uint32_t)(buffer_addr >> 32);
+    pdma_tx_desc->des2 = (uint32_t)dma_tx_buf->tso_hdr_len & TDES2_NORM_RD_HL_B1L_MASL;
+    pdma_tx_desc->des3 = TDES3_NORM_RD_OWN_MASK | TDES3_NORM_RD_FD_MASK |
+            TDES3_NORM_RD_TSE_MASK |
+            ((((uint32_t)dma_tx_buf->tso_tcp_hdr_len / 4U) <<
+            XGMAC_TDES3_TSO_THL_POS) & XGMAC_TDES3_TSO_THL_MASK) |
+            (payload_len & XGMAC_TDES3_TSO_TPL_MASK);
+    head_indx = (head_indx + 1) % XGMAC_NUM_TX_DESC;
+
+    /* The payload follows, split at the descriptor buffer length limit */
+    for (offset = dma_tx_buf->tso_hdr_len; offset < dma_tx_buf->size;
+            offset += chunk_len)
+    {
+        chunk_len = dma_tx_buf->size - offset;
+        if (chunk_len > XGMAC_TDES_MAX_BUF_LEN)
         {
-            ERROR("xgmac_dma_transmit: Time-out TX buffer not available.");
-            ret_status = -EIO;
-            break;
+            chunk_len = XGMAC_TDES_MAX_BUF_LEN;
         }
 
-        if (osal_semaphore_wait(hxgmac->tx_mutex, block_time_ticks) != pdFAIL)
-        {
+        pdma_tx_desc = &(pchnl->tx_bd_ring[head_indx]);
+        pchnl->ptx_dma_buf1_ap[head_indx] = NULL;
+        pdma_tx_desc->des0 = (uint32_t)(buffer_addr + offset);
+        pdma_tx_desc->des1 = (uint32_t)((buffer_addr + offset) >> 32);
+        pdma_tx_desc->des2 = chunk_len & TDES2_NORM_RD_HL_B1L_MASL;
+        pdma_tx_desc->des3 = TDES3_NORM_RD_OWN_MASK;
 
-            pdma_tx_desc = &(hxgmac->tx_bd_ring[head_indx]);
-            if (pdma_tx_desc == NULL)
+        if ((offset + chunk_len) == dma_tx_buf->size)
+        {
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_LD_MASK;
+            if (irq_on_completion == true)
             {
-                return -EINVAL;
+                pdma_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
             }
 
-            /* Assign NW Buffer address to Desc0 address */
-            buffer_addr = (uintptr_t)dma_tx_buf->buf;
-            low_addr = (uint32_t)buffer_addr;
-            high_addr = (uint32_t)(buffer_addr >> 32);
-
-            /* The Application will set this flag if it wants to release buffers after Tx done.
-             * Hence copy the buffer address later to be used in TX Done function */
+            /* The DMA reads the buffer until the last descriptor is done */
             if (dma_tx_buf->release_buf != 0U)
             {
-                hxgmac->ptx_dma_buf1_ap[head_indx] = (uint8_t *)buffer_addr;
-            }
-            else
-            {
-                hxgmac->ptx_dma_buf1_ap[head_indx] = NULL;
+                pchnl->ptx_dma_buf1_ap[head_indx] = dma_tx_buf->buf;
             }
+        }
+        head_indx = (head_indx + 1) % XGMAC_NUM_TX_DESC;
+    }
 
-            /* Assign BufferAP address to Desc0 and Desc1  */
-            pdma_tx_desc->des0 = low_addr;
-            pdma_tx_desc->des1 = high_addr;
-
-            data_length = dma_tx_buf->size;
-            xgmac_flush_buffer((void *)(uintptr_t)buffer_addr, data_length);
-
-            /* Set Buffer-1 Length */
-            pdma_tx_desc->des2 = (data_length & TDES2_NORM_RD_HL_B1L_MASL);
+    return head_indx;
+}
 
-            /* Enable Interrupt On Completion */
-            pdma_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
+static int32_t dma_fill_sg_descriptors(xgmac_handle_t hxgmac,
+        struct xgmac_chnl_desc_t *pchnl, int32_t head_indx,
+        const xgmac_tx_buf_t *dma_tx_buf, bool irq_on_completion)
+{
+    xgmac_buf_desc_t *pdma_tx_desc;
+    const xgmac_tx_seg_t *pseg;
+    uintptr_t buffer_addr;
+    uint32_t frame_len = 0U;
+    uint8_t seg;
 
-            /* Prepare transmit descriptors to give to DMA. */
+    for (seg = 0U; seg < dma_tx_buf->num_segs; seg++)
+    {
+        frame_len += dma_tx_buf->segs[seg].size;
+    }
 
-            /* Set the IPv4 checksum */
-            ckecksum_insertion = hxgmac->csum_mode;
-            if (ckecksum_insertion == XGMAC_CSUM_BY_HW)
+    for (seg = 0U; seg < dma_tx_buf->num_segs; seg++)
+    {
+        pseg = &(dma_tx_buf->segs[seg]);
+        pdma_tx_desc = &(pchnl->tx_bd_ring[head_indx]);
+        pchnl->ptx_dma_buf1_ap[head_indx] = NULL;
+
+        buffer_addr = (uintptr_t)pseg->buf;
+        xgmac_flush_buffer((void *)buffer_addr, pseg->size);
+        pdma_tx_desc->des0 = (uint32_t)buffer_addr;
+        pdma_tx_desc->des1 = (uint32_t)(buffer_addr >> 32);
+        pdma_tx_desc->des2 = pseg->size & TDES2_NORM_RD_HL_B1L_MASL;
+        pdma_tx_desc->des3 = TDES3_NORM_RD_OWN_MASK;
+
+        /* The first descriptor carries the frame length and checksum control */
+        if (seg == 0U)
+        {
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_FD_MASK |
+                    (frame_len & TDES3_NORM_RD_FL_TPL_MASK);
+            if (hxgmac->csum_mode == XGMAC_CSUM_BY_HW)
             {
                 pdma_tx_desc->des3 |= TDES3_NORM_RD_CIC_TPL_MASK;
             }
-
-            /* Set first and last descriptor mask */
-            /* Set Own bit of the Tx descriptor to give the buffer back to DMA */
-            pdma_tx_desc->des3 |= TDES3_NORM_RD_FD_MASK |
-                    TDES3_NORM_RD_LD_MASK | TDES3_NORM_RD_OWN_MASK;
-
-            /* Issue synchronization barrier instruction */
-            __asm volatile ("DSB SY");
-
-            /* Point to next descriptor */
-            head_indx++;
-            if (head_indx == XGMAC_NUM_TX_DESC)
+            if ((dma_tx_buf->ts_request != 0U) && (hxgmac->ts_enabled == true))
             {
-                head_indx = 0;
+                pdma_tx_desc->des2 |= TDES2_NORM_RD_TTSE_TMWD_MASK;
             }
+        }
 
-            /* Update the TX-head index */
-            hxgmac->tx_desc_head = head_indx;
-
-            /* Program the  Tx Tail Pointer Register */
-            last_tx_desc = (uint32_t)(uintptr_t)&(hxgmac->tx_bd_ring[head_indx]);
-            WR_DMA_CHNL_REG32(dma_base_addr, XGMAC_DMA_CH0, XGMAC_DMA_CH_TXDESC_TAIL_LPOINTER,
-                    last_tx_desc);
+        if (seg == (dma_tx_buf->num_segs - 1U))
+        {
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_LD_MASK;
+            if (irq_on_completion == true)
+            {
+                pdma_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
+            }
 
-            /* Release the Mutex. */
-            if (osal_semaphore_post(hxgmac->tx_mutex) == false)
+            /* The frame is released once its last segment is sent */
+            if (dma_tx_buf->release_buf != 0U)
             {
-                ret_status = -EIO;
-                break;
+                pchnl->ptx_dma_buf1_ap[head_indx] = dma_tx_buf->buf;
             }
         }
-        else
-        {
-            ret_status = -EIO;
-            break;
-        }
-    } while(false);
+        head_indx = (head_indx + 1) % XGMAC_NUM_TX_DESC;
+    }
 
-    return ret_status;
+    return head_indx;
 }
 
-int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
+static bool dma_tx_buf_valid(xgmac_handle_t hxgmac, const xgmac_tx_buf_t *dma_tx_buf)
 {
-    xgmac_buf_desc_t *pdma_rx_desc;
-    int32_t head_indx = hxgmac->rx_desc_head;
-    uint8_t *pethernet_buffer;
-    BaseType_t received_packet_length;
-    BaseType_t dma_inv_length;
-    int32_t ret_status;
-
-    ret_status = 0;
-
-    pdma_rx_desc = &(hxgmac->rx_bd_ring[head_indx]);
-    if (pdma_rx_desc == NULL)
-    {
-        return -EINVAL;
-    }
+    uint32_t max_frame_len = hxgmac->mtu + XGMAC_FRAME_OVERHEAD;
+    uint32_t frame_len = 0U;
+    uint8_t seg;
 
-    if ((pdma_rx_desc->des3 & XGMAC_RDES3_OWN) == 0u)
+    if (dma_tx_buf->num_segs != 0U)
     {
-        /* Parse the buffer address from RxBufAP Array  */
-        pethernet_buffer = hxgmac->prx_dma_buf1_ap[head_indx];
-        if (pethernet_buffer == NULL)
-        {
-            return -EINVAL;
-        }
-        received_packet_length = pdma_rx_desc->des3 & RDES3_NORM_WR_PL_MASK;
-        if(received_packet_length & 0x3f )
+        if ((dma_tx_buf->segs == NULL) || (dma_tx_buf->tso_mss != 0U) ||
+                (dma_tx_buf->num_segs > XGMAC_TX_MAX_SEGS))
         {
-            dma_inv_length = ((received_packet_length + (SOCFGPA_CACHE_LINE_WIDTH)) & ~(SOCFGPA_CACHE_LINE_WIDTH - 1U));
-            xgmac_invalidate_buffer((void *)(uintptr_t)pethernet_buffer, dma_inv_length);
+            return false;
         }
-        else
+        for (seg = 0U; seg < dma_tx_buf->num_segs; seg++)
         {
-            xgmac_invalidate_buffer((void *)(uintptr_t)pethernet_buffer, received_packet_length);
+            if ((dma_tx_buf->segs[seg].buf == NULL) ||
+                    (dma_tx_buf->segs[seg].size == 0U) ||
+                    (dma_tx_buf->segs[seg].size > XGMAC_TX_MAX_SEG_SIZE))
+            {
+                return false;
+            }
+            frame_len += dma_tx_buf->segs[seg].size;
         }
 
-        dma_rx_buf->buf = pethernet_buffer;
-        dma_rx_buf->size = received_packet_length;
-        dma_rx_buf->packet_status = pdma_rx_desc->des3;
-
+        /* The first descriptor carries the length of the whole frame */
+        return ((frame_len <= TDES3_NORM_RD_FL_TPL_MASK) &&
+                (frame_len <= max_frame_len));
     }
-    else
+
+    /* Only TSO frames may be longer than the MTU, they go out as segments */
+    if (dma_tx_buf->tso_mss == 0U)
     {
-        ret_status = -EAGAIN;
+        return ((dma_tx_buf->size <= TDES3_NORM_RD_FL_TPL_MASK) &&
+                (dma_tx_buf->size <= max_frame_len));
     }
 
-    return ret_status;
+    if ((hxgmac->tso_enabled == false) ||
+            (dma_tx_buf->tso_mss > XGMAC_TSO_MAX_MSS) ||
+            (dma_tx_buf->tso_hdr_len > XGMAC_TDES_MAX_BUF_LEN) ||
+            ((dma_tx_buf->tso_tcp_hdr_len % 4U) != 0U) ||
+            (dma_tx_buf->tso_tcp_hdr_len >= dma_tx_buf->tso_hdr_len) ||
+            (dma_tx_buf->size <= dma_tx_buf->tso_hdr_len) ||
+            ((dma_tx_buf->size - dma_tx_buf->tso_hdr_len) > XGMAC_TSO_MAX_PAYLOAD))
+    {
+        return false;
+    }
+    return true;
 }
 
-int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t *buf)
+static uint32_t dma_tx_desc_count(const xgmac_tx_buf_t *dma_tx_buf)
 {
-    xgmac_buf_desc_t *pdma_rx_desc;
-    int32_t head_indx = hxgmac->rx_desc_head;
-    xgmac_base_addr_t dma_base_addr;
-    uint32_t last_rx_desc;
+    uint32_t payload_len;
 
-    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
-    pdma_rx_desc = &(hxgmac->rx_bd_ring[head_indx]);
-    if ((dma_base_addr == 0U) || (pdma_rx_desc == NULL))
+    if (dma_tx_buf->num_segs != 0U)
     {
-        return -1;
+        return dma_tx_buf->num_segs;
     }
-    if (buf != NULL)
-    {
-        pdma_rx_desc->des0 = (uint32_t)(uintptr_t)buf;
-        pdma_rx_desc->des1 = (uint32_t)((uintptr_t)buf >> 32);
 
-        hxgmac->prx_dma_buf1_ap[head_indx] = (uint8_t *)buf;
+    if (dma_tx_buf->tso_mss == 0U)
+    {
+        return 1U;
     }
-    /*
-     * There is a possibility that the buffer is cached in L1 but not in L4.
-     * Since the peripherals use L4 cache, it could see stale data
-     */
-     xgmac_flush_buffer(buf, XGMAC_MAX_PACKET_SIZE);
-
-    /* Release descriptors to DMA */
-    pdma_rx_desc->des2 = 0;
-    pdma_rx_desc->des3 = 0;
 
-    /* Set Own bit and IOC bit of of the Rx descriptor Status */
-    pdma_rx_desc->des3 = XGMAC_RDES3_OWN | XGMAC_RDES3_IOC;
+    /* Context and header descriptors, then one per payload chunk */
+    payload_len = dma_tx_buf->size - dma_tx_buf->tso_hdr_len;
+    return 2U + ((payload_len + XGMAC_TDES_MAX_BUF_LEN - 1U) / XGMAC_TDES_MAX_BUF_LEN);
+}
 
-    head_indx = (head_indx + 1) % XGMAC_NUM_RX_DESC;
+static bool dma_reserve_tx_desc(struct xgmac_chnl_desc_t *pchnl, uint32_t count,
+        TickType_t block_time_ticks)
+{
+    uint32_t taken;
 
-    hxgmac->rx_desc_head = head_indx;
+    for (taken = 0U; taken < count; taken++)
+    {
+        if (osal_semaphore_wait(pchnl->tx_sem, block_time_ticks) != pdPASS)
+        {
+            break;
+        }
+    }
 
-    /* Update the tail pointer register */
-    /*
-     * Tail pointer should be always ahead of current pointer
-     * Setting the tail to recently processed descriptor gives better chance
-     * to avoid current catching up to tail (since it is a ring buffer)
-     */
-    last_rx_desc = (uint32_t)(uintptr_t)pdma_rx_desc;
-    WR_DMA_CHNL_REG32(dma_base_addr, XGMAC_DMA_CH0, XGMAC_DMA_CH_RXDESC_TAIL_LPOINTER,
-            last_rx_desc);
+    if (taken == count)
+    {
+        return true;
+    }
 
-    return 0;
+    /* Not enough for the whole frame, give back the partial reservation */
+    while (taken > 0U)
+    {
+        (void)osal_semaphore_post(pchnl->tx_sem);
+        taken--;
+    }
+    return false;
 }
 
-int32_t xgmac_set_callback(xgmac_handle_t hxgmac, xgmac_callback_t callback, void *pcntxt)
+int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_tx_buf_t *dma_tx_buf)
 {
-    if (hxgmac == NULL)
-    {
-        return -EINVAL;
-    }
+    int32_t ret_status;
 
-    if (hxgmac->is_started != 0)
+    ret_status = xgmac_dma_transmit_burst(hxgmac, chnl, dma_tx_buf, 1U);
+    if (ret_status != 1)
     {
-        return -EBUSY;
+        return -EIO;
     }
 
-    hxgmac->callback = callback;
-    hxgmac->pcntxt = pcntxt;
-
     return 0;
 }
 
-int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer)
+int32_t xgmac_dma_transmit_burst(xgmac_handle_t hxgmac, uint8_t chnl,
+        xgmac_tx_buf_t *dma_tx_bufs, uint32_t num_bufs)
 {
-    int tail_indx = hxgmac->tx_desc_tail;
-    int head_indx = hxgmac->tx_desc_head;
     TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
-    int32_t ret_status;
+    struct xgmac_chnl_desc_t *pchnl;
+    int32_t head_indx;
+    uint32_t last_tx_desc;
+    xgmac_base_addr_t dma_base_addr;
+    uint32_t num_queued = 0U;
+    uint32_t num_reserved = 0U;
+    uint32_t num_slots = 0U;
+    uint32_t desc_count;
+    bool irq_on_completion;
+
+    if ((hxgmac == NULL) || (chnl >= XGMAC_NUM_DMA_CHANNELS) ||
+            (dma_tx_bufs == NULL) || (num_bufs == 0U) ||
+            (num_bufs > (uint32_t)XGMAC_NUM_TX_DESC))
+    {
+        return -EINVAL;
+    }
 
-    ret_status = 0;
+    for (num_queued = 0U; num_queued < num_bufs; num_queued++)
+    {
+        if ((dma_tx_buf_valid(hxgmac, &dma_tx_bufs[num_queued]) == false) ||
+                (dma_tx_desc_count(&dma_tx_bufs[num_queued]) >
+                (uint32_t)XGMAC_NUM_TX_DESC))
+        {
+            return -EINVAL;
+        }
+    }
 
-    xgmac_buf_desc_t *pdma_tx_desc;
+    pchnl = &(hxgmac->chnl[chnl]);
+    if ((pchnl->tx_sem == NULL) || (pchnl->tx_mutex == NULL))
+    {
+        return -EIO;
+    }
 
-    size_t ux_count = ((UBaseType_t)XGMAC_NUM_TX_DESC) -
-            uxSemaphoreGetCount(hxgmac->tx_sem);
+    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
 
-    if (osal_semaphore_wait(hxgmac->tx_mutex, block_time_ticks) != pdFAIL)
+    /*
+     * Reserve the descriptors of each buffer. Only the first reservation may
+     * block, the rest of the burst is trimmed to the descriptors that are free
+     * right now
+     */
+    desc_count = dma_tx_desc_count(&dma_tx_bufs[0]);
+    if (dma_reserve_tx_desc(pchnl, desc_count, block_time_ticks) == false)
     {
-        pdma_tx_desc = &(hxgmac->tx_bd_ring[tail_indx]);
-        if (pdma_tx_desc == NULL)
+        ERROR("xgmac_dma_transmit: Time-out TX buffer not available.");
+        return -EIO;
+    }
+    num_slots += desc_count;
+    num_reserved++;
+    while (num_reserved < num_bufs)
+    {
+        desc_count = dma_tx_desc_count(&dma_tx_bufs[num_reserved]);
+        if (dma_reserve_tx_desc(pchnl, desc_count, 0U) == false)
         {
-            return -EINVAL;
+            break;
         }
+        num_slots += desc_count;
+        num_reserved++;
+    }
 
-        if (ux_count > 0UL)
+    if (osal_semaphore_wait(pchnl->tx_mutex, block_time_ticks) == pdFAIL)
+    {
+        while (num_slots > 0U)
         {
-            if ((tail_indx == head_indx) && (ux_count !=
-                    (uint32_t)XGMAC_NUM_TX_DESC))
-            {
-                return -EINVAL;
-            }
+            (void)osal_semaphore_post(pchnl->tx_sem);
+            num_slots--;
+        }
+        return -EIO;
+    }
 
-            *release_buffer = (uint8_t *)hxgmac->ptx_dma_buf1_ap[tail_indx];
+    /* Request the completion interrupt on the last descriptor once enough frames are queued */
+    pchnl->tx_coal_count += (uint16_t)num_reserved;
+    irq_on_completion = (pchnl->tx_coal_count >= hxgmac->coalesce.tx_frames);
+    if (irq_on_completion == true)
+    {
+        pchnl->tx_coal_count = 0U;
+    }
 
-            /* Reset all descriptor values */
-            pdma_tx_desc->des0 = 0;
-            pdma_tx_desc->des1 = 0;
-            pdma_tx_desc->des2 = 0;
-            pdma_tx_desc->des3 = 0;
+    head_indx = pchnl->tx_desc_head;
+    for (num_queued = 0U; num_queued < num_reserved; num_queued++)
+    {
+        if (dma_tx_bufs[num_queued].tso_mss != 0U)
+        {
+            head_indx = dma_fill_tso_descriptors(pchnl, head_indx,
+                    &dma_tx_bufs[num_queued],
+                    (irq_on_completion && (num_queued == (num_reserved - 1U))));
+            continue;
+        }
 
-            /* Issue synchronization barrier instruction */
-            __asm volatile ("DSB SY");
+        if (dma_tx_bufs[num_queued].num_segs != 0U)
+        {
+            head_indx = dma_fill_sg_descriptors(hxgmac, pchnl, head_indx,
+                    &dma_tx_bufs[num_queued],
+                    (irq_on_completion && (num_queued == (num_reserved - 1U))));
+            continue;
+        }
 
-            ux_count--;
+        dma_fill_tx_descriptor(hxgmac, pchnl, head_indx, &dma_tx_bufs[num_queued],
+                (irq_on_completion && (num_queued == (num_reserved - 1U))));
+
+        /* Point to next descriptor */
+        head_indx++;
+        if (head_indx == XGMAC_NUM_TX_DESC)
+        {
+            head_indx = 0;
+        }
+    }
+
+    /* Issue synchronization barrier instruction once for the whole burst */
+    XGMAC_DMA_BARRIER();
+
+    /* Update the TX-head index */
+    pchnl->tx_desc_head = head_indx;
+
+    /* Program the Tx Tail Pointer Register once for the whole burst */
+    last_tx_desc = (uint32_t)(uintptr_t)&(pchnl->tx_bd_ring[head_indx]);
+    WR_DMA_CHNL_REG32(dma_base_addr, chnl, XGMAC_DMA_CH_TXDESC_TAIL_LPOINTER,
+            last_tx_desc);
+
+    /* Release the Mutex. */
+    if (osal_semaphore_post(pchnl->tx_mutex) == false)
+    {
+        return -EIO;
+    }
+
+    return (int32_t)num_queued;
+}
+
+static void dma_rx_consume_ctxt(struct xgmac_chnl_desc_t *pchnl, int32_t indx)
+{
+    /* A context descriptor holds no data, its buffer is re-armed as is */
+    pchnl->rx_ctxt[indx] = 1U;
+    pchnl->rx_desc_tail = (indx + 1) % XGMAC_NUM_RX_DESC;
+    pchnl->rx_unfilled++;
+}
+
+static void dma_rx_read_timestamp(struct xgmac_chnl_desc_t *pchnl,
+        xgmac_rx_buf_t *dma_rx_buf)
+{
+    xgmac_buf_desc_t *pdma_rx_desc;
+    int32_t indx;
+    uint32_t poll;
+
+    indx = pchnl->rx_desc_tail;
+    pdma_rx_desc = &(pchnl->rx_bd_ring[indx]);
+
+    /* The context descriptor is written back shortly after the frame */
+    for (poll = 0U; poll < XGMAC_RX_CTXT_POLL_COUNT; poll++)
+    {
+        if ((pdma_rx_desc->des3 & XGMAC_RDES3_OWN) == 0U)
+        {
+            break;
+        }
+    }
+    if ((pdma_rx_desc->des3 & (XGMAC_RDES3_OWN | RDES3_NORM_WR_CTXT_MASK)) !=
+            RDES3_NORM_WR_CTXT_MASK)
+    {
+        /* Not there yet, it is skipped by a later receive */
+        return;
+    }
+
+    if ((pdma_rx_desc->des3 & (XGMAC_RDES3_CTXT_TSA_MASK |
+            XGMAC_RDES3_CTXT_TSD_MASK)) == XGMAC_RDES3_CTXT_TSA_MASK)
+    {
+        dma_rx_buf->timestamp.nsec = pdma_rx_desc->des0;
+        dma_rx_buf->timestamp.sec = pdma_rx_desc->des1;
+        dma_rx_buf->ts_valid = true;
+    }
+    dma_rx_consume_ctxt(pchnl, indx);
+}
+
+int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_rx_buf_t *dma_rx_buf)
+{
+    struct xgmac_chnl_desc_t *pchnl;
+    xgmac_buf_desc_t *pdma_rx_desc;
+    int32_t tail_indx;
+    uint8_t *pethernet_buffer;
+    BaseType_t received_packet_length;
+    BaseType_t dma_inv_length;
+    int32_t ret_status;
+
+    ret_status = 0;
+
+    if (chnl >= XGMAC_NUM_DMA_CHANNELS)
+    {
+        return -EINVAL;
+    }
+    pchnl = &(hxgmac->chnl[chnl]);
+    tail_indx = pchnl->rx_desc_tail;
+
+    /* Every descriptor is waiting for a refill, none can hold a new frame */
+    if (pchnl->rx_unfilled >= (uint32_t)XGMAC_NUM_RX_DESC)
+    {
+        return -EAGAIN;
+    }
+
+    pdma_rx_desc = &(pchnl->rx_bd_ring[tail_indx]);
+    if (pdma_rx_desc == NULL)
+    {
+        return -EINVAL;
+    }
+
+    /* Skip context descriptors that were late for their frame */
+    while ((pdma_rx_desc->des3 & (XGMAC_RDES3_OWN | RDES3_NORM_WR_CTXT_MASK)) ==
+            RDES3_NORM_WR_CTXT_MASK)
+    {
+        dma_rx_consume_ctxt(pchnl, tail_indx);
+        if (pchnl->rx_unfilled >= (uint32_t)XGMAC_NUM_RX_DESC)
+        {
+            return -EAGAIN;
+        }
+        tail_indx = pchnl->rx_desc_tail;
+        pdma_rx_desc = &(pchnl->rx_bd_ring[tail_indx]);
+    }
+
+    if ((pdma_rx_desc->des3 & XGMAC_RDES3_OWN) == 0u)
+    {
+        /* Parse the buffer address from RxBufAP Array  */
+        pethernet_buffer = pchnl->prx_dma_buf1_ap[tail_indx];
+        if (pethernet_buffer == NULL)
+        {
+            return -EINVAL;
+        }
+        /*
+         * The packet length is only written to the last buffer of a frame and
+         * counts the bytes of all its buffers
+         */
+        if ((pdma_rx_desc->des3 & RDES3_NORM_WR_FD_MASK) != 0U)
+        {
+            pchnl->rx_frame_len = 0U;
+        }
+        if ((pdma_rx_desc->des3 & RDES3_NORM_WR_LD_MASK) != 0U)
+        {
+            received_packet_length = (BaseType_t)((pdma_rx_desc->des3 &
+                    RDES3_NORM_WR_PL_MASK) - pchnl->rx_frame_len);
+            pchnl->rx_frame_len = 0U;
+        }
+        else
+        {
+            received_packet_length = (BaseType_t)hxgmac->rx_buf_size;
+            pchnl->rx_frame_len += hxgmac->rx_buf_size;
+        }
+        if(received_packet_length & 0x3f )
+        {
+            dma_inv_length = ((received_packet_length + (SOCFGPA_CACHE_LINE_WIDTH)) & ~(SOCFGPA_CACHE_LINE_WIDTH - 1U));
+            xgmac_invalidate_buffer((void *)(uintptr_t)pethernet_buffer, dma_inv_length);
+        }
+        else
+        {
+            xgmac_invalidate_buffer((void *)(uintptr_t)pethernet_buffer, received_packet_length);
+        }
+
+        dma_rx_buf->buf = pethernet_buffer;
+        dma_rx_buf->size = received_packet_length;
+        dma_rx_buf->packet_status = pdma_rx_desc->des3;
+
+        hxgmac->irq_stats.rx_packets++;
+
+        /* The descriptor is given back to the DMA by a later refill */
+        pchnl->rx_desc_tail = (tail_indx + 1) % XGMAC_NUM_RX_DESC;
+        pchnl->rx_unfilled++;
+
+        /* A timestamped frame is followed by a context descriptor */
+        dma_rx_buf->ts_valid = false;
+        if (((dma_rx_buf->packet_status & RDES3_NORM_WR_CDA_MASK) != 0U) &&
+                (pchnl->rx_unfilled < (uint32_t)XGMAC_NUM_RX_DESC))
+        {
+            dma_rx_read_timestamp(pchnl, dma_rx_buf);
+        }
+
+    }
+    else
+    {
+        ret_status = -EAGAIN;
+    }
+
+    return ret_status;
+}
+
+static xgmac_buf_desc_t *dma_arm_rx_descriptor(xgmac_handle_t hxgmac,
+        struct xgmac_chnl_desc_t *pchnl, uint8_t *buf)
+{
+    xgmac_buf_desc_t *pdma_rx_desc;
+    int32_t head_indx;
+
+    head_indx = pchnl->rx_desc_head;
+    pdma_rx_desc = &(pchnl->rx_bd_ring[head_indx]);
+
+    if (buf != NULL)
+    {
+        pdma_rx_desc->des0 = (uint32_t)(uintptr_t)buf;
+        pdma_rx_desc->des1 = (uint32_t)((uintptr_t)buf >> 32);
+
+        pchnl->prx_dma_buf1_ap[head_indx] = (uint8_t *)buf;
+    }
+    /*
+     * There is a possibility that the buffer is cached in L1 but not in L4.
+     * Since the peripherals use L4 cache, it could see stale data
+     */
+     xgmac_flush_buffer(buf, hxgmac->rx_buf_size);
+
+    /* Release descriptors to DMA */
+    pdma_rx_desc->des2 = 0;
+    pdma_rx_desc->des3 = 0;
+
+    /*
+     * Set Own bit of the Rx descriptor Status. With Rx coalescing only every
+     * rx_frames descriptor raises an interrupt, the Rx watchdog covers the rest
+     */
+    pchnl->rx_coal_count++;
+    if (pchnl->rx_coal_count >= hxgmac->coalesce.rx_frames)
+    {
+        pchnl->rx_coal_count = 0U;
+        pdma_rx_desc->des3 = XGMAC_RDES3_OWN | XGMAC_RDES3_IOC;
+    }
+    else
+    {
+        pdma_rx_desc->des3 = XGMAC_RDES3_OWN;
+    }
+
+    head_indx = (head_indx + 1) % XGMAC_NUM_RX_DESC;
+
+    pchnl->rx_desc_head = head_indx;
+    if (pchnl->rx_unfilled > 0U)
+    {
+        pchnl->rx_unfilled--;
+    }
+
+    return pdma_rx_desc;
+}
+
+static xgmac_buf_desc_t *dma_rearm_rx_ctxt(xgmac_handle_t hxgmac,
+        struct xgmac_chnl_desc_t *pchnl)
+{
+    xgmac_buf_desc_t *plast_desc = NULL;
+    int32_t head_indx;
+
+    head_indx = pchnl->rx_desc_head;
+    while ((pchnl->rx_ctxt[head_indx] != 0U) && (pchnl->rx_unfilled > 0U))
+    {
+        pchnl->rx_ctxt[head_indx] = 0U;
+        plast_desc = dma_arm_rx_descriptor(hxgmac, pchnl,
+                pchnl->prx_dma_buf1_ap[head_indx]);
+        head_indx = pchnl->rx_desc_head;
+    }
+
+    return plast_desc;
+}
+
+static xgmac_buf_desc_t *dma_fill_rx_descriptor(xgmac_handle_t hxgmac,
+        struct xgmac_chnl_desc_t *pchnl, uint8_t *buf)
+{
+    xgmac_buf_desc_t *pdma_rx_desc;
+    xgmac_buf_desc_t *pctxt_desc;
+
+    /* Context descriptors keep their buffer, only frames take a new one */
+    (void)dma_rearm_rx_ctxt(hxgmac, pchnl);
+    pdma_rx_desc = dma_arm_rx_descriptor(hxgmac, pchnl, buf);
+    pctxt_desc = dma_rearm_rx_ctxt(hxgmac, pchnl);
+
+    return (pctxt_desc != NULL) ? pctxt_desc : pdma_rx_desc;
+}
+
+int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t chnl, uint8_t *buf)
+{
+    return xgmac_refill_rx_descriptors(hxgmac, chnl, &buf, 1U);
+}
+
+int32_t xgmac_refill_rx_descriptors(xgmac_handle_t hxgmac, uint8_t chnl,
+        uint8_t *const *bufs, uint32_t num_bufs)
+{
+    struct xgmac_chnl_desc_t *pchnl;
+    xgmac_buf_desc_t *pdma_rx_desc = NULL;
+    xgmac_base_addr_t dma_base_addr;
+    uint32_t last_rx_desc;
+    uint32_t indx;
+
+    if ((hxgmac == NULL) || (chnl >= XGMAC_NUM_DMA_CHANNELS) ||
+            (bufs == NULL) || (num_bufs > (uint32_t)XGMAC_NUM_RX_DESC))
+    {
+        return -1;
+    }
+    pchnl = &(hxgmac->chnl[chnl]);
+
+    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
+    if ((dma_base_addr == 0U) || (pchnl->rx_bd_ring == NULL))
+    {
+        return -1;
+    }
+    if (num_bufs == 0U)
+    {
+        return 0;
+    }
+
+    for (indx = 0U; indx < num_bufs; indx++)
+    {
+        pdma_rx_desc = dma_fill_rx_descriptor(hxgmac, pchnl, bufs[indx]);
+    }
+
+    /* Make the descriptors visible before the DMA is told about them */
+    XGMAC_DMA_BARRIER();
+
+    /* Update the tail pointer register once for the whole batch */
+    /*
+     * Tail pointer should be always ahead of current pointer
+     * Setting the tail to recently processed descriptor gives better chance
+     * to avoid current catching up to tail (since it is a ring buffer)
+     */
+    last_rx_desc = (uint32_t)(uintptr_t)pdma_rx_desc;
+    WR_DMA_CHNL_REG32(dma_base_addr, chnl, XGMAC_DMA_CH_RXDESC_TAIL_LPOINTER,
+            last_rx_desc);
+
+    return 0;
+}
+
+int32_t xgmac_set_callback(xgmac_handle_t hxgmac, xgmac_callback_t callback, void *pcntxt)
+{
+    if (hxgmac == NULL)
+    {
+        return -EINVAL;
+    }
+
+    if (hxgmac->is_started != 0)
+    {
+        return -EBUSY;
+    }
+
+    hxgmac->callback = callback;
+    hxgmac->pcntxt = pcntxt;
+
+    return 0;
+}
+
+bool xgmac_dma_rx_pending(xgmac_handle_t hxgmac, uint8_t chnl)
+{
+    struct xgmac_chnl_desc_t *pchnl;
+    xgmac_buf_desc_t *pdma_rx_desc;
+
+    if ((hxgmac == NULL) || (chnl >= XGMAC_NUM_DMA_CHANNELS))
+    {
+        return false;
+    }
+
+    pchnl = &(hxgmac->chnl[chnl]);
+    if (pchnl->rx_bd_ring == NULL)
+    {
+        return false;
+    }
+
+    if (pchnl->rx_unfilled >= (uint32_t)XGMAC_NUM_RX_DESC)
+    {
+        return false;
+    }
+
+    pdma_rx_desc = &(pchnl->rx_bd_ring[pchnl->rx_desc_tail]);
+
+    return ((pdma_rx_desc->des3 & XGMAC_RDES3_OWN) == 0U);
+}
+
+static int32_t xgmac_set_rx_irq(xgmac_handle_t hxgmac, uint8_t chnl, bool enable)
+{
+    xgmac_base_addr_t dma_base_addr;
+    int32_t ll_ret;
+
+    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
+    if ((dma_base_addr == 0U) || (chnl >= XGMAC_NUM_DMA_CHANNELS))
+    {
+        return -EINVAL;
+    }
+
+    if (enable == true)
+    {
+        hxgmac->chnl[chnl].rx_irq_masked = false;
+        ll_ret = xgmac_enable_dma_interrupt(dma_base_addr, chnl, INTERRUPT_RI);
+    }
+    else
+    {
+        ll_ret = xgmac_disable_dma_interrupt(dma_base_addr, chnl, INTERRUPT_RI);
+        hxgmac->chnl[chnl].rx_irq_masked = true;
+    }
+
+    if (ll_ret != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EIO;
+    }
+    return 0;
+}
+
+static int32_t dma_set_rx_steering(xgmac_handle_t hxgmac, const
+        xgmac_rx_steering_t *psteer)
+{
+    xgmac_base_addr_t emac_base_addr;
+    uint8_t prio_mask[XGMAC_NUM_DMA_CHANNELS];
+    uint32_t key_word;
+    uint32_t entry;
+    uint8_t index;
+    uint8_t byte;
+    uint8_t chnl;
+
+    emac_base_addr = hxgmac->xgmac_inst_base_addr;
+    if (emac_base_addr == 0U)
+    {
+        return -EINVAL;
+    }
+
+    (void)memset(prio_mask, 0, sizeof(prio_mask));
+    if (psteer->mode == XGMAC_RX_STEER_VLAN_PRIO)
+    {
+        for (index = 0U; index < XGMAC_NUM_PRIORITIES; index++)
+        {
+            if (psteer->prio_to_chnl[index] >= XGMAC_NUM_DMA_CHANNELS)
+            {
+                return -EINVAL;
+            }
+            prio_mask[psteer->prio_to_chnl[index]] |= (uint8_t)(1U << index);
+        }
+    }
+    else if (psteer->mode == XGMAC_RX_STEER_FLOW_HASH)
+    {
+        if (xgmac_is_rss_supported(emac_base_addr) == false)
+        {
+            return -ENOTSUP;
+        }
+    }
+    else if (psteer->mode != XGMAC_RX_STEER_NONE)
+    {
+        return -EINVAL;
+    }
+
+    /*
+     * Each MTL Rx queue feeds the DMA channel of the same index. The user
+     * priority masks pick the queue, untagged frames stay on queue 0
+     */
+    xgmac_rss_enable(emac_base_addr, false);
+    for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+    {
+        xgmac_set_rxq_priority(emac_base_addr, chnl, prio_mask[chnl]);
+        xgmac_map_rxq_to_dma(emac_base_addr, chnl, chnl,
+                (psteer->mode == XGMAC_RX_STEER_FLOW_HASH));
+    }
+
+    if (psteer->mode != XGMAC_RX_STEER_FLOW_HASH)
+    {
+        return 0;
+    }
+
+    /* Four key bytes per register write, the first byte in the low bits */
+    for (index = 0U; index < (XGMAC_RSS_KEY_SIZE / 4U); index++)
+    {
+        key_word = 0U;
+        for (byte = 0U; byte < 4U; byte++)
+        {
+            key_word |= (uint32_t)psteer->rss_key[(index * 4U) + byte] << (byte * 8U);
+        }
+        if (xgmac_rss_write(emac_base_addr, true, index, key_word) !=
+                XGMAC_LL_RETVAL_SUCCESS)
+        {
+            return -EIO;
+        }
+    }
+
+    /* Spread the indirection table round robin over the channels */
+    for (entry = 0U; entry < XGMAC_RSS_TABLE_SIZE; entry++)
+    {
+        if (xgmac_rss_write(emac_base_addr, false, (uint8_t)entry,
+                entry % XGMAC_NUM_DMA_CHANNELS) != XGMAC_LL_RETVAL_SUCCESS)
+        {
+            return -EIO;
+        }
+    }
+
+    xgmac_rss_enable(emac_base_addr, true);
+
+    return 0;
+}
+
+static int32_t ptp_wait_command(xgmac_base_addr_t base_addr, uint32_t cmd_mask)
+{
+    uint32_t elapsed_time = 0U;
+
+    xgmac_ptp_command(base_addr, cmd_mask);
+    while (!xgmac_is_ptp_command_done(base_addr, cmd_mask))
+    {
+        if (elapsed_time >= XGMAC_PTP_CMD_TIMEOUT_MS)
+        {
+            return -EIO;
+        }
+        DELAY_MS(1);
+        elapsed_time += 1U;
+    }
+    return 0;
+}
+
+static int32_t ptp_enable(xgmac_handle_t hxgmac, bool enable)
+{
+    xgmac_base_addr_t base_addr;
+    uint32_t ssinc_ns;
+    int32_t ret;
+
+    base_addr = hxgmac->xgmac_inst_base_addr;
+    if (enable == false)
+    {
+        hxgmac->ts_enabled = false;
+        xgmac_ptp_config(base_addr, false, 0U);
+        return 0;
+    }
+
+    if (xgmac_is_timestamp_supported(base_addr) == false)
+    {
+        return -ENOTSUP;
+    }
+
+    /*
+     * The addend accumulator overflows at half the reference clock rate, each
+     * overflow adds two clock periods to the time. This leaves room in the
+     * addend to run the clock faster or slower than nominal
+     */
+    ssinc_ns = (2U * XGMAC_PTP_NSEC_PER_SEC) / XGMAC_PTP_REF_CLK_HZ;
+    hxgmac->ptp_addend = (uint32_t)(((uint64_t)XGMAC_PTP_NSEC_PER_SEC << 32) /
+            ((uint64_t)ssinc_ns * XGMAC_PTP_REF_CLK_HZ));
+
+    xgmac_ptp_config(base_addr, true, (uint8_t)ssinc_ns);
+    xgmac_ptp_write_addend(base_addr, hxgmac->ptp_addend);
+    ret = ptp_wait_command(base_addr, XGMAC_MAC_TIMESTAMP_CONTROL_TSADDREG_MASK);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    /* Start the system time from zero */
+    xgmac_ptp_write_update(base_addr, 0U, 0U, false);
+    ret = ptp_wait_command(base_addr, XGMAC_MAC_TIMESTAMP_CONTROL_TSINIT_MASK);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    hxgmac->ts_enabled = true;
+    return 0;
+}
+
+static int32_t xgmac_set_mtu(xgmac_handle_t hxgmac, const xgmac_mtu_config_t *mtu_config)
+{
+    uint32_t rx_buf_size;
+
+    if ((mtu_config->mtu < XGMAC_MIN_MTU) || (mtu_config->mtu > XGMAC_MAX_MTU))
+    {
+        return -EINVAL;
+    }
+
+    rx_buf_size = mtu_config->rx_buf_size;
+    if (rx_buf_size == 0U)
+    {
+        rx_buf_size = XGMAC_FRAME_SIZE(mtu_config->mtu);
+    }
+    if ((rx_buf_size < XGMAC_FRAME_SIZE(XGMAC_MIN_MTU)) ||
+            (rx_buf_size > XGMAC_MAX_RX_BUF_SIZE) ||
+            ((rx_buf_size % XGMAC_RX_BUF_ALIGN) != 0U))
+    {
+        return -EINVAL;
+    }
+
+    /* Buffers already given to the DMA were sized for the old setting */
+    if ((rx_buf_size != hxgmac->rx_buf_size) &&
+            (hxgmac->chnl[XGMAC_DMA_CH0].rx_bd_ring != NULL))
+    {
+        return -EBUSY;
+    }
+
+    hxgmac->rx_buf_size = rx_buf_size;
+    hxgmac->mtu = mtu_config->mtu;
+    if (hxgmac->is_started != 0)
+    {
+        mac_set_frame_limit(hxgmac);
+    }
+
+    return 0;
+}
+
+static void mac_read_mmc_stats(xgmac_base_addr_t base_addr, xgmac_mmc_stats_t *mmc)
+{
+    mmc->tx_octets = xgmac_mmc_read_counter(base_addr, XGMAC_TX_OCTET_COUNT_GOOD_BAD_LOW);
+    mmc->tx_packets = xgmac_mmc_read_counter(base_addr, XGMAC_TX_PACKET_COUNT_GOOD_BAD_LOW);
+    mmc->tx_broadcast = xgmac_mmc_read_counter(base_addr, XGMAC_TX_BROADCAST_PACKETS_GOOD_LOW);
+    mmc->tx_multicast = xgmac_mmc_read_counter(base_addr, XGMAC_TX_MULTICAST_PACKETS_GOOD_LOW);
+    mmc->tx_underflow = xgmac_mmc_read_counter(base_addr, XGMAC_TX_UNDERFLOW_ERROR_PACKETS_LOW);
+    mmc->tx_pause = xgmac_mmc_read_counter(base_addr, XGMAC_TX_PAUSE_PACKETS_LOW);
+
+    mmc->rx_octets = xgmac_mmc_read_counter(base_addr, XGMAC_RX_OCTET_COUNT_GOOD_BAD_LOW);
+    mmc->rx_packets = xgmac_mmc_read_counter(base_addr, XGMAC_RX_PACKET_COUNT_GOOD_BAD_LOW);
+    mmc->rx_broadcast = xgmac_mmc_read_counter(base_addr, XGMAC_RX_BROADCAST_PACKETS_GOOD_LOW);
+    mmc->rx_multicast = xgmac_mmc_read_counter(base_addr, XGMAC_RX_MULTICAST_PACKETS_GOOD_LOW);
+    mmc->rx_crc_errors = xgmac_mmc_read_counter(base_addr, XGMAC_RX_CRC_ERROR_PACKETS_LOW);
+    mmc->rx_length_errors = xgmac_mmc_read_counter(base_addr, XGMAC_RX_LENGTH_ERROR_PACKETS_LOW);
+    mmc->rx_out_of_range = xgmac_mmc_read_counter(base_addr, XGMAC_RX_OUTOFRANGE_PACKETS_LOW);
+    mmc->rx_fifo_overflow = xgmac_mmc_read_counter(base_addr, XGMAC_RX_FIFOOVERFLOW_PACKETS_LOW);
+    mmc->rx_pause = xgmac_mmc_read_counter(base_addr, XGMAC_RX_PAUSE_PACKETS_LOW);
+    mmc->rx_discarded = xgmac_mmc_read_counter(base_addr, XGMAC_RX_DISCARD_PACKETS_GOOD_BAD_LOW);
+
+    /* The error counters below are only 32 bits wide */
+    mmc->rx_runt = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_RUNT_ERROR_PACKETS);
+    mmc->rx_jabber = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_JABBER_ERROR_PACKETS);
+    mmc->rx_undersize = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_UNDERSIZE_PACKETS_GOOD);
+    mmc->rx_oversize = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_OVERSIZE_PACKETS_GOOD);
+    mmc->rx_watchdog = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_WATCHDOG_ERROR_PACKETS);
+    mmc->rx_alignment = xgmac_mmc_read_counter32(base_addr, XGMAC_RX_ALIGNMENT_ERROR_PACKETS);
+}
+
+int32_t xgmac_ioctl(xgmac_handle_t hxgmac, xgmac_ioctl_t cmd, void *buf)
+{
+    xgmac_coalesce_t *pcoalesce;
+    xgmac_irq_stats_t *pstats;
+    uint32_t num_packets;
+    uint8_t chnl;
+    int32_t result = 0;
+
+    if (hxgmac == NULL)
+    {
+        return -EINVAL;
+    }
+
+    switch (cmd)
+    {
+        case XGMAC_SET_COALESCE:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            pcoalesce = (xgmac_coalesce_t *)buf;
+
+            /* Without the watchdog a frame on a descriptor without IOC is never signalled */
+            if ((pcoalesce->rx_frames == 0U) || (pcoalesce->tx_frames == 0U) ||
+                    (pcoalesce->rx_frames > (uint16_t)XGMAC_NUM_RX_DESC) ||
+                    (pcoalesce->tx_frames > (uint16_t)XGMAC_NUM_TX_DESC) ||
+                    (pcoalesce->rx_watchdog_unit > 3U) ||
+                    ((pcoalesce->rx_frames > 1U) && (pcoalesce->rx_watchdog == 0U)))
+            {
+                result = -EINVAL;
+                break;
+            }
+            hxgmac->coalesce = *pcoalesce;
+            for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+            {
+                hxgmac->chnl[chnl].rx_coal_count = 0U;
+                hxgmac->chnl[chnl].tx_coal_count = 0U;
+
+                if (hxgmac->xgmac_inst_dma_base_addr != 0U)
+                {
+                    xgmac_set_rx_watchdog(hxgmac->xgmac_inst_dma_base_addr, chnl,
+                            pcoalesce->rx_watchdog, pcoalesce->rx_watchdog_unit);
+                }
+            }
+            break;
+
+        case XGMAC_GET_COALESCE:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            *(xgmac_coalesce_t *)buf = hxgmac->coalesce;
+            break;
+
+        case XGMAC_SET_RX_POLL_MODE:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            hxgmac->rx_poll_mode = *(bool *)buf;
+            for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+            {
+                if ((hxgmac->rx_poll_mode == false) &&
+                        (hxgmac->chnl[chnl].rx_irq_masked == true))
+                {
+                    result = xgmac_set_rx_irq(hxgmac, chnl, true);
+                }
+            }
+            break;
+
+        case XGMAC_ENABLE_RX_IRQ:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            result = xgmac_set_rx_irq(hxgmac, *(uint8_t *)buf, true);
+            break;
+
+        case XGMAC_DISABLE_RX_IRQ:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            result = xgmac_set_rx_irq(hxgmac, *(uint8_t *)buf, false);
+            break;
+
+        case XGMAC_SET_RX_STEERING:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            result = dma_set_rx_steering(hxgmac, (const xgmac_rx_steering_t *)buf);
+            break;
+
+        case XGMAC_SET_TSO:
+            if ((buf == NULL) || (hxgmac->xgmac_inst_dma_base_addr == 0U))
+            {
+                result = -EINVAL;
+                break;
+            }
+            if ((*(bool *)buf == true) &&
+                    (xgmac_is_tso_supported(hxgmac->xgmac_inst_base_addr) == false))
+            {
+                result = -ENOTSUP;
+                break;
+            }
+            hxgmac->tso_enabled = *(bool *)buf;
+            for (chnl = 0U; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
+            {
+                xgmac_set_dma_tso(hxgmac->xgmac_inst_dma_base_addr, chnl,
+                        hxgmac->tso_enabled);
+            }
+            break;
+
+        case XGMAC_SET_TIMESTAMPING:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            result = ptp_enable(hxgmac, *(bool *)buf);
+            break;
+
+        case XGMAC_SET_MTU:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            result = xgmac_set_mtu(hxgmac, (const xgmac_mtu_config_t *)buf);
+            break;
+
+        case XGMAC_GET_IRQ_STATS:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            pstats = (xgmac_irq_stats_t *)buf;
+            *pstats = hxgmac->irq_stats;
+
+            num_packets = pstats->rx_packets + pstats->tx_packets;
+            if (num_packets != 0U)
+            {
+                pstats->irqs_per_kpkt = (uint32_t)(((uint64_t)pstats->irq_count *
+                        1000U) / num_packets);
+            }
+            else
+            {
+                pstats->irqs_per_kpkt = 0U;
+            }
+            break;
+
+        case XGMAC_CLEAR_IRQ_STATS:
+            (void)memset(&(hxgmac->irq_stats), 0, sizeof(hxgmac->irq_stats));
+            break;
+
+        case XGMAC_GET_MMC_STATS:
+            if (buf == NULL)
+            {
+                result = -EINVAL;
+                break;
+            }
+            mac_read_mmc_stats(hxgmac->xgmac_inst_base_addr, (xgmac_mmc_stats_t *)buf);
+            break;
+
+        case XGMAC_CLEAR_MMC_STATS:
+            xgmac_mmc_reset_counters(hxgmac->xgmac_inst_base_addr);
+            break;
+
+        default:
+            result = -EINVAL;
+            break;
+    }
+
+    return result;
+}
+
+int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t chnl, uint8_t **release_buffer)
+{
+    struct xgmac_chnl_desc_t *pchnl;
+    int tail_indx;
+    int head_indx;
+    TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
+    int32_t ret_status;
+    bool last_desc;
+
+    ret_status = 0;
+
+    xgmac_buf_desc_t *pdma_tx_desc;
+
+    if (chnl >= XGMAC_NUM_DMA_CHANNELS)
+    {
+        return -EINVAL;
+    }
+    pchnl = &(hxgmac->chnl[chnl]);
+    tail_indx = pchnl->tx_desc_tail;
+    head_indx = pchnl->tx_desc_head;
+
+    size_t ux_count = ((UBaseType_t)XGMAC_NUM_TX_DESC) -
+            uxSemaphoreGetCount(pchnl->tx_sem);
+
+    if (osal_semaphore_wait(pchnl->tx_mutex, block_time_ticks) != pdFAIL)
+    {
+        pdma_tx_desc = &(pchnl->tx_bd_ring[tail_indx]);
+        if (pdma_tx_desc == NULL)
+        {
+            return -EINVAL;
+        }
+
+        if (ux_count > 0UL)
+        {
+            if ((tail_indx == head_indx) && (ux_count !=
+                    (uint32_t)XGMAC_NUM_TX_DESC))
+            {
+                (void)osal_semaphore_post(pchnl->tx_mutex);
+                return -EINVAL;
+            }
+
+            /* Descriptor still owned by the DMA, transmission not yet complete */
+            if ((pdma_tx_desc->des3 & TDES3_NORM_WR_OWN_MASK) != 0U)
+            {
+                (void)osal_semaphore_post(pchnl->tx_mutex);
+                return -EAGAIN;
+            }
+
+            *release_buffer = (uint8_t *)pchnl->ptx_dma_buf1_ap[tail_indx];
+            last_desc = ((pdma_tx_desc->des3 &
+                    (TDES3_NORM_WR_LD_MASK | TDES3_NORM_WR_CTXT_MASK)) ==
+                    TDES3_NORM_WR_LD_MASK);
+
+            /* The write-back of the last descriptor holds the Tx timestamp */
+            if (last_desc == true)
+            {
+                pchnl->tx_ts_valid = ((pdma_tx_desc->des3 & XGMAC_TDES3_WR_TTSS_MASK) != 0U);
+                if (pchnl->tx_ts_valid == true)
+                {
+                    pchnl->tx_ts.nsec = pdma_tx_desc->des0;
+                    pchnl->tx_ts.sec = pdma_tx_desc->des1;
+                }
+            }
+
+            /* Reset all descriptor values */
+            pdma_tx_desc->des0 = 0;
+            pdma_tx_desc->des1 = 0;
+            pdma_tx_desc->des2 = 0;
+            pdma_tx_desc->des3 = 0;
+
+            /* Issue synchronization barrier instruction */
+            XGMAC_DMA_BARRIER();
+
+            ux_count--;
+
+            /* A TSO frame spans several descriptors, count it once */
+            if (last_desc == true)
+            {
+                hxgmac->irq_stats.tx_packets++;
+            }
 
             /* Give back counting semaphore */
-            if (osal_semaphore_post(hxgmac->tx_sem) == false)
+            if (osal_semaphore_post(pchnl->tx_sem) == false)
             {
                 ret_status = -EIO;
             }
@@ -631,14 +1705,14 @@ int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer)
                 tail_indx = 0;
             }
 
-            hxgmac->tx_desc_tail = tail_indx;
+            pchnl->tx_desc_tail = tail_indx;
         }
         else
         {
             ret_status = -EAGAIN;
         }
 
-        if (osal_semaphore_post(hxgmac->tx_mutex) == false)
+        if (osal_semaphore_post(pchnl->tx_mutex) == false)
         {
             ret_status = -EIO;
         }
@@ -651,6 +1725,110 @@ int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer)
     return ret_status;
 }
 
+int32_t xgmac_get_tx_timestamp(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (chnl >= XGMAC_NUM_DMA_CHANNELS) || (ts == NULL))
+    {
+        return -EINVAL;
+    }
+
+    if (hxgmac->chnl[chnl].tx_ts_valid == false)
+    {
+        return -ENODATA;
+    }
+
+    *ts = hxgmac->chnl[chnl].tx_ts;
+    return 0;
+}
+
+int32_t xgmac_ptp_get_time(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (ts == NULL))
+    {
+        return -EINVAL;
+    }
+    if (hxgmac->ts_enabled == false)
+    {
+        return -EPERM;
+    }
+
+    xgmac_ptp_read_time(hxgmac->xgmac_inst_base_addr, &(ts->sec), &(ts->nsec));
+    return 0;
+}
+
+int32_t xgmac_ptp_set_time(xgmac_handle_t hxgmac, const xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (ts == NULL) || (ts->sec > UINT32_MAX) ||
+            (ts->nsec >= XGMAC_PTP_NSEC_PER_SEC))
+    {
+        return -EINVAL;
+    }
+    if (hxgmac->ts_enabled == false)
+    {
+        return -EPERM;
+    }
+
+    xgmac_ptp_write_update(hxgmac->xgmac_inst_base_addr, (uint32_t)ts->sec,
+            ts->nsec, false);
+    return ptp_wait_command(hxgmac->xgmac_inst_base_addr,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSINIT_MASK);
+}
+
+int32_t xgmac_ptp_adj_time(xgmac_handle_t hxgmac, int64_t delta_ns)
+{
+    uint64_t abs_ns;
+    uint32_t sec;
+    uint32_t nsec;
+    bool subtract;
+
+    if (hxgmac == NULL)
+    {
+        return -EINVAL;
+    }
+    if (hxgmac->ts_enabled == false)
+    {
+        return -EPERM;
+    }
+
+    subtract = (delta_ns < 0);
+    abs_ns = (subtract == true) ? (uint64_t)(-delta_ns) : (uint64_t)delta_ns;
+    sec = (uint32_t)(abs_ns / XGMAC_PTP_NSEC_PER_SEC);
+    nsec = (uint32_t)(abs_ns % XGMAC_PTP_NSEC_PER_SEC);
+
+    /* With the nanosecond rollover a subtraction is programmed as a complement */
+    if (subtract == true)
+    {
+        sec = (uint32_t)(0U - sec);
+        nsec = XGMAC_PTP_NSEC_PER_SEC - nsec;
+    }
+
+    xgmac_ptp_write_update(hxgmac->xgmac_inst_base_addr, sec, nsec, subtract);
+    return ptp_wait_command(hxgmac->xgmac_inst_base_addr,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSUPDT_MASK);
+}
+
+int32_t xgmac_ptp_adj_freq(xgmac_handle_t hxgmac, int32_t ppb)
+{
+    int64_t addend;
+
+    if ((hxgmac == NULL) || (ppb > XGMAC_PTP_MAX_ADJ_PPB) ||
+            (ppb < -XGMAC_PTP_MAX_ADJ_PPB))
+    {
+        return -EINVAL;
+    }
+    if (hxgmac->ts_enabled == false)
+    {
+        return -EPERM;
+    }
+
+    addend = (int64_t)hxgmac->ptp_addend;
+    addend += (addend * ppb) / (int64_t)XGMAC_PTP_NSEC_PER_SEC;
+
+    xgmac_ptp_write_addend(hxgmac->xgmac_inst_base_addr, (uint32_t)addend);
+    return ptp_wait_command(hxgmac->xgmac_inst_base_addr,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSADDREG_MASK);
+}
+
 static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr)
 {
     uint8_t elapsed_time = 0;
@@ -676,66 +1854,82 @@ static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr)
 static Basetype_t dma_set_descriptors(xgmac_handle_t hxgmac)
 
 {
-    /* Initialize the Tx and Rx Head and Tail to 0*/
-    hxgmac->tx_desc_head = 0;
-    hxgmac->rx_desc_head = 0;
+    struct xgmac_chnl_desc_t *pchnl;
+    uint8_t chnl;
 
-    hxgmac->tx_desc_tail = 0;
-    hxgmac->rx_desc_tail = 0;
-
-    /* Create Descriptor list for Tx and Rx */
-    if (hxgmac->tx_bd_ring == NULL)
+    for (chnl = 0; chnl < XGMAC_NUM_DMA_CHANNELS; chnl++)
     {
-        hxgmac->tx_bd_ring = hxgmac->axBufferDescTx;
-    }
+        pchnl = &hxgmac->chnl[chnl];
 
-    if (hxgmac->rx_bd_ring == NULL)
-    {
-        hxgmac->rx_bd_ring = hxgmac->axBufferDescRx;
-    }
+        /* Initialize the Tx and Rx Head and Tail to 0*/
+        pchnl->tx_desc_head = 0;
+        pchnl->rx_desc_head = 0;
 
-    /* Set all field values to zero */
-    (void)memset(hxgmac->tx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
-    (void)memset(hxgmac->rx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
+        pchnl->tx_desc_tail = 0;
+        pchnl->rx_desc_tail = 0;
+        pchnl->rx_unfilled = 0U;
+        pchnl->rx_frame_len = 0U;
+        (void)memset(pchnl->rx_ctxt, 0, sizeof(pchnl->rx_ctxt));
+        pchnl->tx_ts_valid = false;
 
-    /* Setup Tx Descriptor Table Parameters */
-    dma_setup_tx_descriptor_list(hxgmac);
+        pchnl->rx_coal_count = 0;
+        pchnl->tx_coal_count = 0;
+        pchnl->rx_irq_masked = false;
 
-    /* Create the Tx Buffer Descriptor Semaphore  */
-    if (hxgmac->tx_sem == NULL)
-    {
-        hxgmac->tx_sem =
-                osal_semaphore_counting_create(NULL, (UBaseType_t)XGMAC_NUM_TX_DESC,
-                (UBaseType_t)XGMAC_NUM_TX_DESC);
-        configASSERT(hxgmac->tx_sem != NULL);
-    }
+        /* Create Descriptor list for Tx and Rx */
+        if (pchnl->tx_bd_ring == NULL)
+        {
+            pchnl->tx_bd_ring = pchnl->axBufferDescTx;
+        }
 
-    /* Create the Tx Descriptor Mutex   */
-    if (hxgmac->tx_mutex == NULL)
-    {
-        hxgmac->tx_mutex = osal_mutex_create(NULL);
-        configASSERT(hxgmac->tx_mutex != NULL);
-    }
+        if (pchnl->rx_bd_ring == NULL)
+        {
+            pchnl->rx_bd_ring = pchnl->axBufferDescRx;
+        }
+
+        /* Set all field values to zero */
+        (void)memset(pchnl->tx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
+        (void)memset(pchnl->rx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
+
+        /* Setup Tx Descriptor Table Parameters */
+        dma_setup_tx_descriptor_list(pchnl);
 
-    /* Setup Rx Descriptor Table Parameters */
-    dma_setup_rx_descriptor_list(hxgmac);
+        /* Create the Tx Buffer Descriptor Semaphore  */
+        if (pchnl->tx_sem == NULL)
+        {
+            pchnl->tx_sem =
+                    osal_semaphore_counting_create(NULL, (UBaseType_t)XGMAC_NUM_TX_DESC,
+                    (UBaseType_t)XGMAC_NUM_TX_DESC);
+            configASSERT(pchnl->tx_sem != NULL);
+        }
+
+        /* Create the Tx Descriptor Mutex   */
+        if (pchnl->tx_mutex == NULL)
+        {
+            pchnl->tx_mutex = osal_mutex_create(NULL);
+            configASSERT(pchnl->tx_mutex != NULL);
+        }
+
+        /* Setup Rx Descriptor Table Parameters */
+        dma_setup_rx_descriptor_list(pchnl);
+    }
 
     return true;
 }
 
-void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac)
+void dma_setup_tx_descriptor_list(struct xgmac_chnl_desc_t *pchnl)
 {
     xgmac_buf_desc_t *pdma_descriptor;
     int16_t index;
 
     /* Initialize the Tx buffer descriptor pointer */
-    pdma_descriptor = hxgmac->tx_bd_ring;
+    pdma_descriptor = pchnl->tx_bd_ring;
 
     /* Initialize the Tx buffer descriptor parameters - Desc0, Desc1, Desc2, Desc3 */
     for (index = 0; index < XGMAC_NUM_TX_DESC; index++)
     {
         /* Initialize Buffer1 address pointer in Handle TxDMA Buffer Pointer Array to NULL */
-        hxgmac->ptx_dma_buf1_ap[index] = NULL;
+        pchnl->ptx_dma_buf1_ap[index] = NULL;
 
         /* Initialize all Descriptors to 0 */
         pdma_descriptor[index].des0 = 0;
@@ -745,19 +1939,19 @@ void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac)
     }
 }
 
-void dma_setup_rx_descriptor_list(xgmac_handle_t hxgmac)
+void dma_setup_rx_descriptor_list(struct xgmac_chnl_desc_t *pchnl)
 {
     xgmac_buf_desc_t *pdma_descriptor;
     int16_t index;
 
     /* Initialize the Rx buffer descriptor pointer */
-    pdma_descriptor = hxgmac->rx_bd_ring;
+    pdma_descriptor = pchnl->rx_bd_ring;
 
     /* Initialize the Rx buffer descriptor parameters - Desc0, Desc1, Desc2, Desc3 */
     for (index = 0; index < XGMAC_NUM_RX_DESC; index++)
     {
         /* Initialize Buffer1 address pointer in Handle RxDMA Buffer Pointer Array to NULL */
-        hxgmac->prx_dma_buf1_ap[index] = NULL;
+        pchnl->prx_dma_buf1_ap[index] = NULL;
 
         /* Initialize all Descriptors to 0. These will be set in Refill Descriptor */
         pdma_descriptor[index].des0 = 0;
@@ -773,7 +1967,7 @@ static void dma_channel_init(xgmac_handle_t hxgmac, const
     xgmac_dma_desc_addr_t dma_desc_addr_params;
     xgmac_buf_desc_t *pax_buffer_desc_tx;
     xgmac_buf_desc_t *pax_buffer_desc_rx;
-    uint8_t dma_ch_index = XGMAC_DMA_CH0;
+    uint8_t dma_ch_index;
 
     dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
     if (dma_base_addr == 0U)
@@ -781,34 +1975,46 @@ static void dma_channel_init(xgmac_handle_t hxgmac, const
         return;
     }
 
-    /* Program the DMA channel Descriptor Registers */
-    pax_buffer_desc_tx = hxgmac->tx_bd_ring;
-    pax_buffer_desc_rx = hxgmac->rx_bd_ring;
-
-    dma_desc_addr_params.tx_ring_len = (uint32_t)(XGMAC_NUM_TX_DESC - 1);
-    dma_desc_addr_params.rx_ring_len = (uint32_t)(XGMAC_NUM_RX_DESC - 1);
-    dma_desc_addr_params.tx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_tx;
-    dma_desc_addr_params.tx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_tx >> 32);
-    dma_desc_addr_params.rx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_rx;
-    dma_desc_addr_params.rx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_rx >> 32);
-    dma_desc_addr_params.tx_last_desc_addr =
-            (uint32_t)(uintptr_t)&(pax_buffer_desc_tx[XGMAC_NUM_TX_DESC -
-            1]);
-    dma_desc_addr_params.rx_last_desc_addr =
-            (uint32_t)(uintptr_t)&(pax_buffer_desc_rx[XGMAC_NUM_RX_DESC -
-            1]);
-
-    /* Set DMA Tx/Rx Descriptor Address */
-    xgmac_init_dma_channel_desc_reg(dma_base_addr, dma_ch_index, &dma_desc_addr_params);
-
-    if (dma_base_addr == 0U)
+    for (dma_ch_index = 0; dma_ch_index < XGMAC_NUM_DMA_CHANNELS; dma_ch_index++)
     {
-        return;
+        /* Program the DMA channel Descriptor Registers */
+        pax_buffer_desc_tx = hxgmac->chnl[dma_ch_index].tx_bd_ring;
+        pax_buffer_desc_rx = hxgmac->chnl[dma_ch_index].rx_bd_ring;
+
+        dma_desc_addr_params.tx_ring_len = (uint32_t)(XGMAC_NUM_TX_DESC - 1);
+        dma_desc_addr_params.rx_ring_len = (uint32_t)(XGMAC_NUM_RX_DESC - 1);
+        dma_desc_addr_params.tx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_tx;
+        dma_desc_addr_params.tx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_tx >> 32);
+        dma_desc_addr_params.rx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_rx;
+        dma_desc_addr_params.rx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_rx >> 32);
+        dma_desc_addr_params.tx_last_desc_addr =
+                (uint32_t)(uintptr_t)&(pax_buffer_desc_tx[XGMAC_NUM_TX_DESC -
+                1]);
+        dma_desc_addr_params.rx_last_desc_addr =
+                (uint32_t)(uintptr_t)&(pax_buffer_desc_rx[XGMAC_NUM_RX_DESC -
+                1]);
+
+        /* Set DMA Tx/Rx Descriptor Address */
+        xgmac_init_dma_channel_desc_reg(dma_base_addr, dma_ch_index, &dma_desc_addr_params);
+
+        /* Program  DMA channel Control Settings */
+        xgmac_config_dma_channel_control(dma_base_addr, dma_ch_index, (const
+                xgmacdma_chanl_config_t *)(uintptr_t)xgmac_dev_config->
+                dma_channel_config);
+
+        /* Buffers are sized by XGMAC_SET_MTU rather than the static configuration */
+        xgmac_set_dma_rx_buf_size(dma_base_addr, dma_ch_index, hxgmac->rx_buf_size);
+
+        /* The DMA reset clears TSE, restore it when TSO was enabled */
+        if (hxgmac->tso_enabled == true)
+        {
+            xgmac_set_dma_tso(dma_base_addr, dma_ch_index, true);
+        }
+
+        /* Restore the Rx watchdog, the DMA reset clears it */
+        xgmac_set_rx_watchdog(dma_base_addr, dma_ch_index,
+                hxgmac->coalesce.rx_watchdog, hxgmac->coalesce.rx_watchdog_unit);
     }
-    /* Program  DMA channel Control Settings */
-    xgmac_config_dma_channel_control(dma_base_addr, dma_ch_index, (const
-            xgmacdma_chanl_config_t *)(uintptr_t)xgmac_dev_config->
-            dma_channel_config);
 }
 
 static Basetype_t dma_enable_interrupts(xgmac_handle_t hxgmac, const
@@ -885,78 +2091,129 @@ static Basetype_t dma_register_isr(xgmac_handle_t hxgmac)
     return true;
 }
 
-void socfpga_xgmac_dma_isr(void *param)
+static void dma_chnl_isr(xgmac_handle_t hxgmac, uint8_t dmachnum)
 {
-    xgmac_handle_t hxgmac = (xgmac_handle_t)param;
     xgmac_base_addr_t dma_base_addr;
-    xgmac_dma_interrupt_id_t id;
+    struct xgmac_chnl_desc_t *pchnl;
+    xgmac_err_info_t *pIntData = (xgmac_err_info_t *)hxgmac->pcntxt;
     xgmac_err_t err_type = XGMAC_ERR_UNHANDLED;
-    xgmac_int_status_t int_status = XGMAC_ERR_EVENT;
     uint32_t base_dma_chnl_address;
-    uint8_t dmachnum;
+    uint32_t status;
+    bool error_reported = true;
 
     dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
-    dmachnum = XGMAC_DMA_CH0;
+    pchnl = &(hxgmac->chnl[dmachnum]);
     base_dma_chnl_address = ((uint32_t)(uintptr_t)dma_base_addr +
             XGMAC_DMA_CHANNEL_BASE +
             ((uint32_t)dmachnum * XGMAC_DMA_CHANNEL_INC));
 
-    id = check_and_clear_xgmac_interrupt_status(base_dma_chnl_address);
+    /*
+     * Transmit and receive completions can be pending together, more so with
+     * coalescing. Report every event found in the status, not just the first
+     */
+    status = xgmac_get_and_clear_dma_status(base_dma_chnl_address);
 
-    switch (id)
+    /* The callback reads the channel of every event from the context */
+    if (pIntData != NULL)
     {
-        case INTERRUPT_TI:
-            int_status = XGMAC_TX_DONE_EVENT;
-            break;
+        pIntData->err_ch = dmachnum;
+    }
 
-        case INTERRUPT_RI:
-            int_status = XGMAC_RX_EVENT;
-            break;
+    if ((status & XGMAC_DMA_INTR_MASK_TI) != 0U)
+    {
+        hxgmac->irq_stats.tx_irq_count++;
+        if (hxgmac->callback != NULL)
+        {
+            hxgmac->callback(XGMAC_TX_DONE_EVENT, hxgmac->pcntxt);
+        }
+    }
 
-        case INTERRUPT_FBE:
-        case INTERRUPT_TXS:
-        case INTERRUPT_RBU:
-        case INTERRUPT_RS:
-        case INTERRUPT_DDE:
-        case INTERRUPT_UNHANDLED:
-            {
-                xgmac_err_info_t *pIntData = (xgmac_err_info_t *)hxgmac->pcntxt;
-                int_status = XGMAC_ERR_EVENT;
+    if (((status & XGMAC_DMA_INTR_MASK_RI) != 0U) && (pchnl->rx_irq_masked == false))
+    {
+        /* In poll mode the application re-enables RI once the ring is drained */
+        if (hxgmac->rx_poll_mode == true)
+        {
+            (void)xgmac_disable_dma_interrupt(dma_base_addr, dmachnum, INTERRUPT_RI);
+            pchnl->rx_irq_masked = true;
+        }
+        hxgmac->irq_stats.rx_irq_count++;
+        if (hxgmac->callback != NULL)
+        {
+            hxgmac->callback(XGMAC_RX_EVENT, hxgmac->pcntxt);
+        }
+    }
 
-                /* Re-mapping the error type to handle in the Network Interface Layer */
-                switch (id)
-                {
-                    case INTERRUPT_FBE:
-                        err_type = XGMAC_ERR_FATAL_BUS;
-                        break;
-                    case INTERRUPT_TXS:
-                        err_type = XGMAC_ERR_TX_STOPPED;
-                        break;
-                    case INTERRUPT_RBU:
-                        err_type = XGMAC_ERR_RX_BUF_UNAVAILABLE;
-                        break;
-                    case INTERRUPT_RS:
-                        err_type = XGMAC_ERR_RX_STOPPED;
-                        break;
-                    case INTERRUPT_DDE:
-                        err_type = XGMAC_ERR_DESC_DEFINE;
-                        break;
-                    default: /*do nothing*/
-                        break;
-                }
+    /* Re-mapping the error type to handle in the Network Interface Layer */
+    if ((status & XGMAC_DMA_INTR_MASK_FBE) != 0U)
+    {
+        err_type = XGMAC_ERR_FATAL_BUS;
+    }
+    else if ((status & XGMAC_DMA_INTR_MASK_TXS) != 0U)
+    {
+        err_type = XGMAC_ERR_TX_STOPPED;
+    }
+    else if ((status & XGMAC_DMA_INTR_MASK_RBU) != 0U)
+    {
+        err_type = XGMAC_ERR_RX_BUF_UNAVAILABLE;
+    }
+    else if ((status & XGMAC_DMA_INTR_MASK_RS) != 0U)
+    {
+        err_type = XGMAC_ERR_RX_STOPPED;
+    }
+    else if ((status & XGMAC_DMA_INTR_MASK_DDE) != 0U)
+    {
+        err_type = XGMAC_ERR_DESC_DEFINE;
+    }
+    else if ((status & XGMAC_DMA_INTR_MASK_CDE) != 0U)
+    {
+        err_type = XGMAC_ERR_CNTXT_DESC;
+    }
+    else if ((status & (XGMAC_DMA_INTR_MASK_TI | XGMAC_DMA_INTR_MASK_RI)) != 0U)
+    {
+        /* Only normal events, already reported above */
+        error_reported = false;
+    }
+    else
+    {
+        /* Nothing recognised in the status, report it as unhandled */
+        err_type = XGMAC_ERR_UNHANDLED;
+    }
 
-                pIntData->err_ch = dmachnum;
-                pIntData->err_type = (uint8_t)err_type;
-                break;
-            }
+    if (error_reported == true)
+    {
+        hxgmac->irq_stats.err_irq_count++;
+        if ((hxgmac->callback != NULL) && (pIntData != NULL))
+        {
+            pIntData->err_type = (uint8_t)err_type;
+            hxgmac->callback(XGMAC_ERR_EVENT, hxgmac->pcntxt);
+        }
+    }
+}
 
-        default: /*do nothing*/
-            break;
+void socfpga_xgmac_dma_isr(void *param)
+{
+    xgmac_handle_t hxgmac = (xgmac_handle_t)param;
+    uint32_t chnl_status;
+    uint8_t dmachnum;
+
+    hxgmac->irq_stats.irq_count++;
+
+    /*
+     * All DMA channels share one interrupt line. DMA_Interrupt_Status has a
+     * bit per channel, so only the channels with an event are serviced
+     */
+    chnl_status = RD_REG32((uint32_t)(uintptr_t)hxgmac->xgmac_inst_base_addr +
+            XGMAC_DMA_INTERRUPT_STATUS);
+    for (dmachnum = 0U; dmachnum < XGMAC_NUM_DMA_CHANNELS; dmachnum++)
+    {
+        if ((chnl_status & (1UL << dmachnum)) != 0U)
+        {
+            dma_chnl_isr(hxgmac, dmachnum);
+        }
     }
 
     if (hxgmac->callback != NULL)
     {
-        hxgmac->callback(int_status, hxgmac->pcntxt);
         check_and_clear_link_interrupt_status((uint32_t)((uintptr_t)hxgmac
                 ->xgmac_inst_base_addr));
     }
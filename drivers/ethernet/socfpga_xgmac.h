@@ -38,6 +38,11 @@ extern "C"
  * - Supports 10/100 Mbps Ethernet
  * - Link status detection and monitoring
  * - IPv4 and IPv6 compatible
+ * - Multiple DMA channels with VLAN priority or RSS flow hash receive steering
+ * - TCP segmentation offload for IPv4
+ * - Scatter-gather transmit of frames split over several buffers
+ * - IEEE 1588 hardware timestamps of received and transmitted frames
+ * - Jumbo frames with an MTU of up to 9000 bytes
  *
  * The driver is normally not used directly. It is used indirectly via the
  * tcp/ip stack.
@@ -89,7 +94,32 @@ extern "C"
 #define XGMAC_PACKET_SIZE        1536U            /*!< Standard Ethernet packet size */
 #define XGMAC_DMA_ALIGN_BYTES    64U             /*!< DMA alignment size in bytes */
 #define XGMAC_MAX_PACKET_SIZE    (XGMAC_PACKET_SIZE + XGMAC_DMA_ALIGN_BYTES)            /*!< Max packet size including alignment */
+#define XGMAC_STD_MTU            1500U      /*!< Standard Ethernet MTU */
+#define XGMAC_MIN_MTU            68U        /*!< Smallest MTU accepted by XGMAC_SET_MTU */
+#define XGMAC_MAX_MTU            9000U      /*!< Largest jumbo frame MTU */
+#define XGMAC_FRAME_OVERHEAD     22U        /*!< Ethernet header, VLAN tag and FCS */
+#define XGMAC_MAX_RX_BUF_SIZE    0x3FF0U    /*!< Largest receive buffer the DMA can be given */
+#define XGMAC_RX_BUF_ALIGN       16U        /*!< Receive buffer sizes are a multiple of this */
+/*!< Frame buffer size for an MTU, XGMAC_FRAME_SIZE(XGMAC_STD_MTU) is XGMAC_PACKET_SIZE */
+#define XGMAC_FRAME_SIZE(mtu)    ((((mtu) + XGMAC_FRAME_OVERHEAD) + (XGMAC_DMA_ALIGN_BYTES - 1U)) & \
+        ~(XGMAC_DMA_ALIGN_BYTES - 1U))
+/*!< Buffer size for an MTU including alignment, XGMAC_BUF_SIZE(XGMAC_STD_MTU) is XGMAC_MAX_PACKET_SIZE */
+#define XGMAC_BUF_SIZE(mtu)      (XGMAC_FRAME_SIZE(mtu) + XGMAC_DMA_ALIGN_BYTES)
 #define XGMAC_DMA_CH0            0U         /*!< DMA channel 0 */
+#define XGMAC_MAX_DMA_CHANNELS   8U         /*!< Number of DMA channels and MTL queues in the IP */
+#ifndef XGMAC_NUM_DMA_CHANNELS
+#define XGMAC_NUM_DMA_CHANNELS   1U         /*!< DMA channels in use, each with its own descriptor rings and MTL queue */
+#endif
+#define XGMAC_NUM_PRIORITIES     8U         /*!< Number of VLAN user priorities */
+#define XGMAC_RSS_KEY_SIZE       40U        /*!< Size of the RSS hash key in bytes */
+#define XGMAC_TSO_MAX_PAYLOAD    0x3FFFFU   /*!< Largest TCP payload of a single TSO buffer */
+#define XGMAC_TSO_MAX_MSS        0x3FFFU    /*!< Largest segment size for TSO */
+#define XGMAC_TX_MAX_SEGS        16U        /*!< Most buffers gathered into one frame */
+#define XGMAC_TX_MAX_SEG_SIZE    0x3FFFU    /*!< Largest buffer of a gathered frame */
+
+#ifndef XGMAC_PTP_REF_CLK_HZ
+#define XGMAC_PTP_REF_CLK_HZ     250000000U /*!< PTP reference clock driving the system time */
+#endif
 
 /*!< Receive Descriptor RDES3 Bitmasks */
 #define XGMAC_RDES3_OWN          BIT(31)            /*!< Ownership bit */
@@ -133,6 +163,36 @@ typedef enum
     XGMAC_ERR_CNTXT_DESC,             /*!< Context Descriptor Error  */
     XGMAC_ERR_UNHANDLED,               /*!< Unhandled Interrupt  */
 } xgmac_err_t;
+
+/**
+ * @brief Ioctl requests for the XGMAC driver
+ */
+typedef enum
+{
+    XGMAC_SET_COALESCE,        /*!< Set the interrupt coalescing thresholds, the data type is xgmac_coalesce_t. */
+    XGMAC_GET_COALESCE,        /*!< Get the interrupt coalescing thresholds, the data type is xgmac_coalesce_t. */
+    XGMAC_SET_RX_POLL_MODE,    /*!< Mask the receive interrupt in the ISR each time it is reported, the data type is bool. */
+    XGMAC_ENABLE_RX_IRQ,       /*!< Unmask the receive interrupt of a DMA channel, the data type is uint8_t. */
+    XGMAC_DISABLE_RX_IRQ,      /*!< Mask the receive interrupt of a DMA channel, the data type is uint8_t. */
+    XGMAC_SET_RX_STEERING,     /*!< Select how received frames are spread over the DMA channels, the data type is xgmac_rx_steering_t. */
+    XGMAC_SET_TSO,             /*!< Enable TCP segmentation offload on all DMA channels, the data type is bool. */
+    XGMAC_SET_TIMESTAMPING,    /*!< Enable hardware timestamps and start the system time, the data type is bool. */
+    XGMAC_SET_MTU,             /*!< Set the MTU and the receive buffer size, the data type is xgmac_mtu_config_t. */
+    XGMAC_GET_IRQ_STATS,       /*!< Get the interrupt statistics, the data type is xgmac_irq_stats_t. */
+    XGMAC_CLEAR_IRQ_STATS,     /*!< Clear the interrupt statistics, no data. */
+    XGMAC_GET_MMC_STATS,       /*!< Read the MAC management counters, the data type is xgmac_mmc_stats_t. */
+    XGMAC_CLEAR_MMC_STATS,     /*!< Reset the MAC management counters, no data. */
+} xgmac_ioctl_t;
+
+/**
+ * @brief Receive steering modes
+ */
+typedef enum
+{
+    XGMAC_RX_STEER_NONE,        /*!< All frames are received on DMA channel 0 */
+    XGMAC_RX_STEER_VLAN_PRIO,   /*!< Tagged frames are steered by their VLAN user priority */
+    XGMAC_RX_STEER_FLOW_HASH,   /*!< Frames are steered by the RSS hash of their IPv4 and TCP/UDP header */
+} xgmac_rx_steer_mode_t;
 /**
  * @}
  */
@@ -144,7 +204,7 @@ typedef enum
 typedef struct
 {
     uint8_t err_type;       /*!< Error Code for Error Handling and Reporting */
-    uint8_t err_ch; /*!< DMA Error channel Number */
+    uint8_t err_ch; /*!< DMA channel Number of the reported event */
 
 } xgmac_err_info_t;
 
@@ -159,20 +219,167 @@ typedef struct
     uint32_t des3;   /*!< Descriptor word 3 */
 } xgmac_buf_desc_t;
 
+/**
+ * @brief  XGMAC system time or frame timestamp
+ */
+typedef struct
+{
+    uint64_t sec;       /*!< Seconds */
+    uint32_t nsec;      /*!< Nanoseconds, below one billion */
+} xgmac_timestamp_t;
+
+/**
+ * @brief  XGMAC transmit segment, one piece of a gathered frame
+ */
+typedef struct
+{
+    uint8_t *buf;       /*!< Pointer to the segment data */
+    uint32_t size;      /*!< Size of the segment in bytes, at most XGMAC_TX_MAX_SEG_SIZE */
+} xgmac_tx_seg_t;
+
+/**
+ * @brief  XGMAC transmit buffer
+ *
+ * @details With tso_mss set, buf holds an IPv4 TCP frame with a payload
+ * larger than one segment. The hardware sends it as segments of tso_mss
+ * payload bytes, each with a copy of the first tso_hdr_len bytes of headers
+ * updated for the segment. TSO must be enabled with XGMAC_SET_TSO first.
+ *
+ * With num_segs set, the frame is gathered from segs in order, one descriptor
+ * per segment, and size is ignored. buf is then only the handle returned by
+ * xgmac_dma_tx_done() when release_buf is set. The segs array is read before
+ * the transmit call returns, the segment data must stay valid until the frame
+ * is done. Gathered frames cannot use TSO.
+ *
+ * With ts_request set and timestamping enabled, the transmit time of the
+ * frame is captured and can be read with xgmac_get_tx_timestamp() once the
+ * frame is returned by xgmac_dma_tx_done().
+ */
 typedef struct
 {
     uint8_t *buf;       /*!< Pointer to transmit buffer */
     uint32_t size;          /*!< Size of the buffer in bytes */
     uint8_t release_buf;  /*!< Flag to release buffer after transmit */
+    uint8_t tso_tcp_hdr_len; /*!< TCP header length in bytes, a multiple of 4 */
+    uint16_t tso_hdr_len;    /*!< Ethernet, IP and TCP header length in bytes */
+    uint16_t tso_mss;        /*!< TCP payload bytes per segment, 0 sends buf as a single frame */
+    const xgmac_tx_seg_t *segs; /*!< Segments of a gathered frame */
+    uint8_t num_segs;        /*!< Number of segments, 0 sends buf as a single buffer */
+    uint8_t ts_request;      /*!< Capture the transmit timestamp of the frame */
 } xgmac_tx_buf_t;
 
+/**
+ * @brief  XGMAC receive buffer
+ *
+ * @details A frame larger than the receive buffer size is spread over several
+ * buffers. RDES3_NORM_WR_FD_MASK in packet_status marks the first buffer of a
+ * frame and RDES3_NORM_WR_LD_MASK the last one, the error and timestamp
+ * information is only valid in the last buffer.
+ */
 typedef struct
 {
     uint8_t *buf;       /*!< Pointer to receive buffer */
-    uint32_t size;          /*!< Size of received data in bytes */
+    uint32_t size;          /*!< Size of received data in this buffer in bytes */
     uint32_t packet_status;  /*!< Status of the received packet */
+    xgmac_timestamp_t timestamp; /*!< Receive time, valid when ts_valid is set */
+    bool ts_valid;           /*!< The frame was timestamped */
 } xgmac_rx_buf_t;
 
+/**
+ * @brief  XGMAC interrupt coalescing thresholds
+ *
+ * @details A receive interrupt is raised once rx_frames frames were received
+ * or, for a smaller number of frames, once the Rx watchdog expires. The
+ * watchdog runs for rx_watchdog * (256 << rx_watchdog_unit) system clock
+ * cycles after a frame is received without raising an interrupt. A transmit
+ * interrupt is requested once at least tx_frames frames were queued since
+ * the previous one.
+ */
+typedef struct
+{
+    uint16_t rx_frames;       /*!< Received frames per interrupt, 1 disables Rx coalescing */
+    uint8_t rx_watchdog;      /*!< Rx watchdog count, must be non zero when rx_frames is above 1 */
+    uint8_t rx_watchdog_unit; /*!< Rx watchdog unit, 0 to 3 for 256 to 2048 clock cycles */
+    uint16_t tx_frames;       /*!< Transmitted frames per interrupt, 1 disables Tx coalescing */
+} xgmac_coalesce_t;
+
+/**
+ * @brief  XGMAC MTU configuration
+ *
+ * @details The MAC accepts frames of up to mtu plus XGMAC_FRAME_OVERHEAD
+ * bytes, jumbo frames are enabled for an MTU above XGMAC_STD_MTU. Each
+ * receive buffer must hold rx_buf_size bytes, a frame that does not fit is
+ * received in several buffers. The receive buffer size can only be changed
+ * before xgmac_dma_initialize().
+ */
+typedef struct
+{
+    uint32_t mtu;             /*!< MTU in bytes, XGMAC_MIN_MTU to XGMAC_MAX_MTU */
+    uint32_t rx_buf_size;     /*!< Receive buffer size, a multiple of XGMAC_RX_BUF_ALIGN up to XGMAC_MAX_RX_BUF_SIZE, 0 for XGMAC_FRAME_SIZE(mtu) */
+} xgmac_mtu_config_t;
+
+/**
+ * @brief  XGMAC interrupt statistics
+ */
+typedef struct
+{
+    uint32_t irq_count;      /*!< Number of times the DMA ISR ran */
+    uint32_t rx_irq_count;   /*!< Receive interrupts reported to the application */
+    uint32_t tx_irq_count;   /*!< Transmit complete interrupts reported to the application */
+    uint32_t err_irq_count;  /*!< Error interrupts reported to the application */
+    uint32_t rx_packets;     /*!< Frames returned by xgmac_dma_receive() */
+    uint32_t tx_packets;     /*!< Frames released by xgmac_dma_tx_done() */
+    uint32_t irqs_per_kpkt;  /*!< Interrupts per thousand packets, filled by XGMAC_GET_IRQ_STATS */
+} xgmac_irq_stats_t;
+
+/**
+ * @brief  XGMAC MAC management counters
+ *
+ * @details Counted by the MAC for all DMA channels, the counters keep running
+ * while the application is busy and include frames the DMA never saw.
+ */
+typedef struct
+{
+    uint64_t tx_octets;          /*!< Bytes of transmitted frames, good and bad */
+    uint64_t tx_packets;         /*!< Transmitted frames, good and bad */
+    uint64_t tx_broadcast;       /*!< Good broadcast frames transmitted */
+    uint64_t tx_multicast;       /*!< Good multicast frames transmitted */
+    uint64_t tx_underflow;       /*!< Frames aborted by a Tx FIFO underflow */
+    uint64_t tx_pause;           /*!< Pause frames transmitted */
+    uint64_t rx_octets;          /*!< Bytes of received frames, good and bad */
+    uint64_t rx_packets;         /*!< Received frames, good and bad */
+    uint64_t rx_broadcast;       /*!< Good broadcast frames received */
+    uint64_t rx_multicast;       /*!< Good multicast frames received */
+    uint64_t rx_crc_errors;      /*!< Frames with a CRC error */
+    uint64_t rx_length_errors;   /*!< Frames whose length does not match the type field */
+    uint64_t rx_out_of_range;    /*!< Frames with a length field above the maximum */
+    uint64_t rx_fifo_overflow;   /*!< Frames dropped because the Rx FIFO was full */
+    uint64_t rx_pause;           /*!< Pause frames received */
+    uint64_t rx_discarded;       /*!< Frames discarded by the MTL */
+    uint32_t rx_runt;            /*!< Frames shorter than 64 bytes with an error */
+    uint32_t rx_jabber;          /*!< Frames longer than allowed with an error */
+    uint32_t rx_undersize;       /*!< Good frames shorter than 64 bytes */
+    uint32_t rx_oversize;        /*!< Good frames longer than allowed */
+    uint32_t rx_watchdog;        /*!< Frames cut by the receive watchdog */
+    uint32_t rx_alignment;       /*!< Frames with an alignment error */
+} xgmac_mmc_stats_t;
+
+/**
+ * @brief  XGMAC receive steering configuration
+ *
+ * @details With XGMAC_RX_STEER_VLAN_PRIO, a tagged frame with user priority p
+ * is received on DMA channel prio_to_chnl[p]. Untagged frames go to channel 0.
+ * With XGMAC_RX_STEER_FLOW_HASH, the RSS indirection table is spread evenly
+ * over all DMA channels in use and rss_key is the Toeplitz hash key. Flow
+ * hashing needs the RSS block, which is optional in the IP.
+ */
+typedef struct
+{
+    xgmac_rx_steer_mode_t mode;                   /*!< Steering mode */
+    uint8_t prio_to_chnl[XGMAC_NUM_PRIORITIES];   /*!< DMA channel per VLAN user priority */
+    uint8_t rss_key[XGMAC_RSS_KEY_SIZE];          /*!< RSS hash key */
+} xgmac_rx_steering_t;
+
 /**
  * @}
  */
@@ -348,6 +555,7 @@ int32_t xgmac_dma_deinitialize(xgmac_handle_t hxgmac);
  * The application should call this once the data is ready to be transmitted.
  *
  * @param[in] hxgmac     The instance of the XGMAC to stop.
+ * @param[in] chnl       The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
  * @param[in] dma_tx_buf The structure to buffer descriptor. It contains the
  *                               pointer to the buffer, size of buffer and the flag
  *                               to notify the dma driver regarding releasing the buffer
@@ -358,7 +566,37 @@ int32_t xgmac_dma_deinitialize(xgmac_handle_t hxgmac);
  * - -EIO: if DMA failed to transmit the buffer
  *
  */
-int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, xgmac_tx_buf_t *dma_tx_buf);
+int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_tx_buf_t *dma_tx_buf);
+
+/**
+ * @brief Initiate the transmit of a burst of buffers via DMA.
+ *
+ * All descriptors of the burst are filled under a single lock and the DMA
+ * tail pointer is written once, after the last descriptor. Each buffer is
+ * sent as a separate frame, or as a series of segments for a TSO buffer.
+ * A TSO buffer takes a context descriptor, a header descriptor and one
+ * descriptor per 16 KB of payload. A gathered buffer takes one descriptor
+ * per segment, FD on the first and LD on the last. Only the last descriptor
+ * of the burst
+ * raises the transmit complete interrupt.
+ *
+ * @param[in] hxgmac      The instance of the XGMAC.
+ * @param[in] chnl        The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
+ * @param[in] dma_tx_bufs Array of transmit buffer structures, one per frame.
+ * @param[in] num_bufs    Number of entries in dma_tx_bufs.
+ *
+ * @return
+ * - Number of buffers queued to the DMA. This can be less than num_bufs
+ *   if the descriptor ring does not have enough free entries.
+ * - -EINVAL: if the parameters are invalid, a buffer asks for TSO while
+ *            it is not enabled, a frame without TSO is longer than the MTU
+ *            or the frame length field of the descriptor allows, or a
+ *            gathered buffer has too many or oversized segments.
+ * - -EIO:    if no descriptor became available or the ring lock failed.
+ *
+ */
+int32_t xgmac_dma_transmit_burst(xgmac_handle_t hxgmac, uint8_t chnl,
+        xgmac_tx_buf_t *dma_tx_bufs, uint32_t num_bufs);
 
 /**
  * @brief Check if the transmit is done to release the buffer.
@@ -366,22 +604,28 @@ int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, xgmac_tx_buf_t *dma_tx_buf);
  * The application should call this once it gets an event notification after a dma transmit.
  *
  * @param[in]  hxgmac     The instance of the XGMAC to stop.
+ * @param[in]  chnl       The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
  * @param[out] release_buffer The released buffer which will be used for next transmit.
  *
  * @return
  * -  0:      if successfully obtained the status of buffer transmission.
  * - -EIO:    if failed to obtain the status of buffer transmission.
- * - -EAGAIN: if application failed to obtain the status of dma descriptor.
+ * - -EAGAIN: if no descriptor is pending or the oldest one is still owned by the DMA.
  *
  */
-int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer);
+int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t chnl, uint8_t **release_buffer);
 
 /**
  * @brief Initiate the receive of the buffer via DMA.
  *
  * The application should call this once the data is ready to be recevied in the dma fifo.
+ * Each received descriptor stays with the application until it is given a
+ * buffer again by xgmac_refill_rx_descriptor() or xgmac_refill_rx_descriptors(),
+ * refills may be deferred and batched. A frame larger than the receive buffer
+ * size is returned one buffer per call, see xgmac_rx_buf_t.
  *
  * @param[in]  hxgmac    The instance of the XGMAC to stop.
+ * @param[in]  chnl      The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
  * @param[out] dma_rx_buf The structure to buffer descriptor. It contains the
  *                              pointer to the buffer, size of buffer and the packet
  *                              status which will be validated by the stack to
@@ -392,7 +636,7 @@ int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer);
  * - -EAGAIN: if DMA failed to receive the buffer
  *
  */
-int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf);
+int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_rx_buf_t *dma_rx_buf);
 
 /**
  * @brief Refill a receive descriptor with a new buffer.
@@ -401,12 +645,147 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf);
  * so the DMA can receive new incoming packets.
  *
  * @param[in] hxgmac The instance of the XGMAC to refill the descriptor for.
+ * @param[in] chnl   The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
  * @param[in] buf    Pointer to the new buffer to assign to the RX descriptor.
  *
  * @return
  * - 0: if the descriptor was successfully refilled.
  */
-int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t *buf);
+int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t chnl, uint8_t *buf);
+
+/**
+ * @brief Refill a batch of receive descriptors.
+ *
+ * The descriptors following the last refilled one are given the buffers in
+ * order and handed to the DMA with a single Rx tail pointer write.
+ *
+ * @param[in] hxgmac   The instance of the XGMAC to refill the descriptors for.
+ * @param[in] chnl     The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
+ * @param[in] bufs     Array of new buffers, one per descriptor.
+ * @param[in] num_bufs Number of entries in bufs, at most XGMAC_NUM_RX_DESC.
+ *
+ * @return
+ * - 0:  if the descriptors were successfully refilled.
+ * - -1: if the parameters are invalid or the DMA is not initialized.
+ */
+int32_t xgmac_refill_rx_descriptors(xgmac_handle_t hxgmac, uint8_t chnl,
+        uint8_t *const *bufs, uint32_t num_bufs);
+
+/**
+ * @brief Check whether a received frame is waiting in the receive ring.
+ *
+ * Used after re-enabling the receive interrupt to catch a frame that
+ * arrived while it was masked.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] chnl   The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
+ *
+ * @return
+ * - true:  if the next receive descriptor has been released by the DMA.
+ * - false: otherwise.
+ */
+bool xgmac_dma_rx_pending(xgmac_handle_t hxgmac, uint8_t chnl);
+
+/**
+ * @brief Perform a configuration request on the XGMAC instance.
+ *
+ * This sets the interrupt coalescing thresholds, controls the receive
+ * interrupt for poll mode operation, selects the receive steering over the
+ * DMA channels and reports interrupt statistics.
+ * XGMAC_SET_RX_POLL_MODE, XGMAC_ENABLE_RX_IRQ and XGMAC_DISABLE_RX_IRQ
+ * only access registers and can be called from the driver callback.
+ *
+ * @param[in]     hxgmac The instance of the XGMAC.
+ * @param[in]     cmd    The request from one of the xgmac_ioctl_t.
+ * @param[in,out] buf    The data for the request.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if
+ *     - hxgmac is NULL
+ *     - buf is NULL with requests which need a buffer
+ *     - the coalescing thresholds are out of range
+ *     - the MTU or the receive buffer size is out of range
+ *     - a DMA channel is not below XGMAC_NUM_DMA_CHANNELS
+ * - -ENOTSUP: if flow hash steering, TSO or timestamping is requested and
+ *             the IP does not support it.
+ * - -EBUSY:  if the receive buffer size is changed after xgmac_dma_initialize().
+ * - -EIO:    if the register update failed.
+ */
+int32_t xgmac_ioctl(xgmac_handle_t hxgmac, xgmac_ioctl_t cmd, void *buf);
+
+/**
+ * @brief Get the transmit timestamp of the last completed frame.
+ *
+ * Reports the timestamp of the frame most recently returned by
+ * xgmac_dma_tx_done() on the channel.
+ *
+ * @param[in]  hxgmac The instance of the XGMAC.
+ * @param[in]  chnl   The DMA channel, below XGMAC_NUM_DMA_CHANNELS.
+ * @param[out] ts     The transmit time of the frame.
+ *
+ * @return
+ * -  0:       on success.
+ * - -EINVAL:  if the parameters are invalid.
+ * - -ENODATA: if the frame was sent without a timestamp.
+ */
+int32_t xgmac_get_tx_timestamp(xgmac_handle_t hxgmac, uint8_t chnl, xgmac_timestamp_t *ts);
+
+/**
+ * @brief Read the PTP system time.
+ *
+ * @param[in]  hxgmac The instance of the XGMAC.
+ * @param[out] ts     The current system time.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the parameters are invalid.
+ * - -EPERM:  if timestamping is not enabled.
+ */
+int32_t xgmac_ptp_get_time(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts);
+
+/**
+ * @brief Set the PTP system time.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] ts     The new system time, seconds are limited to 32 bits.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the parameters are invalid.
+ * - -EPERM:  if timestamping is not enabled.
+ * - -EIO:    if the hardware did not take the update.
+ */
+int32_t xgmac_ptp_set_time(xgmac_handle_t hxgmac, const xgmac_timestamp_t *ts);
+
+/**
+ * @brief Step the PTP system time by an offset.
+ *
+ * @param[in] hxgmac   The instance of the XGMAC.
+ * @param[in] delta_ns Offset in nanoseconds, negative values move the time back.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if hxgmac is NULL.
+ * - -EPERM:  if timestamping is not enabled.
+ * - -EIO:    if the hardware did not take the update.
+ */
+int32_t xgmac_ptp_adj_time(xgmac_handle_t hxgmac, int64_t delta_ns);
+
+/**
+ * @brief Adjust the rate of the PTP system time.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] ppb    Frequency offset in parts per billion from the nominal
+ *                   XGMAC_PTP_REF_CLK_HZ rate, within +/- 32000000.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if hxgmac is NULL or ppb is out of range.
+ * - -EPERM:  if timestamping is not enabled.
+ * - -EIO:    if the hardware did not take the update.
+ */
+int32_t xgmac_ptp_adj_freq(xgmac_handle_t hxgmac, int32_t ppb);
 
 /**
  * @brief Flush the DMA buffers.
@@ -158,9 +158,9 @@ static const xgmacmac_pkt_filter_config_t mac_pkt_filter_config = {
  */
 static const xgmac_dev_config_t mac_dev_config = {
 
-    .nofdmachannels = 1,
-    .noftxqueues = 1,
-    .nofrxqueues = 1,
+    .nofdmachannels = XGMAC_NUM_DMA_CHANNELS,
+    .noftxqueues = XGMAC_NUM_DMA_CHANNELS,
+    .nofrxqueues = XGMAC_NUM_DMA_CHANNELS,
 };
 
 /* Main XGMAC Configuration instance */
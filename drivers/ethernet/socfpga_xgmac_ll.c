@@ -337,21 +337,13 @@ void xgmac_config_dma_channel_control(uint32_t base_address, uint8_t dmachindx,
     WR_DMA_CHNL_REG32(base_address, dmachindx, XGMAC_DMA_CH_RX_CONTROL, val);
 
     /* Program  DMA Rx Control Settings - RBSZ Receive Buffer Size*/
-    val = RD_DMA_CHNL_REG32(base_address, dmachindx, XGMAC_DMA_CH_RX_CONTROL);
-    val |= (uint32_t)dmachnlconfig->rbsz << XGMAC_DMA_CH_RX_CONTROL_RBSZ_POS;
-    WR_DMA_CHNL_REG32(base_address, dmachindx, XGMAC_DMA_CH_RX_CONTROL, val);
+    xgmac_set_dma_rx_buf_size(base_address, dmachindx, dmachnlconfig->rbsz);
 
 }
-int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
-        xgmac_dma_interrupt_id_t id)
+static uint32_t xgmac_get_dma_interrupt_mask(xgmac_dma_interrupt_id_t id)
 {
-    uint32_t val;
     uint32_t intrmask;
 
-    /* Clear the DMA channel status register bits if set. Its a sticky bit hence write back to clear */
-    val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS);
-    WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS, val);
-
     switch (id)
     {
         case INTERRUPT_NIS:
@@ -362,18 +354,48 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
         case INTERRUPT_AIS:
             intrmask = XGMAC_DMA_INTR_MASK_FBE | XGMAC_DMA_INTR_MASK_TXS |
                     XGMAC_DMA_INTR_MASK_RBU | XGMAC_DMA_INTR_MASK_RS |
-                    XGMAC_DMA_INTR_MASK_DDE | XGMAC_DMA_INTR_MASK_AIS;
+                    XGMAC_DMA_INTR_MASK_DDE | XGMAC_DMA_INTR_MASK_CDE |
+                    XGMAC_DMA_INTR_MASK_AIS;
+            break;
+
+        case INTERRUPT_TI:
+            intrmask = XGMAC_DMA_INTR_MASK_TI;
+            break;
+
+        case INTERRUPT_RI:
+            intrmask = XGMAC_DMA_INTR_MASK_RI;
             break;
 
         default:
             intrmask = 0U;
             break;
     }
+
+    return intrmask;
+}
+
+int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
+        xgmac_dma_interrupt_id_t id)
+{
+    uint32_t val;
+    uint32_t intrmask;
+
+    intrmask = xgmac_get_dma_interrupt_mask(id);
     if (intrmask == 0U)
     {
         return XGMAC_LL_RETVAL_FAIL;
     }
 
+    /*
+     * Clear the DMA channel status register bits if set. Its a sticky bit hence write back to clear.
+     * Individual TI/RI sources are re-enabled at run time and must not lose a pending event
+     */
+    if ((id == INTERRUPT_NIS) || (id == INTERRUPT_AIS))
+    {
+        val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS);
+        WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS, val);
+    }
+
     val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_INTERRUPT_ENABLE);
     val |= intrmask;
     WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_INTERRUPT_ENABLE, val);
@@ -381,6 +403,157 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
     return XGMAC_LL_RETVAL_SUCCESS;
 }
 
+int32_t xgmac_disable_dma_interrupt(uint32_t base_address, uint8_t chindx,
+        xgmac_dma_interrupt_id_t id)
+{
+    uint32_t val;
+    uint32_t intrmask;
+
+    intrmask = xgmac_get_dma_interrupt_mask(id);
+
+    /* Keep the summary bit while only one of its sources is masked */
+    if ((id == INTERRUPT_TI) || (id == INTERRUPT_RI))
+    {
+        intrmask &= ~XGMAC_DMA_INTR_MASK_NIS;
+    }
+    if (intrmask == 0U)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_INTERRUPT_ENABLE);
+    val &= ~intrmask;
+    WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_INTERRUPT_ENABLE, val);
+
+    return XGMAC_LL_RETVAL_SUCCESS;
+}
+
+void xgmac_set_rx_watchdog(uint32_t base_address, uint8_t chindx, uint8_t rwt,
+        uint8_t rwtu)
+{
+    uint32_t val;
+
+    val = RD_DMA_CHNL_REG32(base_address, chindx,
+            XGMAC_DMA_CH_RX_INTERRUPT_WATCHDOG_TIMER);
+    val &= ~(XGMAC_DMA_CH_RWT_MASK | XGMAC_DMA_CH_RWTU_MASK);
+    val |= ((uint32_t)rwt << XGMAC_DMA_CH_RWT_POS) & XGMAC_DMA_CH_RWT_MASK;
+    val |= ((uint32_t)rwtu << XGMAC_DMA_CH_RWTU_POS) & XGMAC_DMA_CH_RWTU_MASK;
+    WR_DMA_CHNL_REG32(base_address, chindx,
+            XGMAC_DMA_CH_RX_INTERRUPT_WATCHDOG_TIMER, val);
+}
+
+bool xgmac_is_tso_supported(uint32_t base_address)
+{
+    return ((RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1) &
+           XGMAC_MAC_HW_FEATURE1_TSOEN_MASK) != 0U);
+}
+
+void xgmac_set_dma_tso(uint32_t base_address, uint8_t chindx, bool enable)
+{
+    if (enable == true)
+    {
+        ENABLE_DMA_CHNL_REGBIT(base_address + XGMAC_DMA_CH_TX_CONTROL, chindx,
+                XGMAC_DMA_CH0_TX_CONTROL_TSE_MASK);
+    }
+    else
+    {
+        DISABLE_DMA_CHNL_REGBIT(base_address + XGMAC_DMA_CH_TX_CONTROL, chindx,
+                XGMAC_DMA_CH0_TX_CONTROL_TSE_MASK);
+    }
+}
+
+void xgmac_set_dma_rx_buf_size(uint32_t base_address, uint8_t chindx, uint32_t size)
+{
+    uint32_t val;
+
+    /* The field holds the size in bytes, the low bits are not implemented */
+    val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_RX_CONTROL);
+    val &= ~XGMAC_DMA_CH_RX_CONTROL_RBSZ_MASK;
+    val |= size & XGMAC_DMA_CH_RX_CONTROL_RBSZ_MASK;
+    WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_RX_CONTROL, val);
+}
+
+bool xgmac_is_timestamp_supported(uint32_t base_address)
+{
+    return ((RD_REG32(base_address + XGMAC_MAC_HW_FEATURE0) &
+           XGMAC_MAC_HW_FEATURE0_TSSEL_MASK) != 0U);
+}
+
+void xgmac_ptp_config(uint32_t base_address, bool enable, uint8_t ssinc_ns)
+{
+    if (enable == false)
+    {
+        WR_REG32(base_address + XGMAC_MAC_TIMESTAMP_CONTROL, 0U);
+        return;
+    }
+
+    WR_REG32(base_address + XGMAC_MAC_SUB_SECOND_INCREMENT,
+            ((uint32_t)ssinc_ns << XGMAC_MAC_SUB_SECOND_INCREMENT_SSINC_POS) &
+            XGMAC_MAC_SUB_SECOND_INCREMENT_SSINC_MASK);
+
+    /*
+     * Fine correction with a nanosecond rollover, every frame is timestamped
+     * and the time is stored in the Tx descriptor write-back
+     */
+    WR_REG32(base_address + XGMAC_MAC_TIMESTAMP_CONTROL,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSENA_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSCFUPDT_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSCTRLSSR_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSENALL_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSVER2ENA_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSIPENA_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSIPV4ENA_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSIPV6ENA_MASK);
+}
+
+void xgmac_ptp_write_addend(uint32_t base_address, uint32_t addend)
+{
+    WR_REG32(base_address + XGMAC_MAC_TIMESTAMP_ADDEND, addend);
+}
+
+void xgmac_ptp_write_update(uint32_t base_address, uint32_t sec, uint32_t nsec,
+        bool subtract)
+{
+    uint32_t val;
+
+    val = nsec & XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE_TSSS_MASK;
+    if (subtract == true)
+    {
+        val |= XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE_ADDSUB_MASK;
+    }
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS_UPDATE, sec);
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE, val);
+}
+
+void xgmac_ptp_command(uint32_t base_address, uint32_t cmd_mask)
+{
+    ENABLE_BIT(base_address + XGMAC_MAC_TIMESTAMP_CONTROL, cmd_mask);
+}
+
+bool xgmac_is_ptp_command_done(uint32_t base_address, uint32_t cmd_mask)
+{
+    /* TSINIT, TSUPDT and TSADDREG clear once the update is applied */
+    return ((RD_REG32(base_address + XGMAC_MAC_TIMESTAMP_CONTROL) & cmd_mask) == 0U);
+}
+
+void xgmac_ptp_read_time(uint32_t base_address, uint64_t *sec, uint32_t *nsec)
+{
+    uint32_t sec_lo;
+    uint32_t sec_hi;
+
+    /* Read again if the seconds rolled over while reading the nanoseconds */
+    do
+    {
+        sec_lo = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS);
+        sec_hi = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS) &
+                XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS_TSHWR_MASK;
+        *nsec = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_NANOSECONDS) &
+                XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_TSSS_MASK;
+    } while (sec_lo != RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS));
+
+    *sec = ((uint64_t)sec_hi << 32) | sec_lo;
+}
+
 void xgmac_mac_init(uint32_t base_address, const
         xgmac_dev_config_str_t *xgmacdevconfig)
 {
@@ -393,7 +566,7 @@ void xgmac_mac_init(uint32_t base_address, const
         return;
     }
     /* Configure  MAC Rx Queue Control Register */
-    xgmac_config_macrxqctrl_regs(base_address, (const
+    xgmac_config_macrxqctrl_regs(base_address, macdevconfig->nofrxqueues, (const
             xgmacmac_rx_q_ctrl_config_t *)
             xgmacdevconfig->mac_rx_q_ctrl_config);
 
@@ -453,15 +626,26 @@ void xgmac_start_stop_mac_rx(uint32_t base_address, bool stflag)
     }
 }
 
-void xgmac_config_macrxqctrl_regs(uint32_t base_address, const
-        xgmacmac_rx_q_ctrl_config_t *macrxqctrlconfig)
+void xgmac_config_macrxqctrl_regs(uint32_t base_address, uint8_t num_queues,
+        const xgmacmac_rx_q_ctrl_config_t *macrxqctrlconfig)
 {
-    /* Clear and set the Receive Queue 0 */
-    DISABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0, XGMAC_MAC_RXQ_CTRL0_RXQ0EN_MASK);
+    uint32_t pos;
+    uint8_t qindx;
 
-    /* Enable for data Center Bridging/Generic */
-    ENABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0,
-            macrxqctrlconfig->rxq0en << XGMAC_MAC_RXQ_CTRL0_RXQ0EN_POS);
+    /* Every queue in use gets the same mode as Receive Queue 0 */
+    for (qindx = 0; qindx < num_queues; qindx++)
+    {
+        pos = XGMAC_MAC_RXQ_CTRL0_RXQ0EN_POS +
+                ((uint32_t)qindx * XGMAC_MAC_RXQ_CTRL0_RXQEN_WIDTH);
+
+        /* Clear and set the Receive Queue */
+        DISABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0,
+                XGMAC_MAC_RXQ_CTRL0_RXQ0EN_MASK << pos);
+
+        /* Enable for data Center Bridging/Generic */
+        ENABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0,
+                (uint32_t)macrxqctrlconfig->rxq0en << pos);
+    }
 
     /* Enable/Disable Multicast and Broadcast Queue Enable */
     if (macrxqctrlconfig->mcbcqen == 1)
@@ -474,6 +658,104 @@ void xgmac_config_macrxqctrl_regs(uint32_t base_address, const
     }
 }
 
+void xgmac_set_rxq_priority(uint32_t base_address, uint8_t qindx, uint8_t
+        prio_mask)
+{
+    uint32_t reg;
+    uint32_t pos;
+    uint32_t val;
+
+    /* PSRQ0..3 live in RxQ_Ctrl2 and PSRQ4..7 in RxQ_Ctrl3 */
+    reg = (qindx < XGMAC_MAC_RXQ_CTRL_PSRQ_QPERREG) ? XGMAC_MAC_RXQ_CTRL2 :
+            XGMAC_MAC_RXQ_CTRL3;
+    pos = ((uint32_t)qindx % XGMAC_MAC_RXQ_CTRL_PSRQ_QPERREG) *
+            XGMAC_MAC_RXQ_CTRL_PSRQ_WIDTH;
+
+    val = RD_REG32(base_address + reg);
+    val &= ~(XGMAC_MAC_RXQ_CTRL_PSRQ_MASK << pos);
+    val |= (uint32_t)prio_mask << pos;
+    WR_REG32(base_address + reg, val);
+}
+
+void xgmac_map_rxq_to_dma(uint32_t base_address, uint8_t qindx, uint8_t
+        dmachindx, bool dynamic)
+{
+    uint32_t reg;
+    uint32_t pos;
+    uint32_t val;
+    uint32_t field;
+
+    reg = (qindx < XGMAC_MTL_RXQ_DMA_MAP_QPERREG) ? XGMAC_MTL_RXQ_DMA_MAP0 :
+            XGMAC_MTL_RXQ_DMA_MAP1;
+    pos = ((uint32_t)qindx % XGMAC_MTL_RXQ_DMA_MAP_QPERREG) * 8U;
+
+    /*
+     * With dynamic mapping the channel comes from the RSS indirection table
+     * and the static channel is only used for packets RSS does not hash
+     */
+    field = (uint32_t)dmachindx & XGMAC_MTL_RXQ_DMA_QXMDMACH_MASK;
+    if (dynamic == true)
+    {
+        field |= XGMAC_MTL_RXQ_DMA_QXDDMACH_MASK;
+    }
+
+    val = RD_REG32(base_address + reg);
+    val &= ~(0xFFU << pos);
+    val |= field << pos;
+    WR_REG32(base_address + reg, val);
+}
+
+bool xgmac_is_rss_supported(uint32_t base_address)
+{
+    return ((RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1) &
+           XGMAC_MAC_HW_FEATURE1_RSSEN_MASK) != 0U);
+}
+
+int32_t xgmac_rss_write(uint32_t base_address, bool is_key, uint8_t indx,
+        uint32_t val)
+{
+    uint32_t addr;
+    uint32_t count;
+
+    WR_REG32(base_address + XGMAC_MAC_RSS_DATA, val);
+
+    addr = ((uint32_t)indx << XGMAC_MAC_RSS_ADDR_RSSIA_POS) |
+            XGMAC_MAC_RSS_ADDR_OB_MASK;
+    if (is_key == true)
+    {
+        addr |= XGMAC_MAC_RSS_ADDR_ADDRT_MASK;
+    }
+    WR_REG32(base_address + XGMAC_MAC_RSS_ADDR, addr);
+
+    /* The write is done once the hardware clears the busy bit */
+    for (count = 0; count < XGMAC_RSS_BUSY_POLL_COUNT; count++)
+    {
+        if ((RD_REG32(base_address + XGMAC_MAC_RSS_ADDR) &
+                XGMAC_MAC_RSS_ADDR_OB_MASK) == 0U)
+        {
+            return XGMAC_LL_RETVAL_SUCCESS;
+        }
+    }
+    return XGMAC_LL_RETVAL_FAIL;
+}
+
+void xgmac_rss_enable(uint32_t base_address, bool enable)
+{
+    if (enable == true)
+    {
+        /* Hash on the IPv4 addresses and the TCP/UDP ports */
+        ENABLE_BIT(base_address + XGMAC_MAC_RSS_CTRL,
+                XGMAC_MAC_RSS_CTRL_RSSE_MASK | XGMAC_MAC_RSS_CTRL_IP2TE_MASK |
+                XGMAC_MAC_RSS_CTRL_TCP4TE_MASK |
+                XGMAC_MAC_RSS_CTRL_UDP4TE_MASK);
+    }
+    else
+    {
+        DISABLE_BIT(base_address + XGMAC_MAC_RSS_CTRL,
+                XGMAC_MAC_RSS_CTRL_RSSE_MASK);
+    }
+}
+
 void xgmac_config_mac_frame_filter(uint32_t base_address, const
         xgmacmac_pkt_filter_config_t *macpktfilterconfig)
 {
@@ -633,7 +915,7 @@ void xgmac_config_mac_rx(uint32_t base_address, const
         xgmacmac_rx_config_t *macrxconfig)
 {
     uint32_t setmask = 0, clrmask = 0;
-    uint16_t val;
+    uint32_t val;
 
     /* Set/Clear mask bits for Automatic Pad or CRC Stripping */
     if (macrxconfig->acs == 1)
@@ -740,8 +1022,10 @@ void xgmac_config_mac_rx(uint32_t base_address, const
     DISABLE_BIT(base_address + XGMAC_MAC_RX_CONFIGURATION, clrmask);
 
     /* Program Giant Packet Size Limit */
-    val = (uint16_t)RD_REG32(base_address + XGMAC_MAC_RX_CONFIGURATION);
-    val |= (uint16_t)((uint32_t)macrxconfig->gpsl << XGMAC_MAC_RX_CONFIGURATION_GPSL_POS);
+    val = RD_REG32(base_address + XGMAC_MAC_RX_CONFIGURATION);
+    val &= ~XGMAC_MAC_RX_CONFIGURATION_GPSL_MASK;
+    val |= ((uint32_t)macrxconfig->gpsl << XGMAC_MAC_RX_CONFIGURATION_GPSL_POS) &
+            XGMAC_MAC_RX_CONFIGURATION_GPSL_MASK;
     WR_REG32(base_address + XGMAC_MAC_RX_CONFIGURATION, val);
 }
 
@@ -841,7 +1125,7 @@ void xgmac_mtl_init (uint32_t base_address, const
     num_queues = macdevconfig->noftxqueues;
     for (qindex = 0; qindex < num_queues; qindex++)
     {
-        xgmac_set_mtl_tx_regs(base_address, qindex, (const
+        xgmac_set_mtl_tx_regs(base_address, qindex, num_queues, (const
                 xgmacmtl_tx_queue_config_t *)
                 xgmacdevconfig->mtl_tx_q_config);
     }
@@ -854,7 +1138,7 @@ void xgmac_mtl_init (uint32_t base_address, const
         {
             return;
         }
-        xgmac_set_mtl_rx_regs(base_address, qindex, (const
+        xgmac_set_mtl_rx_regs(base_address, qindex, num_queues, (const
                 xgmacmtl_rx_queue_config_t *)
                 xgmacdevconfig->mtl_rx_q_config);
     }
@@ -870,16 +1154,20 @@ void xgmac_dev_start(uint32_t base_address)
     xgmac_start_stop_mac_rx(base_address, true);
 }
 
-void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_tx_queue_config_t *mtltxqcfgparams)
+void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_tx_queue_config_t *mtltxqcfgparams)
 {
     uint32_t val;
     uint32_t reg_val;
     uint32_t tqs;
 
-    /* Compute Tqs */
+    /* Compute Tqs, the Tx FIFO is split evenly between the queues in use */
     reg_val = RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1);
     tqs = XGMAC_MTL_TX_FIFO_BLK_CNT(reg_val);
+    if (num_queues > 1U)
+    {
+        tqs = ((tqs + 1U) / num_queues) - 1U;
+    }
 
     /* Enable Transmit Queue Store and Forward */
     if (mtltxqcfgparams->tsf == 1)
@@ -905,16 +1193,20 @@ void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
     WR_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TXQ_OPERATION_MODE, val);
 }
 
-void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_rx_queue_config_t *mtlrxqcfgparams)
+void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_rx_queue_config_t *mtlrxqcfgparams)
 {
     uint32_t val;
     uint32_t reg_val;
     uint32_t rqs;
 
-    /* Compute Rqs */
+    /* Compute Rqs, the Rx FIFO is split evenly between the queues in use */
     reg_val = RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1);
     rqs = XGMAC_MTL_RX_FIFO_BLK_CNT(reg_val);
+    if (num_queues > 1U)
+    {
+        rqs = ((rqs + 1U) / num_queues) - 1U;
+    }
 
     /* Enable Receive Queue Store and Forward */
     if (mtlrxqcfgparams->rsf == 1)
@@ -1023,6 +1315,19 @@ xgmac_dma_interrupt_id_t check_and_clear_xgmac_interrupt_status(uint32_t
 
     return res;
 }
+uint32_t xgmac_get_and_clear_dma_status(uint32_t base_address)
+{
+    uint32_t val;
+
+    /* Read the status */
+    val = RD_REG32(base_address + XGMAC_DMA_CH_STATUS);
+
+    /* Clear the status */
+    WR_REG32(base_address + XGMAC_DMA_CH_STATUS, val);
+
+    return val;
+}
+
 void check_and_clear_link_interrupt_status(uint32_t base_address)
 {
     uint32_t val;
@@ -1048,8 +1353,34 @@ void xgmac_mmc_setup(uint32_t base_address)
      * Disable all the Receive IPC statistics counter,
      * in the management counter
      *
-     * MMC block is unused, the interrupt masking is done to avoid some
-     * unwanted interrupts
+     * The counters are only polled through XGMAC_GET_MMC_STATS, the
+     * interrupt masking is done to avoid some unwanted interrupts
      * */
     DISABLE_BIT(base_address + XGMAC_MMC_IPC_RX_INTERRUPT_MASK, XGMAC_MMC_IPC_RX_INTR_MASK_ALL);
 }
+
+uint64_t xgmac_mmc_read_counter(uint32_t base_address, uint32_t low_offset)
+{
+    uint32_t high;
+    uint32_t low;
+
+    /* The high word is read again in case the low word wrapped in between */
+    do
+    {
+        high = RD_REG32(base_address + low_offset + 4U);
+        low = RD_REG32(base_address + low_offset);
+    } while (RD_REG32(base_address + low_offset + 4U) != high);
+
+    return ((uint64_t)high << 32) | low;
+}
+
+uint32_t xgmac_mmc_read_counter32(uint32_t base_address, uint32_t offset)
+{
+    return RD_REG32(base_address + offset);
+}
+
+void xgmac_mmc_reset_counters(uint32_t base_address)
+{
+    /* Self clearing */
+    ENABLE_BIT(base_address + XGMAC_MMC_CONTROL, XGMAC_MMC_CONTROL_CNTRST_MASK);
+}
@@ -79,6 +79,52 @@
 #define XGMAC_DMA_INTR_POS_NIS     15U
 #define XGMAC_DMA_INTR_MASK_NIS    0x00008000U
 
+/* DMA channel Rx interrupt watchdog timer fields */
+#define XGMAC_DMA_CH_RWT_POS       0U
+#define XGMAC_DMA_CH_RWT_MASK      0x000000FFU
+#define XGMAC_DMA_CH_RWTU_POS      12U
+#define XGMAC_DMA_CH_RWTU_MASK     0x00003000U
+
+/* Transmit descriptor fields used for TCP segmentation offload */
+#define XGMAC_TDES2_CTXT_MSS_MASK       0x00003FFFU
+#define XGMAC_TDES3_CTXT_TCMSSV_MASK    0x04000000U
+#define XGMAC_TDES3_TSO_THL_POS         19U
+#define XGMAC_TDES3_TSO_THL_MASK        0x00780000U
+#define XGMAC_TDES3_TSO_TPL_MASK        0x0003FFFFU
+#define XGMAC_TDES_MAX_BUF_LEN          0x3FFFU
+
+/* Descriptor fields used for IEEE 1588 timestamps */
+#define XGMAC_TDES3_WR_TTSS_MASK        0x00020000U
+#define XGMAC_RDES3_CTXT_TSA_MASK       0x00000010U
+#define XGMAC_RDES3_CTXT_TSD_MASK       0x00000020U
+#define XGMAC_PTP_NSEC_PER_SEC          1000000000U
+
+/* Rx queue to DMA channel mapping, one byte per queue in MTL_RxQ_DMA_Map0/1 */
+#define XGMAC_MTL_RXQ_DMA_QXMDMACH_MASK    0x07U
+#define XGMAC_MTL_RXQ_DMA_QXDDMACH_MASK    0x80U
+#define XGMAC_MTL_RXQ_DMA_MAP_QPERREG      4U
+
+/* Rx queue enable field width and user priority mask per queue */
+#define XGMAC_MAC_RXQ_CTRL0_RXQEN_WIDTH    2U
+#define XGMAC_MAC_RXQ_CTRL_PSRQ_WIDTH      8U
+#define XGMAC_MAC_RXQ_CTRL_PSRQ_MASK       0xFFU
+#define XGMAC_MAC_RXQ_CTRL_PSRQ_QPERREG    4U
+
+/* Receive side scaling registers, not part of the generated register map */
+#define XGMAC_MAC_RSS_CTRL                 0x0C80U
+#define XGMAC_MAC_RSS_CTRL_RSSE_MASK       0x00000001U
+#define XGMAC_MAC_RSS_CTRL_IP2TE_MASK      0x00000002U
+#define XGMAC_MAC_RSS_CTRL_TCP4TE_MASK     0x00000004U
+#define XGMAC_MAC_RSS_CTRL_UDP4TE_MASK     0x00000008U
+#define XGMAC_MAC_RSS_ADDR                 0x0C88U
+#define XGMAC_MAC_RSS_ADDR_OB_MASK         0x00000001U
+#define XGMAC_MAC_RSS_ADDR_ADDRT_MASK      0x00000004U
+#define XGMAC_MAC_RSS_ADDR_RSSIA_POS       8U
+#define XGMAC_MAC_RSS_DATA                 0x0C8CU
+#define XGMAC_RSS_KEY_WORDS                10U
+#define XGMAC_RSS_TABLE_SIZE               256U
+#define XGMAC_RSS_BUSY_POLL_COUNT          1000U
+
 #define XGMAC_MMC_IPC_RX_INTR_MASK_ALL    0xFFFFFFFFU
 /* Get the fifo size in bytes from Feature1 register
  * */
@@ -125,13 +171,20 @@
 #define DISABLE_DMA_CHNL_REGBIT(addr, channel, bit)    (*(uint32_t volatile *)((uintptr_t)(addr) + \
     XGMAC_DMA_CHANNEL_BASE + ((channel) * XGMAC_DMA_CHANNEL_INC)) &= ~(bit))
 
-/* DMA register read/write macros */
+/* DMA register read/write macros, the host tests replace them with stubs */
+#ifndef WR_DMA_CHNL_REG32
 #define RD_DMA_CHNL_REG32(base_address, channel, reg_offset)          *(uint32_t  \
     volatile *)((uintptr_t)(base_address) + XGMAC_DMA_CHANNEL_BASE + ((channel) * \
     XGMAC_DMA_CHANNEL_INC) + (reg_offset))
 #define WR_DMA_CHNL_REG32(base_address, channel, reg_offset, data)    (*(uint32_t \
     volatile *)((uintptr_t)(base_address) + XGMAC_DMA_CHANNEL_BASE + ((channel) * \
     XGMAC_DMA_CHANNEL_INC) + (reg_offset)) = (data))
+#endif
+
+/* Barrier making the descriptor writes visible before the DMA is told */
+#ifndef XGMAC_DMA_BARRIER
+#define XGMAC_DMA_BARRIER()    __asm volatile ("DSB SY")
+#endif
 
 typedef enum
 {
@@ -359,8 +412,16 @@ void xgmac_deassert_reset(int32_t emacindex);
 void xgmac_start_stop_mac_rx(uint32_t base_address, bool stflag);
 void xgmac_start_stop_mac_tx(uint32_t base_address, bool stflag);
 
-void xgmac_config_macrxqctrl_regs(uint32_t base_address, const
-        xgmacmac_rx_q_ctrl_config_t *macrxqctrlconfig);
+void xgmac_config_macrxqctrl_regs(uint32_t base_address, uint8_t num_queues,
+        const xgmacmac_rx_q_ctrl_config_t *macrxqctrlconfig);
+void xgmac_set_rxq_priority(uint32_t base_address, uint8_t qindx, uint8_t
+        prio_mask);
+void xgmac_map_rxq_to_dma(uint32_t base_address, uint8_t qindx, uint8_t
+        dmachindx, bool dynamic);
+bool xgmac_is_rss_supported(uint32_t base_address);
+int32_t xgmac_rss_write(uint32_t base_address, bool is_key, uint8_t indx,
+        uint32_t val);
+void xgmac_rss_enable(uint32_t base_address, bool enable);
 void xgmac_config_mac_frame_filter(uint32_t base_address, const
         xgmacmac_pkt_filter_config_t *macpktfilterconfig);
 void xgmac_config_mac_tx(uint32_t base_address, const
@@ -372,10 +433,10 @@ void xgmac_enable_tx_flow_control(uint32_t base_address, uint8_t qindx, const
 void xgmac_enable_rx_flow_control(uint32_t base_address, const
         xgmacmac_rx_flow_ctrl_config_t *macrxflowctrlconfig);
 
-void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_tx_queue_config_t *mtltxqcfgparams);
-void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_rx_queue_config_t *mtlrxqcfgparams);
+void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_tx_queue_config_t *mtltxqcfgparams);
+void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_rx_queue_config_t *mtlrxqcfgparams);
 
 /* DMA Function prototypes */
 void xgmac_dma_init(uint32_t base_address, const
@@ -396,6 +457,19 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx, xgmac_
         id);
 int32_t xgmac_disable_dma_interrupt(uint32_t base_address, uint8_t chindx, xgmac_dma_interrupt_id_t
         id);
+void xgmac_set_rx_watchdog(uint32_t base_address, uint8_t chindx, uint8_t rwt,
+        uint8_t rwtu);
+bool xgmac_is_tso_supported(uint32_t base_address);
+void xgmac_set_dma_tso(uint32_t base_address, uint8_t chindx, bool enable);
+void xgmac_set_dma_rx_buf_size(uint32_t base_address, uint8_t chindx, uint32_t size);
+bool xgmac_is_timestamp_supported(uint32_t base_address);
+void xgmac_ptp_config(uint32_t base_address, bool enable, uint8_t ssinc_ns);
+void xgmac_ptp_write_addend(uint32_t base_address, uint32_t addend);
+void xgmac_ptp_write_update(uint32_t base_address, uint32_t sec, uint32_t nsec,
+        bool subtract);
+void xgmac_ptp_command(uint32_t base_address, uint32_t cmd_mask);
+bool xgmac_is_ptp_command_done(uint32_t base_address, uint32_t cmd_mask);
+void xgmac_ptp_read_time(uint32_t base_address, uint64_t *sec, uint32_t *nsec);
 void xgmac_start_dma_dev(uint32_t base_address, const
         xgmac_dev_config_str_t *xgmacdevconfig);
 void xgmac_stop_dma_dev(uint32_t base_address, const
@@ -411,11 +485,15 @@ void xgmac_dev_stop(uint32_t base_address);
 void xgmac_disable_interrupt(uint32_t base_address);
 xgmac_dma_interrupt_id_t check_and_clear_xgmac_interrupt_status(
     uint32_t base_address);
+uint32_t xgmac_get_and_clear_dma_status(uint32_t base_address);
 void check_and_clear_link_interrupt_status(uint32_t base_address);
 
 void xgmac_invalidate_buffer(void *buf, size_t size);
 void xgmac_flush_buffer(void *buf, size_t size);
 
 void xgmac_mmc_setup(uint32_t base_address);
+uint64_t xgmac_mmc_read_counter(uint32_t base_address, uint32_t low_offset);
+uint32_t xgmac_mmc_read_counter32(uint32_t base_address, uint32_t offset);
+void xgmac_mmc_reset_counters(uint32_t base_address);
 
 #endif
@@ -926,7 +926,7 @@ static int run_fcs_get_digest_update(char *uuid, uint32_t context_id,
     fcs_digest_update_args[4] = (uint64_t)fcs_out_ops_buffer;
     fcs_digest_update_args[5] = FCS_DIGEST_MAX_RESP;
     fcs_digest_update_args[6] = (uint64_t)FCS_SMMU_GET_ADDR(src_data);
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_DIGEST_MAX_RESP);
+    cache_force_invalidate_nosync(fcs_out_ops_buffer, FCS_DIGEST_MAX_RESP);
     cache_force_write_back(src_data, src_size);
 
     if (final == FCS_FINALIZE)
@@ -1098,7 +1098,7 @@ static int run_fcs_mac_verify_update(char *uuid, uint32_t context_id,
     fcs_mac_verify_args[6] = src_size;
     fcs_mac_verify_args[7] = (uint64_t)FCS_SMMU_GET_ADDR(src_addr);
 
-    cache_force_write_back(src_addr, src_size + mac_data_size);
+    cache_force_write_back_nosync(src_addr, src_size + mac_data_size);
     cache_force_invalidate(fcs_out_ops_buffer, FCS_MAC_VERIFY_RESP);
 
     if (final == FCS_UPDATE)
@@ -1270,7 +1270,7 @@ int run_fcs_sdos_encrypt(char *uuid, uint32_t context_id,
     sdos_encrypt_args[7] = 0;
     sdos_encrypt_args[8] = FCS_SMMU_GET_ADDR(src_data);
     sdos_encrypt_args[9] = FCS_SMMU_GET_ADDR(resp_data);
-    cache_force_write_back(src_data, src_size);
+    cache_force_write_back_nosync(src_data, src_size);
     cache_force_invalidate(resp_data, FCS_SDOS_ENC_MAX_RESP);
 
     DEBUG("Sdos_encrypt: src_addr: %lx, src_size: %lu, resp_addr: %lx",
@@ -1338,7 +1338,7 @@ int run_fcs_sdos_decrypt(char *uuid, uint32_t context_id,
     /* SMMU address is used by the mailbox */
     sdos_decrypt_args[8] = FCS_SMMU_GET_ADDR(src_data);
     sdos_decrypt_args[9] = FCS_SMMU_GET_ADDR(resp_data);
-    cache_force_write_back(src_data, src_size);
+    cache_force_write_back_nosync(src_data, src_size);
     cache_force_invalidate(resp_data, FCS_SDOS_DEC_MAX_RESP);
 
     DEBUG(
@@ -1581,7 +1581,7 @@ int run_fcs_mctp_cmd_send(char *src_data, uint32_t src_size, char *resp_data,
         ERROR("No buffer provided");
         return -EINVAL;
     }
-    cache_force_write_back(src_data, src_size);
+    cache_force_write_back_nosync(src_data, src_size);
     cache_force_invalidate(resp_data, FCS_MCTP_MAX_SIZE);
 
     mctp_send_args[0] = (uint64_t)src_data;
@@ -1812,7 +1812,7 @@ static int run_fcs_aes_update(char *uuid, uint32_t context_id,
         ERROR("Failed to locate client");
         return -EIO;
     }
-    cache_force_write_back(src_addr, src_size);
+    cache_force_write_back_nosync(src_addr, src_size);
     cache_force_invalidate(dest_addr, dest_size);
 
     fcs_aes_update_args[0] = session_id;
@@ -2109,7 +2109,7 @@ int run_fcs_ecdsa_hash_sign(char *uuid, uint32_t context_id, uint32_t key_id,
     {
         return ret;
     }
-    cache_force_write_back(hash_data, hash_data_size);
+    cache_force_write_back_nosync(hash_data, hash_data_size);
     cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_SIGN_MAX_RESP);
 
     fcs_hash_sign_args[0] = session_id;
@@ -2206,7 +2206,7 @@ int run_fcs_ecdsa_hash_verify(char *uuid, uint32_t context_id,
                 sizeof(uint32_t)), pub_key_data, pub_key_size);
         mbox_arg_size += pub_key_size;
     }
-    cache_force_write_back(fcs_inp_ops_buffer, mbox_arg_size);
+    cache_force_write_back_nosync(fcs_inp_ops_buffer, mbox_arg_size);
     cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_VERIFY_RESP);
 
     fcs_hash_sign_verify_args[0] = session_id;
@@ -2304,7 +2304,7 @@ static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
         return -EIO;
     }
 
-    cache_force_invalidate(fcs_out_ops_buffer,
+    cache_force_invalidate_nosync(fcs_out_ops_buffer,
             FCS_ECDSA_HASH_SHA2_SIGN_MAX_RESP);
     cache_force_write_back(src_addr, src_size);
 
@@ -2494,7 +2494,7 @@ static int run_fcs_ecdsa_sha2_data_sign_verify_update(char *uuid,
                 sizeof(uint32_t)), pub_key_data, pub_key_size);
         payload_size += pub_key_size;
     }
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_SHA2_VERIFY_RESP);
+    cache_force_invalidate_nosync(fcs_out_ops_buffer, FCS_ECDSA_HASH_SHA2_VERIFY_RESP);
     cache_force_write_back(fcs_inp_ops_buffer, payload_size);
 
     fcs_sha2_sign_verify_args[0] = session_id;
@@ -2763,7 +2763,7 @@ int run_fcs_ecdh_request(char *uuid, uint32_t key_id,
         return ret;
     }
 
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDH_MAX_RESP);
+    cache_force_invalidate_nosync(fcs_out_ops_buffer, FCS_ECDH_MAX_RESP);
     cache_force_write_back(pub_key_data, pub_key_size);
 
     *shared_sec_size = FCS_ECDH_MAX_RESP;
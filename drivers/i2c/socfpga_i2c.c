@@ -12,8 +12,20 @@
 #include "socfpga_i2c_reg.h"
 #include "socfpga_defines.h"
 #include "socfpga_rst_mngr.h"
+#include "socfpga_dma.h"
+#include "socfpga_cache.h"
 #include "osal_log.h"
 
+#define I2C_DMA_NUM_CONTROLLERS   2U
+#define I2C_DMA_NUM_CHANNELS      4U
+#define I2C_DMA_MAX_BLOCK_SIZE    32768U
+#define I2C_DMA_MAX_BLOCKS        16U
+/* The read commands are one block per I2C_DMA_MAX_BLOCK_SIZE bytes plus
+ * the last command */
+#define I2C_DMA_MAX_READ          ((I2C_DMA_MAX_BLOCKS - 1U) * I2C_DMA_MAX_BLOCK_SIZE)
+/* Commands per half of the staging buffer of writes */
+#define I2C_DMA_STAGE_SIZE        256U
+
 struct i2c_descriptor
 {
     uint32_t base_address;
@@ -34,14 +46,52 @@ struct i2c_descriptor
     osal_semaphore_def_t sem_mem;
     osal_mutex_t mutex;
     osal_semaphore_t sem;
+    /* DMA mode */
+    BaseType_t dma_enabled;
+    BaseType_t is_dma;
+    i2c_dma_config_t dma_cfg;
+    dma_handle_t tx_dma;
+    dma_handle_t rx_dma;
+    dma_xfer_cfg_t dma_blocks[I2C_DMA_MAX_BLOCKS];
+    uint32_t dma_stage_idx;
+    uint32_t dma_jobs;
 };
 
 static struct i2c_descriptor i2c_desc[MAX_I2C_INSTANCES];
 
+/*
+ * The data command register takes the data with the command and stop bits
+ * above it, writes are staged as commands in two halves, one is filled
+ * while the DMA sends the other
+ */
+static uint32_t i2c_dma_stage[MAX_I2C_INSTANCES][2][I2C_DMA_STAGE_SIZE]
+__attribute__((aligned(64)));
+
+/* DMA handshakes of the instances, instances 2 to 4 are the I2C EMAC ones */
+static const dma_peri_id_t i2c_dma_tx_id[MAX_I2C_INSTANCES] =
+{
+    DMA_I2C0_TX, DMA_I2C1_TX, DMA_I2C_EMAC0_TX, DMA_I2C_EMAC1_TX,
+    DMA_I2C_EMAC2_TX
+};
+static const dma_peri_id_t i2c_dma_rx_id[MAX_I2C_INSTANCES] =
+{
+    DMA_I2C0_RX, DMA_I2C1_RX, DMA_I2C_EMAC0_RX, DMA_I2C_EMAC1_RX,
+    DMA_I2C_EMAC2_RX
+};
+
+/* Read command, then read command with stop */
+static uint32_t i2c_dma_read_cmds[2] __attribute__((aligned(64))) =
+{
+    I2C_DATA_CMD_CMD_MASK,
+    I2C_DATA_CMD_CMD_MASK | I2C_DATA_CMD_STOP_MASK
+};
+
 /**
  * @brief handle the interrupt
  */
 void i2c_isr(void *data);
+static int32_t i2c_dma_set_mode(i2c_handle_t hi2c, const i2c_dma_config_t *cfg);
+static void i2c_dma_disable(i2c_handle_t hi2c);
 
 /**
  * @brief Get the reset instance for the I2C peripheral
@@ -130,6 +180,7 @@ i2c_handle_t i2c_open(uint32_t instance)
 
         handle->base_address = GET_I2C_BASE_ADDRESS(instance);
         handle->instance = instance;
+        handle->dma_cfg.threshold = I2C_DMA_THRESHOLD_DEFAULT;
         rst_instance = i2c_get_rst_instance(instance);
         if (rst_instance == RST_PERIPHERAL_END)
         {
@@ -200,6 +251,10 @@ int32_t i2c_close(i2c_handle_t const hi2c)
     {
         i2c_disable_interrupt(hi2c->base_address, I2C_TX_EMPTY_INT);
         i2c_disable_interrupt(hi2c->base_address, I2C_RX_FULL_INT);
+        if (hi2c->dma_enabled == true)
+        {
+            i2c_dma_disable(hi2c);
+        }
         hi2c->is_open = false;
         return 0;
     }
@@ -290,6 +345,29 @@ int32_t i2c_ioctl(i2c_handle_t const hi2c, i2c_ioctl_t cmd, void *const pparam)
             *(uint16_t *)pparam = bytes_left;
             break;
 
+        case I2C_SET_DMA_MODE:
+            if ((pparam == NULL))
+            {
+                ERROR("Buffer cannot be null");
+                return -EINVAL;
+            }
+            if (hi2c->is_busy == true)
+            {
+                ERROR("Instance is busy");
+                return -EBUSY;
+            }
+            ret = i2c_dma_set_mode(hi2c, (const i2c_dma_config_t *)pparam);
+            break;
+
+        case I2C_GET_DMA_MODE:
+            if ((pparam == NULL))
+            {
+                ERROR("Buffer cannot be null");
+                return -EINVAL;
+            }
+            *(i2c_dma_config_t *)pparam = hi2c->dma_cfg;
+            break;
+
         default:
             ERROR("Invalid IOCTL request");
             ret = -EINVAL;
@@ -298,6 +376,421 @@ int32_t i2c_ioctl(i2c_handle_t const hi2c, i2c_ioctl_t cmd, void *const pparam)
     return ret;
 }
 
+/**
+ * @brief Open and configure a free DMA channel for the I2C master
+ */
+static dma_handle_t i2c_dma_open_channel(dma_xfer_type_t dir,
+        dma_peri_id_t peri_id, uint8_t prio)
+{
+    dma_handle_t hdma;
+    dma_config_t cfg;
+    uint32_t inst;
+    uint32_t ch;
+
+    for (inst = 0U; inst < I2C_DMA_NUM_CONTROLLERS; inst++)
+    {
+        for (ch = 0U; ch < I2C_DMA_NUM_CHANNELS; ch++)
+        {
+            hdma = dma_open(inst, ch);
+            if (hdma == NULL)
+            {
+                continue;
+            }
+            cfg.instance = (uint8_t)inst;
+            cfg.ch_dir = dir;
+            cfg.ch_prio = prio;
+            cfg.peri_id = peri_id;
+            cfg.callback = NULL;
+            if (dma_config(hdma, &cfg) == 0)
+            {
+                return hdma;
+            }
+            (void)dma_close(hdma);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Release the DMA channels, the bus must be idle
+ */
+static void i2c_dma_disable(i2c_handle_t hi2c)
+{
+    if (hi2c->rx_dma != NULL)
+    {
+        (void)dma_close(hi2c->rx_dma);
+        hi2c->rx_dma = NULL;
+    }
+    if (hi2c->tx_dma != NULL)
+    {
+        (void)dma_close(hi2c->tx_dma);
+        hi2c->tx_dma = NULL;
+    }
+    hi2c->dma_enabled = false;
+}
+
+/**
+ * @brief Enable or disable the DMA mode
+ */
+static int32_t i2c_dma_set_mode(i2c_handle_t hi2c, const i2c_dma_config_t *cfg)
+{
+    if (hi2c->dma_enabled == true)
+    {
+        i2c_dma_disable(hi2c);
+    }
+    if (cfg->enable == 0U)
+    {
+        hi2c->dma_cfg = *cfg;
+        return 0;
+    }
+    hi2c->tx_dma = i2c_dma_open_channel(DMA_MEM_TO_PERI_DMAC,
+            i2c_dma_tx_id[hi2c->instance], 0U);
+    /* The receive FIFO overflows if it is not drained in time */
+    hi2c->rx_dma = i2c_dma_open_channel(DMA_PERI_TO_MEM_DMAC,
+            i2c_dma_rx_id[hi2c->instance], 1U);
+    if ((hi2c->tx_dma == NULL) || (hi2c->rx_dma == NULL))
+    {
+        i2c_dma_disable(hi2c);
+        return -ENODEV;
+    }
+    cache_force_write_back((void *)i2c_dma_read_cmds,
+            sizeof(i2c_dma_read_cmds));
+
+    hi2c->dma_cfg = *cfg;
+    hi2c->dma_enabled = true;
+    return 0;
+}
+
+/**
+ * @brief Check if a transfer goes through the DMA
+ */
+static BaseType_t i2c_dma_eligible(i2c_handle_t hi2c, size_t nbytes,
+        BaseType_t is_read)
+{
+    if ((hi2c->dma_enabled == false) || (nbytes < hi2c->dma_cfg.threshold))
+    {
+        return false;
+    }
+    if ((is_read == true) && (nbytes > I2C_DMA_MAX_READ))
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stop the DMA requests and drop the queued jobs
+ */
+static void i2c_dma_stop(i2c_handle_t hi2c)
+{
+    i2c_disable_dma(hi2c->base_address);
+    if (dma_get_queued_jobs(hi2c->tx_dma) > 0U)
+    {
+        (void)dma_stop_transfer(hi2c->tx_dma);
+    }
+    if (dma_get_queued_jobs(hi2c->rx_dma) > 0U)
+    {
+        (void)dma_stop_transfer(hi2c->rx_dma);
+    }
+}
+
+/**
+ * @brief Notify the caller of the end of a transfer
+ */
+static void i2c_dma_notify(i2c_handle_t hi2c, int32_t status)
+{
+    if (hi2c->is_async == true)
+    {
+        if (status == I2C_SUCCESS)
+        {
+            hi2c->is_busy = false;
+            hi2c->no_stop_flag = false;
+        }
+        if (hi2c->callback_fn != NULL)
+        {
+            hi2c->callback_fn(status, hi2c->cb_usercontext);
+        }
+    }
+    else
+    {
+        (void)osal_semaphore_post(hi2c->sem);
+    }
+}
+
+/**
+ * @brief Fail a DMA transfer, called from the DMA interrupt
+ */
+static void i2c_dma_fail(i2c_handle_t hi2c)
+{
+    /* Already ended by a transfer abort */
+    if (hi2c->is_dma == false)
+    {
+        return;
+    }
+    hi2c->is_dma = false;
+    i2c_dma_stop(hi2c);
+    i2c_disable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
+            I2C_TX_EMPTY_INT | I2C_RX_FULL_INT);
+    hi2c->is_xfer_abort = true;
+    i2c_dma_notify(hi2c, I2C_OP_FAIL);
+}
+
+/**
+ * @brief Append the blocks of count items of width bytes to the block list
+ */
+static uint32_t i2c_dma_build_blocks(i2c_handle_t hi2c, uint32_t num_blocks,
+        uint64_t src, uint64_t dst, uint32_t count, uint32_t width,
+        uint32_t flags)
+{
+    uint32_t offset;
+    uint32_t blk;
+
+    for (offset = 0U; offset < count; offset += blk)
+    {
+        blk = count - offset;
+        if (blk > I2C_DMA_MAX_BLOCK_SIZE)
+        {
+            blk = I2C_DMA_MAX_BLOCK_SIZE;
+        }
+        hi2c->dma_blocks[num_blocks].src = src +
+                (((flags & DMA_XFER_SRC_FIXED) != 0U) ? 0UL :
+                (uint64_t)offset * width);
+        hi2c->dma_blocks[num_blocks].dst = dst +
+                (((flags & DMA_XFER_DST_FIXED) != 0U) ? 0UL :
+                (uint64_t)offset * width);
+        hi2c->dma_blocks[num_blocks].blk_size = blk * width;
+        hi2c->dma_blocks[num_blocks].next_trnsfr_cfg = NULL;
+        if (num_blocks > 0U)
+        {
+            hi2c->dma_blocks[num_blocks - 1U].next_trnsfr_cfg =
+                    &hi2c->dma_blocks[num_blocks];
+        }
+        num_blocks++;
+    }
+    return num_blocks;
+}
+
+static int32_t i2c_dma_queue_write(i2c_handle_t hi2c);
+
+/**
+ * @brief Completion of a staged part of a write, called from the DMA interrupt
+ */
+static void i2c_dma_write_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    i2c_handle_t hi2c = (i2c_handle_t)cb_data;
+
+    (void)hdma;
+    if ((status == -ECANCELED) || (hi2c->is_dma == false))
+    {
+        return;
+    }
+    if (status != 0)
+    {
+        i2c_dma_fail(hi2c);
+        return;
+    }
+    hi2c->dma_jobs--;
+    if (hi2c->bytes_left > 0U)
+    {
+        if (i2c_dma_queue_write(hi2c) != 0)
+        {
+            i2c_dma_fail(hi2c);
+        }
+    }
+    else if (hi2c->dma_jobs == 0U)
+    {
+        /* The interrupt handler completes the write once the FIFO drains */
+        i2c_disable_dma(hi2c->base_address);
+        hi2c->is_dma = false;
+        i2c_enable_interrupt(hi2c->base_address, I2C_TX_EMPTY_INT);
+    }
+}
+
+/**
+ * @brief Stage the next bytes of a write as data commands in the free half
+ * of the staging buffer and queue them
+ *
+ * Called from the DMA interrupt, or with the interrupts masked.
+ */
+static int32_t i2c_dma_queue_write(i2c_handle_t hi2c)
+{
+    uint32_t *stage;
+    dma_job_t job;
+    uint32_t count;
+    uint32_t i;
+    int32_t ret;
+
+    stage = i2c_dma_stage[hi2c->instance][hi2c->dma_stage_idx];
+    count = (hi2c->bytes_left > I2C_DMA_STAGE_SIZE) ? I2C_DMA_STAGE_SIZE :
+            hi2c->bytes_left;
+    for (i = 0U; i < count; i++)
+    {
+        stage[i] = hi2c->buffer[i];
+    }
+    if ((count == hi2c->bytes_left) && (hi2c->no_stop_flag == false))
+    {
+        stage[count - 1U] |= I2C_DATA_CMD_STOP_MASK;
+    }
+    cache_force_write_back((void *)stage, count * sizeof(uint32_t));
+
+    job.flags = DMA_XFER_DST_FIXED | DMA_XFER_PERI_SINGLE;
+    job.xfer_list = hi2c->dma_blocks;
+    job.num_xfers = i2c_dma_build_blocks(hi2c, 0U, (uint64_t)(uintptr_t)stage,
+            (uint64_t)(hi2c->base_address + I2C_DATA_CMD), count,
+            sizeof(uint32_t), job.flags);
+    job.src_width = DMA_TRANSFER_WIDTH4;
+    job.dst_width = DMA_TRANSFER_WIDTH4;
+    job.callback = i2c_dma_write_done;
+    job.cb_data = hi2c;
+    ret = dma_submit_job(hi2c->tx_dma, &job);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    hi2c->buffer += count;
+    hi2c->bytes_left -= count;
+    hi2c->dma_stage_idx ^= 1U;
+    hi2c->dma_jobs++;
+    return 0;
+}
+
+/**
+ * @brief Start a write on the DMA, the bus must be claimed
+ *
+ * Nothing is sent on failure, the caller falls back to the FIFO.
+ */
+static int32_t i2c_dma_start_write(i2c_handle_t hi2c)
+{
+    UBaseType_t int_mask;
+    int32_t ret;
+
+    hi2c->dma_stage_idx = 0U;
+    hi2c->dma_jobs = 0U;
+    hi2c->is_dma = true;
+    i2c_enable_dma(hi2c->base_address, false);
+    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT);
+
+    /* Masks the DMA interrupt, whose completions stage the next parts */
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    ret = i2c_dma_queue_write(hi2c);
+    if ((ret == 0) && (hi2c->bytes_left > 0U))
+    {
+        /* Staged by the first completion if the queue is full */
+        (void)i2c_dma_queue_write(hi2c);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (ret != 0)
+    {
+        i2c_disable_dma(hi2c->base_address);
+        hi2c->is_dma = false;
+    }
+    return ret;
+}
+
+/**
+ * @brief Completion of the receive job of a read, called from the DMA interrupt
+ */
+static void i2c_dma_read_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    i2c_handle_t hi2c = (i2c_handle_t)cb_data;
+
+    (void)hdma;
+    if ((status == -ECANCELED) || (hi2c->is_dma == false))
+    {
+        return;
+    }
+    if (status != 0)
+    {
+        i2c_dma_fail(hi2c);
+        return;
+    }
+    /* Drop the lines the CPU may have fetched during the transfer */
+    cache_flush((void *)hi2c->buffer, hi2c->xfer_size);
+    i2c_disable_dma(hi2c->base_address);
+    hi2c->is_dma = false;
+    hi2c->buffer += hi2c->xfer_size;
+    hi2c->bytes_left = 0U;
+    hi2c->rd_cmds_left = 0U;
+    i2c_dma_notify(hi2c, I2C_SUCCESS);
+}
+
+/**
+ * @brief Completion of the read commands, called from the DMA interrupt
+ */
+static void i2c_dma_cmd_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    i2c_handle_t hi2c = (i2c_handle_t)cb_data;
+
+    (void)hdma;
+    if ((status != 0) && (status != -ECANCELED))
+    {
+        /* The receive job waits for bytes that are not read, cancel it */
+        i2c_dma_fail(hi2c);
+    }
+}
+
+/**
+ * @brief Start a read on the DMA, the bus must be claimed
+ *
+ * The receive job is queued first, then the read commands are sent from
+ * a fixed command word with the last one carrying the stop. Nothing is
+ * read on failure, the caller falls back to the FIFO.
+ */
+static int32_t i2c_dma_start_read(i2c_handle_t hi2c)
+{
+    dma_job_t job;
+    uint64_t data_reg;
+    uint32_t nbytes;
+    uint32_t last;
+    int32_t ret;
+
+    data_reg = (uint64_t)(hi2c->base_address + I2C_DATA_CMD);
+    nbytes = hi2c->xfer_size;
+    cache_flush((void *)hi2c->buffer, nbytes);
+
+    hi2c->is_dma = true;
+    i2c_enable_dma(hi2c->base_address, true);
+    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT);
+
+    job.flags = DMA_XFER_SRC_FIXED | DMA_XFER_PERI_SINGLE;
+    job.xfer_list = hi2c->dma_blocks;
+    job.num_xfers = i2c_dma_build_blocks(hi2c, 0U, data_reg,
+            (uint64_t)(uintptr_t)hi2c->buffer, nbytes, 1U, job.flags);
+    job.src_width = DMA_TRANSFER_WIDTH1;
+    job.dst_width = DMA_TRANSFER_WIDTH1;
+    job.callback = i2c_dma_read_done;
+    job.cb_data = hi2c;
+    ret = dma_submit_job(hi2c->rx_dma, &job);
+    if (ret == 0)
+    {
+        last = (hi2c->no_stop_flag == true) ? 0U : 1U;
+        job.flags = DMA_XFER_SRC_FIXED | DMA_XFER_DST_FIXED |
+                DMA_XFER_PERI_SINGLE;
+        job.num_xfers = i2c_dma_build_blocks(hi2c, 0U,
+                (uint64_t)(uintptr_t)&i2c_dma_read_cmds[0], data_reg,
+                nbytes - 1U, sizeof(uint32_t), job.flags);
+        job.num_xfers = i2c_dma_build_blocks(hi2c, job.num_xfers,
+                (uint64_t)(uintptr_t)&i2c_dma_read_cmds[last], data_reg,
+                1U, sizeof(uint32_t), job.flags);
+        job.src_width = DMA_TRANSFER_WIDTH4;
+        job.dst_width = DMA_TRANSFER_WIDTH4;
+        job.callback = i2c_dma_cmd_done;
+        ret = dma_submit_job(hi2c->tx_dma, &job);
+        if (ret != 0)
+        {
+            /* The receive job would wait forever, cancel it */
+            (void)dma_stop_transfer(hi2c->rx_dma);
+        }
+    }
+    if (ret != 0)
+    {
+        i2c_disable_dma(hi2c->base_address);
+        hi2c->is_dma = false;
+    }
+    return ret;
+}
+
 int32_t i2c_write_sync(i2c_handle_t const hi2c, uint8_t *const buf, size_t nbytes)
 {
     if ((hi2c == NULL) || (buf == NULL) || (nbytes == 0U) || (!hi2c->is_open))
@@ -347,12 +840,17 @@ int32_t i2c_write_sync(i2c_handle_t const hi2c, uint8_t *const buf, size_t nbyte
     hi2c->bytes_left = nbytes;
 
     INFO("Starting I2C sync write");
-    nbytes = i2c_write_fifo(hi2c->base_address, buf, hi2c->xfer_size, hi2c->no_stop_flag);
+    if ((i2c_dma_eligible(hi2c, nbytes, false) == false) ||
+            (i2c_dma_start_write(hi2c) != 0))
+    {
+        nbytes = i2c_write_fifo(hi2c->base_address, buf, hi2c->xfer_size,
+                hi2c->no_stop_flag);
 
-    hi2c->bytes_left -= nbytes;
-    hi2c->buffer += nbytes;
-    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
-            I2C_TX_EMPTY_INT);
+        hi2c->bytes_left -= nbytes;
+        hi2c->buffer += nbytes;
+        i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
+                I2C_TX_EMPTY_INT);
+    }
 
     if (osal_semaphore_wait(hi2c->sem, 0xFFFFFFFFU) == false)
     {
@@ -419,13 +917,17 @@ int32_t i2c_write_async(i2c_handle_t const hi2c, uint8_t *const buf, size_t nbyt
     hi2c->bytes_left = nbytes;
 
     INFO("Starting I2C async write");
-    nbytes = i2c_write_fifo(hi2c->base_address, buf, hi2c->xfer_size, hi2c->no_stop_flag);
-
-    hi2c->bytes_left -= nbytes;
-    hi2c->buffer += nbytes;
+    if ((i2c_dma_eligible(hi2c, nbytes, false) == false) ||
+            (i2c_dma_start_write(hi2c) != 0))
+    {
+        nbytes = i2c_write_fifo(hi2c->base_address, buf, hi2c->xfer_size,
+                hi2c->no_stop_flag);
 
-    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
-            I2C_TX_EMPTY_INT);
+        hi2c->bytes_left -= nbytes;
+        hi2c->buffer += nbytes;
+        i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
+                I2C_TX_EMPTY_INT);
+    }
 
     return 0;
 }
@@ -481,12 +983,16 @@ int32_t i2c_read_sync(i2c_handle_t const hi2c, uint8_t *const buf, size_t nbytes
 
     INFO("Starting I2C sync read");
 
-    /* Enqueue the read commands */
-    hi2c->rd_cmds_left -= i2c_enq_read_cmd(
-            hi2c->base_address, nbytes, hi2c->no_stop_flag);
+    /* Enqueue the read commands, or let the DMA send them */
+    if ((i2c_dma_eligible(hi2c, nbytes, true) == false) ||
+            (i2c_dma_start_read(hi2c) != 0))
+    {
+        hi2c->rd_cmds_left -= i2c_enq_read_cmd(
+                hi2c->base_address, nbytes, hi2c->no_stop_flag);
 
-    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
-            I2C_RX_FULL_INT);
+        i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
+                I2C_RX_FULL_INT);
+    }
 
     if (osal_semaphore_wait(hi2c->sem, 0xFFFFFFFFU) == false)
     {
@@ -554,12 +1060,16 @@ int32_t i2c_read_async(i2c_handle_t const hi2c, uint8_t *const buf, size_t nbyte
     hi2c->rd_cmds_left = nbytes;
 
     INFO("Starting I2C async read");
-    /* Enqueue the read commands */
-    hi2c->rd_cmds_left -= i2c_enq_read_cmd(
-            hi2c->base_address, nbytes, hi2c->no_stop_flag);
+    /* Enqueue the read commands, or let the DMA send them */
+    if ((i2c_dma_eligible(hi2c, nbytes, true) == false) ||
+            (i2c_dma_start_read(hi2c) != 0))
+    {
+        hi2c->rd_cmds_left -= i2c_enq_read_cmd(
+                hi2c->base_address, nbytes, hi2c->no_stop_flag);
 
-    i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
-            I2C_RX_FULL_INT);
+        i2c_enable_interrupt(hi2c->base_address, I2C_TX_ABORT_INT |
+                I2C_RX_FULL_INT);
+    }
 
     return 0;
 }
@@ -576,6 +1086,11 @@ int32_t i2c_cancel(i2c_handle_t const hi2c)
         ERROR("I2C instance is not busy");
         return -EPERM;
     }
+    if (hi2c->is_dma == true)
+    {
+        hi2c->is_dma = false;
+        i2c_dma_stop(hi2c);
+    }
     i2c_ll_cancel(hi2c->base_address);
     hi2c->is_xfer_abort = false;
     hi2c->is_busy = false;
@@ -606,6 +1121,11 @@ void i2c_isr(void *data)
         i2c_disable_interrupt(base_addr, I2C_TX_ABORT_INT | I2C_TX_EMPTY_INT |
                 I2C_RX_FULL_INT);
 
+        if (pi2c_peripheral->is_dma == true)
+        {
+            pi2c_peripheral->is_dma = false;
+            i2c_dma_stop(pi2c_peripheral);
+        }
         pi2c_peripheral->is_xfer_abort = true;
         if ((pi2c_peripheral->is_async) == 1)
         {
@@ -85,6 +85,7 @@
 #define I2C_FAST_MODE_BPS         (400000U)        /*!< Fast mode bits per second. */
 #define I2C_FAST_MODE_PLUS_BPS    (1000000U)       /*!< Fast plus mode bits per second. */
 #define I2C_HIGH_SPEED_BPS        (3400000U)       /*!< High speed mode bits per second. */
+#define I2C_DMA_THRESHOLD_DEFAULT    (32U)    /*!< Default size from which transfers use the DMA in DMA mode. */
 /**
  * @}
  */
@@ -113,6 +114,20 @@ typedef struct i2c_config
 {
     uint32_t clk; /*!< Bus frequency/baud rate */
 } i2c_config_t;
+
+/**
+ * @brief I2C DMA configuration
+ *
+ * In DMA mode, reads and writes of at least threshold bytes are moved
+ * between memory and the FIFOs by the DMA, reads of more than 480 KiB still
+ * use the FIFO interrupts. Every instance has DMA handshakes, instances 2
+ * to 4 use the I2C EMAC ones.
+ */
+typedef struct i2c_dma_config
+{
+    uint8_t enable; /*!< 1 to use the DMA, 0 for FIFO interrupts only. */
+    uint32_t threshold; /*!< Transfers of at least this many bytes use the DMA. */
+} i2c_dma_config_t;
 /**
  * @}
  */
@@ -133,6 +148,8 @@ typedef enum
     I2C_GET_BUS_STATE, /*!< Get the current I2C bus status. Returns eI2CBusIdle or eI2CBusy */
     I2C_GET_TX_NBYTES, /*!< Get the number of bytes sent in write operation. */
     I2C_GET_RX_NBYTES, /*!< Get the number of bytes received in read operation. */
+    I2C_SET_DMA_MODE, /*!< Enables or disables DMA transfers using the struct #i2c_dma_config_t. */
+    I2C_GET_DMA_MODE, /*!< Gets the DMA configuration using the struct #i2c_dma_config_t. */
 } i2c_ioctl_t;
 
 /**
@@ -376,12 +393,21 @@ int32_t i2c_write_async(i2c_handle_t const hi2c, uint8_t *const buf, size_t
  * This is supposed to be called in the caller task or application callback, right after last transaction completes.
  * This request expects 2 bytes buffer (uint16_t).
  *
+ * @note I2C_SET_DMA_MODE enables or disables DMA transfers.
+ * This request expects the buffer with size of i2c_dma_config_t. Two free
+ * DMA channels are needed to enable the DMA mode.
+ *
+ * @note I2C_GET_DMA_MODE gets the current DMA configuration.
+ * This request expects the buffer with size of i2c_dma_config_t.
+ *
  * @return
  * - 0: on success
  * - -EINVAL: if
  *     - hi2c is NULL
  *     - hi2c is not opened yet
  *     - buf is NULL with requests which needs buffer
+ * - -EBUSY:  if the DMA mode is changed during a transfer
+ * - -ENODEV: if no DMA channel is free
  */
 int32_t i2c_ioctl(i2c_handle_t const hi2c, i2c_ioctl_t cmd, void *const pparam);
 
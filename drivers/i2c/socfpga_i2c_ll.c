@@ -337,3 +337,30 @@ void i2c_ll_cancel(uint32_t base_addr)
     /* Clear all abort interrupts */
     (void)RD_REG32(base_addr + I2C_CLR_TX_ABRT);
 }
+
+/**
+ * @brief Enable the DMA requests, the receive request for reads only
+ */
+void i2c_enable_dma(uint32_t base_addr, BaseType_t is_read)
+{
+    uint32_t val;
+
+    WR_REG32(base_addr + I2C_DMA_TDLR, (I2C_DMA_TX_LEVEL <<
+            I2C_DMA_TDLR_DMATDL_POS) & I2C_DMA_TDLR_DMATDL_MASK);
+    WR_REG32(base_addr + I2C_DMA_RDLR, (I2C_DMA_RX_LEVEL <<
+            I2C_DMA_RDLR_DMARDL_POS) & I2C_DMA_RDLR_DMARDL_MASK);
+    val = I2C_DMA_CR_TDMAE_MASK;
+    if (is_read)
+    {
+        val |= I2C_DMA_CR_RDMAE_MASK;
+    }
+    WR_REG32(base_addr + I2C_DMA_CR, val);
+}
+
+/**
+ * @brief Disable the DMA requests
+ */
+void i2c_disable_dma(uint32_t base_addr)
+{
+    WR_REG32(base_addr + I2C_DMA_CR, 0U);
+}
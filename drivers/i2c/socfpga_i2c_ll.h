@@ -19,6 +19,9 @@
 #define I2C_RX_FULL_INT     2U           /*!< Rx FIFO Full interrupt*/
 #define I2C_TX_ABORT_INT    4U           /*!< Tx Abort interrupt*/
 
+#define I2C_DMA_TX_LEVEL    8U           /*!< Tx FIFO level requesting the DMA*/
+#define I2C_DMA_RX_LEVEL    0U           /*!< Rx FIFO level requesting the DMA, plus one*/
+
 void i2c_enable_interrupt(uint32_t base_addr, uint32_t interrupt_req);
 
 void i2c_disable_interrupt(uint32_t base_addr, uint32_t interrupt_req);
@@ -46,4 +49,8 @@ void i2c_ll_cancel(uint32_t base_addr);
 
 uint32_t i2c_get_config(uint32_t base_addr);
 
+void i2c_enable_dma(uint32_t base_addr, BaseType_t is_read);
+
+void i2c_disable_dma(uint32_t base_addr);
+
 #endif   /* ifndef __SOCFPGA_I2C_LL_H__ */
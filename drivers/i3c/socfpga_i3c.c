@@ -700,6 +700,29 @@ static int32_t i3c_get_device_dyn_address(uint8_t instance,
     return ret;
 }
 
+/**
+ * @brief Enable or disable the DMA mode of the controller instance.
+ */
+static int32_t i3c_set_dma_mode(uint8_t instance,
+        const struct i3c_dma_config *pdma_cfg)
+{
+    if ((instance >= I3C_NUM_INSTANCES) || (pdma_cfg == NULL))
+    {
+        return -EINVAL;
+    }
+    if (i3c_obj[instance].is_busy == true)
+    {
+        ERROR("I3C bus is busy");
+        return -EBUSY;
+    }
+    if (i3c_ll_set_dma_mode(instance, pdma_cfg->enable,
+            pdma_cfg->threshold) != I3C_OK)
+    {
+        ERROR("DMA mode not available");
+        return -ENODEV;
+    }
+    return 0;
+}
 
 int32_t i3c_open(uint8_t instance)
 {
@@ -713,6 +736,7 @@ int32_t i3c_open(uint8_t instance)
 
     /* initialise the address allotment table */
     i3c_init_address_table(instance);
+    i3c_obj[instance].dma_threshold = I3C_DMA_THRESHOLD_DEFAULT;
 
     /* initialise the Transfer semaphore*/
     i3c_obj[instance].xfer_complete = osal_semaphore_create(
@@ -770,6 +794,24 @@ int32_t i3c_ioctl(uint8_t instance, enum i3c_ioctl_request ioctl, void *pargs)
             status = i3c_validate_i2c_device_address(instance, pi3c_device);
             break;
 
+        case I3C_IOCTL_SET_DMA_MODE:
+            INFO("Configuring the DMA mode");
+            status = i3c_set_dma_mode(instance,
+                    (struct i3c_dma_config *)pargs);
+            break;
+
+        case I3C_IOCTL_GET_DMA_MODE:
+            INFO("Fetching the DMA mode");
+            struct i3c_dma_config *pdma_cfg = (struct i3c_dma_config *)pargs;
+            if ((instance >= I3C_NUM_INSTANCES) || (pdma_cfg == NULL))
+            {
+                status = -EINVAL;
+                break;
+            }
+            pdma_cfg->enable = i3c_obj[instance].dma_enabled;
+            pdma_cfg->threshold = i3c_obj[instance].dma_threshold;
+            break;
+
         default:
             INFO("Invalid IOCTL command");
             status = -EINVAL;
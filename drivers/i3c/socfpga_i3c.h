@@ -81,6 +81,7 @@
 #define I3C_INSTANCE1        0x0U                   /*!< I3C  instance number 1. */
 #define I3C_INSTANCE2        0x1U                   /*!< I3C  instance number 2. */
 #define I3C_NUM_INSTANCES    0x2U                   /*!< I3C  maximum number of instances */
+#define I3C_DMA_THRESHOLD_DEFAULT    (32U)          /*!< Default size from which transfers use the DMA in DMA mode. */
 /**
  * @}
  */
@@ -95,7 +96,9 @@ enum i3c_ioctl_request
     I3C_IOCTL_BUS_INIT,               /*!< Command for I3C bus initialization. */
     I3C_IOCTL_DO_DAA,                 /*!< command to start DAA. */
     I3C_IOCTL_GET_DYNADDRESS,         /*!< Command to get I3C device dynamic address. */
-    I2C_IOCTL_ADDRESS_VALID           /*!< Command to check if I2C device is valid. */
+    I2C_IOCTL_ADDRESS_VALID,          /*!< Command to check if I2C device is valid. */
+    I3C_IOCTL_SET_DMA_MODE,           /*!< Command to enable or disable DMA transfers. */
+    I3C_IOCTL_GET_DMA_MODE            /*!< Command to get the DMA configuration. */
 };
 
 /**
@@ -154,6 +157,19 @@ struct i3c_xfer_request
 
     bool read;              /*!< read or write xfer*/
 };
+
+/**
+ * @brief Structure used with I3C_IOCTL_SET_DMA_MODE and I3C_IOCTL_GET_DMA_MODE.
+ *
+ * In DMA mode the whole words of a transfer of at least threshold bytes are
+ * moved by the DMA, the last partial word by the CPU. Only the write and the
+ * read of a request are moved by the DMA when it has a single one of each.
+ */
+struct i3c_dma_config
+{
+    bool enable;            /*!< true to use the DMA, false for FIFO interrupts only */
+    uint16_t threshold;     /*!< transfers of at least this many bytes use the DMA */
+};
 /**
  * @}
  */
@@ -188,6 +204,11 @@ extern int32_t i3c_open(uint8_t instance);
  *
  * @note I3C_IOCTL_CONFIG_IBI: Enable/disable the slave in-bound interrupt.
  *
+ * @note I3C_IOCTL_SET_DMA_MODE: Enable or disable DMA transfers, uses the
+ * struct i3c_dma_config. Two free DMA channels are needed to enable it.
+ *
+ * @note I3C_IOCTL_GET_DMA_MODE: Get the DMA configuration in a struct i3c_dma_config.
+ *
  * @param[in] instance Instance of the I3C controller.
  * @param[in] ioctl    IOCTL request.
  * @param[in] pargs    Pointer to the arguments for the IOCTL request.
@@ -196,6 +217,7 @@ extern int32_t i3c_open(uint8_t instance);
  * - I3C_OK:  if successful
  * - -EINVAL: if incorrect instance
  * - -EBUSY:  if busy
+ * - -ENODEV: if the DMA mode is not available
  */
 extern int32_t i3c_ioctl(uint8_t instance, enum i3c_ioctl_request ioctl,
         void *pargs );
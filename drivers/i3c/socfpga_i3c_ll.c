@@ -12,10 +12,21 @@
 #include "socfpga_i3c_regs.h"
 #include "socfpga_i3c.h"
 #include "socfpga_i3c_ll.h"
+#include "socfpga_cache.h"
 
 #define MHZ         (1000000U)
 #define NANO_SEC    (1000000000U)
 
+#define GET_I3C_DMA_TX_ID(instance)    (((instance) == I3C_INSTANCE1) \
+    ? DMA_I3C0_TX : DMA_I3C1_TX)
+#define GET_I3C_DMA_RX_ID(instance)    (((instance) == I3C_INSTANCE1) \
+    ? DMA_I3C0_RX : DMA_I3C1_RX)
+
+#define I3C_DMA_NUM_CONTROLLERS    (2U)
+#define I3C_DMA_NUM_CHANNELS       (4U)
+#define I3C_DMA_MAX_BLOCK_SIZE     (32768U)                        /* bytes of a block with 1 byte source items*/
+#define I3C_DMA_DRAIN_WAIT         (10000U)                        /* polls of the Rx FIFO level after a short read*/
+
 #define I3C_XFER_WAIT_TIME    pdMS_TO_TICKS(10000U)                                /* 1000ms wait for xfer complete,*/
 #define WAIT_FOR_XFER_COMPLETE(instance)    ((osal_semaphore_wait(i3c_obj[ \
             (instance)].xfer_complete, (uint64_t)I3C_XFER_WAIT_TIME)) \
@@ -152,6 +163,9 @@ static uint16_t read_data_from_rx_fifo(uint8_t instance, uint8_t *data,
 }
 
 
+static int32_t complete_xfer(uint8_t instance, int32_t error);
+static void i3c_dma_response(uint8_t instance, int32_t error);
+
 /* Function to read the response for the xfer requests, will be called from ISR for I3C controller.*/
 static int32_t read_xfer_response(uint8_t instance)
 {
@@ -160,7 +174,6 @@ static int32_t read_xfer_response(uint8_t instance)
 
     uint8_t i, num_response, idx;
     int32_t error = I3C_OK;
-    uint16_t bytes;
 
     /* read the number of response in the response queue*/
     num_response = (uint8_t)HAL_REG_READ_FIELD((i3c_obj[instance].reg_base +
@@ -221,6 +234,21 @@ static int32_t read_xfer_response(uint8_t instance)
                 I3C_DEVICE_CTRL_RESUME_POS, I3C_DEVICE_CTRL_RESUME_MASK, 1U);
 
     }
+    /* The DMA may still move the data of the transfer */
+    if (i3c_obj[instance].dma_pending > 0U)
+    {
+        i3c_dma_response(instance, error);
+        return error;
+    }
+    return complete_xfer(instance, error);
+}
+
+/* Complete the current request, once both the response and the data are in */
+static int32_t complete_xfer(uint8_t instance, int32_t error)
+{
+    uint8_t i;
+    uint16_t bytes;
+
     /* If synchronous release the semaphore or else read the remaining bytes
      * and trigger the call back
      */
@@ -277,6 +305,11 @@ static void  request_transfer(uint8_t instance)
 
     for (i = 0; i < i3c_obj[instance].num_xfers; i++)
     {
+        if (i3c_obj[instance].cmd_obj[i].is_dma == true)
+        {
+            /* Data moved by the DMA, see i3c_dma_start() */
+            continue;
+        }
         if (i3c_obj[instance].cmd_obj[i].cmd.xfer.field.rnw == 0U)
         {
             i3c_obj[instance].cmd_obj[i].write_bytes_left =
@@ -325,6 +358,341 @@ static void  request_transfer(uint8_t instance)
     return;
 }
 
+/* Set or clear the RX THRESHOLD interrupt signal */
+static void i3c_dma_rx_thld_signal(uint8_t instance, bool enable)
+{
+    uint32_t interrupt_signal_enable =
+            RD_REG32((i3c_obj[instance].reg_base + I3C_INTR_SIGNAL_EN));
+
+    if (enable)
+    {
+        interrupt_signal_enable |= RX_THLD_INTR;
+    }
+    else
+    {
+        interrupt_signal_enable &= ~RX_THLD_INTR;
+    }
+    WR_REG32((i3c_obj[instance].reg_base + I3C_INTR_SIGNAL_EN),
+            interrupt_signal_enable);
+}
+
+/* Release the DMA resources once the response and every DMA job are in,
+ * and hand the partial words over to the CPU
+ */
+static void i3c_dma_finish(uint8_t instance)
+{
+    struct i3c_cmd_obj *pcmd_obj;
+    uint16_t len;
+
+    HAL_REG_WRITE_FIELD((i3c_obj[instance].reg_base + I3C_DEVICE_CTRL),
+            I3C_DEVICE_CTRL_DMA_ENABLE_POS, I3C_DEVICE_CTRL_DMA_ENABLE_MASK,
+            0U);
+
+    pcmd_obj = i3c_obj[instance].dma_rx_cmd;
+    if (pcmd_obj != NULL)
+    {
+        len = i3c_obj[instance].dma_rx_len;
+
+        /* drop the lines the CPU may have fetched during the transfer */
+        cache_flush((void *)pcmd_obj->read_buffer, len);
+        pcmd_obj->read_bytes_left = (pcmd_obj->rx_length > len) ?
+                (pcmd_obj->rx_length - len) : 0U;
+        pcmd_obj->read_buffer += len;
+        pcmd_obj->is_dma = false;
+        i3c_dma_rx_thld_signal(instance, true);
+    }
+    if (i3c_obj[instance].dma_status != I3C_OK)
+    {
+        if (pcmd_obj != NULL)
+        {
+            pcmd_obj->status = I3C_RESPONSE_XFER_ABORT;
+        }
+        if (i3c_obj[instance].dma_tx_cmd != NULL)
+        {
+            i3c_obj[instance].dma_tx_cmd->status = I3C_RESPONSE_XFER_ABORT;
+        }
+    }
+    if (i3c_obj[instance].dma_tx_cmd != NULL)
+    {
+        i3c_obj[instance].dma_tx_cmd->is_dma = false;
+    }
+    i3c_obj[instance].dma_tx_cmd = NULL;
+    i3c_obj[instance].dma_rx_cmd = NULL;
+}
+
+/* Account for the response or a DMA job, the last one completes the request */
+static void i3c_dma_event(uint8_t instance)
+{
+    UBaseType_t int_mask;
+    bool done;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    i3c_obj[instance].dma_pending--;
+    done = (i3c_obj[instance].dma_pending == 0U);
+    if (done)
+    {
+        i3c_dma_finish(instance);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (done)
+    {
+        (void)complete_xfer(instance,
+                i3c_obj[instance].dma_status);
+    }
+}
+
+/* Cancel the jobs still queued, the response is the only event left */
+static void i3c_dma_stop(uint8_t instance)
+{
+    UBaseType_t int_mask;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if (dma_get_queued_jobs(i3c_obj[instance].tx_dma) > 0U)
+    {
+        (void)dma_stop_transfer(i3c_obj[instance].tx_dma);
+    }
+    if (dma_get_queued_jobs(i3c_obj[instance].rx_dma) > 0U)
+    {
+        (void)dma_stop_transfer(i3c_obj[instance].rx_dma);
+    }
+    i3c_obj[instance].dma_pending = 1U;
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
+
+/* Response of a request with DMA jobs, called from the I3C ISR */
+static void i3c_dma_response(uint8_t instance, int32_t error)
+{
+    struct i3c_cmd_obj *pcmd_obj = i3c_obj[instance].dma_rx_cmd;
+    uint32_t wait;
+
+    if (error != I3C_OK)
+    {
+        /* The FIFOs are reset, the jobs would never complete */
+        i3c_obj[instance].dma_status = error;
+        i3c_dma_stop(instance);
+    }
+    else if ((pcmd_obj != NULL) && (pcmd_obj->is_dma == true) &&
+            (pcmd_obj->rx_length < i3c_obj[instance].dma_rx_len))
+    {
+        /* Short read, the receive job waits for words that never come.
+         * Let it take what was received first.
+         */
+        for (wait = 0U; wait < I3C_DMA_DRAIN_WAIT; wait++)
+        {
+            if (HAL_REG_READ_FIELD((i3c_obj[instance].reg_base +
+                    I3C_DATA_BUFFER_STATUS_LEVEL),
+                    I3C_DATA_BUFFER_STATUS_LEVEL_RX_BUF_BLR_POS,
+                    I3C_DATA_BUFFER_STATUS_LEVEL_RX_BUF_BLR_MASK) == 0U)
+            {
+                break;
+            }
+        }
+        i3c_dma_stop(instance);
+    }
+    else
+    {
+        /* the DMA jobs are accounted for by their callbacks */
+    }
+    i3c_dma_event(instance);
+}
+
+/* Completion of the write job, called from the DMA interrupt */
+static void i3c_dma_tx_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    uint8_t instance = (uint8_t)(uintptr_t)cb_data;
+    struct i3c_cmd_obj *pcmd_obj = i3c_obj[instance].dma_tx_cmd;
+    uint32_t interrupt_signal_enable;
+
+    (void)hdma;
+    if (status == -ECANCELED)
+    {
+        return;
+    }
+    if (status != 0)
+    {
+        i3c_obj[instance].dma_status = I3C_IO;
+    }
+    else if (pcmd_obj->tx_length > i3c_obj[instance].dma_tx_len)
+    {
+        /* The TX THRESHOLD interrupt pushes the last partial word */
+        pcmd_obj->write_buffer = pcmd_obj->data +
+                i3c_obj[instance].dma_tx_len;
+        pcmd_obj->write_bytes_left = pcmd_obj->tx_length -
+                i3c_obj[instance].dma_tx_len;
+        interrupt_signal_enable = RD_REG32((i3c_obj[instance].reg_base +
+                I3C_INTR_SIGNAL_EN));
+        interrupt_signal_enable |= TX_THLD_INTR;
+        WR_REG32((i3c_obj[instance].reg_base + I3C_INTR_SIGNAL_EN),
+                interrupt_signal_enable);
+    }
+    else
+    {
+        /* all the data was moved */
+    }
+    i3c_dma_event(instance);
+}
+
+/* Completion of the read job, called from the DMA interrupt */
+static void i3c_dma_rx_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    uint8_t instance = (uint8_t)(uintptr_t)cb_data;
+
+    (void)hdma;
+    if (status == -ECANCELED)
+    {
+        return;
+    }
+    if (status != 0)
+    {
+        i3c_obj[instance].dma_status = I3C_IO;
+    }
+    i3c_dma_event(instance);
+}
+
+/* Queue a DMA job of len bytes between memory and the data port */
+static int32_t i3c_dma_submit(uint8_t instance, bool is_read, uint8_t *buf,
+        uint16_t len)
+{
+    dma_job_t job;
+    uint64_t data_port;
+    uint32_t offset;
+    uint32_t blk;
+    uint32_t num_blocks = 0U;
+
+    data_port = (uint64_t)(i3c_obj[instance].reg_base + I3C_TX_DATA_PORT);
+    for (offset = 0U; offset < len; offset += blk)
+    {
+        blk = (uint32_t)len - offset;
+        if (blk > I3C_DMA_MAX_BLOCK_SIZE)
+        {
+            blk = I3C_DMA_MAX_BLOCK_SIZE;
+        }
+        i3c_obj[instance].dma_blocks[num_blocks].src = is_read ? data_port :
+                ((uint64_t)(uintptr_t)buf + offset);
+        i3c_obj[instance].dma_blocks[num_blocks].dst = is_read ?
+                ((uint64_t)(uintptr_t)buf + offset) : data_port;
+        i3c_obj[instance].dma_blocks[num_blocks].blk_size = blk;
+        i3c_obj[instance].dma_blocks[num_blocks].next_trnsfr_cfg = NULL;
+        if (num_blocks > 0U)
+        {
+            i3c_obj[instance].dma_blocks[num_blocks - 1U].next_trnsfr_cfg =
+                    &i3c_obj[instance].dma_blocks[num_blocks];
+        }
+        num_blocks++;
+    }
+
+    /* The data port takes whole words, the memory side is byte aligned */
+    job.xfer_list = i3c_obj[instance].dma_blocks;
+    job.num_xfers = num_blocks;
+    job.cb_data = (void *)(uintptr_t)instance;
+    if (is_read)
+    {
+        job.src_width = DMA_TRANSFER_WIDTH4;
+        job.dst_width = DMA_TRANSFER_WIDTH1;
+        job.flags = DMA_XFER_SRC_FIXED | DMA_XFER_PERI_SINGLE;
+        job.callback = i3c_dma_rx_done;
+        return dma_submit_job(i3c_obj[instance].rx_dma, &job);
+    }
+    job.src_width = DMA_TRANSFER_WIDTH1;
+    job.dst_width = DMA_TRANSFER_WIDTH4;
+    job.flags = DMA_XFER_DST_FIXED | DMA_XFER_PERI_SINGLE;
+    job.callback = i3c_dma_tx_done;
+    return dma_submit_job(i3c_obj[instance].tx_dma, &job);
+}
+
+/* Move the whole words of the only write and the only read of the request
+ * with the DMA, when they are large enough. Transfers whose job cannot be
+ * queued stay with the CPU.
+ */
+static void i3c_dma_start(uint8_t instance)
+{
+    struct i3c_cmd_obj *ptx = NULL;
+    struct i3c_cmd_obj *prx = NULL;
+    uint32_t num_tx = 0U, num_rx = 0U;
+    uint16_t len;
+    UBaseType_t int_mask;
+    uint32_t i;
+
+    for (i = 0U; i < i3c_obj[instance].num_xfers; i++)
+    {
+        if (i3c_obj[instance].cmd_obj[i].cmd.xfer.field.rnw == 0U)
+        {
+            ptx = &i3c_obj[instance].cmd_obj[i];
+            num_tx++;
+        }
+        else
+        {
+            prx = &i3c_obj[instance].cmd_obj[i];
+            num_rx++;
+        }
+    }
+    if ((num_tx != 1U) || (ptx->tx_length < i3c_obj[instance].dma_threshold) ||
+            (ptx->tx_length < RX_TX_DATA_PORT_SIZE))
+    {
+        ptx = NULL;
+    }
+    if ((num_rx != 1U) || (prx->rx_length < i3c_obj[instance].dma_threshold) ||
+            (prx->rx_length < RX_TX_DATA_PORT_SIZE))
+    {
+        prx = NULL;
+    }
+
+    i3c_obj[instance].dma_tx_cmd = NULL;
+    i3c_obj[instance].dma_rx_cmd = NULL;
+    i3c_obj[instance].dma_status = I3C_OK;
+    i3c_obj[instance].dma_pending = 0U;
+    if ((ptx == NULL) && (prx == NULL))
+    {
+        return;
+    }
+
+    /* Masks the DMA interrupt until every job is accounted for */
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    i3c_obj[instance].dma_pending = 1U;
+    if (prx != NULL)
+    {
+        len = prx->rx_length & (uint16_t)~(RX_TX_DATA_PORT_SIZE - 1U);
+        cache_flush((void *)prx->read_buffer, prx->rx_length);
+        if (i3c_dma_submit(instance, true, prx->read_buffer, len) == 0)
+        {
+            /* The RX THRESHOLD interrupt would fire until the DMA drains
+             * the FIFO
+             */
+            i3c_dma_rx_thld_signal(instance, false);
+            prx->is_dma = true;
+            prx->read_bytes_left = 0U;
+            i3c_obj[instance].dma_rx_cmd = prx;
+            i3c_obj[instance].dma_rx_len = len;
+            i3c_obj[instance].dma_pending++;
+        }
+    }
+    if (ptx != NULL)
+    {
+        len = ptx->tx_length & (uint16_t)~(RX_TX_DATA_PORT_SIZE - 1U);
+        cache_force_write_back((void *)ptx->data, len);
+        if (i3c_dma_submit(instance, false, ptx->data, len) == 0)
+        {
+            ptx->is_dma = true;
+            i3c_obj[instance].dma_tx_cmd = ptx;
+            i3c_obj[instance].dma_tx_len = len;
+            i3c_obj[instance].dma_pending++;
+        }
+    }
+    if (i3c_obj[instance].dma_pending == 1U)
+    {
+        /* nothing was queued, the CPU moves all the data */
+        i3c_obj[instance].dma_pending = 0U;
+    }
+    else
+    {
+        HAL_REG_WRITE_FIELD((i3c_obj[instance].reg_base + I3C_DEVICE_CTRL),
+                I3C_DEVICE_CTRL_DMA_ENABLE_POS,
+                I3C_DEVICE_CTRL_DMA_ENABLE_MASK, 1U);
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+}
+
 /**
  * @brief Interrupt Service Routine for the I3C controller.
  *
@@ -751,6 +1119,11 @@ int32_t i3c_ll_send_xfer_command(uint8_t instance,
     i3c_obj[instance].num_xfers = num_cmds;
     i3c_obj[instance].is_async = is_async;
 
+    /* Queue the DMA jobs before the commands start the transfers */
+    if (i3c_obj[instance].dma_enabled == true)
+    {
+        i3c_dma_start(instance);
+    }
 
     /*Initiate the command transfer*/
     request_transfer(instance);
@@ -758,6 +1131,13 @@ int32_t i3c_ll_send_xfer_command(uint8_t instance,
     {
         /* wait for the command transfer to complete, signaled by the xfer semaphore*/
         ret = WAIT_FOR_XFER_COMPLETE(instance);
+        if ((ret != I3C_OK) && (i3c_obj[instance].dma_pending > 0U))
+        {
+            /* No response, drop the DMA jobs */
+            i3c_dma_stop(instance);
+            i3c_obj[instance].dma_pending = 0U;
+            i3c_dma_finish(instance);
+        }
 
         /*Disable the TX THRESHOLD INTERRUPT*/
         uint32_t interrupt_signal_enable =
@@ -1035,3 +1415,97 @@ int32_t i3c_ll_detach_device(uint8_t instance,
 }
 
 /* end of File*/
+
+/* Open and configure a free DMA channel for the I3C controller */
+static dma_handle_t i3c_dma_open_channel(dma_xfer_type_t dir,
+        dma_peri_id_t peri_id, uint8_t prio)
+{
+    dma_handle_t hdma;
+    dma_config_t cfg;
+    uint32_t inst;
+    uint32_t ch;
+
+    for (inst = 0U; inst < I3C_DMA_NUM_CONTROLLERS; inst++)
+    {
+        for (ch = 0U; ch < I3C_DMA_NUM_CHANNELS; ch++)
+        {
+            hdma = dma_open(inst, ch);
+            if (hdma == NULL)
+            {
+                continue;
+            }
+            cfg.instance = (uint8_t)inst;
+            cfg.ch_dir = dir;
+            cfg.ch_prio = prio;
+            cfg.peri_id = peri_id;
+            cfg.callback = NULL;
+            if (dma_config(hdma, &cfg) == 0)
+            {
+                return hdma;
+            }
+            (void)dma_close(hdma);
+        }
+    }
+    return NULL;
+}
+
+/* Release the DMA channels, the controller must be idle */
+static void i3c_dma_release(uint8_t instance)
+{
+    if (i3c_obj[instance].rx_dma != NULL)
+    {
+        (void)dma_close(i3c_obj[instance].rx_dma);
+        i3c_obj[instance].rx_dma = NULL;
+    }
+    if (i3c_obj[instance].tx_dma != NULL)
+    {
+        (void)dma_close(i3c_obj[instance].tx_dma);
+        i3c_obj[instance].tx_dma = NULL;
+    }
+    i3c_obj[instance].dma_enabled = false;
+}
+
+/**
+ * @brief Enable or disable the DMA mode of the controller.
+ *
+ * @param[in] instance   Instance of the I3C controller.
+ * @param[in] enable     true to move the data of large transfers with the DMA.
+ * @param[in] threshold  Transfers of at least this many bytes use the DMA.
+ * @return int32_t       I3C_OK if the operation was successful,
+ *                       I3C_DENIED if the controller has no DMA interface
+ *                       or no DMA channel is free.
+ */
+int32_t i3c_ll_set_dma_mode(uint8_t instance, bool enable, uint16_t threshold)
+{
+    if (instance >= I3C_NUM_INSTANCES)
+    {
+        return I3C_PARAM;
+    }
+    if (i3c_obj[instance].dma_enabled == true)
+    {
+        i3c_dma_release(instance);
+    }
+    i3c_obj[instance].dma_threshold = threshold;
+    if (!enable)
+    {
+        return I3C_OK;
+    }
+
+    if (HAL_REG_READ_FIELD((i3c_obj[instance].reg_base + I3C_HW_CAPABILITY),
+            I3C_HW_CAPABILITY_DMA_EN_POS, I3C_HW_CAPABILITY_DMA_EN_MASK) == 0U)
+    {
+        return I3C_DENIED;
+    }
+    i3c_obj[instance].tx_dma = i3c_dma_open_channel(DMA_MEM_TO_PERI_DMAC,
+            GET_I3C_DMA_TX_ID(instance), 0U);
+    /* The receive FIFO overflows if it is not drained in time */
+    i3c_obj[instance].rx_dma = i3c_dma_open_channel(DMA_PERI_TO_MEM_DMAC,
+            GET_I3C_DMA_RX_ID(instance), 1U);
+    if ((i3c_obj[instance].tx_dma == NULL) || (i3c_obj[instance].rx_dma == NULL))
+    {
+        i3c_dma_release(instance);
+        return I3C_DENIED;
+    }
+    i3c_obj[instance].dma_enabled = true;
+    return I3C_OK;
+}
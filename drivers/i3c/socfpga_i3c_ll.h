@@ -9,6 +9,7 @@
 #define __SOCFPGA_I3C_LL_H__
 
 #include "osal.h"
+#include "socfpga_dma.h"
 
 #define I3C_CORE_CLOCK    (200U * MHZ)                                /*200Mhz : i3c core clock source is 14_mp_clk
                                                                          and according to Fig259 (TRM)14_mp_clk value is 200Mhz */
@@ -16,6 +17,7 @@
 
 #define I3C_MAX_DEVICES    (8U)
 #define I3C_MAX_XFER       (16U)
+#define I3C_DMA_MAX_BLOCKS    (2U)                                /* blocks of a DMA job of up to 64 KiB*/
 
 #define I3C_CONTROLLER_REGISTER_BASE(inst)    (((inst) == I3C_INSTANCE1) \
     ? 0x10DA0000   \
@@ -256,6 +258,7 @@ struct i3c_cmd_obj
     uint16_t read_bytes_left;
     uint8_t *read_buffer;
     int32_t status;
+    bool is_dma;                /* data moved by the DMA*/
 };
 
 /* command payload structure.
@@ -363,6 +366,18 @@ struct i3c_driver_obj
     osal_semaphore_t xfer_complete;           /* signal to indicate the current xfer request is completed*/
     osal_semaphore_t lock;                   /* mutex to prevent concurrent access while an operation is ongoing */
 
+    /* DMA mode, moves the data of the only write and the only read of a request */
+    bool dma_enabled;
+    uint16_t dma_threshold;                  /* transfers of at least this many bytes use the DMA */
+    dma_handle_t tx_dma;
+    dma_handle_t rx_dma;
+    dma_xfer_cfg_t dma_blocks[I3C_DMA_MAX_BLOCKS];
+    struct i3c_cmd_obj *dma_tx_cmd;
+    struct i3c_cmd_obj *dma_rx_cmd;
+    uint16_t dma_tx_len;                     /* whole words moved by the DMA */
+    uint16_t dma_rx_len;
+    uint32_t dma_pending;                    /* DMA jobs and the response still to complete */
+    int32_t dma_status;
 };
 
 extern int32_t i3c_ll_attach_i2c_device(uint8_t instance, struct
@@ -383,4 +398,7 @@ extern int32_t i3c_ll_send_xfer_command(uint8_t instance,
 
 extern void i3c_ll_init(uint8_t instance);
 
+extern int32_t i3c_ll_set_dma_mode(uint8_t instance, bool enable,
+        uint16_t threshold);
+
 #endif // __SOCFPGA_I3C_LL_H__
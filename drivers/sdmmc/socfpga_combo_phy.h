@@ -58,6 +58,10 @@
 #define WRCMD0_DLY                   (1U)
 #define REG_ADD_LSB_MASK             (0x0000FFFFU)
 #define PHONY_DQS_DELAY              (0x3FU << 4U)
+#define SEL_DLL_LOCK_MODE            ((uint32_t) 0 << 23U)
+#define READ_DQS_CMD_DELAY_POS       24U
+#define READ_DQS_DELAY_POS           0U
+#define READ_DELAY_MASK              (0xFFU)
 
 
 #endif
@@ -55,6 +55,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include "osal.h"
 #include "osal_log.h"
@@ -74,16 +75,21 @@
 #define DEV_TYPE_SD      0
 #define DEV_TYPE_EMMC    1
 
-/*specify max descriptor count here
- * 1 descriptor can handle up to 64KB of data
+/*specify initial descriptor count here
+ * 1 descriptor can handle up to 64KB of data, the table grows when a
+ * transfer needs more
  */
 #define SDMMC_MAX_DESCRIPTOR    160U
 /* specify your device here */
 #define DEV_TYPE    DEV_TYPE_SD
 
 /*INFO:
- * Driver supports High speed[speed upto 25 MBps at 50 MHz] and
- * Default speed[speed upto 12.5 MBps at 25 MHz] mode.
+ * The card is switched to the fastest bus timing supported by the host and
+ * the card: SDR104[upto 104 MBps at 200 MHz], SDR50[upto 50 MBps at 100 MHz]
+ * for SD cards, HS400[upto 400 MBps at 200 MHz DDR], HS200[upto 200 MBps at
+ * 200 MHz] for eMMC devices, then High speed[upto 25 MBps at 50 MHz] and
+ * Default speed[upto 12.5 MBps at 25 MHz]. Enabling SUPPORT_DEF_SPEED keeps
+ * the card in Default speed.
  **/
 
 #define SUPPORT_DEF_SPEED    DEF_SPEED_DI
@@ -94,23 +100,46 @@
 
 #if (DEV_TYPE ==  DEV_TYPE_SD)
 #define BUS_PARAM    0
-static int32_t sd_mmc_init(uint64_t *sec_num);
+static int32_t sd_mmc_init(uint64_t *sec_num, sdmmc_timing_t limit);
 static int32_t sd_go_idle(cmd_parameters_t *pcmd);
 static int32_t sd_snd_if_cond(cmd_parameters_t *pcmd);
 static int32_t sd_snd_app_cmd(cmd_parameters_t *pcmd);
-static int32_t sd_check_ocr(cmd_parameters_t *pcmd);
+static int32_t sd_check_ocr(cmd_parameters_t *pcmd, uint32_t ocr_arg);
 static int32_t sd_snd_all_cid(cmd_parameters_t *pcmd);
 static int32_t sd_snd_rel_add(cmd_parameters_t *pcmd);
 static int32_t sd_sel_card(cmd_parameters_t *pcmd);
 static int32_t sd_snd_csd(cmd_parameters_t *pcmd);
-static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle);
+static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle,
+        uint32_t ocr_arg);
 static int32_t sd_snd_app_bus_cmd(cmd_parameters_t *pcmd);
 static int32_t sd_set_bus_width(cmd_parameters_t *pcmd_handle);
 static int32_t sd_bus_width_4(cmd_parameters_t *pcmd);
+static int32_t sd_voltage_switch(cmd_parameters_t *pcmd);
+static int32_t sd_switch_func(cmd_parameters_t *pcmd, uint32_t argument);
+static int32_t sd_select_timing(cmd_parameters_t *pcmd, sdmmc_timing_t limit);
+static int32_t sd_send_scr(cmd_parameters_t *pcmd);
+
+/*
+ * Bytes of the switch function status. The access modes of function group 1
+ * are numbered as sdmmc_timing_t up to SDR104.
+ */
+#define SD_SWITCH_GROUP1_SUPPORT    13U
+#define SD_SWITCH_GROUP1_RESULT     16U
+#define SD_SWITCH_RESULT_MASK       0xFU
+#define SD_UHS_MODES_MASK           0x1CU
+
+static uint8_t sd_switch_status[SDMMC_SWITCH_STATUS_SIZE]
+__attribute__((aligned(64)));
+
+/*CMD_SUPPORT bits of the SCR, in its fourth byte*/
+#define SD_SCR_CMD_SUPPORT          3U
+#define SD_SCR_CMD23_SUPPORT        0x2U
+
+static uint8_t sd_scr[SDMMC_SCR_SIZE] __attribute__((aligned(64)));
 
 #elif (DEV_TYPE ==  DEV_TYPE_EMMC)
 #define BUS_PARAM    1
-static int32_t sd_mmc_init(uint64_t *sec_num);
+static int32_t sd_mmc_init(uint64_t *sec_num, sdmmc_timing_t limit);
 static int32_t mmc_go_idle(cmd_parameters_t *pcmd);
 static int32_t mmc_snd_all_cid(cmd_parameters_t *pcmd);
 static int32_t mmc_set_rel_add(cmd_parameters_t *pcmd);
@@ -119,19 +148,147 @@ static int32_t mmc_sel_card(cmd_parameters_t *pcmd);
 static int32_t mmc_snd_csd(cmd_parameters_t *pcmd);
 static int32_t mmc_send_ext_csd(cmd_parameters_t *pcmd,
         uint64_t *sector_count_ref);
-static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd);
+static int32_t mmc_switch(cmd_parameters_t *pcmd, uint32_t argument);
+static int32_t mmc_select_timing(cmd_parameters_t *pcmd, sdmmc_timing_t limit);
+static int32_t mmc_cq_enable(void);
+static int32_t mmc_cq_disable(void);
+static void mmc_cq_free(void);
+
+/*EXT CSD fields used to select the bus timing*/
+#define MMC_DEVICE_TYPE_HS       0x03U
+#define MMC_DEVICE_TYPE_HS200    0x10U
+#define MMC_DEVICE_TYPE_HS400    0x40U
+#define MMC_HS_TIMING_HS         1U
+#define MMC_HS_TIMING_HS200      2U
+#define MMC_HS_TIMING_HS400      3U
+#define MMC_BUS_WIDTH_8_DDR      6U
 
 static uint8_t ext_csd_buff[512];
 
+/*Tuning block of the 8-bit bus defined by the eMMC specification*/
+static const uint8_t tuning_pattern_8bit[128] =
+{
+    0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00,
+    0xFF, 0xFF, 0xCC, 0xCC, 0xCC, 0x33, 0xCC, 0xCC,
+    0xCC, 0x33, 0x33, 0xCC, 0xCC, 0xCC, 0xFF, 0xFF,
+    0xFF, 0xEE, 0xFF, 0xFF, 0xFF, 0xEE, 0xEE, 0xFF,
+    0xFF, 0xFF, 0xDD, 0xFF, 0xFF, 0xFF, 0xDD, 0xDD,
+    0xFF, 0xFF, 0xFF, 0xBB, 0xFF, 0xFF, 0xFF, 0xBB,
+    0xBB, 0xFF, 0xFF, 0xFF, 0x77, 0xFF, 0xFF, 0xFF,
+    0x77, 0x77, 0xFF, 0x77, 0xBB, 0xDD, 0xEE, 0xFF,
+    0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00,
+    0x00, 0xFF, 0xFF, 0xCC, 0xCC, 0xCC, 0x33, 0xCC,
+    0xCC, 0xCC, 0x33, 0x33, 0xCC, 0xCC, 0xCC, 0xFF,
+    0xFF, 0xFF, 0xEE, 0xFF, 0xFF, 0xFF, 0xEE, 0xEE,
+    0xFF, 0xFF, 0xFF, 0xDD, 0xFF, 0xFF, 0xFF, 0xDD,
+    0xDD, 0xFF, 0xFF, 0xFF, 0xBB, 0xFF, 0xFF, 0xFF,
+    0xBB, 0xBB, 0xFF, 0xFF, 0xFF, 0x77, 0xFF, 0xFF,
+    0xFF, 0x77, 0x77, 0xFF, 0x77, 0xBB, 0xDD, 0xEE,
+};
+
 #else
 #error "Device not supported"
 #endif
 
 static int32_t sdmmc_setup_host(void);
+static int32_t sdmmc_execute_tuning(uint8_t command_index,
+        const uint8_t *pattern, uint32_t size);
+
+/*Tuning block of the 4-bit bus defined by the SD specification*/
+static const uint8_t tuning_pattern_4bit[64] =
+{
+    0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC,
+    0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
+    0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB,
+    0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
+    0xFF, 0xF0, 0xFF, 0xF0, 0x0F, 0xFC, 0xCC, 0x3C,
+    0xCC, 0x33, 0xCC, 0xCF, 0xFF, 0xEF, 0xFF, 0xEE,
+    0xFF, 0xFD, 0xFF, 0xFD, 0xDF, 0xFF, 0xBF, 0xFF,
+    0xBB, 0xFF, 0xF7, 0xFF, 0xF7, 0x7F, 0x7B, 0xDE,
+};
+
+static uint32_t tuning_buff[128U / sizeof(uint32_t)];
+
+static const char *const timing_name[] =
+{
+    "Default speed", "High speed", "SDR50", "SDR104", "HS200", "HS400"
+};
 
 static void sdmmc_wait_xfer_done(void);
 void sdmmc_irq_handler(void *data);
 static void sdmmc_wait_cmd_done(void);
+static int32_t sdmmc_prepare_xfer(uint32_t block_size);
+static int32_t sdmmc_queue_issue(const sdmmc_request_t *preq);
+static void sdmmc_queue_complete(sdmmc_request_t *preq, int32_t status);
+static void sdmmc_queue_xfer_done(int32_t xfer_flag);
+static void sdmmc_queue_cq_irq(void);
+static void sdmmc_irq_error(uint32_t int_status, uint32_t is_xfer);
+static int32_t sdmmc_reserve_descriptors(uint64_t count);
+static int32_t sdmmc_xfer_start(const sdmmc_sg_entry_t *psg,
+        uint32_t sg_count, uint64_t addr, uint32_t block_size, bool is_write,
+        bool is_sync, sdmmc_cb_fun xfer_done_call_back);
+static int32_t sdmmc_xfer_block(uint64_t *pbuffer, uint64_t addr,
+        uint32_t block_size, uint32_t number_of_blocks, bool is_write,
+        bool is_sync, sdmmc_cb_fun xfer_done_call_back);
+static int32_t sdmmc_xfer_next(void);
+static int32_t sdmmc_xfer_continue(void);
+static void sdmmc_read_maintenance(const sdmmc_sg_entry_t *psg,
+        uint32_t sg_count);
+
+/*
+ * Number of blocks a single command carries, the width of the block count
+ * register. A longer transfer is split and the transfer complete interrupt
+ * of each part sends the next one.
+ */
+#define SDMMC_MAX_XFER_BLOCKS    0xFFFFU
+
+#define SDMMC_CACHE_LINE         64U
+
+/*
+ * Transfer of the block functions. The single buffer functions use a list
+ * of one entry.
+ */
+struct sdmmc_xfer
+{
+    const sdmmc_sg_entry_t *psg;    /* NULL when no transfer is in progress */
+    sdmmc_sg_entry_t single;
+    uint32_t sg_count;
+    uint64_t offset;                /* bytes of the list already sent */
+    uint64_t block_addr;
+    uint32_t block_size;
+    uint32_t blocks_left;
+    bool is_write;
+};
+
+static struct sdmmc_xfer sdmmc_xfer;
+
+/*
+ * Request queue. A request takes the tag of a free slot. With the command
+ * queue engine every slot is a task of the engine. Otherwise the requests
+ * wait in a list and the transfer complete interrupt sends the next one.
+ * Each slot has the transfer descriptors of a 1MB request.
+ */
+#define SDMMC_QUEUE_DEPTH         32U
+#define SDMMC_QUEUE_MAX_DESC      16U
+#define SDMMC_QUEUE_MAX_BLOCKS    ((SDMMC_QUEUE_MAX_DESC * DESC_MAX_XFER_SIZE) / \
+    SDMMC_BLOCK_SIZE)
+#define SDMMC_CQ_TDL_ALIGN        1024U
+
+struct sdmmc_queue
+{
+    bool is_open;
+    bool use_cqe;
+    uint32_t depth;
+    uint32_t free_tags;
+    sdmmc_request_t *preq[SDMMC_QUEUE_DEPTH];
+    sdmmc_request_t *phead;
+    sdmmc_request_t *ptail;
+    sdmmc_request_t *pactive;
+    cq_slot_t *ptdl;
+    cq_descriptor_t *pxfer_desc;
+};
+
+static struct sdmmc_queue sdmmc_queue;
 
 static card_data_t *pcard_specific_data;
 static card_data_t card_data;
@@ -139,6 +296,18 @@ static card_data_t card_data;
 static osal_semaphore_def_t osal_def_xfer;
 static osal_semaphore_def_t osal_def_cmd;
 
+/*
+ * Transfer state of the card. The block length set by CMD16 holds until the
+ * next CMD16, so CMD16 is only sent when a transfer needs another length or
+ * after an error left the card in an unknown state.
+ */
+typedef enum
+{
+    SDMMC_CARD_UNKNOWN = 0,    /* not initialized, or after an error */
+    SDMMC_CARD_TRAN,           /* transfer state with a known block length */
+    SDMMC_CARD_CMDQ            /* driven by the command queue engine */
+} sdmmc_card_state_t;
+
 struct sdmmc_context
 {
     bool is_api_sync;
@@ -146,461 +315,892 @@ struct sdmmc_context
     osal_semaphore_t semaphore_xfer;
     osal_semaphore_t semaphore_cmd;
     sdmmc_cb_fun xfer_call_back;
-    dma_descriptor_t dma_descriptor[SDMMC_MAX_DESCRIPTOR];
+    dma_descriptor_t *dma_descriptor;
+    uint32_t desc_count;
     uint32_t is_def_speed_supported;
     uint32_t dev_type;
+    sdmmc_timing_t timing_limit;
+    sdmmc_timing_t timing;
+    uint32_t tuning_tap;
+    uint32_t cq_depth;
+    sdmmc_card_state_t card_state;
+    uint32_t block_len;
 };
 
-static struct sdmmc_context sdmmc_descriptor;
+static struct sdmmc_context sdmmc_descriptor =
+{
+    .timing_limit = SDMMC_TIMING_AUTO,
+};
 
 int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
         uint32_t block_size, uint32_t number_of_blocks,
         sdmmc_cb_fun xfer_done_call_back)
 {
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
-    int32_t state;
-    sdmmc_descriptor.status_code = 0;
+    DEBUG("Initiating sdmmc data read");
+    return sdmmc_xfer_block(pread_buffer, read_addr, block_size,
+            number_of_blocks, false, false, xfer_done_call_back);
+}
 
-    sdmmc_descriptor.is_api_sync = false;
-    sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
+int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
+        uint32_t block_size, uint32_t number_of_blocks)
+{
+    int32_t state;
 
-    if (block_size == 0U)
+    DEBUG("Initiating sdmmc data read");
+    state = sdmmc_xfer_block(pread_buffer, read_addr, block_size,
+            number_of_blocks, false, true, NULL);
+    if (state == 0)
     {
-        return -EINVAL;
+        DEBUG("Read %x blocks", number_of_blocks);
     }
+    return state;
+}
 
-    /*convert address into block number*/
-    read_addr /= block_size;
+int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
+        uint32_t block_size, uint32_t number_of_blocks,
+        sdmmc_cb_fun xfer_done_call_back)
+{
+    INFO("Initiating sdmmc data write");
+    return sdmmc_xfer_block(pwrite_buffer, write_addr, block_size,
+            number_of_blocks, true, false, xfer_done_call_back);
+}
+
+int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
+        uint32_t block_size, uint32_t number_of_blocks)
+{
+    int32_t state;
 
-    if ((pread_buffer == NULL) || (number_of_blocks == 0U))
+    INFO("Initiating sdmmc data write");
+    state = sdmmc_xfer_block(pwrite_buffer, write_addr, block_size,
+            number_of_blocks, true, true, NULL);
+    if (state == 0)
     {
-        return -EINVAL;
+        INFO("Written %x blocks", number_of_blocks);
     }
-    /*send cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
+    return state;
+}
 
-    if (state != 0)
+int32_t sdmmc_read_sg_sync(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t read_addr, uint32_t block_size)
+{
+    return sdmmc_xfer_start(psg, sg_count, read_addr, block_size, false,
+            true, NULL);
+}
+
+int32_t sdmmc_write_sg_sync(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t write_addr, uint32_t block_size)
+{
+    return sdmmc_xfer_start(psg, sg_count, write_addr, block_size, true,
+            true, NULL);
+}
+
+int32_t sdmmc_read_sg_async(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t read_addr, uint32_t block_size, sdmmc_cb_fun
+        xfer_done_call_back)
+{
+    return sdmmc_xfer_start(psg, sg_count, read_addr, block_size, false,
+            false, xfer_done_call_back);
+}
+
+int32_t sdmmc_write_sg_async(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t write_addr, uint32_t block_size, sdmmc_cb_fun
+        xfer_done_call_back)
+{
+    return sdmmc_xfer_start(psg, sg_count, write_addr, block_size, true,
+            false, xfer_done_call_back);
+}
+
+/*
+ * Grows the descriptor table to at least count descriptors. The table is
+ * only replaced by a larger one, so it keeps the size of the largest
+ * transfer seen.
+ */
+static int32_t sdmmc_reserve_descriptors(uint64_t count)
+{
+    dma_descriptor_t *pdesc;
+    uint64_t capacity = sdmmc_descriptor.desc_count;
+
+    if (sdmmc_descriptor.dma_descriptor == NULL)
     {
         return -EIO;
     }
+    if (count <= capacity)
+    {
+        return 0;
+    }
+    while (capacity < count)
+    {
+        capacity *= 2UL;
+    }
+    if (capacity > (UINT32_MAX / sizeof(dma_descriptor_t)))
+    {
+        return -ENOMEM;
+    }
 
-    sdmmc_wait_cmd_done();
+    pdesc = (dma_descriptor_t *)pvPortMallocCoherentAligned(64U,
+            sizeof(dma_descriptor_t) * capacity);
+    if (pdesc == NULL)
+    {
+        ERROR("Cannot grow the DMA descriptors to %u", (uint32_t)capacity);
+        return -ENOMEM;
+    }
+    vPortFreeCoherent(sdmmc_descriptor.dma_descriptor);
+    sdmmc_descriptor.dma_descriptor = pdesc;
+    sdmmc_descriptor.desc_count = (uint32_t)capacity;
+    return 0;
+}
 
-    if (sdmmc_descriptor.status_code != 0)
+/*
+ * Checks the list, sizes the descriptor table and sends the first command
+ * of the transfer. The table is sized for the whole list, plus one for the
+ * buffer a split may cut in two, as every part starts from its beginning.
+ */
+static int32_t sdmmc_xfer_start(const sdmmc_sg_entry_t *psg,
+        uint32_t sg_count, uint64_t addr, uint32_t block_size, bool is_write,
+        bool is_sync, sdmmc_cb_fun xfer_done_call_back)
+{
+    uint64_t total = 0UL;
+    uint64_t desc_count = 1UL;
+    uint32_t i;
+    int32_t state;
+
+    if ((sdmmc_queue.is_open == true) || (sdmmc_xfer.psg != NULL))
     {
-        return -EIO;
+        return -EBUSY;
+    }
+    if ((psg == NULL) || (sg_count == 0U) || (block_size == 0U))
+    {
+        return -EINVAL;
     }
-    /*argument preparation for data read*/
-    if (number_of_blocks > 1U)
+    for (i = 0U; i < sg_count; i++)
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        /*the DMA moves words*/
+        if ((psg[i].buffer == NULL) || (psg[i].length == 0U) ||
+                (((uintptr_t)psg[i].buffer & 0x3U) != 0U) ||
+                ((psg[i].length & 0x3U) != 0U))
+        {
+            return -EINVAL;
+        }
+        total += psg[i].length;
+        desc_count += ((uint64_t)psg[i].length + DESC_MAX_XFER_SIZE - 1U) /
+                DESC_MAX_XFER_SIZE;
     }
-    else
+    if (((total % block_size) != 0UL) || ((total / block_size) > UINT32_MAX))
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_SINGLE_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return -EINVAL;
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
 
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+    /*the list marks the transfer in progress, every failure clears it*/
+    sdmmc_xfer.psg = psg;
+    state = sdmmc_reserve_descriptors(desc_count);
+    if (state == 0)
     {
-        return -EIO;
-    }
+        sdmmc_descriptor.status_code = 0;
+        sdmmc_descriptor.is_api_sync = is_sync;
+        sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
 
-    /*send cmd to request data from the card*/
-    else
+        /*set the block size unless the card already uses it*/
+        state = sdmmc_prepare_xfer(block_size);
+    }
+    if (state == 0)
     {
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pread_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
-        DEBUG("Initiating sdmmc data read");
-        state = sdmmc_send_command(pcmd);
-        if (state != 0)
+        if (is_write == true)
         {
-            return -EIO;
+            for (i = 0U; i < sg_count; i++)
+            {
+                cache_force_write_back_nosync(psg[i].buffer, psg[i].length);
+            }
+            cache_sync();
+        }
+        else
+        {
+            sdmmc_read_maintenance(psg, sg_count);
         }
 
+        sdmmc_xfer.sg_count = sg_count;
+        sdmmc_xfer.offset = 0UL;
+        /*convert address into block number*/
+        sdmmc_xfer.block_addr = addr / block_size;
+        sdmmc_xfer.block_size = block_size;
+        sdmmc_xfer.blocks_left = (uint32_t)(total / block_size);
+        sdmmc_xfer.is_write = is_write;
+        state = sdmmc_xfer_next();
+    }
+    if (state != 0)
+    {
+        sdmmc_xfer.psg = NULL;
+        return state;
+    }
+    if (is_sync == false)
+    {
         return 0;
     }
+
+    sdmmc_wait_xfer_done();
+    return (sdmmc_descriptor.status_code == 0) ? 0 : -EIO;
 }
 
-int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
-        uint32_t block_size, uint32_t number_of_blocks)
+static int32_t sdmmc_xfer_block(uint64_t *pbuffer, uint64_t addr,
+        uint32_t block_size, uint32_t number_of_blocks, bool is_write,
+        bool is_sync, sdmmc_cb_fun xfer_done_call_back)
 {
-    sdmmc_descriptor.is_api_sync = false;
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
-    int32_t state;
+    uint64_t length = (uint64_t)block_size * number_of_blocks;
 
-    sdmmc_descriptor.is_api_sync = true;
-    if (block_size == 0U)
+    if ((sdmmc_queue.is_open == true) || (sdmmc_xfer.psg != NULL))
+    {
+        return -EBUSY;
+    }
+    if ((pbuffer == NULL) || (length == 0UL) || (length > UINT32_MAX))
     {
         return -EINVAL;
     }
+    sdmmc_xfer.single.buffer = pbuffer;
+    sdmmc_xfer.single.length = (uint32_t)length;
 
-    /*convert address into block number*/
-    read_addr /= block_size;
+    return sdmmc_xfer_start(&sdmmc_xfer.single, 1U, addr, block_size,
+            is_write, is_sync, xfer_done_call_back);
+}
+
+/*
+ * Sends the command of the next part of the transfer, from the task for the
+ * first part and from the transfer complete interrupt for the others.
+ */
+static int32_t sdmmc_xfer_next(void)
+{
+    cmd_parameters_t command_config;
+    uint32_t block_ct = sdmmc_xfer.blocks_left;
 
-    if ((pread_buffer == NULL) || (number_of_blocks == 0U))
+    if (block_ct > SDMMC_MAX_XFER_BLOCKS)
     {
-        return -EINVAL;
+        block_ct = SDMMC_MAX_XFER_BLOCKS;
     }
-    /*send cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
 
-    if (state != 0)
+    command_config.argument = sdmmc_xfer.block_addr;
+    if (sdmmc_xfer.is_write == true)
+    {
+        command_config.command_index = (block_ct > 1U) ?
+                SDMMC_CMD_WRITE_MULT_BLOCK : SDMMC_CMD_WRITE_SINGLE_BLOCK;
+    }
+    else
+    {
+        command_config.command_index = (block_ct > 1U) ?
+                SDMMC_CMD_READ_MULT_BLOCK : SDMMC_CMD_READ_SINGLE_BLOCK;
+    }
+    command_config.data_xfer_present = SDMMC_DATA_XFER_PST;
+    command_config.response_type = SDMMC_SHORT_RESPONSE;
+    command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+
+    (void)sdmmc_set_up_xfer_sg(sdmmc_descriptor.dma_descriptor,
+            sdmmc_xfer.psg, sdmmc_xfer.sg_count, sdmmc_xfer.offset,
+            sdmmc_xfer.block_size, block_ct);
+    sdmmc_set_xfer_config(&command_config);
+
+    sdmmc_xfer.offset += (uint64_t)block_ct * sdmmc_xfer.block_size;
+    sdmmc_xfer.block_addr += block_ct;
+    sdmmc_xfer.blocks_left -= block_ct;
+
+    if (sdmmc_send_command(&command_config) != 0)
     {
         return -EIO;
     }
+    return 0;
+}
 
-    sdmmc_wait_cmd_done();
+/*
+ * Called on the transfer complete interrupt. Returns 1 when the next part
+ * of the transfer was sent, 0 when the transfer is done and -EIO when the
+ * next part could not be sent. Transfers of the driver itself and of the
+ * request queue have no list and are done at once.
+ */
+static int32_t sdmmc_xfer_continue(void)
+{
+    if (sdmmc_xfer.psg == NULL)
+    {
+        return 0;
+    }
+    if (sdmmc_xfer.blocks_left != 0U)
+    {
+        if (sdmmc_xfer_next() == 0)
+        {
+            return 1;
+        }
+        sdmmc_xfer.psg = NULL;
+        return -EIO;
+    }
 
-    if (sdmmc_descriptor.status_code != 0)
+    if (sdmmc_xfer.is_write == false)
+    {
+        sdmmc_read_maintenance(sdmmc_xfer.psg, sdmmc_xfer.sg_count);
+    }
+    sdmmc_xfer.psg = NULL;
+    return 0;
+}
+
+/*
+ * Cache maintenance of the buffers of a read, before and after the DMA. A
+ * line a buffer shares with other data at either end is written back and
+ * invalidated, so no dirty line is evicted over the data and the other data
+ * is kept. The lines of the buffer alone are only invalidated.
+ */
+static void sdmmc_read_maintenance(const sdmmc_sg_entry_t *psg,
+        uint32_t sg_count)
+{
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t head;
+    uintptr_t tail;
+    uint32_t i;
+
+    for (i = 0U; i < sg_count; i++)
+    {
+        start = (uintptr_t)psg[i].buffer;
+        end = start + psg[i].length;
+        head = (start + SDMMC_CACHE_LINE - 1U) &
+                ~((uintptr_t)SDMMC_CACHE_LINE - 1U);
+        tail = end & ~((uintptr_t)SDMMC_CACHE_LINE - 1U);
+        if (head >= tail)
+        {
+            cache_flush_nosync((void *)start, psg[i].length);
+            continue;
+        }
+        if (head != start)
+        {
+            cache_flush_nosync((void *)start, head - start);
+        }
+        cache_force_invalidate_nosync((void *)head, tail - head);
+        if (tail != end)
+        {
+            cache_flush_nosync((void *)tail, end - tail);
+        }
+    }
+    cache_sync();
+}
+
+int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
+{
+    int32_t ret;
+    int32_t cmd_status;
+    socfpga_interrupt_err_t intr_ret;
+    sdmmc_timing_t limit;
+
+    pcard_specific_data = &card_data;
+    if (pcard_specific_data == NULL)
     {
         return -EIO;
     }
-    /*argument preparation for data read*/
-    if (number_of_blocks > 1U)
+
+    if (ptr_sec_num == NULL)
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return -EINVAL;
     }
-    else
+
+    if (sdmmc_queue.is_open == true)
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_SINGLE_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return -EBUSY;
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
 
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+    if (sdmmc_is_card_present() != SDMMC_IS_CARD_DET)
     {
+        ERROR("Device detection failed");
         return -EIO;
     }
 
-    /*send cmd to request data from the card*/
-    else
+    /* The descriptor table lives in uncached memory shared with the ADMA */
+    if (sdmmc_descriptor.dma_descriptor == NULL)
     {
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pread_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
-        DEBUG("Initiating sdmmc data read");
-        state = sdmmc_send_command(pcmd);
-        if (state != 0)
+        sdmmc_descriptor.dma_descriptor = (dma_descriptor_t *)
+                pvPortMallocCoherentAligned(64U,
+                sizeof(dma_descriptor_t) * SDMMC_MAX_DESCRIPTOR);
+        if (sdmmc_descriptor.dma_descriptor == NULL)
         {
-            return -EIO;
+            ERROR("Cannot allocate the DMA descriptors");
+            return -ENOMEM;
         }
+        sdmmc_descriptor.desc_count = SDMMC_MAX_DESCRIPTOR;
+    }
+    /*a transfer the card never completed is dropped*/
+    sdmmc_xfer.psg = NULL;
 
-        sdmmc_wait_xfer_done();
+    sdmmc_descriptor.is_def_speed_supported = SUPPORT_DEF_SPEED;
+    sdmmc_descriptor.dev_type = DEV_TYPE;
 
-        if (sdmmc_descriptor.status_code == 0)
+    sdmmc_descriptor.semaphore_xfer = osal_semaphore_create(&osal_def_xfer);
+    sdmmc_descriptor.semaphore_cmd = osal_semaphore_create(&osal_def_cmd);
+    intr_ret = interrupt_register_isr(SDMMC_IRQ, sdmmc_irq_handler, NULL);
+    if (intr_ret != ERR_OK)
+    {
+        return -EIO;
+    }
+    intr_ret = interrupt_enable(SDMMC_IRQ, GIC_INTERRUPT_PRIORITY_SDMMC);
+    if (intr_ret != ERR_OK)
+    {
+        return -EIO;
+    }
+
+    limit = sdmmc_descriptor.timing_limit;
+    if (sdmmc_descriptor.is_def_speed_supported == DEF_SPEED_EN)
+    {
+        limit = SDMMC_TIMING_DS;
+    }
+
+    sdmmc_descriptor.card_state = SDMMC_CARD_UNKNOWN;
+    for (;;)
+    {
+        ret = sdmmc_setup_host();
+
+        if (ret != CTRL_CONFIG_PASS)
         {
-            cache_force_invalidate((uint64_t *)pread_buffer, block_size *
-                    number_of_blocks);
-            DEBUG("Read %x blocks", number_of_blocks);
+            return -EIO;
+        }
+        sdmmc_descriptor.timing = SDMMC_TIMING_DS;
+        cmd_status = sd_mmc_init(ptr_sec_num, limit);
 
+        if (cmd_status == 0)
+        {
+            /*a selected card starts with blocks of 512 bytes*/
+            sdmmc_descriptor.block_len = SDMMC_BLOCK_SIZE;
+            sdmmc_descriptor.card_state = SDMMC_CARD_TRAN;
+            INFO("Card running in %s mode",
+                    timing_name[sdmmc_descriptor.timing]);
             return 0;
         }
-        else
+        if (sdmmc_descriptor.timing == SDMMC_TIMING_DS)
         {
             return -EIO;
         }
+        /*initialize again without the mode the card failed to switch to*/
+        WARN("Card failed in %s mode, falling back",
+                timing_name[sdmmc_descriptor.timing]);
+        limit = (sdmmc_timing_t)((uint32_t)sdmmc_descriptor.timing - 1U);
     }
 }
 
-int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
-        uint32_t block_size, uint32_t number_of_blocks,
-        sdmmc_cb_fun xfer_done_call_back)
+int32_t sdmmc_set_timing_limit(sdmmc_timing_t timing)
 {
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
-    int32_t state;
-
-    sdmmc_descriptor.is_api_sync = false;
-    sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
-
-    if (block_size == 0U)
+    if ((uint32_t)timing > (uint32_t)SDMMC_TIMING_AUTO)
     {
         return -EINVAL;
     }
+    sdmmc_descriptor.timing_limit = timing;
+    return 0;
+}
+
+sdmmc_timing_t sdmmc_get_timing(void)
+{
+    return sdmmc_descriptor.timing;
+}
 
-    /*converts address into block number*/
-    write_addr /= block_size;
+/*
+ * Set the block length of the next transfer. CMD16 is skipped while the
+ * card is known to use the length already.
+ */
+static int32_t sdmmc_prepare_xfer(uint32_t block_size)
+{
+    cmd_parameters_t command_config;
+    int32_t state;
 
-    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
+    if ((sdmmc_descriptor.card_state == SDMMC_CARD_TRAN) &&
+            (sdmmc_descriptor.block_len == block_size))
     {
-        return -EINVAL;
+        return 0;
     }
-    /*set cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
 
+    command_config.argument = block_size;
+    command_config.command_index = SDMMC_CMD_SET_BLOCK_LEN;
+    command_config.data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
+    command_config.response_type = SDMMC_SHORT_RESPONSE;
+    command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+    state = sdmmc_send_command(&command_config);
     if (state != 0)
     {
+        sdmmc_descriptor.card_state = SDMMC_CARD_UNKNOWN;
         return -EIO;
     }
-
     sdmmc_wait_cmd_done();
-
     if (sdmmc_descriptor.status_code != 0)
     {
+        sdmmc_descriptor.card_state = SDMMC_CARD_UNKNOWN;
         return -EIO;
     }
-    /*argument preparation for data transfer*/
-    if (number_of_blocks > 1U)
+
+    sdmmc_descriptor.block_len = block_size;
+    sdmmc_descriptor.card_state = SDMMC_CARD_TRAN;
+    return 0;
+}
+
+int32_t sdmmc_queue_open(uint32_t *pdepth)
+{
+    int32_t state;
+
+    if (pdepth == NULL)
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return -EINVAL;
     }
-    else
+    if ((sdmmc_queue.is_open == true) || (sdmmc_xfer.psg != NULL))
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return -EBUSY;
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+    if (sdmmc_descriptor.dma_descriptor == NULL)
     {
         return -EIO;
     }
+    (void)memset(&sdmmc_queue, 0, sizeof(sdmmc_queue));
 
-    /*send cmd to transfer data to the card*/
-    else
+    /*every queued request moves blocks of SDMMC_BLOCK_SIZE bytes*/
+    state = sdmmc_prepare_xfer(SDMMC_BLOCK_SIZE);
+    if (state != 0)
     {
-        cache_force_write_back((uint64_t *)pwrite_buffer, block_size *
-                number_of_blocks);
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pwrite_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
+        return state;
+    }
 
-        state = sdmmc_send_command(pcmd);
-        INFO("Initiating sdmmc data write");
-        if (state != 0)
+    sdmmc_queue.depth = SDMMC_QUEUE_DEPTH;
+#if (DEV_TYPE == DEV_TYPE_EMMC)
+    if ((sdmmc_descriptor.cq_depth != 0U) && (sdmmc_cq_is_supported() == 1U))
+    {
+        state = mmc_cq_enable();
+        if (state == -ENOMEM)
         {
-            return -EIO;
+            return state;
+        }
+        if (state == 0)
+        {
+            sdmmc_queue.use_cqe = true;
+            sdmmc_descriptor.card_state = SDMMC_CARD_CMDQ;
+            if (sdmmc_descriptor.cq_depth < SDMMC_QUEUE_DEPTH)
+            {
+                sdmmc_queue.depth = sdmmc_descriptor.cq_depth;
+            }
+        }
+        else
+        {
+            WARN("Command queue engine not enabled, using the software queue");
         }
     }
+#endif
+    sdmmc_queue.free_tags = (sdmmc_queue.depth == 32U) ? 0xFFFFFFFFU :
+            (((uint32_t)1U << sdmmc_queue.depth) - 1U);
+
+    /*the software queue completes through the asynchronous transfer path*/
+    sdmmc_descriptor.is_api_sync = false;
+    sdmmc_descriptor.xfer_call_back = sdmmc_queue_xfer_done;
+    sdmmc_queue.is_open = true;
+
+    *pdepth = sdmmc_queue.depth;
+    INFO("Request queue of depth %u on the %s", sdmmc_queue.depth,
+            (sdmmc_queue.use_cqe == true) ? "command queue engine" :
+            "software queue");
     return 0;
 }
 
-int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
-        uint32_t block_size, uint32_t number_of_blocks)
+int32_t sdmmc_queue_close(void)
 {
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
+    uint32_t all_tags;
+#if (DEV_TYPE == DEV_TYPE_EMMC)
     int32_t state;
+#endif
 
-    sdmmc_descriptor.is_api_sync = true;
-    if (block_size == 0U)
+    if (sdmmc_queue.is_open == false)
     {
         return -EINVAL;
     }
-
-    /*converts address into block number*/
-    write_addr /= block_size;
-
-    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
+    all_tags = (sdmmc_queue.depth == 32U) ? 0xFFFFFFFFU :
+            (((uint32_t)1U << sdmmc_queue.depth) - 1U);
+    if (sdmmc_queue.free_tags != all_tags)
     {
-        return -EINVAL;
+        return -EBUSY;
     }
-    /*set cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
 
-    if (state != 0)
+    sdmmc_queue.is_open = false;
+    sdmmc_descriptor.xfer_call_back = NULL;
+#if (DEV_TYPE == DEV_TYPE_EMMC)
+    if (sdmmc_queue.use_cqe == true)
     {
-        return -EIO;
+        sdmmc_queue.use_cqe = false;
+        state = mmc_cq_disable();
+        sdmmc_descriptor.card_state = (state == 0) ? SDMMC_CARD_TRAN :
+                SDMMC_CARD_UNKNOWN;
+        return state;
     }
+#endif
+    return 0;
+}
 
-    sdmmc_wait_cmd_done();
+uint32_t sdmmc_queue_uses_cqe(void)
+{
+    return ((sdmmc_queue.is_open == true) && (sdmmc_queue.use_cqe == true)) ?
+           1U : 0U;
+}
 
-    if (sdmmc_descriptor.status_code != 0)
+int32_t sdmmc_submit_request(sdmmc_request_t *preq)
+{
+    UBaseType_t int_mask;
+    uint32_t size;
+    uint32_t tag;
+    int32_t state = 0;
+
+    if ((preq == NULL) || (preq->buffer == NULL) ||
+            (preq->number_of_blocks == 0U) ||
+            (preq->number_of_blocks > SDMMC_QUEUE_MAX_BLOCKS) ||
+            ((preq->addr % SDMMC_BLOCK_SIZE) != 0U))
+    {
+        return -EINVAL;
+    }
+    if (sdmmc_queue.is_open == false)
     {
         return -EIO;
     }
-    /*argument preparation for data transfer*/
-    if (number_of_blocks > 1U)
+
+    size = preq->number_of_blocks * SDMMC_BLOCK_SIZE;
+    if (preq->is_write != 0U)
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        cache_force_write_back(preq->buffer, size);
     }
     else
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        cache_force_invalidate(preq->buffer, size);
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
 
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+    /*the interrupt handler gives tags back and starts the next request*/
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if (sdmmc_queue.free_tags == 0U)
     {
-        return -EIO;
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        return -EBUSY;
     }
-    /*send cmd to transfer data to the card*/
-    else
-    {
-        cache_force_write_back((uint64_t *)pwrite_buffer, block_size *
-                number_of_blocks);
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pwrite_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
+    tag = (uint32_t)__builtin_ctz(sdmmc_queue.free_tags);
+    sdmmc_queue.free_tags &= ~((uint32_t)1U << tag);
+    sdmmc_queue.preq[tag] = preq;
+    preq->tag = tag;
+    preq->pnext = NULL;
 
-        state = sdmmc_send_command(pcmd);
-        INFO("Initiating sdmmc data write");
+    if (sdmmc_queue.use_cqe == true)
+    {
+        sdmmc_cq_set_up_task(&sdmmc_queue.ptdl[tag],
+                &sdmmc_queue.pxfer_desc[tag * SDMMC_QUEUE_MAX_DESC],
+                preq->buffer, preq->addr / SDMMC_BLOCK_SIZE,
+                preq->number_of_blocks, (preq->is_write != 0U) ? 0U : 1U);
+        sdmmc_cq_ring(tag);
+    }
+    else if (sdmmc_queue.pactive == NULL)
+    {
+        sdmmc_queue.pactive = preq;
+        state = sdmmc_queue_issue(preq);
         if (state != 0)
         {
-            return -EIO;
+            sdmmc_queue.pactive = NULL;
+            sdmmc_queue.preq[tag] = NULL;
+            sdmmc_queue.free_tags |= (uint32_t)1U << tag;
         }
-
-        sdmmc_wait_xfer_done();
-
-        if (sdmmc_descriptor.status_code == 0)
+    }
+    else
+    {
+        if (sdmmc_queue.ptail == NULL)
         {
-            INFO("Written %x blocks", number_of_blocks);
-            return 0;
+            sdmmc_queue.phead = preq;
         }
         else
         {
-            return -EIO;
+            sdmmc_queue.ptail->pnext = preq;
         }
+        sdmmc_queue.ptail = preq;
     }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+    return state;
 }
 
-
-int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
+/*
+ * Send a request of the software queue to the card.
+ */
+static int32_t sdmmc_queue_issue(const sdmmc_request_t *preq)
 {
-    int32_t ret;
-    int32_t cmd_status;
-    socfpga_interrupt_err_t intr_ret;
+    cmd_parameters_t command_config;
 
-    pcard_specific_data = &card_data;
-    if (pcard_specific_data == NULL)
+    command_config.argument = preq->addr / SDMMC_BLOCK_SIZE;
+    if (preq->is_write != 0U)
     {
-        return -EIO;
+        command_config.command_index = (preq->number_of_blocks > 1U) ?
+                SDMMC_CMD_WRITE_MULT_BLOCK : SDMMC_CMD_WRITE_SINGLE_BLOCK;
     }
-
-    if (ptr_sec_num == NULL)
+    else
     {
-        return -EINVAL;
+        command_config.command_index = (preq->number_of_blocks > 1U) ?
+                SDMMC_CMD_READ_MULT_BLOCK : SDMMC_CMD_READ_SINGLE_BLOCK;
     }
+    command_config.data_xfer_present = SDMMC_DATA_XFER_PST;
+    command_config.response_type = SDMMC_SHORT_RESPONSE;
+    command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
 
-    if (sdmmc_is_card_present() != SDMMC_IS_CARD_DET)
+    sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, preq->buffer,
+            SDMMC_BLOCK_SIZE, preq->number_of_blocks);
+    sdmmc_set_xfer_config(&command_config);
+    if (sdmmc_send_command(&command_config) != 0)
     {
-        ERROR("Device detection failed");
         return -EIO;
     }
+    return 0;
+}
 
-    sdmmc_descriptor.is_def_speed_supported = SUPPORT_DEF_SPEED;
-    sdmmc_descriptor.dev_type = DEV_TYPE;
+/*
+ * Give the tag of a finished request back and report the request.
+ */
+static void sdmmc_queue_complete(sdmmc_request_t *preq, int32_t status)
+{
+    if ((status == 0) && (preq->is_write == 0U))
+    {
+        cache_force_invalidate(preq->buffer, preq->number_of_blocks *
+                SDMMC_BLOCK_SIZE);
+    }
+    sdmmc_queue.preq[preq->tag] = NULL;
+    sdmmc_queue.free_tags |= (uint32_t)1U << preq->tag;
+    if (preq->call_back != NULL)
+    {
+        preq->call_back(preq, status);
+    }
+}
 
-    sdmmc_descriptor.semaphore_xfer = osal_semaphore_create(&osal_def_xfer);
-    sdmmc_descriptor.semaphore_cmd = osal_semaphore_create(&osal_def_cmd);
-    intr_ret = interrupt_register_isr(SDMMC_IRQ, sdmmc_irq_handler, NULL);
-    if (intr_ret != ERR_OK)
+/*
+ * Transfer complete callback of the software queue, runs in the interrupt.
+ * The next request is sent before the callback of the finished one so the
+ * bus does not wait for the callback.
+ */
+static void sdmmc_queue_xfer_done(int32_t xfer_flag)
+{
+    sdmmc_request_t *pdone = sdmmc_queue.pactive;
+    sdmmc_request_t *pnext;
+
+    sdmmc_queue.pactive = NULL;
+    while (sdmmc_queue.phead != NULL)
     {
-        return -EIO;
+        pnext = sdmmc_queue.phead;
+        sdmmc_queue.phead = pnext->pnext;
+        if (sdmmc_queue.phead == NULL)
+        {
+            sdmmc_queue.ptail = NULL;
+        }
+        sdmmc_queue.pactive = pnext;
+        if (sdmmc_queue_issue(pnext) == 0)
+        {
+            break;
+        }
+        sdmmc_queue.pactive = NULL;
+        sdmmc_queue_complete(pnext, -EIO);
     }
-    intr_ret = interrupt_enable(SDMMC_IRQ, GIC_INTERRUPT_PRIORITY_SDMMC);
-    if (intr_ret != ERR_OK)
+
+    if (pdone != NULL)
     {
-        return -EIO;
+        sdmmc_queue_complete(pdone, (xfer_flag == 0) ? 0 : -EIO);
     }
+}
 
-    ret = sdmmc_setup_host();
+/*
+ * Interrupt of the command queue engine. On an error the tasks it stopped
+ * are discarded and fail, the other tasks go on.
+ */
+static void sdmmc_queue_cq_irq(void)
+{
+    uint32_t done;
+    uint32_t failed = 0U;
+    uint32_t is_error;
+    uint32_t tag;
 
-    if (ret != CTRL_CONFIG_PASS)
+    done = sdmmc_cq_get_completions(&is_error);
+    if (is_error != 0U)
     {
-        return -EIO;
+        failed = sdmmc_cq_clear_tasks() & ~done;
     }
-    cmd_status = sd_mmc_init(ptr_sec_num);
 
-    if (cmd_status == 0)
+    while (done != 0U)
     {
-        return 0;
+        tag = (uint32_t)__builtin_ctz(done);
+        done &= done - 1U;
+        if (sdmmc_queue.preq[tag] != NULL)
+        {
+            sdmmc_queue_complete(sdmmc_queue.preq[tag], 0);
+        }
     }
-    else
+    while (failed != 0U)
+    {
+        tag = (uint32_t)__builtin_ctz(failed);
+        failed &= failed - 1U;
+        if (sdmmc_queue.preq[tag] != NULL)
+        {
+            sdmmc_queue_complete(sdmmc_queue.preq[tag], -EIO);
+        }
+    }
+}
+
+/*
+ * Sweep the read delay of the phy over the tuning block and keep the middle
+ * of the widest window of delays that read the block correctly.
+ */
+static int32_t sdmmc_execute_tuning(uint8_t command_index,
+        const uint8_t *pattern, uint32_t size)
+{
+    uint32_t tap;
+    uint32_t start = 0U;
+    uint32_t len = 0U;
+    uint32_t best_start = 0U;
+    uint32_t best_len = 0U;
+
+    for (tap = 0U; tap < SDMMC_TUNING_TAPS; tap++)
+    {
+        /*a delay the phy did not take counts as failed*/
+        if ((sdmmc_set_tuning_tap(tap) == CTRL_CONFIG_PASS) &&
+                (sdmmc_read_tuning_block(command_index, size, tuning_buff) ==
+                CTRL_CONFIG_PASS) && (memcmp(tuning_buff, pattern, size) == 0))
+        {
+            if (len == 0U)
+            {
+                start = tap;
+            }
+            len++;
+            if (len > best_len)
+            {
+                best_start = start;
+                best_len = len;
+            }
+        }
+        else
+        {
+            len = 0U;
+        }
+    }
+
+    if (best_len == 0U)
+    {
+        ERROR("Tuning failed in %s mode", timing_name[sdmmc_descriptor.timing]);
+        return -EIO;
+    }
+    sdmmc_descriptor.tuning_tap = best_start + (best_len / 2U);
+    if (sdmmc_set_tuning_tap(sdmmc_descriptor.tuning_tap) != CTRL_CONFIG_PASS)
     {
+        ERROR("Phy did not take the tuned delay");
         return -EIO;
     }
+    DEBUG("Tuned to tap %u of a %u tap window", sdmmc_descriptor.tuning_tap,
+            best_len);
+    return 0;
 }
 #if (DEV_TYPE ==  DEV_TYPE_SD)
 /*follows SD association standard*/
-static int32_t sd_mmc_init(uint64_t *sec_num)
+static int32_t sd_mmc_init(uint64_t *sec_num, sdmmc_timing_t limit)
 {
     cmd_parameters_t *pcmd_handle;
     cmd_parameters_t command_config;
+    uint32_t ocr_arg = SDMMC_ARG_SDHC_OCR;
     int32_t state;
 
     pcmd_handle = &command_config;
+    /*ask for 1.8V signaling when a UHS-I mode may be selected*/
+    if ((limit >= SDMMC_TIMING_SDR50) &&
+            (sdmmc_host_supports_timing(SDMMC_TIMING_SDR50) == 1U) &&
+            (sdmmc_is_signal_1v8() == 0U))
+    {
+        ocr_arg |= SDMMC_ARG_S18R;
+    }
     /*send cmd to set the card idle*/
     state = sd_go_idle(pcmd_handle);
     if (state != 0)
@@ -616,12 +1216,22 @@ static int32_t sd_mmc_init(uint64_t *sec_num)
     /*delay required when the combo phy clock -> 200 MHz*/
     osal_task_delay(10);
     /*send cmd to put card into ready state*/
-    state = sd_en_card_ready(pcmd_handle);
+    state = sd_en_card_ready(pcmd_handle, ocr_arg);
     if (state != 0)
     {
         return -EIO;
     }
     sd_get_card_type(pcard_specific_data);
+    /*switch to 1.8V signaling if the card accepted it*/
+    if (((ocr_arg & SDMMC_ARG_S18R) != 0U) && (sdmmc_is_1v8_accepted() == 1U))
+    {
+        sdmmc_descriptor.timing = SDMMC_TIMING_SDR50;
+        state = sd_voltage_switch(pcmd_handle);
+        if (state != 0)
+        {
+            return -EIO;
+        }
+    }
     /*send cmd to request cid of the card*/
     state = sd_snd_all_cid(pcmd_handle);
     if (state != 0)
@@ -649,8 +1259,20 @@ static int32_t sd_mmc_init(uint64_t *sec_num)
         return -EIO;
     }
     state = sd_set_bus_width(pcmd_handle);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    /*pre-define the length of multi block transfers if the card can*/
+    state = sd_send_scr(pcmd_handle);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    sdmmc_set_auto_cmd(((sd_scr[SD_SCR_CMD_SUPPORT] & SD_SCR_CMD23_SUPPORT) !=
+            0U) ? SDMMC_AUTO_CMD23 : SDMMC_AUTO_CMD12);
 
-    return state;
+    return sd_select_timing(pcmd_handle, limit);
 }
 static int32_t sd_go_idle(cmd_parameters_t *pcmd)
 {
@@ -706,10 +1328,10 @@ static int32_t sd_snd_app_cmd(cmd_parameters_t *pcmd)
     return sdmmc_descriptor.status_code;
 }
 
-static int32_t sd_check_ocr(cmd_parameters_t *pcmd)
+static int32_t sd_check_ocr(cmd_parameters_t *pcmd, uint32_t ocr_arg)
 {
     int32_t state;
-    pcmd->argument = SDMMC_ARG_SDHC_OCR;
+    pcmd->argument = ocr_arg;
     pcmd->command_index = SDMMC_CMD_READ_OCR;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
     pcmd->response_type = SDMMC_SHORT_RESPONSE;
@@ -760,7 +1382,8 @@ static int32_t sd_snd_rel_add(cmd_parameters_t *pcmd)
     return sdmmc_descriptor.status_code;
 
 }
-static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle)
+static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle,
+        uint32_t ocr_arg)
 {
     int32_t state;
     int retry = 100;
@@ -779,7 +1402,7 @@ static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle)
         {
             return -EIO;
         }
-        state = sd_check_ocr(pcmd_handle);
+        state = sd_check_ocr(pcmd_handle, ocr_arg);
         if (state != 0)
         {
             return -EIO;
@@ -887,13 +1510,167 @@ static int32_t sd_snd_app_bus_cmd(cmd_parameters_t *pcmd)
     sdmmc_wait_cmd_done();
     return sdmmc_descriptor.status_code;
 }
+
+static int32_t sd_voltage_switch(cmd_parameters_t *pcmd)
+{
+    int32_t state;
+    pcmd->argument = SDMMC_NO_CMD_ARG;
+    pcmd->command_index = SDMMC_CMD_VOLTAGE_SWITCH;
+    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
+    pcmd->response_type = SDMMC_SHORT_RESPONSE;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+    state = sdmmc_send_command(pcmd);
+    if (state != 0)
+    {
+        return state;
+    }
+    sdmmc_wait_cmd_done();
+    if (sdmmc_descriptor.status_code != 0)
+    {
+        return sdmmc_descriptor.status_code;
+    }
+    if (sdmmc_switch_signal_1v8(1U) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    return 0;
+}
+
+static int32_t sd_switch_func(cmd_parameters_t *pcmd, uint32_t argument)
+{
+    int32_t state;
+    pcmd->argument = argument;
+    pcmd->command_index = SDMMC_CMD_SWITCH;
+    pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
+    pcmd->response_type = SDMMC_SHORT_RESPONSE;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+
+    sdmmc_descriptor.is_api_sync = true;
+
+    sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor,
+            (uint64_t *)sd_switch_status, SDMMC_SWITCH_STATUS_SIZE,
+            SDMMC_SINGLE_BLOCK);
+    sdmmc_set_xfer_config(pcmd);
+
+    state = sdmmc_send_command(pcmd);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    sdmmc_wait_xfer_done();
+
+    if (sdmmc_descriptor.status_code == 0)
+    {
+        cache_force_invalidate(sd_switch_status, SDMMC_SWITCH_STATUS_SIZE);
+    }
+    return sdmmc_descriptor.status_code;
+}
+
+static int32_t sd_send_scr(cmd_parameters_t *pcmd)
+{
+    int32_t state;
+
+    state = sd_snd_app_bus_cmd(pcmd);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    pcmd->argument = SDMMC_NO_CMD_ARG;
+    pcmd->command_index = SDMMC_CMD_SEND_SCR;
+    pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
+    pcmd->response_type = SDMMC_SHORT_RESPONSE;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+
+    sdmmc_descriptor.is_api_sync = true;
+
+    sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, (uint64_t *)sd_scr,
+            SDMMC_SCR_SIZE, SDMMC_SINGLE_BLOCK);
+    sdmmc_set_xfer_config(pcmd);
+
+    state = sdmmc_send_command(pcmd);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    sdmmc_wait_xfer_done();
+
+    if (sdmmc_descriptor.status_code == 0)
+    {
+        cache_force_invalidate(sd_scr, SDMMC_SCR_SIZE);
+    }
+    return sdmmc_descriptor.status_code;
+}
+
+static int32_t sd_select_timing(cmd_parameters_t *pcmd, sdmmc_timing_t limit)
+{
+    sdmmc_timing_t timing;
+    uint32_t support;
+    int32_t state;
+
+    /*query the access modes of the card*/
+    state = sd_switch_func(pcmd, SDMMC_ARG_SWITCH_CHECK);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    support = sd_switch_status[SD_SWITCH_GROUP1_SUPPORT];
+
+    /*
+     * A card still at 1.8V from an earlier initialization does not accept
+     * S18R again but reports its UHS-I modes, only the host has to switch.
+     */
+    if ((sdmmc_is_signal_1v8() == 0U) && ((support & SD_UHS_MODES_MASK) != 0U))
+    {
+        sdmmc_descriptor.timing = SDMMC_TIMING_SDR50;
+        if (sdmmc_switch_signal_1v8(0U) != CTRL_CONFIG_PASS)
+        {
+            return -EIO;
+        }
+    }
+
+    timing = (limit > SDMMC_TIMING_SDR104) ? SDMMC_TIMING_SDR104 : limit;
+    while (timing > SDMMC_TIMING_DS)
+    {
+        if (((support & (1U << (uint32_t)timing)) != 0U) &&
+                (sdmmc_host_supports_timing((uint32_t)timing) == 1U) &&
+                ((timing == SDMMC_TIMING_HS) || (sdmmc_is_signal_1v8() == 1U)))
+        {
+            break;
+        }
+        timing = (sdmmc_timing_t)((uint32_t)timing - 1U);
+    }
+    sdmmc_descriptor.timing = timing;
+
+    if (timing != SDMMC_TIMING_DS)
+    {
+        state = sd_switch_func(pcmd, SDMMC_ARG_SWITCH_SET | (uint32_t)timing);
+        if ((state != 0) || ((sd_switch_status[SD_SWITCH_GROUP1_RESULT] &
+                SD_SWITCH_RESULT_MASK) != (uint32_t)timing))
+        {
+            return -EIO;
+        }
+    }
+    if (sdmmc_set_bus_timing((uint32_t)timing, 0U) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    if (timing >= SDMMC_TIMING_SDR50)
+    {
+        return sdmmc_execute_tuning(SDMMC_CMD_SEND_TUNING_BLOCK,
+                tuning_pattern_4bit, sizeof(tuning_pattern_4bit));
+    }
+    return 0;
+}
 #endif
 
 #if (DEV_TYPE ==  DEV_TYPE_EMMC)
 /*follows e.MMC standard: JESD84-B51A: Embedded MultiMediaCard (e.MMC),
  * Electrical Standard (5.1A)
  */
-static int32_t sd_mmc_init(uint64_t *sec_num)
+static int32_t sd_mmc_init(uint64_t *sec_num, sdmmc_timing_t limit)
 {
     cmd_parameters_t *pcmd_handle;
     cmd_parameters_t command_config;
@@ -940,14 +1717,34 @@ static int32_t sd_mmc_init(uint64_t *sec_num)
         return -EIO;
     }
     /*send cmd to set ext_csd */
-    state = mmc_switch_bus_width(pcmd_handle);
+    state = mmc_switch(pcmd_handle, SDMMC_SET_EXT_BUS_WIDTH);
     if (state != 0)
     {
         return -EIO;
     }
+    /*every eMMC device takes CMD23 before multi block transfers*/
+    sdmmc_set_auto_cmd(SDMMC_AUTO_CMD23);
     /*send cmd to request extended csd of the card*/
     state = mmc_send_ext_csd(pcmd_handle, sec_num);
-    return state;
+    if (state != 0)
+    {
+        return -EIO;
+    }
+
+    state = mmc_select_timing(pcmd_handle, limit);
+    if (state != 0)
+    {
+        return state;
+    }
+
+    /*depth of the command queue of the device, 0 without one*/
+    sdmmc_descriptor.cq_depth = 0U;
+    if ((ext_csd_buff[SDMMC_EXT_CSD_CMDQ_SUPPORT] & 0x1U) != 0U)
+    {
+        sdmmc_descriptor.cq_depth = (uint32_t)(ext_csd_buff[
+                    SDMMC_EXT_CSD_CMDQ_DEPTH] & 0x1FU) + 1U;
+    }
+    return 0;
 }
 
 
@@ -1094,10 +1891,10 @@ static int32_t mmc_send_ext_csd(cmd_parameters_t *pcmd,
     }
     return sdmmc_descriptor.status_code;
 }
-static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd)
+static int32_t mmc_switch(cmd_parameters_t *pcmd, uint32_t argument)
 {
     int32_t state;
-    pcmd->argument = SDMMC_SET_EXT_BUS_WIDTH;
+    pcmd->argument = argument;
     pcmd->command_index = SDMMC_CMD_SWITCH;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
     pcmd->response_type = SDMMC_SHORT_RESPONSE_BUSY;
@@ -1113,6 +1910,167 @@ static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd)
     sdmmc_wait_xfer_done();
     return sdmmc_descriptor.status_code;
 }
+
+static int32_t mmc_select_timing(cmd_parameters_t *pcmd, sdmmc_timing_t limit)
+{
+    uint8_t device_type = ext_csd_buff[SDMMC_EXT_CSD_DEVICE_TYPE];
+    sdmmc_timing_t timing = SDMMC_TIMING_DS;
+    uint64_t sector_count;
+    int32_t state;
+
+    if ((limit >= SDMMC_TIMING_HS400) &&
+            ((device_type & MMC_DEVICE_TYPE_HS400) != 0U) &&
+            (sdmmc_host_supports_timing(SDMMC_TIMING_HS400) == 1U))
+    {
+        timing = SDMMC_TIMING_HS400;
+    }
+    else if ((limit >= SDMMC_TIMING_HS200) &&
+            ((device_type & MMC_DEVICE_TYPE_HS200) != 0U) &&
+            (sdmmc_host_supports_timing(SDMMC_TIMING_HS200) == 1U))
+    {
+        timing = SDMMC_TIMING_HS200;
+    }
+    else if ((limit >= SDMMC_TIMING_HS) &&
+            ((device_type & MMC_DEVICE_TYPE_HS) != 0U))
+    {
+        timing = SDMMC_TIMING_HS;
+    }
+    sdmmc_descriptor.timing = timing;
+
+    if (timing == SDMMC_TIMING_DS)
+    {
+        return (sdmmc_set_bus_timing(SDMMC_TIMING_DS, 1U) ==
+               CTRL_CONFIG_PASS) ? 0 : -EIO;
+    }
+    if (timing == SDMMC_TIMING_HS)
+    {
+        state = mmc_switch(pcmd, SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_HS_TIMING,
+                MMC_HS_TIMING_HS));
+        if (state != 0)
+        {
+            return -EIO;
+        }
+        return (sdmmc_set_bus_timing(SDMMC_TIMING_HS, 1U) ==
+               CTRL_CONFIG_PASS) ? 0 : -EIO;
+    }
+
+    /*HS200 and HS400 signal at 1.8V and are tuned in HS200*/
+    if ((sdmmc_is_signal_1v8() == 0U) &&
+            (sdmmc_switch_signal_1v8(0U) != CTRL_CONFIG_PASS))
+    {
+        return -EIO;
+    }
+    state = mmc_switch(pcmd, SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_HS_TIMING,
+            MMC_HS_TIMING_HS200));
+    if ((state != 0) || (sdmmc_set_bus_timing(SDMMC_TIMING_HS200, 1U) !=
+            CTRL_CONFIG_PASS))
+    {
+        return -EIO;
+    }
+    state = sdmmc_execute_tuning(SDMMC_CMD_SEND_TUNING_HS200,
+            tuning_pattern_8bit, sizeof(tuning_pattern_8bit));
+    if ((state != 0) || (timing == SDMMC_TIMING_HS200))
+    {
+        return state;
+    }
+
+    /*HS400 is entered from HS on the 8-bit DDR bus*/
+    state = mmc_switch(pcmd, SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_HS_TIMING,
+            MMC_HS_TIMING_HS));
+    if ((state != 0) || (sdmmc_set_bus_timing(SDMMC_TIMING_HS, 1U) !=
+            CTRL_CONFIG_PASS))
+    {
+        return -EIO;
+    }
+    state = mmc_switch(pcmd, SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_BUS_WIDTH,
+            MMC_BUS_WIDTH_8_DDR));
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    state = mmc_switch(pcmd, SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_HS_TIMING,
+            MMC_HS_TIMING_HS400));
+    if ((state != 0) || (sdmmc_set_bus_timing(SDMMC_TIMING_HS400, 1U) !=
+            CTRL_CONFIG_PASS))
+    {
+        return -EIO;
+    }
+    /*the phy reload cleared the delay found in HS200*/
+    if (sdmmc_set_tuning_tap(sdmmc_descriptor.tuning_tap) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+
+    /*HS400 has no tuning, check the data path with a read*/
+    return mmc_send_ext_csd(pcmd, &sector_count);
+}
+
+/*
+ * Switch the device to its command queue and hand the host to the engine.
+ */
+static int32_t mmc_cq_enable(void)
+{
+    cmd_parameters_t command_config;
+    int32_t state;
+
+    sdmmc_queue.ptdl = (cq_slot_t *)pvPortMallocCoherentAligned(
+            SDMMC_CQ_TDL_ALIGN, sizeof(cq_slot_t) * SDMMC_QUEUE_DEPTH);
+    sdmmc_queue.pxfer_desc = (cq_descriptor_t *)pvPortMallocCoherentAligned(
+            64U, sizeof(cq_descriptor_t) * SDMMC_QUEUE_MAX_DESC *
+            SDMMC_QUEUE_DEPTH);
+    if ((sdmmc_queue.ptdl == NULL) || (sdmmc_queue.pxfer_desc == NULL))
+    {
+        ERROR("Cannot allocate the command queue descriptors");
+        mmc_cq_free();
+        return -ENOMEM;
+    }
+
+    state = mmc_switch(&command_config,
+            SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_CMDQ_MODE_EN, 1U));
+    if (state != 0)
+    {
+        mmc_cq_free();
+        return -EIO;
+    }
+    if (sdmmc_cq_enable(sdmmc_queue.ptdl) != CTRL_CONFIG_PASS)
+    {
+        (void)mmc_switch(&command_config,
+                SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_CMDQ_MODE_EN, 0U));
+        mmc_cq_free();
+        return -EIO;
+    }
+    return 0;
+}
+
+/*
+ * Take the host back from the engine and leave the command queue of the
+ * device.
+ */
+static int32_t mmc_cq_disable(void)
+{
+    cmd_parameters_t command_config;
+    int32_t state = 0;
+
+    if (sdmmc_cq_disable() != CTRL_CONFIG_PASS)
+    {
+        state = -EIO;
+    }
+    else if (mmc_switch(&command_config,
+            SDMMC_ARG_MMC_SWITCH(SDMMC_EXT_CSD_CMDQ_MODE_EN, 0U)) != 0)
+    {
+        state = -EIO;
+    }
+    mmc_cq_free();
+    return state;
+}
+
+static void mmc_cq_free(void)
+{
+    vPortFreeCoherent(sdmmc_queue.ptdl);
+    vPortFreeCoherent(sdmmc_queue.pxfer_desc);
+    sdmmc_queue.ptdl = NULL;
+    sdmmc_queue.pxfer_desc = NULL;
+}
 #endif
 
 static int32_t sdmmc_setup_host(void)
@@ -1139,7 +2097,7 @@ static int32_t sdmmc_setup_host(void)
     {
         return ret;
     }
-    sdmmc_init_configs(sdmmc_descriptor.dev_type,
+    ret = sdmmc_init_configs(sdmmc_descriptor.dev_type,
             sdmmc_descriptor.is_def_speed_supported);
     return ret;
 }
@@ -1165,6 +2123,16 @@ void sdmmc_irq_handler(void *data)
 {
     (void)data;
     uint32_t volatile int_status = sdmmc_get_int_status();
+    uint32_t is_xfer;
+    int32_t xfer_state;
+
+    /*the engine reports through its own registers and stays enabled*/
+    if ((sdmmc_queue.is_open == true) && (sdmmc_queue.use_cqe == true))
+    {
+        sdmmc_queue_cq_irq();
+        return;
+    }
+    is_xfer = sdmmc_is_xfer_int_enabled();
     sdmmc_disable_int();
     sdmmc_clear_int();
 
@@ -1175,43 +2143,63 @@ void sdmmc_irq_handler(void *data)
             (void)osal_semaphore_post(sdmmc_descriptor.semaphore_cmd);
             break;
         case SDMMC_XFER_CPT_INT_LOG:
-            if (sdmmc_descriptor.is_api_sync == true)
-            {
-                sdmmc_descriptor.status_code = 0;
-                (void)osal_semaphore_post(sdmmc_descriptor.semaphore_xfer);
-            }
-            else
+            /*a split transfer goes on with its next part*/
+            xfer_state = sdmmc_xfer_continue();
+            if (xfer_state > 0)
             {
-                sdmmc_descriptor.status_code = 0;
-                if (sdmmc_descriptor.xfer_call_back != NULL)
-                {
-                    sdmmc_descriptor.xfer_call_back(0);
-                }
+                break;
             }
-            break;
-
-        case SDMMC_CMD_TIMOUT_INT_LOG:
-            sdmmc_descriptor.status_code = -EIO;
-            (void)osal_semaphore_post(sdmmc_descriptor.semaphore_cmd);
-            break;
-
-        case SDMMC_XFER_TIMOUT_INT_LOG:
             if (sdmmc_descriptor.is_api_sync == true)
             {
-                sdmmc_descriptor.status_code = XFER_TIMOUT_ERR;
+                sdmmc_descriptor.status_code = xfer_state;
                 (void)osal_semaphore_post(sdmmc_descriptor.semaphore_xfer);
             }
             else
             {
-                sdmmc_descriptor.status_code = XFER_TIMOUT_ERR;
+                sdmmc_descriptor.status_code = xfer_state;
                 if (sdmmc_descriptor.xfer_call_back != NULL)
                 {
-                    sdmmc_descriptor.xfer_call_back(-EIO);
+                    sdmmc_descriptor.xfer_call_back(xfer_state);
                 }
             }
             break;
+
         default:
-            /*Do Nothing*/
+            if ((int_status & SDMMC_ERR_INT_LOG) != 0U)
+            {
+                sdmmc_irq_error(int_status, is_xfer);
+            }
             break;
     }
 }
+
+/*
+ * Any error ends the command or the transfer in progress. A transfer fails
+ * with -EIO, the request queue then goes on with its next request.
+ */
+static void sdmmc_irq_error(uint32_t int_status, uint32_t is_xfer)
+{
+    sdmmc_descriptor.card_state = SDMMC_CARD_UNKNOWN;
+    if (is_xfer == 0U)
+    {
+        sdmmc_descriptor.status_code = -EIO;
+        (void)osal_semaphore_post(sdmmc_descriptor.semaphore_cmd);
+        return;
+    }
+
+    sdmmc_xfer.psg = NULL;
+    sdmmc_descriptor.status_code = (int_status == SDMMC_XFER_TIMOUT_INT_LOG) ?
+            XFER_TIMOUT_ERR : -EIO;
+    if (sdmmc_descriptor.is_api_sync == true)
+    {
+        (void)osal_semaphore_post(sdmmc_descriptor.semaphore_xfer);
+    }
+    else if (sdmmc_descriptor.xfer_call_back != NULL)
+    {
+        sdmmc_descriptor.xfer_call_back(-EIO);
+    }
+    else
+    {
+        /*Do Nothing*/
+    }
+}
@@ -21,11 +21,28 @@
  * @ingroup drivers
  * @brief APIs for SoC FPGA SD/eMMC driver.
  * @details
- * The SD/eMMC driver supports both High-Speed and Default-Speed modes
- * over the SD and eMMC protocols.
+ * The SD/eMMC driver supports the Default-Speed and High-Speed modes over
+ * the SD and eMMC protocols, the UHS-I SDR50 and SDR104 modes of SD cards and
+ * the HS200 and HS400 modes of eMMC devices.
  *
- * SD cards support up to 25 MBps with a 4-bit data bus.
- * eMMC supports up to 50 MBps with an 8-bit data bus.
+ * SD cards support up to 104 MBps with a 4-bit data bus.
+ * eMMC supports up to 400 MBps with an 8-bit data bus.
+ *
+ * The fastest mode supported by both the host and the card is selected during
+ * the card initialization. If the card cannot be switched to a mode or the
+ * tuning of the mode fails, the card is initialized again in the next slower
+ * mode.
+ *
+ * Several read and write requests can be queued with sdmmc_submit_request()
+ * once the request queue is opened. An eMMC device whose host has a command
+ * queue engine runs up to 32 tagged requests in the order it chooses. Other
+ * devices get the requests one after the other from a software queue, the
+ * next request being sent from the interrupt of the previous one.
+ *
+ * A transfer can gather its data from, or scatter it to, a list of buffers.
+ * The DMA descriptor table grows with the largest transfer seen, and a
+ * transfer of more blocks than one command can carry is split into several
+ * commands, the next one being sent from the interrupt of the previous one.
  *
  * To see example usage, see @ref sdmmc_rw_sample  "SDMMC Sample Application".
  * @{
@@ -74,13 +91,17 @@
 #define SDMMC_CMD_SEND_EXT_CSD          (8U)     /*!< SDMMC send EXT CSD command */
 #define SDMMC_CMD_READ_CID              (9U)     /*!< SDMMC read CID command */
 #define SDMMC_CMD_SEND_CSD              (9U)     /*!< SDMMC send CSD command */
+#define SDMMC_CMD_VOLTAGE_SWITCH        (11U)     /*!< SDMMC switch to 1.8V signaling command */
 #define SDMMC_CMD_STOP_TRANSMISSION     (12U)     /*!< SDMMC stop xfer command */
 #define SDMMC_CMD_SET_BLOCK_LEN         (16U)     /*!< SDMMC set block length command */
 #define SDMMC_CMD_READ_SINGLE_BLOCK     (17U)     /*!< SDMMC read single block command */
 #define SDMMC_CMD_READ_MULT_BLOCK       (18U)     /*!< SDMMC read multi block command */
+#define SDMMC_CMD_SEND_TUNING_BLOCK     (19U)     /*!< SDMMC SD send tuning block command */
+#define SDMMC_CMD_SEND_TUNING_HS200     (21U)     /*!< SDMMC eMMC send tuning block command */
 #define SDMMC_CMD_WRITE_SINGLE_BLOCK    (24U)     /*!< SDMMC write single block command */
 #define SDMMC_CMD_WRITE_MULT_BLOCK      (25U)     /*!< SDMMC write multi block command */
 #define SDMMC_CMD_READ_OCR              (41U)     /*!< SDMMC read OCR command */
+#define SDMMC_CMD_SEND_SCR              (51U)     /*!< SDMMC SD read configuration register command */
 #define SDMMC_CMD_SEND_APP              (55U)     /*!< SDMMC send application specific command */
 
 /**
@@ -93,6 +114,11 @@
 #define SDMMC_ARG_CHECK_PATTERN    (0x000001AAU)          /*!< Check pattern for echo back*/
 #define SDMMC_ARG_SDHC_OCR         (0x40010000U)          /*!< Argument for voltage negotiation*/
 #define SDMMC_SET_EXT_BUS_WIDTH    (0x03B70200U)          /*!< Argument to set the bus width as 8*/
+#define SDMMC_ARG_S18R             (0x01000000U)          /*!< Request to switch to 1.8V signaling*/
+#define SDMMC_ARG_SWITCH_CHECK     (0x00FFFFF0U)          /*!< Argument to query the SD access modes*/
+#define SDMMC_ARG_SWITCH_SET       (0x80FFFFF0U)          /*!< Argument to set the SD access mode*/
+#define SDMMC_ARG_MMC_SWITCH(index, value)    ((0x3U << 24U) | ((uint32_t)(index) << 16U) | \
+    ((uint32_t)(value) << 8U))          /*!< Argument to write a byte of the EXT CSD*/
 
 /**
  * @brief The SDMMC response type as defined by the protocol.
@@ -115,6 +141,14 @@
 #define SDMMC_REL_CARD_ADDRESS     (1U)          /*!< Default relative card address*/
 #define SDMMC_SINGLE_BLOCK         (1U)          /*!< Used for single block transaction*/
 #define SDMMC_EXT_CSD_SEC_NUM      (212U)          /*!< Used to extract number of sectors from csd */
+#define SDMMC_EXT_CSD_BUS_WIDTH    (183U)          /*!< Bus width byte of the extended csd */
+#define SDMMC_EXT_CSD_HS_TIMING    (185U)          /*!< Timing interface byte of the extended csd */
+#define SDMMC_EXT_CSD_DEVICE_TYPE  (196U)          /*!< Supported timings byte of the extended csd */
+#define SDMMC_EXT_CSD_CMDQ_MODE_EN (15U)          /*!< Command queue enable byte of the extended csd */
+#define SDMMC_EXT_CSD_CMDQ_DEPTH   (307U)          /*!< Command queue depth byte of the extended csd */
+#define SDMMC_EXT_CSD_CMDQ_SUPPORT (308U)          /*!< Command queue support byte of the extended csd */
+#define SDMMC_SWITCH_STATUS_SIZE   (64U)          /*!< Size of the SD switch function status */
+#define SDMMC_SCR_SIZE             (8U)          /*!< Size of the SD configuration register */
 #define SDMMC_BLOCK_SIZE           (512U)          /*!< Size of block for each transaction*/
 
 /**
@@ -125,11 +159,27 @@
 #define SDMMC_CMD_TIMOUT_INT_LOG     (0x18000U)        /*!< Command timeout interrupt*/
 #define SDMMC_IS_CARD_DET            (1U)     /*!< Check the card detection state*/
 #define SDMMC_XFER_TIMOUT_INT_LOG    (0x108000U)          /*!< transfer timeout interrupt*/
+#define SDMMC_ERR_INT_LOG            (0x8000U)          /*!< Error interrupt, set with any error*/
 /**
  * @}
  */
 /* end of group sdmmc_macros */
 
+/**
+ * @brief Bus timing modes of the card interface
+ * @ingroup sdmmc_enums
+ */
+typedef enum
+{
+    SDMMC_TIMING_DS = 0,    /*!< Default speed, 25 MHz */
+    SDMMC_TIMING_HS,        /*!< High speed, 50 MHz (SDR25 once at 1.8V) */
+    SDMMC_TIMING_SDR50,     /*!< SD UHS-I SDR50, 100 MHz at 1.8V */
+    SDMMC_TIMING_SDR104,    /*!< SD UHS-I SDR104, 200 MHz at 1.8V */
+    SDMMC_TIMING_HS200,     /*!< eMMC HS200, 200 MHz SDR at 1.8V */
+    SDMMC_TIMING_HS400,     /*!< eMMC HS400, 200 MHz DDR at 1.8V */
+    SDMMC_TIMING_AUTO       /*!< Fastest mode of the host and the card */
+} sdmmc_timing_t;
+
 
 /**
  * @brief SDMMC context structure
@@ -149,6 +199,55 @@ struct sdmmc_context;
  */
 typedef void (*sdmmc_cb_fun)(int32_t xfer_flag);
 
+struct sdmmc_request;
+
+/**
+ * @brief Completion callback of a queued request
+ *
+ * Called from the interrupt handler. The request may be submitted again
+ * from the callback.
+ *
+ * @param[in] preq   The completed request.
+ * @param[in] status 0 on success, -EIO on failure.
+ */
+typedef void (*sdmmc_req_cb_fun)(struct sdmmc_request *preq, int32_t status);
+
+/**
+ * @brief Read or write request of the request queue
+ * @ingroup sdmmc_structs
+ *
+ * The request belongs to the driver from its submission until its callback
+ * is called and must stay valid in between.
+ */
+typedef struct sdmmc_request
+{
+    uint64_t *buffer;              /*!< Data buffer, aligned to a cache line */
+    uint64_t addr;                 /*!< Address on the card, a multiple of SDMMC_BLOCK_SIZE */
+    uint32_t number_of_blocks;     /*!< Number of blocks of SDMMC_BLOCK_SIZE bytes */
+    uint32_t is_write;             /*!< 1 to write the buffer, 0 to read into it */
+    sdmmc_req_cb_fun call_back;    /*!< Completion callback, may be NULL */
+    void *cb_arg;                  /*!< Free for the use of the callback */
+    uint32_t tag;                  /*!< Tag given by the driver on submission */
+    struct sdmmc_request *pnext;   /*!< Used by the driver */
+} sdmmc_request_t;
+
+/**
+ * @brief Buffer of a scatter-gather list
+ * @ingroup sdmmc_structs
+ *
+ * The buffers of a list are transferred one after the other as if they were
+ * a single buffer. A buffer may end in the middle of a block.
+ *
+ * A buffer need not be aligned to a cache line. When it is read into, the
+ * other bytes of its first and last cache lines must not be written until
+ * the transfer completes.
+ */
+typedef struct
+{
+    uint64_t *buffer;    /*!< Data buffer, aligned to 4 bytes */
+    uint32_t length;     /*!< Length in bytes, a multiple of 4 */
+} sdmmc_sg_entry_t;
+
 /**
  * @brief Performs a single or multi-block read from a specified address.
  * @warning If the input handle is invalid, this function silently takes no action.
@@ -163,6 +262,8 @@ typedef void (*sdmmc_cb_fun)(int32_t xfer_flag);
  * - -EIO:    Read operation failed.
  * - -EIO:    Command execution failed.
  * - -EINVAL: One or more arguments are invalid.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
  */
 int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
         uint32_t block_size, uint32_t number_of_blocks);
@@ -181,6 +282,8 @@ int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
  * - -EIO:    Write operation failed.
  * - -EIO:    Command execution failed.
  * - -EINVAL: One or more arguments are invalid.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
  */
 int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
         uint32_t block_size, uint32_t number_of_blocks);
@@ -200,6 +303,8 @@ int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
  * - -EIO:    Read operation failed.
  * - -EIO:    Command execution failed.
  * - -EINVAL: One or more arguments are invalid.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
  */
 int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
         uint32_t block_size, uint32_t number_of_blocks, sdmmc_cb_fun
@@ -220,11 +325,97 @@ int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
  * - -EIO:    Write operation failed.
  * - -EIO:    Command execution failed.
  * - -EINVAL: One or more arguments are invalid.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
  */
 int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
         uint32_t block_size, uint32_t number_of_blocks, sdmmc_cb_fun
         xfer_done_call_back);
 
+/**
+ * @brief Reads blocks from a specified address into a list of buffers.
+ *
+ * @param[in] psg        List of buffers, filled in order.
+ * @param[in] sg_count   Number of buffers in the list.
+ * @param[in] read_addr  The SD/eMMC address from which the data should be read.
+ * @param[in] block_size The size (in bytes) of each block to be read.
+ *
+ * @return
+ * -  0:      Read operation was successful.
+ * - -EIO:    Read operation failed.
+ * - -EINVAL: One or more arguments are invalid, or the total length of the
+ *            list is not a multiple of the block size.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
+ */
+int32_t sdmmc_read_sg_sync(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t read_addr, uint32_t block_size);
+
+/**
+ * @brief Writes a list of buffers to a specified address.
+ *
+ * @param[in] psg        List of buffers, written in order.
+ * @param[in] sg_count   Number of buffers in the list.
+ * @param[in] write_addr The SD/eMMC address to which the data should be written.
+ * @param[in] block_size The size (in bytes) of each block to be written.
+ *
+ * @return
+ * -  0:      Write operation was successful.
+ * - -EIO:    Write operation failed.
+ * - -EINVAL: One or more arguments are invalid, or the total length of the
+ *            list is not a multiple of the block size.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
+ */
+int32_t sdmmc_write_sg_sync(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t write_addr, uint32_t block_size);
+
+/**
+ * @brief Starts reading blocks from a specified address into a list of buffers.
+ *
+ * The list must stay valid until the callback is called.
+ *
+ * @param[in] psg                 List of buffers, filled in order.
+ * @param[in] sg_count            Number of buffers in the list.
+ * @param[in] read_addr           The SD/eMMC address from which the data should be read.
+ * @param[in] block_size          The size (in bytes) of each block to be read.
+ * @param[in] xfer_done_call_back Callback function to be triggered once the transfer is complete.
+ *
+ * @return
+ * -  0:      Read operation was started.
+ * - -EIO:    Command execution failed.
+ * - -EINVAL: One or more arguments are invalid, or the total length of the
+ *            list is not a multiple of the block size.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
+ */
+int32_t sdmmc_read_sg_async(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t read_addr, uint32_t block_size, sdmmc_cb_fun
+        xfer_done_call_back);
+
+/**
+ * @brief Starts writing a list of buffers to a specified address.
+ *
+ * The list must stay valid until the callback is called.
+ *
+ * @param[in] psg                 List of buffers, written in order.
+ * @param[in] sg_count            Number of buffers in the list.
+ * @param[in] write_addr          The SD/eMMC address to which the data should be written.
+ * @param[in] block_size          The size (in bytes) of each block to be written.
+ * @param[in] xfer_done_call_back Callback function to be triggered once the transfer is complete.
+ *
+ * @return
+ * -  0:      Write operation was started.
+ * - -EIO:    Command execution failed.
+ * - -EINVAL: One or more arguments are invalid, or the total length of the
+ *            list is not a multiple of the block size.
+ * - -ENOMEM: The descriptor table could not be grown.
+ * - -EBUSY:  The request queue is open or a transfer is in progress.
+ */
+int32_t sdmmc_write_sg_async(const sdmmc_sg_entry_t *psg, uint32_t sg_count,
+        uint64_t write_addr, uint32_t block_size, sdmmc_cb_fun
+        xfer_done_call_back);
+
 /**
  * @brief Performs the initialization sequence on the card.
  * @warning If the input handle is invalid, this function silently takes no action.
@@ -235,9 +426,90 @@ int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
  * - 0:       Card initialization was successful.
  * - -EIO:    Card initialization failed.
  * - -EINVAL: One or more arguments are invalid.
+ * - -EBUSY:  The request queue is open.
+ * - -ENOMEM: The DMA descriptors could not be allocated.
  */
 int32_t sdmmc_init_card(uint64_t *ptr_sec_num);
 
+/**
+ * @brief Limits the bus timing selected by the next card initialization.
+ *
+ * The card is switched to the fastest mode supported by both the host and
+ * the card which is not faster than the limit. The default limit is
+ * SDMMC_TIMING_AUTO.
+ *
+ * @param[in] timing The fastest mode allowed.
+ *
+ * @return
+ * - 0:       The limit was set.
+ * - -EINVAL: The mode does not exist.
+ */
+int32_t sdmmc_set_timing_limit(sdmmc_timing_t timing);
+
+/**
+ * @brief Gets the bus timing the card was switched to.
+ *
+ * @return The mode in use after the last card initialization.
+ */
+sdmmc_timing_t sdmmc_get_timing(void);
+
+/**
+ * @brief Opens the request queue.
+ *
+ * The card must be initialized. The command queue engine is enabled when
+ * both the host and the eMMC device support it. Until the queue is closed,
+ * requests are only accepted through sdmmc_submit_request() and the other
+ * transfer functions return -EBUSY.
+ *
+ * @param[out] pdepth The number of requests which can be queued at once.
+ *
+ * @return
+ * - 0:       The queue is open.
+ * - -EINVAL: pdepth is NULL.
+ * - -EBUSY:  The queue is already open.
+ * - -EIO:    The card is not initialized or did not accept the block length.
+ * - -ENOMEM: The descriptors of the engine could not be allocated.
+ */
+int32_t sdmmc_queue_open(uint32_t *pdepth);
+
+/**
+ * @brief Closes the request queue.
+ *
+ * @return
+ * - 0:       The queue is closed.
+ * - -EINVAL: The queue is not open.
+ * - -EBUSY:  Requests are still queued.
+ * - -EIO:    The command queue engine could not be disabled.
+ */
+int32_t sdmmc_queue_close(void);
+
+/**
+ * @brief Checks whether the request queue runs on the command queue engine.
+ *
+ * @return
+ * - 1: The requests are queued in the command queue engine.
+ * - 0: The requests are queued by the driver, or the queue is closed.
+ */
+uint32_t sdmmc_queue_uses_cqe(void);
+
+/**
+ * @brief Queues a read or write request.
+ *
+ * The request gets a free tag and is started as soon as the device can take
+ * it. Its callback is called from the interrupt handler once it completes.
+ * A request fits at most 1MB. After a failed request the card must be
+ * initialized again. Can be called from a request callback.
+ *
+ * @param[in] preq The request.
+ *
+ * @return
+ * - 0:       The request was queued.
+ * - -EINVAL: The request is invalid or too large.
+ * - -EBUSY:  Every tag is in use.
+ * - -EIO:    The queue is not open or the request could not be started.
+ */
+int32_t sdmmc_submit_request(sdmmc_request_t *preq);
+
 /**
  * @brief Checks whether a card is detected.
  *
@@ -7,11 +7,13 @@
  */
 
 #include <stdint.h>
+#include "osal.h"
 #include "osal_log.h"
 #include "socfpga_cache.h"
 #include "socfpga_defines.h"
 #include "socfpga_combo_phy.h"
 #include "socfpga_sdmmc_ll.h"
+#include "socfpga_sdmmc.h"
 #include "socfpga_sdmmc_reg.h"
 #include "socfpga_clk_mngr_reg.h"
 
@@ -26,18 +28,29 @@
 #define DATA_READ                 (1U)
 #define MULTI_BLOCK               (1U)
 #define CMD_ID_CHECK_EN           (1U)
+#define CMD_SWITCH_FUNC           (6U)
 #define CMD_SEND_EXT_CSD          (8U)
 #define CMD_READ_SINGLE_BLOCK     (17U)
 #define CMD_READ_MULT_BLOCK       (18U)
 #define CMD_WRITE_SINGLE_BLOCK    (24U)
 #define CMD_WRITE_MULT_BLOCK      (25U)
+#define CMD_SEND_SCR              (51U)
 #define DATA_XFER_BITS_512        (0x200U)
+#define SHORT_RESP               (2U)
 #define SHORT_RESP_BUSY           (3U)
 #define DATA_PRESENT              (1U)
 
 #define CLEAR_INT      (0x0U)
-#define EN_CMD_INT     (0x10001U)
-#define EN_XFER_INT    (0x100002U)
+#define CLEAR_INT_STATUS    (0xFFFFFFFFU)
+#define EN_TUNING_INT       (SDMMC_SRS12_BRR_MASK | SDMMC_SRS12_EDCRC_MASK | \
+    SDMMC_SRS12_EDT_MASK | SDMMC_SRS12_ECT_MASK | SDMMC_SRS12_ECCRC_MASK)
+/*command errors end a transfer as well, before any data moved*/
+#define CMD_ERR_INT    (SDMMC_SRS12_ECT_MASK | SDMMC_SRS12_ECCRC_MASK | \
+    SDMMC_SRS12_ECEB_MASK | SDMMC_SRS12_ECI_MASK)
+#define EN_CMD_INT     (SDMMC_SRS12_CC_MASK | CMD_ERR_INT)
+#define EN_XFER_INT    (SDMMC_SRS12_TC_MASK | CMD_ERR_INT | \
+    SDMMC_SRS12_EDT_MASK | SDMMC_SRS12_EDCRC_MASK | SDMMC_SRS12_EDEB_MASK | \
+    SDMMC_SRS12_EADMA_MASK | SDMMC_SRS12_EAC_MASK)
 
 #define SDCLK_FREQ            (2U)
 #define EN_INTERN_CLK         (1U)
@@ -55,33 +68,124 @@
 #define CMD_INHIBIT_SET    (1U)
 #define FREQ_SEL_25MHz     (4U)
 #define FREQ_SEL_50MHz     (2U)
-#define AUTO_CMD_23_EN     (2U)
+#define FREQ_SEL_100MHz    (1U)
+#define FREQ_SEL_200MHz    (0U)
 
 #define SDSC_DETECTED     (0x0U)
 #define SDHC_DETECTED     (0x1U)
 #define DAT_TIMOUT_CTR    (0xeU)
 
-#define SDMMC_DMA_MAX_BUFFER_SIZE    (64U * 1024U)
+/*UHS mode select of the host control 2 register*/
+#define UHS_SDR12     (0U)
+#define UHS_SDR25     (1U)
+#define UHS_SDR50     (2U)
+#define UHS_SDR104    (3U)
+
+/*eMMC mode select of HRS06*/
+#define EMMC_MODE_SD       (0U)
+#define EMMC_MODE_SDR      (2U)
+#define EMMC_MODE_HS200    (4U)
+#define EMMC_MODE_HS400    (5U)
+
 #define RESET_SOFTPHY                (1U << 6U)
 #define RESET_SDMMC                  (1U << 7U)
 #define RESET_SDMMC_ECC              ((uint32_t)1 << 15U)
 #define IS_CARD_READY                ((uint32_t)1 << 31U)
+#define IS_1V8_ACCEPTED              ((uint32_t)1 << 24U)
 #define END_DESCRIPTOR               (1U << 1U)
 #define EN_DMA_INT                   (1U << 2U)
 #define XFER_DATA                    (1U << 5U)
 #define BIT_MASK_32                  (0xFFFFFFFFUL)
+#define SRS11_LINE_RESETS            (SDMMC_SRS11_SRDAT_MASK | \
+    SDMMC_SRS11_SRCMD_MASK | SDMMC_SRS11_SRFA_MASK)
 
 /*delays approx 12.5 micro-seconds*/
 #define SECTOR_SIZE           512UL
 #define RESET_TIMEOUT         10000
+#define TUNING_TIMEOUT        100000U
+#define TUNING_TAP_STEP       ((READ_DELAY_MASK + 1U) / SDMMC_TUNING_TAPS)
 #define EMMC_8_BIT_MODE_EN    1
 
 #define SOFTPHY_CLK_200_MHZ    1
 
+/*read data sampled on the clock looped back inside the phy*/
+#define DQS_TIM_LPBK      (USE_EXT_LPBK_DQS | USE_LPBK_DQS | USE_PHONY_DQS | \
+    USE_PHONY_DQS_CMD | DQS_SEL_OE_END)
+/*read data sampled on the data strobe driven by the device*/
+#define DQS_TIM_STROBE    (USE_PHONY_DQS_CMD | DQS_SEL_OE_END)
+
+/*descriptor fields of the command queue engine*/
+#define CQ_ACT_TASK         (0x5U << 3U)
+#define CQ_ACT_LINK         (0x6U << 3U)
+#define CQ_DATA_DIR_POS     12U
+#define CQ_BLK_COUNT_POS    16U
+#define CQ_BLK_ADDR_POS     32U
+#define CQ_HALT_TIMEOUT     100000U
+/*CMD48, task management of the device queue*/
+#define CMD_TASK_MGMT       (48U)
+#define CQ_TM_DISCARD_QUEUE 0x1U
+#define CQ_TM_DISCARD_TASK  0x2U
+#define CQ_TM_TASK_ID_POS   16U
+#define CQ_TM_INT           (SDMMC_SRS12_CC_MASK | SDMMC_SRS12_TC_MASK | \
+    CMD_ERR_INT)
+#define CQ_INT_ALL          (SDMMC_CQRS04_CQTCL_MASK | \
+    SDMMC_CQRS04_CQREDI_MASK | SDMMC_CQRS04_CQTCC_MASK | \
+    SDMMC_CQRS04_CQHAC_MASK)
+/*the engine interrupt and the errors of the data transfers it runs*/
+#define EN_CQ_INT           (SDMMC_SRS13_CQINT_SE_MASK | \
+    SDMMC_SRS13_EADMA_SE_MASK | SDMMC_SRS13_EDCRC_SE_MASK | \
+    SDMMC_SRS13_EDT_SE_MASK | SDMMC_SRS13_ECCRC_SE_MASK | \
+    SDMMC_SRS13_ECT_SE_MASK)
+
+typedef struct
+{
+    uint32_t freq_sel;
+    uint32_t high_speed;
+    uint32_t uhs_mode;
+    uint32_t emmc_mode;
+    uint32_t dqs_timing;
+    uint32_t dll_master;
+} bus_timing_cfg_t;
+
+/*
+ * Host and combo-phy settings of each bus timing, in the order of
+ * sdmmc_timing_t. Up to 50 MHz the DLL is bypassed as set up by
+ * sdmmc_init_phy(). From 100 MHz the DLL is locked to the card clock and the
+ * read delay is found by tuning.
+ */
+static const bus_timing_cfg_t bus_timing_cfg[] =
+{
+    { FREQ_SEL_25MHz, DEF_SPEED_MODE, UHS_SDR12, EMMC_MODE_SD, DQS_TIM_LPBK,
+      SEL_DLL_BYPASS_MODE | PARAM_DLL_START_POINT },
+    { FREQ_SEL_50MHz, HIGH_SPEED_MODE, UHS_SDR25, EMMC_MODE_SDR, DQS_TIM_LPBK,
+      SEL_DLL_BYPASS_MODE | PARAM_DLL_START_POINT },
+    { FREQ_SEL_100MHz, HIGH_SPEED_MODE, UHS_SDR50, EMMC_MODE_SDR, DQS_TIM_LPBK,
+      SEL_DLL_LOCK_MODE | PARAM_DLL_START_POINT },
+    { FREQ_SEL_200MHz, HIGH_SPEED_MODE, UHS_SDR104, EMMC_MODE_SDR, DQS_TIM_LPBK,
+      SEL_DLL_LOCK_MODE | PARAM_DLL_START_POINT },
+    { FREQ_SEL_200MHz, HIGH_SPEED_MODE, UHS_SDR104, EMMC_MODE_HS200,
+      DQS_TIM_LPBK, SEL_DLL_LOCK_MODE | PARAM_DLL_START_POINT },
+    { FREQ_SEL_200MHz, HIGH_SPEED_MODE, UHS_SDR104, EMMC_MODE_HS400,
+      DQS_TIM_STROBE, SEL_DLL_LOCK_MODE | PARAM_DLL_START_POINT },
+};
+
 static int32_t reset_dll(void);
 static void prgm_host_config(void);
 static void program_reg(uint32_t val, uint32_t reg_add);
-static void config_phy_xfer_params(void);
+static int32_t config_phy_xfer_params(uint32_t timing);
+static int32_t load_phy_timing(uint32_t timing);
+static void sdmmc_set_host_timing(uint32_t timing, uint32_t is_emmc);
+static void sdmmc_restore_timing(uint32_t is_emmc);
+static int32_t sdmmc_set_clock(uint32_t freq_sel);
+static int32_t reset_lines(void);
+static int32_t cq_set_halt(uint32_t halt);
+static int32_t cq_task_mgmt(uint32_t argument);
+
+/*automatic command of multi block transfers, CMD23 unless the card lacks it*/
+static uint32_t auto_cmd_mode = SDMMC_AUTO_CMD23;
+
+/*bus timing of the settings loaded in the combo-phy*/
+static uint32_t phy_timing = SDMMC_TIMING_DS;
 static void sdmmc_enable_cmd_int(void);
 static void sdmmc_enable_xfer_int(void);
 
@@ -145,11 +249,14 @@ int32_t sdmmc_send_command(const cmd_parameters_t *params)
     srs03_reg_value |= (uint32_t)params->response_type << SDMMC_SRS03_RTS_POS;
 
     srs02_reg_value = (uint32_t)params->argument;
-    /*send stop request once block count decrements to 0 in case of multi block read/write*/
+    /*
+     * multi block transfers are either pre-defined by an automatic CMD23
+     * with the block count, or stopped by an automatic CMD12
+     */
     if ((params->command_index == CMD_WRITE_MULT_BLOCK) ||
             (params->command_index == CMD_READ_MULT_BLOCK))
     {
-        srs03_reg_value |= (AUTO_CMD_23_EN << SDMMC_SRS03_ACE_POS);
+        srs03_reg_value |= (auto_cmd_mode << SDMMC_SRS03_ACE_POS);
     }
     /*check if the cmd line is inhibited to send command*/
     if ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) & CMD_INHIBIT_SET) == 0U)
@@ -190,12 +297,17 @@ void sdmmc_set_xfer_config(cmd_parameters_t const *params)
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
 
     srs03_reg_value &= ~(SDMMC_SRS03_DTDS_MASK | SDMMC_SRS03_MSBS_MASK);
+    /*data commands go through the ADMA, tuning reads turn it off*/
+    srs03_reg_value |= (EN_BCT << SDMMC_SRS03_BCE_POS) |
+            (EN_DMA << SDMMC_SRS03_DMAE_POS);
     /*configure no of blocks for the transaction*/
     switch (params->command_index)
     {
         case CMD_READ_MULT_BLOCK:
         case CMD_READ_SINGLE_BLOCK:
         case CMD_SEND_EXT_CSD:
+        case CMD_SWITCH_FUNC:
+        case CMD_SEND_SCR:
             srs03_reg_value |= DATA_READ << SDMMC_SRS03_DTDS_POS;
             break;
 
@@ -218,6 +330,8 @@ void sdmmc_set_xfer_config(cmd_parameters_t const *params)
         case CMD_READ_SINGLE_BLOCK:
         case CMD_WRITE_SINGLE_BLOCK:
         case CMD_SEND_EXT_CSD:
+        case CMD_SWITCH_FUNC:
+        case CMD_SEND_SCR:
             srs03_reg_value |= (uint32_t)SINGLE_BLOCK << SDMMC_SRS03_MSBS_POS;
             break;
         default:
@@ -239,53 +353,97 @@ void sdmmc_set_xfer_config(cmd_parameters_t const *params)
 void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff,
         uint32_t block_size, uint32_t block_ct)
 {
-    uint64_t desc = 0;
+    sdmmc_sg_entry_t sg;
+
+    sg.buffer = buff;
+    sg.length = block_size * block_ct;
+    (void)sdmmc_set_up_xfer_sg(pdesc, &sg, 1U, 0U, block_size, block_ct);
+}
+
+/**
+ * @brief Set up DMA attributes for a part of a scatter-gather list.
+ */
+uint32_t sdmmc_set_up_xfer_sg(dma_descriptor_t *pdesc,
+        const sdmmc_sg_entry_t *psg, uint32_t sg_count, uint64_t offset,
+        uint32_t block_size, uint32_t block_ct)
+{
+    dma_descriptor_t *pfirst = pdesc;
+    uint64_t size = (uint64_t)block_size * block_ct;
+    uint64_t addr;
+    uint64_t len;
+    uint32_t chunk;
+    uint32_t descriptor_count = 0U;
     uint32_t volatile val = 0;
-    uint32_t volatile i = 0;
-    uint32_t size = block_size * block_ct;
-    uint32_t descriptor_count = 0;
-
-    descriptor_count = (size + (DESC_MAX_XFER_SIZE)-1U) / DESC_MAX_XFER_SIZE;
-    cache_force_invalidate((uint64_t *)buff, size);
-    desc = (uint64_t)pdesc;
-    /*count number of descriptors required*/
-    while ((i + 1U) < descriptor_count)
-    {
-        pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR | EN_DMA_INT;
-        pdesc->reserved = 0U;
-        pdesc->len = 0U;
-        pdesc->addr_lo = (uint32_t)((uint64_t)buff & BIT_MASK_32) +
-                (DESC_MAX_XFER_SIZE * i);
-        pdesc->addr_hi = (uint32_t)(((uint64_t)buff >> 32U) & BIT_MASK_32);
-        size -= SDMMC_DMA_MAX_BUFFER_SIZE;
-        pdesc++;
+    uint32_t i = 0U;
+
+    /*skip the buffers already transferred*/
+    while ((i < sg_count) && (offset >= psg[i].length))
+    {
+        offset -= psg[i].length;
+        i++;
+    }
+
+    while ((size > 0UL) && (i < sg_count))
+    {
+        addr = (uint64_t)(uintptr_t)psg[i].buffer + offset;
+        len = (uint64_t)psg[i].length - offset;
+        if (len > size)
+        {
+            len = size;
+        }
+        cache_force_invalidate_nosync((void *)(uintptr_t)addr, (size_t)len);
+        size -= len;
+        offset = 0UL;
         i++;
+
+        /*one descriptor moves up to 64KB, a length of 0 meaning 64KB*/
+        while (len > 0UL)
+        {
+            chunk = (len > DESC_MAX_XFER_SIZE) ? DESC_MAX_XFER_SIZE :
+                    (uint32_t)len;
+            pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR | EN_DMA_INT;
+            pdesc->reserved = 0U;
+            pdesc->len = (uint16_t)chunk;
+            pdesc->addr_lo = (uint32_t)(addr & BIT_MASK_32);
+            pdesc->addr_hi = (uint32_t)((addr >> 32U) & BIT_MASK_32);
+            addr += chunk;
+            len -= chunk;
+            pdesc++;
+            descriptor_count++;
+        }
     }
-    pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR | EN_DMA_INT | END_DESCRIPTOR;
-    pdesc->reserved = 0U;
-    pdesc->len = (uint16_t)size;
-    pdesc->addr_lo = (uint32_t)(((uint64_t)(uintptr_t)buff & BIT_MASK_32) +
-            ((uint64_t)DESC_MAX_XFER_SIZE * i));
-    pdesc->addr_hi = (uint32_t)((((uint64_t)buff >> 32U) & BIT_MASK_32));
+    if (descriptor_count == 0U)
+    {
+        return 0U;
+    }
+    (pdesc - 1)->attribute |= END_DESCRIPTOR;
 
-    cache_force_write_back((uint64_t *)desc, descriptor_count *
+    /* One barrier for the buffers and the descriptors */
+    cache_force_write_back_nosync(pfirst, descriptor_count *
             sizeof(dma_descriptor_t));
+    cache_sync();
 
-    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS22, (uint32_t)desc);
-    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS23, (uint32_t)((uint64_t)desc >> 32U));
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS22, (uint32_t)(uintptr_t)pfirst);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS23,
+            (uint32_t)((uint64_t)(uintptr_t)pfirst >> 32U));
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS00, (uint32_t)block_ct);
 
     val = (uint32_t)(block_ct << SDMMC_SRS01_BCCT_POS);
     val |= (uint32_t)block_size << SDMMC_SRS01_TBS_POS;
 
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS01, val);
+
+    return descriptor_count;
 }
 
 /**
  * @brief Initialize sdmmc host configuration
  */
-void sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed)
+int32_t sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed)
 {
+    uint32_t timing = (def_speed == 1U) ? (uint32_t)SDMMC_TIMING_DS :
+            (uint32_t)SDMMC_TIMING_HS;
+    int32_t ret;
     uint32_t srs10_reg_value = 0;
     uint32_t srs11_reg_value = 0;
     uint32_t srs03_reg_value = 0;
@@ -325,7 +483,13 @@ void sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed)
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS03, srs03_reg_value);
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS10, srs10_reg_value);
 
-    config_phy_xfer_params();
+    ret = config_phy_xfer_params(timing);
+    if ((ret != CTRL_CONFIG_PASS) && (phy_timing != timing))
+    {
+        /*the phy is back on the settings it had, run the bus to match*/
+        sdmmc_restore_timing(emmc_bus_width);
+    }
+    return ret;
 }
 
 /**
@@ -402,6 +566,8 @@ int32_t sdmmc_init_phy(void)
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS05, reg_value);
 
     ret = reset_dll();
+    /*the bypassed DLL is the setting of the default speed*/
+    phy_timing = SDMMC_TIMING_DS;
 
     reg_value = IO_MASK_DISABLE | IO_MASK_END | IO_MASK_START | DATA_SEL_OE_END;
     program_reg(reg_value, (uint32_t)PHY_DQ_TIM_REG_ADD);
@@ -590,23 +756,51 @@ int32_t sdmmc_reset_per0(void)
 }
 
 /**
- * @brief Enable the extended read,write and command mode.
+ * @brief Load the phy settings of a bus timing. If the DLL does not come up
+ * the settings of the previous timing are loaded back.
  */
-static void config_phy_xfer_params(void)
+static int32_t config_phy_xfer_params(uint32_t timing)
 {
+    int32_t ret;
+
+    ret = load_phy_timing(timing);
+    if (ret == CTRL_CONFIG_PASS)
+    {
+        phy_timing = timing;
+    }
+    else if (timing != phy_timing)
+    {
+        WARN("Phy did not come up, keeping the previous timing");
+        (void)load_phy_timing(phy_timing);
+    }
+    return ret;
+}
+
+/**
+ * @brief Load the phy settings of a bus timing and enable the extended
+ * read,write and command mode.
+ */
+static int32_t load_phy_timing(uint32_t timing)
+{
+    const bus_timing_cfg_t *pcfg = &bus_timing_cfg[timing];
     uint32_t hrs09_reg_val;
 
     hrs09_reg_val = RD_REG32(HRS_BASE_ADDR + SDMMC_HRS09);
     hrs09_reg_val &= ~(PHY_SW_RST);
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
 
+    /*the phy takes the new settings while it is held in reset*/
+    program_reg(pcfg->dqs_timing, PHY_DQS_TIM_REG_ADD);
+    program_reg(pcfg->dll_master, PHY_DLL_MASTER_CTL_ADD);
+    program_reg(READ_DQS_CMD_DELAY | CLK_WRDQS_DELAY | CLK_WR_DELAY |
+            READ_DQS_DELAY, PHY_DLL_SLAVE_CTL_ADD);
+
     hrs09_reg_val |= ((EN_EXT_WR_MODE << SDMMC_HRS09_EXTENDED_WR_MODE_POS) |
             ((uint32_t)EN_EXT_RDCMD_MODE << SDMMC_HRS09_RDCMD_EN_POS) |
             ((uint32_t)EN_EXT_RDDATA_MODE << SDMMC_HRS09_RDDATA_EN_POS));
 
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
-    hrs09_reg_val |= PHY_SW_RST;
-    WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
+    return reset_dll();
 }
 
 /**
@@ -665,6 +859,15 @@ uint32_t sdmmc_get_int_status(void)
     return RD_REG32(SRS_BASE_ADDR + SDMMC_SRS12);
 }
 
+/**
+ * @brief Check if the enabled interrupts are those of a data transfer.
+ */
+uint32_t sdmmc_is_xfer_int_enabled(void)
+{
+    return ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS14) & SDMMC_SRS12_TC_MASK) !=
+           0U) ? 1U : 0U;
+}
+
 /**
  * @brief Disable interrupts for data and response triggers.
  */
@@ -688,3 +891,602 @@ uint32_t sdmmc_is_card_detected(void)
     card_check = (srs09_reg_value >> SDMMC_SRS09_CI_POS) & CARD_DETECTED;
     return card_check;
 }
+
+/**
+ * @brief Check if the host supports a bus timing.
+ */
+uint32_t sdmmc_host_supports_timing(uint32_t timing)
+{
+    uint32_t srs16_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS16);
+    uint32_t srs17_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS17);
+    uint32_t is_1v8 = ((srs16_reg_value & SDMMC_SRS16_VS18_MASK) != 0U) ? 1U : 0U;
+    uint32_t is_sdr104 = ((srs17_reg_value & SDMMC_SRS17_SDR104_MASK) != 0U) ?
+            is_1v8 : 0U;
+    uint32_t supported;
+
+    switch (timing)
+    {
+        case SDMMC_TIMING_DS:
+            supported = 1U;
+            break;
+        case SDMMC_TIMING_HS:
+            supported = ((srs16_reg_value & SDMMC_SRS16_HSS_MASK) != 0U) ? 1U : 0U;
+            break;
+        case SDMMC_TIMING_SDR50:
+            supported = ((srs17_reg_value & SDMMC_SRS17_SDR50_MASK) != 0U) ?
+                    is_1v8 : 0U;
+            break;
+        case SDMMC_TIMING_SDR104:
+        case SDMMC_TIMING_HS200:
+            supported = is_sdr104;
+            break;
+        case SDMMC_TIMING_HS400:
+            /*HS400 is only defined on the 8-bit bus*/
+            supported = ((srs16_reg_value & SDMMC_SRS16_EDS8_MASK) != 0U) ?
+                    is_sdr104 : 0U;
+            break;
+        default:
+            supported = 0U;
+            break;
+    }
+    return supported;
+}
+
+/**
+ * @brief Switch the host to a bus timing.
+ */
+int32_t sdmmc_set_bus_timing(uint32_t timing, uint32_t is_emmc)
+{
+    uint32_t reg_value;
+    int32_t ret;
+
+    if (timing >= (sizeof(bus_timing_cfg) / sizeof(bus_timing_cfg[0])))
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+
+    /*the card clock is stopped while the timing changes*/
+    reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    reg_value &= ~(SRS11_LINE_RESETS | SDMMC_SRS11_SDCE_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, reg_value);
+
+    sdmmc_set_host_timing(timing, is_emmc);
+    ret = config_phy_xfer_params(timing);
+    if (ret != CTRL_CONFIG_PASS)
+    {
+        sdmmc_restore_timing(is_emmc);
+        return ret;
+    }
+    return sdmmc_set_clock(bus_timing_cfg[timing].freq_sel);
+}
+
+/**
+ * @brief Select the speed mode of a bus timing in the host.
+ */
+static void sdmmc_set_host_timing(uint32_t timing, uint32_t is_emmc)
+{
+    const bus_timing_cfg_t *pcfg = &bus_timing_cfg[timing];
+    uint32_t reg_value;
+
+    reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS10);
+    reg_value &= ~SDMMC_SRS10_HSE_MASK;
+    reg_value |= pcfg->high_speed << SDMMC_SRS10_HSE_POS;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS10, reg_value);
+
+    reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+    reg_value &= ~SDMMC_SRS15_UMS_MASK;
+    reg_value |= pcfg->uhs_mode << SDMMC_SRS15_UMS_POS;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, reg_value);
+
+    reg_value = RD_REG32(HRS_BASE_ADDR + SDMMC_HRS06);
+    reg_value &= ~SDMMC_HRS06_EMM_MASK;
+    reg_value |= ((is_emmc == 1U) ? pcfg->emmc_mode : EMMC_MODE_SD) <<
+            SDMMC_HRS06_EMM_POS;
+    WR_REG32(HRS_BASE_ADDR + SDMMC_HRS06, reg_value);
+}
+
+/**
+ * @brief Run the bus at the timing of the settings loaded in the phy.
+ */
+static void sdmmc_restore_timing(uint32_t is_emmc)
+{
+    sdmmc_set_host_timing(phy_timing, is_emmc);
+    (void)sdmmc_set_clock(bus_timing_cfg[phy_timing].freq_sel);
+}
+
+/**
+ * @brief Program the card clock divider and restart the card clock.
+ */
+static int32_t sdmmc_set_clock(uint32_t freq_sel)
+{
+    uint32_t srs11_reg_value;
+    uint32_t count = RESET_TIMEOUT;
+
+    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    srs11_reg_value &= ~(SRS11_LINE_RESETS | SDMMC_SRS11_SDCE_MASK |
+            SDMMC_SRS11_SDCFSL_MASK | SDMMC_SRS11_SDCFSH_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+
+    srs11_reg_value |= (freq_sel & 0xFFU) << SDMMC_SRS11_SDCFSL_POS;
+    srs11_reg_value |= ((freq_sel >> 8U) & 0x3U) << SDMMC_SRS11_SDCFSH_POS;
+    srs11_reg_value |= (EN_INTERN_CLK << SDMMC_SRS11_ICE_POS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+
+    /*wait for the internal clock to be stable*/
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_ICS_MASK) == 0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        else
+        {
+            count--;
+        }
+    }
+    srs11_reg_value |= (EN_SD_CLK << SDMMC_SRS11_SDCE_POS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Switch the host signaling to 1.8V.
+ */
+int32_t sdmmc_switch_signal_1v8(uint32_t card_handshake)
+{
+    uint32_t srs11_reg_value;
+    uint32_t srs15_reg_value;
+
+    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    srs11_reg_value &= ~(SRS11_LINE_RESETS | SDMMC_SRS11_SDCE_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+
+    /*the card holds DAT[3:0] low once it has accepted CMD11*/
+    if ((card_handshake == 1U) && ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) &
+            SDMMC_SRS09_DATSL1_MASK) != 0U))
+    {
+        ERROR("Card did not start the voltage switch");
+        return CTRL_CONFIG_FAIL;
+    }
+
+    srs15_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+    srs15_reg_value |= SDMMC_SRS15_V18SE_MASK;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, srs15_reg_value);
+
+    /*the regulator output is stable within 5 ms*/
+    osal_task_delay(5);
+    if ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15) & SDMMC_SRS15_V18SE_MASK) == 0U)
+    {
+        ERROR("Host signaling did not switch to 1.8V");
+        return CTRL_CONFIG_FAIL;
+    }
+
+    srs11_reg_value |= (EN_SD_CLK << SDMMC_SRS11_SDCE_POS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+
+    /*the card releases DAT[3:0] within 1 ms of the clock restart*/
+    osal_task_delay(1);
+    if ((card_handshake == 1U) && ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) &
+            SDMMC_SRS09_DATSL1_MASK) != SDMMC_SRS09_DATSL1_MASK))
+    {
+        ERROR("Card did not complete the voltage switch");
+        return CTRL_CONFIG_FAIL;
+    }
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Check if the host signaling is at 1.8V.
+ */
+uint32_t sdmmc_is_signal_1v8(void)
+{
+    return (RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15) & SDMMC_SRS15_V18SE_MASK) >>
+           SDMMC_SRS15_V18SE_POS;
+}
+
+/**
+ * @brief Parse the response and check if the card accepted 1.8V signaling.
+ */
+uint32_t sdmmc_is_1v8_accepted(void)
+{
+    return ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS04) & IS_1V8_ACCEPTED) != 0U) ?
+           1U : 0U;
+}
+
+/**
+ * @brief Set the read sampling delay of the combo-phy.
+ */
+int32_t sdmmc_set_tuning_tap(uint32_t tap)
+{
+    uint32_t delay = (tap * TUNING_TAP_STEP) & READ_DELAY_MASK;
+    uint32_t count = RESET_TIMEOUT;
+
+    program_reg((delay << READ_DQS_CMD_DELAY_POS) | CLK_WRDQS_DELAY |
+            CLK_WR_DELAY | (delay << READ_DQS_DELAY_POS),
+            PHY_DLL_SLAVE_CTL_ADD);
+
+    /*the slave delay lines load the new value on an update request*/
+    WR_REG32(HRS_BASE_ADDR + SDMMC_HRS08, SDMMC_HRS08_PHY_DLL_UPDREQ_MASK);
+    while ((RD_REG32(HRS_BASE_ADDR + SDMMC_HRS08) &
+            SDMMC_HRS08_PHY_DLL_UPDACK_MASK) == 0U)
+    {
+        if (count == 0U)
+        {
+            WR_REG32(HRS_BASE_ADDR + SDMMC_HRS08, 0U);
+            return CTRL_CONFIG_FAIL;
+        }
+        else
+        {
+            count--;
+        }
+    }
+    WR_REG32(HRS_BASE_ADDR + SDMMC_HRS08, 0U);
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Reset the command and data lines after a failed command.
+ */
+static int32_t reset_lines(void)
+{
+    uint32_t srs11_reg_value;
+    uint32_t count = RESET_TIMEOUT;
+
+    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    srs11_reg_value |= SDMMC_SRS11_SRCMD_MASK | SDMMC_SRS11_SRDAT_MASK;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & (SDMMC_SRS11_SRCMD_MASK |
+            SDMMC_SRS11_SRDAT_MASK)) != 0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        else
+        {
+            count--;
+        }
+    }
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Read a tuning block from the card by polling.
+ */
+int32_t sdmmc_read_tuning_block(uint8_t command_index, uint32_t block_size,
+        uint32_t *buff)
+{
+    uint32_t srs03_reg_value;
+    uint32_t status;
+    uint32_t count;
+    uint32_t i;
+
+    if (reset_lines() != CTRL_CONFIG_PASS)
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+
+    /*the block is polled, the interrupt line stays quiet*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS14, CLEAR_INT);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_TUNING_INT);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS01, (1U << SDMMC_SRS01_BCCT_POS) |
+            (block_size << SDMMC_SRS01_TBS_POS));
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS02, 0U);
+
+    srs03_reg_value = ((uint32_t)command_index << SDMMC_SRS03_CIDX_POS) |
+            (DATA_PRESENT << SDMMC_SRS03_DPS_POS) |
+            (CMD_ID_CHECK_EN << SDMMC_SRS03_CICE_POS) |
+            (CMD_ID_CHECK_EN << SDMMC_SRS03_CRCCE_POS) |
+            (SHORT_RESP << SDMMC_SRS03_RTS_POS) |
+            (DATA_READ << SDMMC_SRS03_DTDS_POS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS03, srs03_reg_value);
+
+    count = TUNING_TIMEOUT;
+    do
+    {
+        status = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS12);
+        count--;
+    } while (((status & EN_TUNING_INT) == 0U) && (count > 0U));
+
+    if ((status & EN_TUNING_INT) != SDMMC_SRS12_BRR_MASK)
+    {
+        WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+        (void)reset_lines();
+        return CTRL_CONFIG_FAIL;
+    }
+
+    for (i = 0U; i < (block_size / 4U); i++)
+    {
+        buff[i] = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS08);
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Select the automatic command of multi block transfers.
+ */
+void sdmmc_set_auto_cmd(uint32_t mode)
+{
+    auto_cmd_mode = mode;
+}
+
+/**
+ * @brief Check if the host has a command queue engine.
+ */
+uint32_t sdmmc_cq_is_supported(void)
+{
+    return ((RD_REG32(HRS_BASE_ADDR + SDMMC_HRS30) & SDMMC_HRS30_CQSUP_MASK) !=
+           0U) ? 1U : 0U;
+}
+
+/**
+ * @brief Halt or resume the command queue engine.
+ */
+static int32_t cq_set_halt(uint32_t halt)
+{
+    uint32_t count = CQ_HALT_TIMEOUT;
+    uint32_t expected = (halt != 0U) ? SDMMC_CQRS03_CQHLT_MASK : 0U;
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS03, expected);
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS03) &
+            SDMMC_CQRS03_CQHLT_MASK) != expected)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        count--;
+    }
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Enable the command queue engine.
+ */
+int32_t sdmmc_cq_enable(cq_slot_t *ptdl)
+{
+    uint64_t tdl = (uint64_t)(uintptr_t)ptdl;
+
+    /*the engine moves blocks of 512 bytes through the ADMA*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS01, DATA_XFER_BITS_512 <<
+            SDMMC_SRS01_TBS_POS);
+
+    /*128-bit descriptors as the ADMA uses 64-bit addresses*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, SDMMC_CQRS02_CQTDS_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS08, (uint32_t)(tdl & BIT_MASK_32));
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS09, (uint32_t)(tdl >> 32U));
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, CQ_INT_ALL);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS05, CQ_INT_ALL);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS06, CQ_INT_ALL);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, SDMMC_CQRS02_CQTDS_MASK |
+            SDMMC_CQRS02_CQE_MASK);
+
+    if (cq_set_halt(0U) != CTRL_CONFIG_PASS)
+    {
+        WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, 0U);
+        return CTRL_CONFIG_FAIL;
+    }
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_CQ_INT);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS14, EN_CQ_INT);
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Halt and disable the command queue engine.
+ */
+int32_t sdmmc_cq_disable(void)
+{
+    int32_t ret;
+
+    ret = cq_set_halt(1U);
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS05, 0U);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS06, 0U);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, CQ_INT_ALL);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, 0U);
+    sdmmc_clear_int();
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+    return ret;
+}
+
+/**
+ * @brief Prepare the task of a slot.
+ */
+void sdmmc_cq_set_up_task(cq_slot_t *pslot, cq_descriptor_t *pxfer,
+        uint64_t *buff, uint64_t block_addr, uint32_t block_ct,
+        uint32_t is_read)
+{
+    uint64_t addr = (uint64_t)(uintptr_t)buff;
+    uint64_t xfer = (uint64_t)(uintptr_t)pxfer;
+    uint32_t size = block_ct * SECTOR_SIZE;
+    uint32_t len;
+
+    /*a length of 0 stands for the maximum of a descriptor*/
+    for (;;)
+    {
+        len = (size > DESC_MAX_XFER_SIZE) ? DESC_MAX_XFER_SIZE : size;
+        pxfer->attribute = XFER_DATA | VAL_DESCRIPTOR;
+        pxfer->reserved = 0U;
+        pxfer->len = (uint16_t)len;
+        pxfer->addr_lo = (uint32_t)(addr & BIT_MASK_32);
+        pxfer->addr_hi = (uint32_t)(addr >> 32U);
+        pxfer->reserved_hi = 0U;
+        size -= len;
+        if (size == 0U)
+        {
+            pxfer->attribute |= END_DESCRIPTOR;
+            break;
+        }
+        addr += len;
+        pxfer++;
+    }
+
+    pslot->link.attribute = CQ_ACT_LINK | VAL_DESCRIPTOR | END_DESCRIPTOR;
+    pslot->link.reserved = 0U;
+    pslot->link.len = 0U;
+    pslot->link.addr_lo = (uint32_t)(xfer & BIT_MASK_32);
+    pslot->link.addr_hi = (uint32_t)(xfer >> 32U);
+    pslot->link.reserved_hi = 0U;
+
+    pslot->task.reserved = 0U;
+    pslot->task.task = (uint64_t)(VAL_DESCRIPTOR | END_DESCRIPTOR |
+            EN_DMA_INT | CQ_ACT_TASK) |
+            ((uint64_t)is_read << CQ_DATA_DIR_POS) |
+            ((uint64_t)block_ct << CQ_BLK_COUNT_POS) |
+            ((block_addr & BIT_MASK_32) << CQ_BLK_ADDR_POS);
+}
+
+/**
+ * @brief Hand the task of a slot to the engine.
+ */
+void sdmmc_cq_ring(uint32_t tag)
+{
+    /*the descriptors are in uncached memory, order them before the doorbell*/
+    cache_sync();
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS10, (uint32_t)1U << tag);
+}
+
+/**
+ * @brief Read and acknowledge the completed tasks.
+ */
+uint32_t sdmmc_cq_get_completions(uint32_t *perror)
+{
+    uint32_t cq_status;
+    uint32_t srs12_reg_value;
+    uint32_t done;
+
+    cq_status = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS04);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, cq_status);
+    done = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS11);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS11, done);
+
+    srs12_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS12);
+    *perror = (((cq_status & SDMMC_CQRS04_CQREDI_MASK) != 0U) ||
+            ((srs12_reg_value & SDMMC_SRS12_EINT_MASK) != 0U)) ? 1U : 0U;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, srs12_reg_value &
+            ~SDMMC_SRS12_CQINT_MASK);
+    return done;
+}
+
+/**
+ * @brief Send CMD48 to the device through the legacy interface of the halted
+ * engine and wait for it by polling.
+ */
+static int32_t cq_task_mgmt(uint32_t argument)
+{
+    uint32_t count = CQ_HALT_TIMEOUT;
+    uint32_t status;
+
+    if ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) & CMD_INHIBIT_SET) != 0U)
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_CQ_INT | CQ_TM_INT);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS02, argument);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS03,
+            ((uint32_t)CMD_TASK_MGMT << SDMMC_SRS03_CIDX_POS) |
+            (CMD_ID_CHECK_EN << SDMMC_SRS03_CICE_POS) |
+            (CMD_ID_CHECK_EN << SDMMC_SRS03_CRCCE_POS) |
+            (SHORT_RESP_BUSY << SDMMC_SRS03_RTS_POS));
+
+    /*the response comes with busy, the device is done at transfer complete*/
+    do
+    {
+        status = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS12);
+        count--;
+    } while (((status & (SDMMC_SRS12_TC_MASK | CMD_ERR_INT)) == 0U) &&
+            (count > 0U));
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_CQ_INT);
+    if ((status & CQ_TM_INT) != (SDMMC_SRS12_CC_MASK | SDMMC_SRS12_TC_MASK))
+    {
+        (void)reset_lines();
+        return CTRL_CONFIG_FAIL;
+    }
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Discard the tasks an error stopped, in the engine and on the device.
+ */
+uint32_t sdmmc_cq_clear_tasks(void)
+{
+    uint32_t pending;
+    uint32_t failed = 0U;
+    uint32_t task_error;
+    uint32_t tag;
+    uint32_t count = CQ_HALT_TIMEOUT;
+
+    (void)cq_set_halt(1U);
+    pending = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS10);
+
+    /*the engine records the task of a response error and of a data error*/
+    task_error = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS21);
+    if ((task_error & SDMMC_CQRS21_CQRMEFV_MASK) != 0U)
+    {
+        failed |= (uint32_t)1U << ((task_error & SDMMC_CQRS21_CQRMETID_MASK) >>
+                SDMMC_CQRS21_CQRMETID_POS);
+    }
+    if ((task_error & SDMMC_CQRS21_CQDTEFV_MASK) != 0U)
+    {
+        failed |= (uint32_t)1U << ((task_error & SDMMC_CQRS21_CQDTETID_MASK) >>
+                SDMMC_CQRS21_CQDTETID_POS);
+    }
+    failed &= pending;
+
+    /*the lines are left in error whichever task failed*/
+    (void)reset_lines();
+
+    if (failed == 0U)
+    {
+        /*no task to blame, the whole queue goes*/
+        failed = pending;
+        WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS03, SDMMC_CQRS03_CQHLT_MASK |
+                SDMMC_CQRS03_CQCAT_MASK);
+        while (((RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS03) &
+                SDMMC_CQRS03_CQCAT_MASK) != 0U) && (count > 0U))
+        {
+            count--;
+        }
+        if ((failed != 0U) && (cq_task_mgmt(CQ_TM_DISCARD_QUEUE) !=
+                CTRL_CONFIG_PASS))
+        {
+            WARN("Device did not discard its queue");
+        }
+    }
+    else
+    {
+        WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS14, failed);
+        while (((RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS14) & failed) != 0U) &&
+                (count > 0U))
+        {
+            count--;
+        }
+        for (tag = 0U; tag < 32U; tag++)
+        {
+            if ((((failed >> tag) & 1U) != 0U) &&
+                    (cq_task_mgmt(CQ_TM_DISCARD_TASK |
+                    (tag << CQ_TM_TASK_ID_POS)) != CTRL_CONFIG_PASS))
+            {
+                WARN("Device did not discard task %u", tag);
+            }
+        }
+    }
+
+    /*completions stay for the caller, only the error is acknowledged*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, SDMMC_CQRS04_CQREDI_MASK |
+            SDMMC_CQRS04_CQTCL_MASK | SDMMC_CQRS04_CQHAC_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS12, CLEAR_INT_STATUS &
+            ~SDMMC_SRS12_CQINT_MASK);
+
+    (void)cq_set_halt(0U);
+    return failed;
+}
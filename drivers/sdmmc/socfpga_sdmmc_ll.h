@@ -9,10 +9,20 @@
 #ifndef __SOCFPGA_SDMMC_LL_H__
 #define __SOCFPGA_SDMMC_LL_H__
 
+#include <stdint.h>
+#include "socfpga_sdmmc.h"
+
 #define PER0MODRST_ADDR    (0x10D11024U)
 
 #define DESC_MAX_XFER_SIZE    (64U * 1024U)
 
+/* Automatic commands of multi block transfers */
+#define SDMMC_AUTO_CMD12      (1U)
+#define SDMMC_AUTO_CMD23      (2U)
+
+/* Number of read delay steps tried by the tuning */
+#define SDMMC_TUNING_TAPS     (32U)
+
 typedef struct
 {
     uint64_t argument;
@@ -39,6 +49,31 @@ typedef struct __attribute__((packed))
     uint32_t addr_hi;
 } dma_descriptor_t;
 
+/* Task descriptor of the command queue engine, 128-bit format */
+typedef struct __attribute__((packed))
+{
+    uint64_t task;
+    uint64_t reserved;
+} cq_task_descriptor_t;
+
+/* Link and transfer descriptors of the command queue engine, 128-bit format */
+typedef struct __attribute__((packed))
+{
+    uint8_t attribute;
+    uint8_t reserved;
+    uint16_t len;
+    uint32_t addr_lo;
+    uint32_t addr_hi;
+    uint32_t reserved_hi;
+} cq_descriptor_t;
+
+/* One slot of the task descriptor list, a task and the link to its data */
+typedef struct __attribute__((packed))
+{
+    cq_task_descriptor_t task;
+    cq_descriptor_t link;
+} cq_slot_t;
+
 #define CMD_SND_OK          0
 #define CMD_ERR             1
 #define XFER_CPT_OK         2
@@ -83,6 +118,25 @@ void sd_read_response_rel_addr(card_data_t *pxcard);
 void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff, uint32_t
         block_size, uint32_t block_ct);
 
+/**
+ * @brief Sets the DMA attributes for a part of a scatter-gather list.
+ *
+ * Builds the descriptors of block_ct blocks starting offset bytes into the
+ * list. A buffer longer than 64KB takes several descriptors.
+ *
+ * @param[in] pdesc      Descriptor table, large enough for the part of the list.
+ * @param[in] psg        List of buffers.
+ * @param[in] sg_count   Number of buffers in the list.
+ * @param[in] offset     Number of bytes of the list already transferred.
+ * @param[in] block_size Size of each block in bytes.
+ * @param[in] block_ct   Number of blocks to be transferred/received.
+ *
+ * @return The number of descriptors used.
+ */
+uint32_t sdmmc_set_up_xfer_sg(dma_descriptor_t *pdesc,
+        const sdmmc_sg_entry_t *psg, uint32_t sg_count, uint64_t offset,
+        uint32_t block_size, uint32_t block_ct);
+
 /**
  * @brief Checks the card type based on its capacity.
  *
@@ -127,6 +181,15 @@ uint32_t sdmmc_is_card_ready(void);
  */
 uint32_t sdmmc_get_int_status(void);
 
+/**
+ * @brief Checks if the enabled interrupts are those of a data transfer.
+ *
+ * @return
+ * - 1 , if a command with data or busy was sent last.
+ * - 0 , if a command without data was sent last.
+ */
+uint32_t sdmmc_is_xfer_int_enabled(void);
+
 /**
  * @brief Calculates the sector count of the sd card.
  *
@@ -146,10 +209,18 @@ int32_t sdmmc_reset_configs(void);
 
 /**
  * @brief  Initializes sdmmc host configuration.
+ *
+ * If the combo-phy does not come up at the requested speed, the host is left
+ * on the timing the phy was running before.
+ *
  * @param[in]  emmc_bus_width - setting the bus width to 8.
  * @param[in]  def_speed - is default speed supported.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the phy did not come up.
  */
-void sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed);
+int32_t sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed);
 
 /**
  * @brief Resets the sdmmc peripherel.
@@ -174,4 +245,179 @@ int32_t sdmmc_init_phy(void);
  */
 void sdmmc_clear_int(void);
 
+/**
+ * @brief Checks if the host supports a bus timing.
+ *
+ * @param[in] timing The bus timing, one of sdmmc_timing_t.
+ *
+ * @return
+ * - 1 , if the timing is supported.
+ * - 0 , if the timing is not supported.
+ */
+uint32_t sdmmc_host_supports_timing(uint32_t timing);
+
+/**
+ * @brief Switches the host to a bus timing.
+ *
+ * Stops the card clock, selects the timing, reloads the combo-phy settings
+ * of the timing and restarts the card clock at the frequency of the timing.
+ * If the phy does not come up, the host goes back to the previous timing.
+ *
+ * @param[in] timing  The bus timing, one of sdmmc_timing_t.
+ * @param[in] is_emmc 1 if the device is an eMMC, 0 for an SD card.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the clock or the phy did not come up.
+ */
+int32_t sdmmc_set_bus_timing(uint32_t timing, uint32_t is_emmc);
+
+/**
+ * @brief Switches the host signaling to 1.8V.
+ *
+ * @param[in] card_handshake 1 to follow the SD voltage switch sequence,
+ *            checking the data lines driven by the card after CMD11.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the switch did not complete.
+ */
+int32_t sdmmc_switch_signal_1v8(uint32_t card_handshake);
+
+/**
+ * @brief Checks if the host signaling is at 1.8V.
+ *
+ * @return
+ * - 1 , if the signaling is at 1.8V.
+ * - 0 , if the signaling is at 3.3V.
+ */
+uint32_t sdmmc_is_signal_1v8(void);
+
+/**
+ * @brief Parse the response and check if the card accepted 1.8V signaling.
+ *
+ * @return
+ * - 1 , if S18A is set.
+ * - 0 , if S18A is not set.
+ */
+uint32_t sdmmc_is_1v8_accepted(void);
+
+/**
+ * @brief Sets the read sampling delay of the combo-phy.
+ *
+ * @param[in] tap The delay step, below SDMMC_TUNING_TAPS.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the phy did not acknowledge the new delay.
+ */
+int32_t sdmmc_set_tuning_tap(uint32_t tap);
+
+/**
+ * @brief Reads a tuning block from the card by polling.
+ *
+ * @param[in]  command_index CMD19 for SD cards or CMD21 for eMMC.
+ * @param[in]  block_size    Size of the tuning block, 64 or 128 bytes.
+ * @param[out] buff          Buffer for the block.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , if the block was received without error.
+ *  - CTRL_CONFIG_FAIL , on a timeout or a CRC error.
+ */
+int32_t sdmmc_read_tuning_block(uint8_t command_index, uint32_t block_size,
+        uint32_t *buff);
+
+/**
+ * @brief Selects how multi block transfers end.
+ *
+ * With SDMMC_AUTO_CMD23 the host sends CMD23 with the block count before
+ * CMD18 or CMD25, so the card knows the length of the transfer. With
+ * SDMMC_AUTO_CMD12 the host stops the transfer with CMD12, for SD cards
+ * which do not support CMD23.
+ *
+ * @param[in] mode SDMMC_AUTO_CMD23 or SDMMC_AUTO_CMD12.
+ */
+void sdmmc_set_auto_cmd(uint32_t mode);
+
+/**
+ * @brief Checks if the host has a command queue engine.
+ *
+ * @return
+ * - 1 , if the engine is present.
+ * - 0 , if the engine is not present.
+ */
+uint32_t sdmmc_cq_is_supported(void);
+
+/**
+ * @brief Enables the command queue engine.
+ *
+ * Sets the block size to 512 bytes, loads the task descriptor list and
+ * enables the engine and its interrupt. Legacy commands cannot be sent until
+ * the engine is disabled again.
+ *
+ * @param[in] ptdl Task descriptor list of 32 slots, aligned to 1KB.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the engine did not leave the halt state.
+ */
+int32_t sdmmc_cq_enable(cq_slot_t *ptdl);
+
+/**
+ * @brief Halts and disables the command queue engine.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the engine did not halt.
+ */
+int32_t sdmmc_cq_disable(void);
+
+/**
+ * @brief Prepares the task of a slot.
+ *
+ * Fills the transfer descriptors of the buffer, then the task descriptor and
+ * the link descriptor of the slot.
+ *
+ * @param[in] pslot      Slot of the task descriptor list.
+ * @param[in] pxfer      Transfer descriptors of the slot.
+ * @param[in] buff       Data buffer.
+ * @param[in] block_addr Address of the first block on the card.
+ * @param[in] block_ct   Number of 512 byte blocks.
+ * @param[in] is_read    1 for a read, 0 for a write.
+ */
+void sdmmc_cq_set_up_task(cq_slot_t *pslot, cq_descriptor_t *pxfer,
+        uint64_t *buff, uint64_t block_addr, uint32_t block_ct,
+        uint32_t is_read);
+
+/**
+ * @brief Hands the task of a slot to the engine.
+ *
+ * @param[in] tag Slot of the task.
+ */
+void sdmmc_cq_ring(uint32_t tag);
+
+/**
+ * @brief Reads and acknowledges the completed tasks.
+ *
+ * @param[out] perror Set to 1 if the engine or the host reported an error.
+ *
+ * @return
+ *  Bit mask of the slots whose task completed.
+ */
+uint32_t sdmmc_cq_get_completions(uint32_t *perror);
+
+/**
+ * @brief Discards the tasks an error stopped.
+ *
+ * Halts the engine and resets the command and data lines. The tasks the
+ * engine reports in error are cleared from the engine and discarded on the
+ * device with CMD48, the other tasks stay queued. If no task is reported,
+ * the whole queue is cleared and discarded. The engine then resumes.
+ * Completions are left for sdmmc_cq_get_completions().
+ *
+ * @return
+ *  Bit mask of the slots whose task was discarded.
+ */
+uint32_t sdmmc_cq_clear_tasks(void);
+
 #endif /*__SOCFPGA_SDMMC_LL_H__*/
@@ -12,11 +12,37 @@
 #include "socfpga_spi_ll.h"
 #include "socfpga_spi_reg.h"
 #include "socfpga_interrupt.h"
+#include "socfpga_dma.h"
+#include "socfpga_cache.h"
 #include "osal.h"
 #include "osal_log.h"
 
 #define MAX_INSTANCES    2U
 
+#define GET_DMA_TX_ID(instance)    (((instance) == 1U) ? DMA_ID_SPI1_MASTER_TX: DMA_ID_SPI0_MASTER_TX)
+#define GET_DMA_RX_ID(instance)    (((instance) == 1U) ? DMA_ID_SPI1_MASTER_RX: DMA_ID_SPI0_MASTER_RX)
+
+#define SPI_DMA_MAX_BLOCK_SIZE     32768U
+#define SPI_DMA_CHUNK_BLOCKS       8U
+#define SPI_DMA_CHUNK_SIZE         (SPI_DMA_CHUNK_BLOCKS * SPI_DMA_MAX_BLOCK_SIZE)
+/* Parts of transactions queued on the DMA at once, the next one is queued
+ * while the previous one runs */
+#define SPI_DMA_MAX_CHUNKS         2U
+#define SPI_DMA_NUM_INSTANCES      2U
+#define SPI_DMA_NUM_CHANNELS       4U
+/* The transmit FIFO requests the DMA while it has room for a burst, the
+ * receive FIFO for every frame */
+#define SPI_DMA_TX_LEVEL           64U
+#define SPI_DMA_RX_LEVEL           0U
+#define SPI_DUMMY_DATA             0x55U
+
+/* Part of a transaction queued on the DMA */
+struct spi_dma_chunk
+{
+    uint8_t *rxbuf;
+    uint32_t nbytes;
+};
+
 struct spi_handle
 {
     BaseType_t is_open;
@@ -41,11 +67,34 @@ struct spi_handle
     osal_semaphore_def_t sem_mem;
     osal_mutex_t mutex;
     osal_semaphore_t sem;
+    /* DMA mode */
+    BaseType_t dma_enabled;
+    spi_dma_config_t dma_cfg;
+    dma_handle_t tx_dma;
+    dma_handle_t rx_dma;
+    dma_xfer_cfg_t dma_blocks[SPI_DMA_CHUNK_BLOCKS];
+    struct spi_dma_chunk chunks[SPI_DMA_MAX_CHUNKS];
+    uint32_t chunk_head;
+    uint32_t chunk_tail;
+    uint32_t chunks_in_flight;
+    spi_transaction_t single_xfer;
+    spi_transaction_t *xfers;
+    uint32_t num_xfers;
+    uint32_t next_xfer;
+    uint32_t next_offset;
+    uint32_t cur_slave;
+    int32_t dma_status;
 };
 
 static struct spi_handle spi_descriptor[MAX_INSTANCES];
 
+/* Source of the dummy data sent and sink of the data discarded by the DMA */
+static uint8_t spi_dma_dummy_tx __attribute__((aligned(64))) = SPI_DUMMY_DATA;
+static uint8_t spi_dma_discard_rx __attribute__((aligned(64)));
+
 void spi_isr(void *param);
+static int32_t spi_dma_set_mode(spi_handle_t hspi, const spi_dma_config_t *cfg);
+static void spi_dma_disable(spi_handle_t hspi);
 
 /**
  * @brief Check if the SPI handle is valid.
@@ -81,6 +130,7 @@ spi_handle_t spi_open(uint32_t instance)
     handle->is_open = 1;
     handle->instance = instance;
     handle->base_address = GET_BASE_ADDRESS(instance);
+    handle->dma_cfg.threshold = SPI_DMA_THRESHOLD_DEFAULT;
 
     int_id = SPI_GET_INT_ID(instance);
     int_ret = interrupt_register_isr(int_id, spi_isr, handle);
@@ -193,6 +243,30 @@ int32_t spi_ioctl(spi_handle_t const hspi, spi_ioctl_t cmd, void *const buf)
         *(uint16_t *)buf = hspi->rx_size - hspi->rx_bytes_left;
         break;
 
+    case SPI_SET_DMA_MODE:
+        if (hspi->is_tx_busy || hspi->is_rx_busy)
+        {
+            ERROR("SPI bus is busy");
+            return -EBUSY;
+        }
+        if (buf == NULL)
+        {
+            ERROR("Buffer cannot be NULL");
+            return -EINVAL;
+        }
+        result = spi_dma_set_mode(hspi, (const spi_dma_config_t *)buf);
+        break;
+
+    case SPI_GET_DMA_MODE:
+        if (buf == NULL)
+        {
+            ERROR("Buffer cannot be NULL");
+            result = -EINVAL;
+            break;
+        }
+        *(spi_dma_config_t *)buf = hspi->dma_cfg;
+        break;
+
     default:
         ERROR("Invalid IOCTL request");
         result = -EINVAL;
@@ -218,6 +292,440 @@ static void spi_transfer(spi_handle_t hspi, uint8_t *buffer, uint16_t nbytes)
     spi_enable_interrupt(hspi->base_address, SPI_TX_EMPTY_INT);
 }
 
+static void spi_dma_advance(spi_handle_t hspi);
+
+/**
+ * @brief Complete a DMA transfer and notify the caller
+ */
+static void spi_dma_finish(spi_handle_t hspi)
+{
+    if ((hspi->dma_status != 0) && (dma_get_queued_jobs(hspi->tx_dma) > 0U))
+    {
+        /* Nothing is received any more, drop what is left to send */
+        (void)dma_stop_transfer(hspi->tx_dma);
+    }
+    spi_disable_dma(hspi->base_address);
+    spi_select_chip(hspi->instance, 0U);
+    hspi->cur_slave = 0U;
+    if (hspi->dma_status == 0)
+    {
+        hspi->tx_bytes_left = 0U;
+        hspi->rx_bytes_left = 0U;
+    }
+
+    hspi->is_tx_busy = false;
+    hspi->is_rx_busy = false;
+    if ((hspi->is_rx_async == true) || (hspi->is_tx_async == true))
+    {
+        hspi->is_tx_async = false;
+        hspi->is_rx_async = false;
+        if (hspi->callback_fn != NULL)
+        {
+            hspi->callback_fn((hspi->dma_status == 0) ? SPI_SUCCESS :
+                    SPI_XFER_ERROR, hspi->cb_user_context);
+        }
+    }
+    else
+    {
+        (void)osal_semaphore_post(hspi->sem);
+    }
+}
+
+/**
+ * @brief Completion of the receive job of a chunk, called from the DMA interrupt
+ *
+ * Every frame sent is received, so the chunk is done on both channels.
+ */
+static void spi_dma_rx_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    spi_handle_t hspi = (spi_handle_t)cb_data;
+    struct spi_dma_chunk *chunk;
+
+    (void)hdma;
+    chunk = &hspi->chunks[hspi->chunk_tail];
+    hspi->chunk_tail = (hspi->chunk_tail + 1U) % SPI_DMA_MAX_CHUNKS;
+    hspi->chunks_in_flight--;
+    if (status != 0)
+    {
+        hspi->dma_status = -EIO;
+    }
+    else if (chunk->rxbuf != NULL)
+    {
+        /* Drop the lines the CPU may have fetched during the transfer */
+        cache_flush((void *)chunk->rxbuf, chunk->nbytes);
+    }
+    spi_dma_advance(hspi);
+}
+
+/**
+ * @brief Completion of the transmit job of a chunk, called from the DMA interrupt
+ */
+static void spi_dma_tx_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    spi_handle_t hspi = (spi_handle_t)cb_data;
+
+    (void)hdma;
+    if ((status != 0) && (status != -ECANCELED))
+    {
+        /* The receive jobs wait for frames that are not sent, cancel them */
+        hspi->dma_status = -EIO;
+        (void)dma_stop_transfer(hspi->rx_dma);
+    }
+}
+
+/**
+ * @brief Fill the block list of a DMA job, a fixed address stays the same
+ * for every block
+ */
+static uint32_t spi_dma_build_blocks(spi_handle_t hspi, uint64_t src,
+        uint64_t dst, uint32_t nbytes, uint32_t flags)
+{
+    uint32_t num_blocks = 0U;
+    uint32_t offset;
+    uint32_t blk;
+
+    for (offset = 0U; offset < nbytes; offset += blk)
+    {
+        blk = nbytes - offset;
+        if (blk > SPI_DMA_MAX_BLOCK_SIZE)
+        {
+            blk = SPI_DMA_MAX_BLOCK_SIZE;
+        }
+        hspi->dma_blocks[num_blocks].src = src +
+                (((flags & DMA_XFER_SRC_FIXED) != 0U) ? 0UL : (uint64_t)offset);
+        hspi->dma_blocks[num_blocks].dst = dst +
+                (((flags & DMA_XFER_DST_FIXED) != 0U) ? 0UL : (uint64_t)offset);
+        hspi->dma_blocks[num_blocks].blk_size = blk;
+        hspi->dma_blocks[num_blocks].next_trnsfr_cfg = NULL;
+        if (num_blocks > 0U)
+        {
+            hspi->dma_blocks[num_blocks - 1U].next_trnsfr_cfg =
+                    &hspi->dma_blocks[num_blocks];
+        }
+        num_blocks++;
+    }
+    return num_blocks;
+}
+
+/**
+ * @brief Queue the receive and transmit jobs of a part of a transaction
+ */
+static int32_t spi_dma_queue_chunk(spi_handle_t hspi,
+        const spi_transaction_t *xfer, uint32_t offset, uint32_t nbytes)
+{
+    struct spi_dma_chunk *chunk;
+    dma_job_t job;
+    uint64_t data_reg;
+    uint64_t addr;
+    int32_t ret;
+
+    data_reg = (uint64_t)(hspi->base_address + SPI_DR0);
+    chunk = &hspi->chunks[hspi->chunk_head];
+    chunk->rxbuf = (xfer->rxbuf != NULL) ? &xfer->rxbuf[offset] : NULL;
+    chunk->nbytes = nbytes;
+
+    /* Receive job first, so it is waiting when the first frame arrives */
+    job.flags = DMA_XFER_SRC_FIXED | DMA_XFER_PERI_SINGLE;
+    if (chunk->rxbuf != NULL)
+    {
+        cache_flush((void *)chunk->rxbuf, nbytes);
+        addr = (uint64_t)(uintptr_t)chunk->rxbuf;
+    }
+    else
+    {
+        job.flags |= DMA_XFER_DST_FIXED;
+        addr = (uint64_t)(uintptr_t)&spi_dma_discard_rx;
+    }
+    job.xfer_list = hspi->dma_blocks;
+    job.num_xfers = spi_dma_build_blocks(hspi, data_reg, addr, nbytes,
+            job.flags);
+    job.src_width = DMA_TRANSFER_WIDTH1;
+    job.dst_width = DMA_TRANSFER_WIDTH1;
+    job.callback = spi_dma_rx_done;
+    job.cb_data = hspi;
+    ret = dma_submit_job(hspi->rx_dma, &job);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    hspi->chunk_head = (hspi->chunk_head + 1U) % SPI_DMA_MAX_CHUNKS;
+    hspi->chunks_in_flight++;
+
+    job.flags = DMA_XFER_DST_FIXED;
+    if (xfer->txbuf != NULL)
+    {
+        cache_force_write_back((void *)&xfer->txbuf[offset], nbytes);
+        addr = (uint64_t)(uintptr_t)&xfer->txbuf[offset];
+    }
+    else
+    {
+        job.flags |= DMA_XFER_SRC_FIXED;
+        addr = (uint64_t)(uintptr_t)&spi_dma_dummy_tx;
+    }
+    job.num_xfers = spi_dma_build_blocks(hspi, addr, data_reg, nbytes,
+            job.flags);
+    job.callback = spi_dma_tx_done;
+    ret = dma_submit_job(hspi->tx_dma, &job);
+    if (ret != 0)
+    {
+        /* The receive job would wait forever, cancel it */
+        hspi->dma_status = -EIO;
+        (void)dma_stop_transfer(hspi->rx_dma);
+    }
+    return ret;
+}
+
+/**
+ * @brief Queue the next chunks of the transactions
+ *
+ * Chunks of transactions with the same slave are queued while the previous
+ * ones run, so the DMA streams them without gaps. The chip select can only
+ * change once the bus is idle, so a transaction with another slave waits for
+ * the queued chunks to complete.
+ */
+static void spi_dma_submit(spi_handle_t hspi)
+{
+    const spi_transaction_t *xfer;
+    uint32_t slave;
+    uint32_t nbytes;
+
+    while ((hspi->dma_status == 0) &&
+            (hspi->chunks_in_flight < SPI_DMA_MAX_CHUNKS) &&
+            (hspi->next_xfer < hspi->num_xfers))
+    {
+        xfer = &hspi->xfers[hspi->next_xfer];
+        slave = (xfer->slave != 0U) ? xfer->slave : hspi->slave_id;
+        if (slave != hspi->cur_slave)
+        {
+            if (hspi->chunks_in_flight > 0U)
+            {
+                break;
+            }
+            spi_select_chip(hspi->instance, slave);
+            hspi->cur_slave = slave;
+        }
+
+        nbytes = xfer->nbytes - hspi->next_offset;
+        if (nbytes > SPI_DMA_CHUNK_SIZE)
+        {
+            nbytes = SPI_DMA_CHUNK_SIZE;
+        }
+        if (spi_dma_queue_chunk(hspi, xfer, hspi->next_offset, nbytes) != 0)
+        {
+            hspi->dma_status = -EIO;
+            break;
+        }
+        hspi->next_offset += nbytes;
+        if (hspi->next_offset == xfer->nbytes)
+        {
+            hspi->next_xfer++;
+            hspi->next_offset = 0U;
+        }
+    }
+}
+
+/**
+ * @brief Queue what the DMA has room for and complete the transfer once
+ * every chunk is done or a chunk failed
+ *
+ * Called from the DMA interrupt, or with the interrupts masked.
+ */
+static void spi_dma_advance(spi_handle_t hspi)
+{
+    spi_dma_submit(hspi);
+    if ((hspi->is_tx_busy == true) && (hspi->chunks_in_flight == 0U) &&
+            ((hspi->dma_status != 0) || (hspi->next_xfer == hspi->num_xfers)))
+    {
+        spi_dma_finish(hspi);
+    }
+}
+
+/**
+ * @brief Start a list of transactions on the DMA, the bus must be claimed
+ */
+static int32_t spi_dma_start(spi_handle_t hspi, spi_transaction_t *xfers,
+        uint32_t num_xfers)
+{
+    UBaseType_t int_mask;
+    BaseType_t async;
+
+    async = hspi->is_tx_async;
+    hspi->xfers = xfers;
+    hspi->num_xfers = num_xfers;
+    hspi->next_xfer = 0U;
+    hspi->next_offset = 0U;
+    hspi->cur_slave = 0U;
+    hspi->chunk_head = 0U;
+    hspi->chunk_tail = 0U;
+    hspi->chunks_in_flight = 0U;
+    hspi->dma_status = 0;
+
+    spi_enable_dma(hspi->base_address, SPI_DMA_TX_LEVEL, SPI_DMA_RX_LEVEL);
+    /* Masks the DMA interrupt, whose completions queue the next chunks */
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    spi_dma_advance(hspi);
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (async == true)
+    {
+        return 0;
+    }
+    (void)osal_semaphore_wait(hspi->sem, OSAL_TIMEOUT_WAIT_FOREVER);
+    return hspi->dma_status;
+}
+
+/**
+ * @brief Open and configure a free DMA channel for the SPI master
+ */
+static dma_handle_t spi_dma_open_channel(dma_xfer_type_t dir,
+        dma_peri_id_t peri_id, uint8_t prio)
+{
+    dma_handle_t hdma;
+    dma_config_t cfg;
+    uint32_t inst;
+    uint32_t ch;
+
+    for (inst = 0U; inst < SPI_DMA_NUM_INSTANCES; inst++)
+    {
+        for (ch = 0U; ch < SPI_DMA_NUM_CHANNELS; ch++)
+        {
+            hdma = dma_open(inst, ch);
+            if (hdma == NULL)
+            {
+                continue;
+            }
+            cfg.instance = (uint8_t)inst;
+            cfg.ch_dir = dir;
+            cfg.ch_prio = prio;
+            cfg.peri_id = peri_id;
+            cfg.callback = NULL;
+            if (dma_config(hdma, &cfg) == 0)
+            {
+                return hdma;
+            }
+            (void)dma_close(hdma);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Release the DMA channels, the bus must be idle
+ */
+static void spi_dma_disable(spi_handle_t hspi)
+{
+    if (hspi->rx_dma != NULL)
+    {
+        (void)dma_close(hspi->rx_dma);
+        hspi->rx_dma = NULL;
+    }
+    if (hspi->tx_dma != NULL)
+    {
+        (void)dma_close(hspi->tx_dma);
+        hspi->tx_dma = NULL;
+    }
+    hspi->dma_enabled = false;
+}
+
+/**
+ * @brief Enable or disable the DMA mode
+ */
+static int32_t spi_dma_set_mode(spi_handle_t hspi, const spi_dma_config_t *cfg)
+{
+    if (hspi->dma_enabled == true)
+    {
+        spi_dma_disable(hspi);
+    }
+    if (cfg->enable == 0U)
+    {
+        hspi->dma_cfg = *cfg;
+        return 0;
+    }
+
+    hspi->tx_dma = spi_dma_open_channel(DMA_MEM_TO_PERI_DMAC,
+            GET_DMA_TX_ID(hspi->instance), 0U);
+    /* The receive FIFO overflows if it is not drained in time */
+    hspi->rx_dma = spi_dma_open_channel(DMA_PERI_TO_MEM_DMAC,
+            GET_DMA_RX_ID(hspi->instance), 1U);
+    if ((hspi->tx_dma == NULL) || (hspi->rx_dma == NULL))
+    {
+        spi_dma_disable(hspi);
+        return -ENODEV;
+    }
+    cache_force_write_back((void *)&spi_dma_dummy_tx, sizeof(spi_dma_dummy_tx));
+
+    hspi->dma_cfg = *cfg;
+    hspi->dma_enabled = true;
+    return 0;
+}
+
+/**
+ * @brief Claim the bus for a DMA transfer
+ */
+static int32_t spi_dma_claim(spi_handle_t hspi, BaseType_t async)
+{
+    int32_t ret = 0;
+
+    if (osal_mutex_lock(hspi->mutex, OSAL_TIMEOUT_WAIT_FOREVER))
+    {
+        if (!hspi->is_open)
+        {
+            ERROR("SPI instance not open");
+            ret = -EINVAL;
+        }
+        else if (hspi->dma_enabled != true)
+        {
+            ERROR("SPI DMA mode not enabled");
+            ret = -ENODEV;
+        }
+        else if (hspi->is_tx_busy || hspi->is_rx_busy)
+        {
+            ERROR("SPI bus is busy");
+            ret = -EBUSY;
+        }
+        else
+        {
+            hspi->is_tx_busy = true;
+            hspi->is_rx_busy = true;
+            hspi->is_tx_async = async;
+            hspi->is_rx_async = async;
+            hspi->tx_size = 0U;
+            hspi->rx_size = 0U;
+            hspi->tx_bytes_left = 0U;
+            hspi->rx_bytes_left = 0U;
+        }
+        if (osal_mutex_unlock(hspi->mutex) == false)
+        {
+            ERROR("Failed to unlock mutex");
+            return -EIO;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Check a list of transactions
+ */
+static BaseType_t spi_dma_xfers_valid(spi_handle_t hspi,
+        const spi_transaction_t *xfers, uint32_t num_xfers)
+{
+    uint32_t i;
+
+    if ((xfers == NULL) || (num_xfers == 0U))
+    {
+        return false;
+    }
+    for (i = 0U; i < num_xfers; i++)
+    {
+        if ((xfers[i].nbytes == 0U) || (xfers[i].slave > 4U) ||
+                ((xfers[i].slave == 0U) && (hspi->slave_id == 0U)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 int32_t spi_transfer_sync(spi_handle_t const hspi,
         uint8_t *const txbuf, uint8_t *const rxbuf, uint16_t nbytes)
 {
@@ -277,6 +785,16 @@ int32_t spi_transfer_sync(spi_handle_t const hspi,
         hspi->rx_size = nbytes;
     }
 
+    if ((hspi->dma_enabled == true) && (nbytes >= hspi->dma_cfg.threshold))
+    {
+        hspi->single_xfer.slave = 0U;
+        hspi->single_xfer.txbuf = txbuf;
+        hspi->single_xfer.rxbuf = rxbuf;
+        hspi->single_xfer.nbytes = nbytes;
+        INFO("Starting SPI DMA transfer in sync mode for %u bytes", nbytes);
+        return spi_dma_start(hspi, &hspi->single_xfer, 1U);
+    }
+
     INFO("Starting SPI transfer in sync mode for %u bytes", nbytes);
     spi_transfer(hspi, txbuf, nbytes);
     rx_sem_return = osal_semaphore_wait(hspi->sem, OSAL_TIMEOUT_WAIT_FOREVER);
@@ -353,6 +871,16 @@ int32_t spi_transfer_async(spi_handle_t const hspi,
         hspi->rx_size = nbytes;
     }
 
+    if ((hspi->dma_enabled == true) && (nbytes >= hspi->dma_cfg.threshold))
+    {
+        hspi->single_xfer.slave = 0U;
+        hspi->single_xfer.txbuf = txbuf;
+        hspi->single_xfer.rxbuf = rxbuf;
+        hspi->single_xfer.nbytes = nbytes;
+        INFO("Starting SPI DMA transfer in async mode for %u bytes", nbytes);
+        return spi_dma_start(hspi, &hspi->single_xfer, 1U);
+    }
+
     INFO("Starting SPI transfer in async mode for %u bytes", nbytes);
     spi_set_transfermode(hspi->base_address, SPI_TX_RX_MOD);
     spi_transfer(hspi, txbuf, nbytes);
@@ -360,6 +888,48 @@ int32_t spi_transfer_async(spi_handle_t const hspi,
     return 0;
 }
 
+int32_t spi_transfer_queue_sync(spi_handle_t const hspi,
+        spi_transaction_t *const xfers, uint32_t num_xfers)
+{
+    int32_t ret;
+
+    if (!(spi_is_handle_valid(hspi)) ||
+            !(spi_dma_xfers_valid(hspi, xfers, num_xfers)))
+    {
+        ERROR("Invalid SPI handle or transaction");
+        return -EINVAL;
+    }
+    ret = spi_dma_claim(hspi, false);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    INFO("Starting %u queued SPI transactions in sync mode", num_xfers);
+    return spi_dma_start(hspi, xfers, num_xfers);
+}
+
+int32_t spi_transfer_queue_async(spi_handle_t const hspi,
+        spi_transaction_t *const xfers, uint32_t num_xfers)
+{
+    int32_t ret;
+
+    if (!(spi_is_handle_valid(hspi)) ||
+            !(spi_dma_xfers_valid(hspi, xfers, num_xfers)))
+    {
+        ERROR("Invalid SPI handle or transaction");
+        return -EINVAL;
+    }
+    ret = spi_dma_claim(hspi, true);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    INFO("Starting %u queued SPI transactions in async mode", num_xfers);
+    return spi_dma_start(hspi, xfers, num_xfers);
+}
+
 int32_t spi_select_slave(spi_handle_t const hspi, uint32_t ss)
 {
     if ((ss < 1U) || (ss > 4U))
@@ -393,6 +963,10 @@ int32_t spi_close(spi_handle_t const hspi)
         return -EINVAL;
     }
 
+    if (hspi->dma_enabled == true)
+    {
+        spi_dma_disable(hspi);
+    }
     hspi->is_open = false;
     spi_deinit(hspi->instance);
 
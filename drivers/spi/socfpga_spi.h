@@ -108,8 +108,15 @@ typedef enum
     SPI_GET_CONFIG, /*!< Gets the configuration of the SPI master and the data type is spi_cfg_t. */
     SPI_GET_TX_NBYTES,  /*!< Get the number of bytes sent in write operation and the data type is uint16_t. */
     SPI_GET_RX_NBYTES,  /*!< Get the number of bytes received in read operation and the data type is uint16_t. */
+    SPI_SET_DMA_MODE, /*!< Enables or disables DMA transfers and the data type is spi_dma_config_t. */
+    SPI_GET_DMA_MODE, /*!< Gets the DMA configuration and the data type is spi_dma_config_t. */
 } spi_ioctl_t;
 
+/**
+ * @brief Default size from which transfers use the DMA in DMA mode.
+ */
+#define SPI_DMA_THRESHOLD_DEFAULT    (64U)
+
 /**
  * @addtogroup spi_structs
  * @{
@@ -126,6 +133,34 @@ typedef struct
     spi_mode_t mode; /*!< Mode selected as per enum spi_mode_t. */
 } spi_cfg_t;
 
+/**
+ * @brief DMA configuration of the SPI master.
+ *
+ * @details In DMA mode a pair of DMA channels feeds the transmit FIFO and
+ * drains the receive FIFO, transfers of at least threshold bytes use them.
+ * The application sets it using the Ioctl SPI_SET_DMA_MODE.
+ */
+typedef struct
+{
+    uint8_t enable; /*!< 1 to use the DMA, 0 for FIFO interrupts only. */
+    uint32_t threshold; /*!< Transfers of at least this many bytes use the DMA. */
+} spi_dma_config_t;
+
+/**
+ * @brief A transaction of a queued transfer.
+ *
+ * @details Consecutive transactions with the same slave are sent as one
+ * continuous stream. The chip select is switched once the previous
+ * transactions completed.
+ */
+typedef struct
+{
+    uint32_t slave; /*!< Slave select number 1 to 4, 0 for the slave set with spi_select_slave(). */
+    uint8_t *txbuf; /*!< Data to transmit, NULL to transmit dummy data. */
+    uint8_t *rxbuf; /*!< Buffer to receive data, NULL to discard the received data. */
+    uint32_t nbytes; /*!< Number of bytes to transfer. */
+} spi_transaction_t;
+
 /**
  * @brief The SPI descriptor type defined in the source file.
  */
@@ -221,6 +256,13 @@ int32_t spi_set_callback(spi_handle_t const hspi, spi_callback_t callback,
  * - If the last operation only did write, this returns 0.
  * - If the last operation did both write and read, this returns the number of read bytes.
  *
+ * @note SPI_SET_DMA_MODE enables or disables DMA transfers.
+ * This request expects the buffer with size of spi_dma_config_t. Two
+ * free DMA channels are needed to enable the DMA mode.
+ *
+ * @note SPI_GET_DMA_MODE gets the current DMA configuration.
+ * This request expects the buffer with size of spi_dma_config_t.
+ *
  * @param[in]     hspi The SPI peripheral handle returned in open() call.
  * @param[in]     cmd  The configuration request from one of the spi_ioctl_t.
  * @param[in,out] buf  The configuration values for the SPI port.
@@ -233,6 +275,8 @@ int32_t spi_set_callback(spi_handle_t const hspi, spi_callback_t callback,
  *     - pucBuffer is NULL with requests which needs buffer
  * - -EBUSY:  if the bus is busy for only following requests:
  *     - SPI_SET_CONFIG
+ *     - SPI_SET_DMA_MODE
+ * - -ENODEV: if no DMA channel is free to enable the DMA mode
  */
 int32_t spi_ioctl(spi_handle_t const hspi, spi_ioctl_t cmd, void *const buf);
 
@@ -242,6 +286,8 @@ int32_t spi_ioctl(spi_handle_t const hspi, spi_ioctl_t cmd, void *const buf);
  * This function attempts to read/write certain number of bytes from/to two pre-allocated buffers at the same time, in synchronous way.
  * This function does not return on partial read/write, unless there is an error.
  * And the number of bytes that have been actually read or written can be obtained by calling spi_ioctl.
+ * In DMA mode, transfers of at least the DMA threshold are done by the DMA,
+ * see spi_transfer_queue_sync() for the cache requirements of rxbuf.
  *
  * @param[in]  hspi   The SPI peripheral handle returned in open() call.
  * @param[in]  txbuf  The buffer to transmit data. For write operation txbuf contains the actual data
@@ -272,6 +318,8 @@ int32_t spi_transfer_sync(spi_handle_t const hspi, uint8_t *const txbuf,
  * If the operation encounters an error, the user callback will be invoked.
  * The callback is not invoked on partial read/write, unless there is an error.
  * And the number of bytes that have been actually read/write can be obtained by calling spi_ioctl.
+ * In DMA mode, transfers of at least the DMA threshold are done by the DMA,
+ * see spi_transfer_queue_sync() for the cache requirements of rxbuf.
  *
  * @param[in]  hspi   The SPI peripheral handle returned in open() call.
  * @param[in]  txbuf  The buffer to transmit data. For write operation txbuf contains the actual data
@@ -291,6 +339,58 @@ int32_t spi_transfer_sync(spi_handle_t const hspi, uint8_t *const txbuf,
 int32_t spi_transfer_async(spi_handle_t const hspi, uint8_t *const txbuf,
         uint8_t *const rxbuf, uint16_t nbytes);
 
+/**
+ * @brief The SPI master runs a list of transactions and waits for them to complete.
+ *
+ * The transactions are run back to back by the DMA, the DMA mode must be
+ * enabled. Each transaction may select its own slave and has no size limit.
+ * The receive buffers are cleaned and invalidated in the cache around the
+ * transfer, data sharing their first and last cache lines must not be
+ * accessed until the transfer completes.
+ *
+ * @param[in] hspi      The SPI peripheral handle returned in open() call.
+ * @param[in] xfers     The transactions, in the order they are run.
+ * @param[in] num_xfers The number of transactions.
+ *
+ * @return
+ * - 0:       on success (all the transactions have completed)
+ * - -EINVAL: if
+ *     - hspi is NULL
+ *     - hspi is not opened yet
+ *     - xfers is NULL or num_xfers is 0
+ *     - a transaction has 0 bytes or an invalid slave
+ * - -ENODEV: if the DMA mode is not enabled.
+ * - -EIO:    if a DMA transfer failed.
+ * - -EBUSY:  if the bus is busy which means there is an ongoing operation.
+ */
+int32_t spi_transfer_queue_sync(spi_handle_t const hspi,
+        spi_transaction_t *const xfers, uint32_t num_xfers);
+
+/**
+ * @brief The SPI master starts a list of transactions and returns immediately.
+ *
+ * The transactions are run back to back by the DMA as in
+ * spi_transfer_queue_sync(). The user callback is invoked once, when the
+ * last transaction completes or a transfer fails. The transactions must not
+ * be modified until then.
+ *
+ * @param[in] hspi      The SPI peripheral handle returned in open() call.
+ * @param[in] xfers     The transactions, in the order they are run.
+ * @param[in] num_xfers The number of transactions.
+ *
+ * @return
+ * - 0:       on success (the transfer has started)
+ * - -EINVAL: if
+ *     - hspi is NULL
+ *     - hspi is not opened yet
+ *     - xfers is NULL or num_xfers is 0
+ *     - a transaction has 0 bytes or an invalid slave
+ * - -ENODEV: if the DMA mode is not enabled.
+ * - -EBUSY:  if the bus is busy which means there is an ongoing operation.
+ */
+int32_t spi_transfer_queue_async(spi_handle_t const hspi,
+        spi_transaction_t *const xfers, uint32_t num_xfers);
+
 /**
  * @brief Closes the SPI instance.
  *
@@ -480,3 +480,24 @@ void spi_disable_interrupt(uint32_t base_address, uint32_t ir_id)
 
     WR_REG32((base_address + SPI_IMR), val);
 }
+
+/**
+ * @brief Enable the DMA requests of the SPI instance
+ */
+void spi_enable_dma(uint32_t base_address, uint32_t tx_level, uint32_t rx_level)
+{
+    WR_REG32((base_address + SPI_DMATDLR),
+            ((tx_level << SPI_DMATDLR_DMATDL_POS) & SPI_DMATDLR_DMATDL_MASK));
+    WR_REG32((base_address + SPI_DMARDLR),
+            ((rx_level << SPI_DMARDLR_DMARDL_POS) & SPI_DMARDLR_DMARDL_MASK));
+    WR_REG32((base_address + SPI_DMACR),
+            (SPI_DMACR_TDMAE_MASK | SPI_DMACR_RDMAE_MASK));
+}
+
+/**
+ * @brief Disable the DMA requests of the SPI instance
+ */
+void spi_disable_dma(uint32_t base_address)
+{
+    WR_REG32((base_address + SPI_DMACR), 0U);
+}
@@ -53,4 +53,7 @@ uint8_t spi_get_interrupt_status(uint32_t base_address);
 void spi_enable_interrupt(uint32_t base_address, uint32_t ir_id);
 void spi_disable_interrupt(uint32_t base_address, uint32_t ir_id);
 
+void spi_enable_dma(uint32_t base_address, uint32_t tx_level, uint32_t rx_level);
+void spi_disable_dma(uint32_t base_address);
+
 #endif /* __SOCFPGA_SPI_H__ */
@@ -11,9 +11,22 @@
 #include "socfpga_uart_ll.h"
 #include "socfpga_uart_reg.h"
 #include "socfpga_interrupt.h"
+#include "socfpga_dma.h"
+#include "socfpga_cache.h"
 #include "osal.h"
+#include "timers.h"
 
 #define GET_INT_ID(instance)    (((instance) == 1U) ? UART1IRQ: UART0IRQ)
+#define GET_DMA_TX_ID(instance)    (((instance) == 1U) ? DMA_ID_UART1_TX: DMA_ID_UART0_TX)
+#define GET_DMA_RX_ID(instance)    (((instance) == 1U) ? DMA_ID_UART1_RX: DMA_ID_UART0_RX)
+
+#define UART_DMA_MAX_BLOCK_SIZE     32768U
+#define UART_DMA_TX_MAX_BLOCKS      (UART_DMA_TX_MAX_SIZE / UART_DMA_MAX_BLOCK_SIZE)
+#define UART_DMA_NUM_INSTANCES      2U
+#define UART_DMA_NUM_CHANNELS       4U
+/* Interval to collect the bytes of a partial period when no idle
+ * timeout is set */
+#define UART_DMA_RX_POLL_MS         10U
 struct uart_descriptor
 {
     BaseType_t is_open;
@@ -23,6 +36,8 @@ struct uart_descriptor
     BaseType_t tx_is_async;
     BaseType_t rx_is_async;
     uint32_t base_address;
+    /* FCR value of the FIFO mode, FCR is write only */
+    uint32_t fifo_ctrl;
     size_t tx_bytes_left;
     size_t rx_bytes_left;
     size_t tx_size;
@@ -37,11 +52,34 @@ struct uart_descriptor
     osal_mutex_t mutex;
     osal_semaphore_t rd_sem;
     osal_semaphore_t wr_sem;
+    /* DMA mode */
+    BaseType_t dma_enabled;
+    uart_dma_config_t dma_cfg;
+    dma_handle_t tx_dma;
+    dma_handle_t rx_dma;
+    dma_xfer_cfg_t tx_blocks[UART_DMA_TX_MAX_BLOCKS];
+    uint8_t *rx_ring;
+    /* Offset of the oldest unread byte in the receive ring */
+    uint32_t rx_tail;
+    /* Periods read past but not yet released to the DMA */
+    uint32_t rx_unreleased;
+    /* Copies out of the receive ring in progress, and the periods claimed
+     * bytes read past, released once no copy is left */
+    uint32_t rx_copying;
+    uint32_t rx_claimed_periods;
+    /* Bytes of the current read received at the last idle check */
+    size_t rx_idle_mark;
+    TimerHandle_t rx_timer;
 };
 
 static struct uart_descriptor uart_descriptors[UART_MAX_INSTANCE];
 
+/* Receive rings of the DMA mode */
+static uint8_t uart_rx_ring[UART_MAX_INSTANCE][UART_DMA_RX_RING_SIZE]
+__attribute__ ((aligned (64)));
+
 void uart_isr(void *param);
+static int32_t uart_dma_set_mode(uart_handle_t huart, const uart_dma_config_t *cfg);
 
 /**
  * @brief Check if the UART handle is valid
@@ -77,6 +115,7 @@ uart_handle_t uart_open(uint32_t instance)
     handle->is_open = 1;
     handle->instance = instance;
     handle->base_address = GET_UART_BASE_ADDRESS(instance);
+    handle->dma_cfg.tx_threshold = UART_DMA_TX_THRESHOLD_DEFAULT;
 
     int_id = GET_INT_ID(instance);
     int_ret = interrupt_register_isr(int_id, uart_isr, handle);
@@ -94,7 +133,7 @@ uart_handle_t uart_open(uint32_t instance)
     handle->mutex = osal_mutex_create(&handle->mutex_mem);
     handle->rd_sem = osal_semaphore_create(&handle->rd_sem_mem);
     handle->wr_sem = osal_semaphore_create(&handle->wr_sem_mem);
-    uart_init(instance);
+    handle->fifo_ctrl = uart_init(instance);
     return handle;
 }
 
@@ -169,6 +208,32 @@ int32_t uart_ioctl(uart_handle_t const huart, uart_ioctl_t cmd, void *const buf)
             }
             break;
 
+        case UART_SET_DMA_MODE:
+            if (huart->tx_is_busy || huart->rx_is_busy)
+            {
+                res = -EBUSY;
+                break;
+            }
+            res = uart_dma_set_mode(huart, (const uart_dma_config_t *)buf);
+            break;
+
+        case UART_GET_DMA_MODE:
+            *(uart_dma_config_t *)buf = huart->dma_cfg;
+            break;
+
+        case UART_GET_RX_OVERRUNS:
+            *(uint32_t *)buf = 0U;
+            if (huart->dma_enabled == true)
+            {
+                dma_cyclic_status_t dma_status;
+
+                if (dma_cyclic_get_status(huart->rx_dma, &dma_status) == 0)
+                {
+                    *(uint32_t *)buf = dma_status.overruns;
+                }
+            }
+            break;
+
         default:
             res = -EINVAL;
             break;
@@ -195,6 +260,397 @@ int32_t uart_set_callback(uart_handle_t const huart, uart_callback_t callback,
     return 0;
 }
 
+/**
+ * @brief Complete the current read
+ */
+static void uart_rx_complete(uart_handle_t huart, uart_op_status_t status)
+{
+    if (huart->rx_is_async == true)
+    {
+        huart->rx_is_async = false;
+        huart->rx_is_busy = false;
+        if (huart->callback_fn != NULL)
+        {
+            huart->callback_fn(status, huart->cb_user_context);
+        }
+    }
+    else
+    {
+        (void)osal_semaphore_post(huart->rd_sem);
+    }
+}
+
+/**
+ * @brief Complete the current write
+ */
+static void uart_tx_complete(uart_handle_t huart, uart_op_status_t status)
+{
+    if (huart->tx_is_async == true)
+    {
+        huart->tx_is_async = false;
+        huart->tx_is_busy = false;
+        if (huart->callback_fn != NULL)
+        {
+            huart->callback_fn(status, huart->cb_user_context);
+        }
+    }
+    else
+    {
+        (void)osal_semaphore_post(huart->wr_sem);
+    }
+}
+
+/**
+ * @brief Release to the DMA the periods read past, as far as the DMA counted
+ * them complete
+ *
+ * A period read past before its interrupt was counted is released by a
+ * later call.
+ */
+static void uart_dma_rx_release(uart_handle_t huart, dma_cyclic_status_t *pdma_status)
+{
+    uint32_t released;
+
+    released = (huart->rx_unreleased < pdma_status->pending) ?
+            huart->rx_unreleased : pdma_status->pending;
+    if ((released > 0U) && (dma_cyclic_release(huart->rx_dma, released) == 0))
+    {
+        huart->rx_unreleased -= released;
+        pdma_status->pending -= released;
+    }
+}
+
+/**
+ * @brief Move received bytes from the DMA ring to the pending read
+ *
+ * Called from the DMA interrupt at the end of every period and from the
+ * receive timer. The timer completes the read early once no byte arrived
+ * for an idle interval. The bytes are claimed with the interrupts masked
+ * and copied with them enabled. The periods read past are only released to
+ * the DMA once no copy is left in progress, so the DMA never writes bytes
+ * still being copied.
+ */
+static void uart_dma_rx_poll(uart_handle_t huart, BaseType_t idle_check)
+{
+    dma_cyclic_status_t dma_status;
+    UBaseType_t int_mask;
+    uint8_t *dst;
+    uint32_t tail;
+    uint32_t tail_off;
+    uint32_t avail;
+    uint32_t chunk;
+    size_t nbytes;
+    size_t left;
+    size_t received;
+    BaseType_t done = false;
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    if ((huart->rx_is_busy != true) || (huart->rx_bytes_left == 0U) ||
+            (dma_cyclic_get_status(huart->rx_dma, &dma_status) != 0))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(int_mask);
+        return;
+    }
+
+    /* Bytes from the oldest unread one up to the DMA write position. The
+     * period holding rx_tail is only released once rx_tail leaves it, so
+     * with completed periods still pending the DMA meeting rx_tail again
+     * means the ring is full rather than empty. Periods still being copied
+     * are pending too and do not count. */
+    uart_dma_rx_release(huart, &dma_status);
+    tail = huart->rx_tail;
+    tail_off = tail % UART_DMA_RX_PERIOD_SIZE;
+    avail = (dma_status.position + UART_DMA_RX_RING_SIZE - tail) %
+            UART_DMA_RX_RING_SIZE;
+    if ((avail == 0U) && (dma_status.pending > huart->rx_claimed_periods))
+    {
+        avail = UART_DMA_RX_RING_SIZE;
+    }
+    nbytes = (avail < huart->rx_bytes_left) ? avail : huart->rx_bytes_left;
+
+    /* Claim the bytes, a poll preempting the copy takes the next ones */
+    dst = huart->rx_buf;
+    huart->rx_buf += nbytes;
+    huart->rx_bytes_left -= nbytes;
+    huart->rx_tail = (tail + (uint32_t)nbytes) % UART_DMA_RX_RING_SIZE;
+    huart->rx_claimed_periods += (tail_off + (uint32_t)nbytes) / UART_DMA_RX_PERIOD_SIZE;
+    huart->rx_copying++;
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    for (left = nbytes; left > 0U; left -= chunk)
+    {
+        chunk = UART_DMA_RX_RING_SIZE - tail;
+        if (chunk > left)
+        {
+            chunk = (uint32_t)left;
+        }
+        /* The ring is only written by the DMA, drop stale lines */
+        cache_flush(&huart->rx_ring[tail], chunk);
+        (void)memcpy(dst, &huart->rx_ring[tail], chunk);
+        dst += chunk;
+        tail = (tail + chunk) % UART_DMA_RX_RING_SIZE;
+    }
+
+    int_mask = taskENTER_CRITICAL_FROM_ISR();
+    huart->rx_copying--;
+    if (huart->rx_copying == 0U)
+    {
+        huart->rx_unreleased += huart->rx_claimed_periods;
+        huart->rx_claimed_periods = 0U;
+        if (dma_cyclic_get_status(huart->rx_dma, &dma_status) == 0)
+        {
+            uart_dma_rx_release(huart, &dma_status);
+        }
+
+        /* Only the last copy out completes the read */
+        received = huart->rx_size - huart->rx_bytes_left;
+        if (huart->rx_bytes_left == 0U)
+        {
+            done = true;
+        }
+        else if (idle_check == true)
+        {
+            if ((huart->dma_cfg.rx_idle_ms != 0U) && (received > 0U) &&
+                    (received == huart->rx_idle_mark))
+            {
+                done = true;
+            }
+            huart->rx_idle_mark = received;
+        }
+        else
+        {
+            /* Wait for more data */
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+    if (done == true)
+    {
+        uart_rx_complete(huart, UART_RD_DONE);
+    }
+}
+
+/**
+ * @brief End of a receive ring period, called from the DMA interrupt
+ */
+static void uart_dma_rx_period(dma_handle_t hdma, void *cb_data,
+        uint32_t period, int32_t status)
+{
+    uart_handle_t huart = (uart_handle_t)cb_data;
+
+    (void)hdma;
+    (void)period;
+    if (status != 0)
+    {
+        /* The ring stopped, fail the pending read */
+        if ((huart->rx_is_busy == true) && (huart->rx_bytes_left > 0U))
+        {
+            uart_rx_complete(huart, UART_LAST_RD_FAILED);
+        }
+        return;
+    }
+    uart_dma_rx_poll(huart, false);
+}
+
+/**
+ * @brief Receive timer, collects partial periods and detects idle lines
+ */
+static void uart_dma_rx_timer(TimerHandle_t timer)
+{
+    uart_handle_t huart = (uart_handle_t)pvTimerGetTimerID(timer);
+
+    uart_dma_rx_poll(huart, true);
+    if ((huart->rx_is_busy != true) || (huart->rx_bytes_left == 0U))
+    {
+        (void)xTimerStop(timer, 0);
+    }
+}
+
+/**
+ * @brief Completion of a DMA write, called from the DMA interrupt
+ */
+static void uart_dma_tx_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    uart_handle_t huart = (uart_handle_t)cb_data;
+
+    (void)hdma;
+    if (status == 0)
+    {
+        huart->tx_bytes_left = 0U;
+    }
+    uart_tx_complete(huart, (status == 0) ? UART_WR_DONE : UART_LAST_WR_FAILED);
+}
+
+/**
+ * @brief Start a write on the DMA
+ */
+static int32_t uart_dma_write(uart_handle_t huart, uint8_t *const buffer,
+        uint32_t nbytes)
+{
+    dma_job_t job;
+    uint32_t num_blocks = 0U;
+    uint32_t offset;
+    uint32_t blk;
+
+    for (offset = 0U; offset < nbytes; offset += blk)
+    {
+        blk = nbytes - offset;
+        if (blk > UART_DMA_MAX_BLOCK_SIZE)
+        {
+            blk = UART_DMA_MAX_BLOCK_SIZE;
+        }
+        huart->tx_blocks[num_blocks].src = (uint64_t)(uintptr_t)&buffer[offset];
+        huart->tx_blocks[num_blocks].dst = (uint64_t)(huart->base_address + UART_THR);
+        huart->tx_blocks[num_blocks].blk_size = blk;
+        huart->tx_blocks[num_blocks].next_trnsfr_cfg = NULL;
+        if (num_blocks > 0U)
+        {
+            huart->tx_blocks[num_blocks - 1U].next_trnsfr_cfg =
+                    &huart->tx_blocks[num_blocks];
+        }
+        num_blocks++;
+    }
+    cache_force_write_back((void *)buffer, nbytes);
+
+    job.xfer_list = huart->tx_blocks;
+    job.num_xfers = num_blocks;
+    job.src_width = DMA_TRANSFER_WIDTH1;
+    job.dst_width = DMA_TRANSFER_WIDTH1;
+    job.flags = DMA_XFER_DST_FIXED | DMA_XFER_PERI_SINGLE;
+    job.callback = uart_dma_tx_done;
+    job.cb_data = huart;
+    return dma_submit_job(huart->tx_dma, &job);
+}
+
+/**
+ * @brief Open and configure a free DMA channel for the UART
+ */
+static dma_handle_t uart_dma_open_channel(dma_xfer_type_t dir,
+        dma_peri_id_t peri_id)
+{
+    dma_handle_t hdma;
+    dma_config_t cfg;
+    uint32_t inst;
+    uint32_t ch;
+
+    for (inst = 0U; inst < UART_DMA_NUM_INSTANCES; inst++)
+    {
+        for (ch = 0U; ch < UART_DMA_NUM_CHANNELS; ch++)
+        {
+            hdma = dma_open(inst, ch);
+            if (hdma == NULL)
+            {
+                continue;
+            }
+            cfg.instance = (uint8_t)inst;
+            cfg.ch_dir = dir;
+            cfg.ch_prio = 0U;
+            cfg.peri_id = peri_id;
+            cfg.callback = NULL;
+            if (dma_config(hdma, &cfg) == 0)
+            {
+                return hdma;
+            }
+            (void)dma_close(hdma);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Stop the DMA mode and release its channels
+ */
+static void uart_dma_disable(uart_handle_t huart)
+{
+    if (huart->rx_timer != NULL)
+    {
+        (void)xTimerDelete(huart->rx_timer, portMAX_DELAY);
+        huart->rx_timer = NULL;
+    }
+    if (huart->rx_dma != NULL)
+    {
+        (void)dma_stop_transfer(huart->rx_dma);
+        (void)dma_close(huart->rx_dma);
+        huart->rx_dma = NULL;
+    }
+    if (huart->tx_dma != NULL)
+    {
+        (void)dma_close(huart->tx_dma);
+        huart->tx_dma = NULL;
+    }
+    /* Back to the FIFO setup of the interrupt mode */
+    WR_REG32((huart->base_address + UART_FCR), huart->fifo_ctrl);
+    huart->dma_enabled = false;
+}
+
+/**
+ * @brief Enable or disable the DMA mode
+ */
+static int32_t uart_dma_set_mode(uart_handle_t huart, const uart_dma_config_t *cfg)
+{
+    dma_cyclic_cfg_t ring_cfg;
+    TickType_t poll_ticks;
+
+    if (cfg->enable == 0U)
+    {
+        if (huart->dma_enabled == true)
+        {
+            uart_dma_disable(huart);
+        }
+        huart->dma_cfg = *cfg;
+        return 0;
+    }
+    if (huart->dma_enabled == true)
+    {
+        uart_dma_disable(huart);
+    }
+
+    huart->tx_dma = uart_dma_open_channel(DMA_MEM_TO_PERI_DMAC,
+            GET_DMA_TX_ID(huart->instance));
+    huart->rx_dma = uart_dma_open_channel(DMA_PERI_TO_MEM_DMAC,
+            GET_DMA_RX_ID(huart->instance));
+    poll_ticks = pdMS_TO_TICKS((cfg->rx_idle_ms != 0U) ? cfg->rx_idle_ms :
+            UART_DMA_RX_POLL_MS);
+    huart->rx_timer = xTimerCreate("uart_rx", (poll_ticks > 0U) ? poll_ticks : 1U,
+            pdTRUE, huart, uart_dma_rx_timer);
+    if ((huart->tx_dma == NULL) || (huart->rx_dma == NULL) ||
+            (huart->rx_timer == NULL))
+    {
+        uart_dma_disable(huart);
+        return -ENODEV;
+    }
+
+    /* Request the DMA for every received byte so the ring holds the data
+     * in order */
+    WR_REG32((huart->base_address + UART_FCR), (huart->fifo_ctrl |
+            (1U << UART_FCR_DMAM_POS)));
+
+    huart->rx_ring = uart_rx_ring[huart->instance];
+    huart->rx_tail = 0U;
+    huart->rx_unreleased = 0U;
+    huart->rx_copying = 0U;
+    huart->rx_claimed_periods = 0U;
+    ring_cfg.buf = (uint64_t)(uintptr_t)huart->rx_ring;
+    ring_cfg.peri_addr = (uint64_t)(huart->base_address + UART_RBR);
+    ring_cfg.buf_len = UART_DMA_RX_RING_SIZE;
+    ring_cfg.period_len = UART_DMA_RX_PERIOD_SIZE;
+    ring_cfg.src_width = DMA_TRANSFER_WIDTH1;
+    ring_cfg.dst_width = DMA_TRANSFER_WIDTH1;
+    ring_cfg.flags = DMA_XFER_PERI_SINGLE;
+    ring_cfg.callback = uart_dma_rx_period;
+    ring_cfg.cb_data = huart;
+    if ((dma_setup_cyclic(huart->rx_dma, &ring_cfg) != 0) ||
+            (dma_start_transfer(huart->rx_dma) != 0))
+    {
+        uart_dma_disable(huart);
+        return -EIO;
+    }
+
+    huart->dma_cfg = *cfg;
+    huart->dma_enabled = true;
+    return 0;
+}
+
 /**
  * @brief Start writing data to transmit FIFO and enable tx interrupt
  * Update the number of bytes
@@ -205,6 +661,16 @@ static void uart_write(uart_handle_t huart, uint8_t *const buffer,
     uint16_t byte_count = 0U;
     huart->tx_bytes_left = nbytes;
 
+    if ((huart->dma_enabled == true) && (nbytes >= huart->dma_cfg.tx_threshold) &&
+            (nbytes <= UART_DMA_TX_MAX_SIZE))
+    {
+        if (uart_dma_write(huart, buffer, nbytes) == 0)
+        {
+            return;
+        }
+        /* Channel busy, fall back to the FIFO interrupt */
+    }
+
     byte_count = uart_write_fifo(huart->base_address, buffer, nbytes);
 
     huart->tx_bytes_left = huart->tx_bytes_left - byte_count;
@@ -223,6 +689,19 @@ static int32_t uart_read(uart_handle_t huart, uint8_t *const buffer,
     uint16_t byte_count = 0U;
     huart->rx_bytes_left = nbytes;
 
+    if (huart->dma_enabled == true)
+    {
+        /* Served from the receive ring, partial periods and idle lines are
+         * picked up by the timer */
+        huart->rx_idle_mark = 0U;
+        uart_dma_rx_poll(huart, false);
+        if ((huart->rx_is_busy == true) && (huart->rx_bytes_left > 0U))
+        {
+            (void)xTimerReset(huart->rx_timer, 0);
+        }
+        return 0;
+    }
+
     byte_count = uart_read_fifo(huart->base_address, buffer, nbytes);
 
     huart->rx_bytes_left -= byte_count;
@@ -475,6 +954,11 @@ int32_t uart_close(uart_handle_t const huart)
         return -EINVAL;
     }
 
+    if (huart->dma_enabled == true)
+    {
+        uart_dma_disable(huart);
+    }
+
     if (osal_semaphore_delete(huart->rd_sem) == false)
     {
         return -EFAULT;
@@ -85,6 +85,27 @@
  */
 #define UART_BAUD_RATE_DEFAULT    (115200U)
 
+/**
+ * @brief Default size from which writes use the DMA in DMA mode.
+ */
+#define UART_DMA_TX_THRESHOLD_DEFAULT    (64U)
+
+/**
+ * @brief Size of the receive ring filled by the DMA in DMA mode.
+ */
+#define UART_DMA_RX_RING_SIZE    (4096U)
+
+/**
+ * @brief Size of a period of the receive ring, pending reads are served
+ * at the end of every period.
+ */
+#define UART_DMA_RX_PERIOD_SIZE    (256U)
+
+/**
+ * @brief Largest write done by the DMA, longer writes use the FIFO interrupt.
+ */
+#define UART_DMA_TX_MAX_SIZE    (8U * 32768U)
+
 /**
  * @}
  */
@@ -160,7 +181,10 @@ typedef enum
     UART_GET_TX_NBYTES, /** Get the number of bytes sent in write operation. */
     UART_GET_RX_NBYTES, /** Get the number of bytes received in read operation. */
     UART_GET_TX_STATE, /** Get the state of Tx UART peripheral*/
-    UART_GET_RX_STATE /** Get the state of Rx UART peripheral*/
+    UART_GET_RX_STATE, /** Get the state of Rx UART peripheral*/
+    UART_SET_DMA_MODE, /** Enables or disables DMA transfers according to uart_dma_config_t. */
+    UART_GET_DMA_MODE, /** Gets the DMA configuration according to uart_dma_config_t. */
+    UART_GET_RX_OVERRUNS /** Get the number of receive ring periods overwritten before they were read. */
 } uart_ioctl_t;
 
 /**
@@ -182,6 +206,21 @@ typedef struct
     uint32_t wlen; /*!< Desired word length. Valid values are from 5 to 8 */
 } uart_config_t;
 
+/**
+ * @brief DMA configuration of the UART.
+ *
+ * In DMA mode a DMA channel fills a receive ring continuously and reads
+ * are served from the ring, so no data is lost between reads. Writes of at
+ * least tx_threshold bytes are sent by a second DMA channel, shorter writes
+ * use the FIFO interrupt.
+ */
+typedef struct
+{
+    uint8_t enable; /*!< 1 to use the DMA, 0 for FIFO interrupts only. */
+    uint32_t tx_threshold; /*!< Writes of at least this many bytes use the DMA. */
+    uint32_t rx_idle_ms; /*!< A read completes early with the bytes received so far once the line was idle this long, 0 waits for all bytes. */
+} uart_dma_config_t;
+
 /**
  * @}
  */
@@ -365,6 +404,17 @@ int32_t uart_write_async(uart_handle_t const huart, uint8_t *const buf,
  * - If the last operation was read, this returns the actual number of read bytes which might be smaller than the requested number (partial read).
  * - If the last operation was write, this returns 0.
  *
+ * @note UART_SET_DMA_MODE enables or disables DMA transfers.
+ * This request expects the buffer with size of uart_dma_config_t. Two
+ * free DMA channels are needed to enable the DMA mode.
+ *
+ * @note UART_GET_DMA_MODE gets the current DMA configuration.
+ * This request expects the buffer with size of uart_dma_config_t.
+ *
+ * @note UART_GET_RX_OVERRUNS returns the number of receive ring periods
+ * overwritten by the DMA before they were read, in DMA mode.
+ * This request expects 4 bytes buffer (uint32_t).
+ *
  * @param[in]     huart The peripheral handle returned in the open() call.
  * @param[in]     cmd   The configuration request. Should be one of the values
  * from uart_ioctl_t.
@@ -377,6 +427,7 @@ int32_t uart_write_async(uart_handle_t const huart, uint8_t *const buf,
  *     - huart is not opened yet
  *     - pucBuffer is NULL
  *     - cmd is invalid
+ * - -ENODEV: if no DMA channel is free to enable the DMA mode
  */
 int32_t uart_ioctl(uart_handle_t const huart, uart_ioctl_t cmd,
         void *const buf);
@@ -59,8 +59,10 @@ static void uart_deassert_reset(uint32_t instance)
 
 /**
  * @brief Initialize UART and configure the FIFO
+ *
+ * @return The FCR value of the FIFO setup, see uart_config_fifo()
  */
-void uart_init(uint32_t instance)
+uint32_t uart_init(uint32_t instance)
 {
     volatile int32_t i = 0;
     uart_enable_clock(instance);
@@ -80,7 +82,7 @@ void uart_init(uint32_t instance)
 
     }
 
-    uart_config_fifo(GET_UART_BASE_ADDRESS(instance));
+    return uart_config_fifo(GET_UART_BASE_ADDRESS(instance));
 }
 
 /**
@@ -170,20 +172,23 @@ uint32_t uart_set_baud(uint32_t base_address, uint32_t baud)
 
 /**
  * @brief Configure UART FIFO
+ *
+ * @return The FCR value of the FIFO setup without the self-clearing FIFO
+ * resets. FCR is write only, this is the value to write to go back to it.
  */
-void uart_config_fifo(uint32_t base_address)
+uint32_t uart_config_fifo(uint32_t base_address)
 {
     uint32_t val = 0U;
 
     val |= (1U << UART_FCR_FIFOE_POS);
-    val |= (1U << UART_FCR_RFIFOR_POS);
-    val |= (1U << UART_FCR_XFIFOR_POS);
 
     /* rx trigger is set as 1 byte
      * as we don't know the exact number of bytes to receive
      */
 
-    WR_REG32((base_address + UART_FCR), val);
+    WR_REG32((base_address + UART_FCR), (val | (1U << UART_FCR_RFIFOR_POS) |
+            (1U << UART_FCR_XFIFOR_POS)));
+    return val;
 }
 
 /**
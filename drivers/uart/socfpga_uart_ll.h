@@ -33,7 +33,7 @@ typedef enum
     INTERRUPT_RX, INTERRUPT_TX, INTERRUPT_HW
 } uart_interrupt_id_t;
 
-void uart_init(uint32_t instance);
+uint32_t uart_init(uint32_t instance);
 void uart_deinit(uint32_t instance);
 
 uint16_t uart_write_fifo(uint32_t base_address, uint8_t *const buffer,
@@ -47,7 +47,7 @@ void uart_disable_interrupt(uint32_t base_address, uart_interrupt_id_t id);
 
 uint32_t get_int_status(uint32_t base_address);
 
-void uart_config_fifo(uint32_t base_address);
+uint32_t uart_config_fifo(uint32_t base_address);
 
 void uart_set_config(uint32_t base_address, uart_partity_t parity,
         uart_stop_bits_t stopbit, uint32_t wordlen);
@@ -81,11 +81,11 @@ int alloc_xhci_contexts(struct xhci_data *xhci_ptr)
         }
         if (xhci_ptr->ip_ctx != NULL)
         {
-            vPortFree((void *)xhci_ptr->ip_ctx);
+            vPortFreeCoherent((void *)xhci_ptr->ip_ctx);
         }
         if (xhci_ptr->op_ctx != NULL)
         {
-            vPortFree((void *)xhci_ptr->op_ctx);
+            vPortFreeCoherent((void *)xhci_ptr->op_ctx);
         }
     }
     INFO("xHCI contexts allocated successfully");
@@ -102,17 +102,17 @@ void deallocate_xhci_context(struct xhci_data *xhci_ptr)
     /* free bulk endpoint tr rings */
     if (xhci_ptr->msc_eps.ep_out.ep_tr_enq_ptr != NULL)
     {
-        vPortFree((void *)(uintptr_t)(xhci_ptr->msc_eps.ep_out.ep_tr_enq_ptr));
+        vPortFreeCoherent((void *)(uintptr_t)(xhci_ptr->msc_eps.ep_out.ep_tr_enq_ptr));
     }
     if (xhci_ptr->msc_eps.ep_in.ep_tr_enq_ptr != NULL)
     {
-        vPortFree((void *)(uintptr_t)(xhci_ptr->msc_eps.ep_in.ep_tr_enq_ptr));
+        vPortFreeCoherent((void *)(uintptr_t)(xhci_ptr->msc_eps.ep_in.ep_tr_enq_ptr));
     }
 
     /* Free Control EP TR ring */
     if (xhci_ptr->ep0.ep_tr_enq_ptr != NULL)
     {
-        vPortFree((void *)(uintptr_t)(xhci_ptr->ep0.ep_tr_enq_ptr));
+        vPortFreeCoherent((void *)(uintptr_t)(xhci_ptr->ep0.ep_tr_enq_ptr));
     }
 
     /* clear input and output context data structures */
@@ -51,7 +51,7 @@ int xhci_crcr_init(xcr_command_ring_t *xcr_ring)
     {
         if (xcr_ring->xcr_dequeue_ptr != NULL)
         {
-            vPortFree(xcr_ring->xcr_dequeue_ptr);
+            vPortFreeCoherent(xcr_ring->xcr_dequeue_ptr);
         }
         return ret;
     }
@@ -88,7 +88,7 @@ int init_xhc_event_ring(struct xhci_data *xhci_ptr)
     reg_val |= XHCI_EVENT_RING_TABLE_SZ;
     WR_REG32((rt_base_addr + USB3_ERSTSZ), reg_val);
 
-    xer_ring->erst_ptr = (xhci_erst_entry *)(uintptr_t) pvPortAlignedAlloc(64,
+    xer_ring->erst_ptr = (xhci_erst_entry *)(uintptr_t) pvPortMallocCoherentAligned(64,
             1U * sizeof(xhci_erst_entry));
     if (xer_ring->erst_ptr == NULL)
     {
@@ -102,14 +102,14 @@ int init_xhc_event_ring(struct xhci_data *xhci_ptr)
         ERROR("Memory alignment error!!!");
         if (xer_ring->erst_ptr != NULL)
         {
-            vPortFree(xer_ring->erst_ptr);
+            vPortFreeCoherent(xer_ring->erst_ptr);
         }
         return ret;
     }
 
     bzero(xer_ring->erst_ptr, sizeof(xhci_erst_entry));
 
-    xer_ring->xer_enqueue_ptr = (xhci_trb_t *)(uintptr_t) pvPortAlignedAlloc(64,
+    xer_ring->xer_enqueue_ptr = (xhci_trb_t *)(uintptr_t) pvPortMallocCoherentAligned(64,
             XHCI_EVENT_RING_SEG_LENTH * sizeof(xhci_trb_t));
 
     if (xer_ring->xer_enqueue_ptr == NULL)
@@ -125,7 +125,7 @@ int init_xhc_event_ring(struct xhci_data *xhci_ptr)
         ERROR("Memory alignment error!!!");
         if (xer_ring->xer_enqueue_ptr != NULL)
         {
-            vPortFree(xer_ring->xer_enqueue_ptr);
+            vPortFreeCoherent(xer_ring->xer_enqueue_ptr);
         }
         return ret;
     }
@@ -166,7 +166,7 @@ xhci_trb_t *allocate_ring_segment(int req_byte_align, int req_trb_len)
     xhci_trb_t *link_trb;
     uint32_t ring_ctrl_flags = 0U;
 
-    xtr = (xhci_trb_t *)pvPortAlignedAlloc(req_byte_align,
+    xtr = (xhci_trb_t *)pvPortMallocCoherentAligned(req_byte_align,
             (size_t)req_trb_len * sizeof(xhci_trb_t));
     if (xtr == NULL)
     {
@@ -183,7 +183,7 @@ xhci_trb_t *allocate_ring_segment(int req_byte_align, int req_trb_len)
         ERROR("Memory alignment error!!!");
         if (xtr != NULL)
         {
-            vPortFree(xtr);
+            vPortFreeCoherent(xtr);
         }
         return NULL;
     }
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Benchmark of the cache maintenance routines
+ */
+
+
+#include <string.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_cache.h"
+
+/**
+ * @defgroup cache_maint_bench Cache maintenance benchmark
+ * @ingroup samples
+ *
+ * Benchmark of the cache maintenance done around DMA transfers
+ *
+ * @details
+ * @section cache_bench_desc Description
+ * This sample measures in CPU cycles the write back, invalidate and flush
+ * of buffers of growing size line by line, next to the write back and flush
+ * of the whole data cache of the core by set/way. Set/way only maintains
+ * the calling core, so the range functions never switch to it; the size
+ * where it becomes cheaper tells when a caller that only needs the local
+ * core could use cache_write_back_all() or cache_flush_all(). It then
+ * compares the maintenance of scattered ranges waited for one by one with
+ * the same ranges issued with the _nosync functions behind a single
+ * cache_sync().
+ *
+ * @section cache_bench_param Configurable Parameters
+ * - The largest size can be configured by changing the value of @c BENCH_MAX_SIZE macro.
+ * - The number of scattered ranges can be configured by changing the value of @c BENCH_RANGES macro.
+ *
+ * @section cache_bench_result Expected Results
+ * - A table of the cycles of each operation for each size is printed.
+ * - The cycles of the batched ranges are printed next to the unbatched ones.
+ */
+
+#define BENCH_MIN_SIZE    4096U
+#define BENCH_MAX_SIZE    (4U * 1024U * 1024U)
+#define BENCH_RANGES      16U
+#define BENCH_RANGE_SIZE  512U
+
+static uint8_t bench_buf[BENCH_MAX_SIZE] __attribute__((aligned(64)));
+
+/*
+ * @brief Start the cycle counter of the PMU
+ */
+static void bench_cycles_init(void)
+{
+    uint64_t val;
+
+    __asm__ volatile ("MRS %0, PMCR_EL0" : "=r" (val));
+    val |= 1UL;
+    __asm__ volatile ("MSR PMCR_EL0, %0" : : "r" (val));
+    __asm__ volatile ("MSR PMCNTENSET_EL0, %0" : : "r" (1UL << 31));
+    __asm__ volatile ("ISB");
+}
+
+static inline uint64_t bench_cycles(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("ISB; MRS %0, PMCCNTR_EL0" : "=r" (count));
+    return count;
+}
+
+/*
+ * @brief Cycles of one maintenance operation on a freshly dirtied buffer
+ */
+static uint64_t bench_op(void (*op)(void *addr, size_t sz), size_t size)
+{
+    uint64_t start;
+
+    (void)memset(bench_buf, (int)size, size);
+    start = bench_cycles();
+    op(bench_buf, size);
+    return bench_cycles() - start;
+}
+
+/*
+ * @brief Cycles of one whole cache operation with a freshly dirtied buffer
+ */
+static uint64_t bench_all(void (*op)(void), size_t size)
+{
+    uint64_t start;
+
+    (void)memset(bench_buf, (int)size, size);
+    start = bench_cycles();
+    op();
+    return bench_cycles() - start;
+}
+
+void cache_maint_bench_task(void)
+{
+    uint64_t va[3];
+    uint64_t sw[2];
+    uint64_t start;
+    uint64_t single;
+    uint64_t batched;
+    size_t size;
+    uint32_t i;
+
+    PRINT("Cache maintenance benchmark");
+    bench_cycles_init();
+
+    PRINT("%9s %10s %10s %10s %10s %10s", "size", "wb line", "wb all",
+            "inv line", "fl line", "fl all");
+    for (size = BENCH_MIN_SIZE; size <= BENCH_MAX_SIZE; size *= 2U)
+    {
+        va[0] = bench_op(cache_force_write_back, size);
+        va[1] = bench_op(cache_force_invalidate, size);
+        va[2] = bench_op(cache_flush, size);
+        sw[0] = bench_all(cache_write_back_all, size);
+        sw[1] = bench_all(cache_flush_all, size);
+
+        PRINT("%9u %10u %10u %10u %10u %10u", (uint32_t)size,
+                (uint32_t)va[0], (uint32_t)sw[0], (uint32_t)va[1],
+                (uint32_t)va[2], (uint32_t)sw[1]);
+    }
+
+    /* Ranges spread over the buffer, as the buffers of a scatter list */
+    (void)memset(bench_buf, 0x5A, BENCH_RANGES * 4096U);
+    start = bench_cycles();
+    for (i = 0U; i < BENCH_RANGES; i++)
+    {
+        cache_force_write_back(&bench_buf[i * 4096U], BENCH_RANGE_SIZE);
+    }
+    single = bench_cycles() - start;
+
+    (void)memset(bench_buf, 0xA5, BENCH_RANGES * 4096U);
+    start = bench_cycles();
+    for (i = 0U; i < BENCH_RANGES; i++)
+    {
+        cache_force_write_back_nosync(&bench_buf[i * 4096U], BENCH_RANGE_SIZE);
+    }
+    cache_sync();
+    batched = bench_cycles() - start;
+
+    PRINT("%u ranges of %u bytes: %u cycles one by one, %u cycles batched",
+            BENCH_RANGES, BENCH_RANGE_SIZE, (uint32_t)single,
+            (uint32_t)batched);
+    PRINT("Cache maintenance benchmark completed.");
+}
@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Fragmentation benchmark of the coherent memory heap
+ */
+
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "osal_log.h"
+
+/**
+ * @defgroup coherent_heap_bench Coherent heap benchmark
+ * @ingroup samples
+ *
+ * Fragmentation benchmark of the coherent memory heap
+ *
+ * @details
+ * @section coherent_bench_desc Description
+ * This sample churns the coherent heap with a random mix of allocations
+ * and frees, the sizes follow what DMA capable drivers ask for: mostly
+ * descriptors and rings of a few hundred bytes, some buffers of a few
+ * pages and the odd block above a granule. After each round the live
+ * bytes are compared with the uncached memory taken from the heap, and the
+ * average time of an allocation and a free is measured. Once everything
+ * is freed the uncached memory must have been given back, except for the
+ * one granule kept as a spare.
+ *
+ * @section coherent_bench_param Configurable Parameters
+ * - The number of live blocks can be configured by changing the value of @c BENCH_SLOTS macro.
+ * - The number of rounds can be configured by changing the value of @c BENCH_ROUNDS macro.
+ *
+ * @section coherent_bench_result Expected Results
+ * - A table of the heap usage and the cost of the operations for each round is printed.
+ * - The content and alignment of every block pass verification.
+ * - All but one granule are returned once the blocks are freed.
+ */
+
+#define BENCH_SLOTS          256U
+#define BENCH_ROUNDS         8U
+#define BENCH_OPS_PER_ROUND  4096U
+
+static void *bench_blocks[BENCH_SLOTS];
+static size_t bench_sizes[BENCH_SLOTS];
+static uint32_t bench_seed = 0x2545F491U;
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+static uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+/*
+ * @brief Size of the next block, weighted towards small DMA structures
+ */
+static size_t bench_pick_size(void)
+{
+    uint32_t pick = bench_rand() % 100U;
+
+    if (pick < 80U)
+    {
+        return 16U + (bench_rand() % 1024U);
+    }
+    if (pick < 98U)
+    {
+        return 4096U + (bench_rand() % (128U * 1024U));
+    }
+    return (2U * 1024U * 1024U) + (bench_rand() % (1024U * 1024U));
+}
+
+/*
+ * @brief Average time of count operations taking ticks, in nanoseconds
+ */
+static uint32_t bench_ns(uint64_t ticks, uint32_t count)
+{
+    if (count == 0U)
+    {
+        return 0U;
+    }
+    return (uint32_t)((ticks * 1000000000UL) / (bench_freq() * count));
+}
+
+/*
+ * @brief Check the fill pattern of a block before it is freed
+ */
+static BaseType_t bench_check(uint32_t slot)
+{
+    const uint8_t *p = bench_blocks[slot];
+    size_t i;
+
+    for (i = 0U; i < bench_sizes[slot]; i += 61U)
+    {
+        if (p[i] != (uint8_t)slot)
+        {
+            return pdFALSE;
+        }
+    }
+    return pdTRUE;
+}
+
+void coherent_heap_bench_task(void)
+{
+    CoherentHeapStats_t stats;
+    uint64_t alloc_ticks;
+    uint64_t free_ticks;
+    uint64_t start;
+    uint64_t live;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failed;
+    uint32_t round;
+    uint32_t op;
+    uint32_t slot;
+    size_t align;
+    BaseType_t ok = pdTRUE;
+
+    PRINT("Coherent heap benchmark");
+
+    PRINT("%6s %10s %10s %10s %6s %8s %8s %6s", "round", "live", "allocated",
+            "coherent", "use %", "alloc ns", "free ns", "fail");
+    live = 0UL;
+    for (round = 0U; round < BENCH_ROUNDS; round++)
+    {
+        alloc_ticks = 0UL;
+        free_ticks = 0UL;
+        allocs = 0U;
+        frees = 0U;
+        failed = 0U;
+
+        for (op = 0U; op < BENCH_OPS_PER_ROUND; op++)
+        {
+            slot = bench_rand() % BENCH_SLOTS;
+            if (bench_blocks[slot] != NULL)
+            {
+                if (bench_check(slot) == pdFALSE)
+                {
+                    ERROR("Block %u was corrupted", slot);
+                    ok = pdFALSE;
+                }
+                start = bench_now();
+                vPortFreeCoherent(bench_blocks[slot]);
+                free_ticks += bench_now() - start;
+                frees++;
+                live -= bench_sizes[slot];
+                bench_blocks[slot] = NULL;
+                continue;
+            }
+
+            bench_sizes[slot] = bench_pick_size();
+            align = (size_t)64U << (bench_rand() % 4U);
+            start = bench_now();
+            bench_blocks[slot] = pvPortMallocCoherentAligned(align,
+                    bench_sizes[slot]);
+            alloc_ticks += bench_now() - start;
+            if (bench_blocks[slot] == NULL)
+            {
+                failed++;
+                continue;
+            }
+            allocs++;
+            if (((uintptr_t)bench_blocks[slot] & (align - 1U)) != 0U)
+            {
+                ERROR("Block %u is not aligned to %u", slot, (uint32_t)align);
+                ok = pdFALSE;
+            }
+            live += bench_sizes[slot];
+            (void)memset(bench_blocks[slot], (int)slot, bench_sizes[slot]);
+        }
+
+        vPortGetCoherentHeapStats(&stats);
+        PRINT("%6u %10u %10u %10u %6u %8u %8u %6u", round, (uint32_t)live,
+                (uint32_t)stats.xAllocatedBytes,
+                (uint32_t)stats.xCoherentBytes,
+                (stats.xCoherentBytes != 0U) ?
+                (uint32_t)((live * 100UL) / stats.xCoherentBytes) : 0U,
+                bench_ns(alloc_ticks, allocs + failed),
+                bench_ns(free_ticks, frees), failed);
+    }
+
+    for (slot = 0U; slot < BENCH_SLOTS; slot++)
+    {
+        if (bench_blocks[slot] != NULL)
+        {
+            if (bench_check(slot) == pdFALSE)
+            {
+                ERROR("Block %u was corrupted", slot);
+                ok = pdFALSE;
+            }
+            vPortFreeCoherent(bench_blocks[slot]);
+            bench_blocks[slot] = NULL;
+        }
+    }
+
+    vPortGetCoherentHeapStats(&stats);
+    PRINT("Peak allocated %u bytes, %u granules left after freeing",
+            (uint32_t)stats.xMaxAllocatedBytes,
+            (uint32_t)stats.xNumberOfGranules);
+    if ((stats.xAllocatedBytes != 0U) || (stats.xNumberOfGranules > 1U))
+    {
+        ERROR("Coherent memory was not returned");
+        ok = pdFALSE;
+    }
+
+    if (ok == pdTRUE)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("Coherent heap benchmark completed.");
+}
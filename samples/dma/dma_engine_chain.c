@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Sample of DMA engine requests submitted from a completion callback
+ */
+
+
+#include <string.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_cache.h"
+#include "socfpga_dma.h"
+#include "socfpga_dma_engine.h"
+
+/**
+ * @defgroup dma_engine_chain DMA engine chained requests
+ * @ingroup samples
+ *
+ * Sample of DMA engine requests submitted from a completion callback
+ *
+ * @details
+ * @section dma_chain_desc Description
+ * This sample submits a memory copy to the DMA engine. The completion
+ * callback of each copy submits the next one, from interrupt context, until
+ * the chain is complete. Each copy has its own source pattern and
+ * destination, so a request reported complete without having run leaves
+ * its destination unchanged and fails the check. The chain is run several
+ * times, the first copy of a run lands on a channel whose queue drained.
+ *
+ * @section dma_chain_param Configurable Parameters
+ * - The number of copies in a chain can be configured by changing the value of @c CHAIN_LENGTH macro.
+ * - The number of runs can be configured by changing the value of @c CHAIN_RUNS macro.
+ *
+ * @section dma_chain_result Expected Results
+ * - Every copy of every chain completes without error.
+ * - Every destination matches its source.
+ */
+
+#define CHAIN_LENGTH       8U
+#define CHAIN_RUNS         4U
+#define CHAIN_BLK_SIZE     4096U
+#define CHAIN_TIMEOUT_MS   1000U
+
+static uint8_t chain_src[CHAIN_LENGTH][CHAIN_BLK_SIZE] __attribute__((aligned(64)));
+static uint8_t chain_dst[CHAIN_LENGTH][CHAIN_BLK_SIZE] __attribute__((aligned(64)));
+static dma_xfer_cfg_t chain_xfer[CHAIN_LENGTH];
+static dma_engine_req_t chain_req;
+
+/* Written from the DMA interrupt */
+static volatile uint32_t chain_done;
+static volatile int32_t chain_status;
+
+static osal_semaphore_def_t chain_sem_mem;
+static osal_semaphore_t chain_sem;
+
+/*
+ * @brief Request of the copy at index, the callback data is the index
+ */
+static void chain_prepare(uint32_t index)
+{
+    chain_req.xfer_list = &chain_xfer[index];
+    chain_req.cb_data = (void *)(uintptr_t)index;
+}
+
+/*
+ * @brief Completion of a copy, submits the next one of the chain
+ */
+static void chain_job_done(dma_handle_t hdma, void *cb_data, int32_t status)
+{
+    uint32_t index = (uint32_t)(uintptr_t)cb_data;
+    int32_t ret;
+
+    (void)hdma;
+    chain_done++;
+    if ((status != 0) || ((index + 1U) == CHAIN_LENGTH))
+    {
+        chain_status = status;
+        (void)osal_semaphore_post(chain_sem);
+        return;
+    }
+
+    chain_prepare(index + 1U);
+    ret = dma_engine_submit(&chain_req);
+    if (ret != 0)
+    {
+        chain_status = ret;
+        (void)osal_semaphore_post(chain_sem);
+    }
+}
+
+/*
+ * @brief Run one chain and check every destination
+ */
+static int32_t chain_run(uint32_t run)
+{
+    uint32_t i;
+    uint32_t j;
+    int32_t ret;
+
+    for (i = 0U; i < CHAIN_LENGTH; i++)
+    {
+        for (j = 0U; j < CHAIN_BLK_SIZE; j++)
+        {
+            chain_src[i][j] = (uint8_t)((run << 5U) ^ (i << 3U) ^ j);
+        }
+        chain_xfer[i].src = (uint64_t)(uintptr_t)chain_src[i];
+        chain_xfer[i].dst = (uint64_t)(uintptr_t)chain_dst[i];
+        chain_xfer[i].blk_size = CHAIN_BLK_SIZE;
+        chain_xfer[i].next_trnsfr_cfg = NULL;
+    }
+    (void)memset(chain_dst, 0, sizeof(chain_dst));
+    cache_force_write_back((void *)chain_src, sizeof(chain_src));
+    cache_force_write_back((void *)chain_dst, sizeof(chain_dst));
+
+    chain_done = 0U;
+    chain_status = 0;
+    chain_prepare(0U);
+    ret = dma_engine_submit(&chain_req);
+    if (ret != 0)
+    {
+        ERROR("Submitting the first copy failed with status: %d", ret);
+        return ret;
+    }
+    if (osal_semaphore_wait(chain_sem, CHAIN_TIMEOUT_MS) != pdTRUE)
+    {
+        ERROR("Chain timed out after %u copies", chain_done);
+        return -1;
+    }
+    if (chain_status != 0)
+    {
+        ERROR("Chain failed after %u copies with status: %d", chain_done,
+                chain_status);
+        return chain_status;
+    }
+
+    cache_force_invalidate((void *)chain_dst, sizeof(chain_dst));
+    for (i = 0U; i < CHAIN_LENGTH; i++)
+    {
+        if (memcmp(chain_dst[i], chain_src[i], CHAIN_BLK_SIZE) != 0)
+        {
+            ERROR("Copy %u of run %u does not match its source", i, run);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void dma_engine_chain_task(void)
+{
+    uint32_t run;
+    int32_t ret;
+    BaseType_t ok = pdTRUE;
+
+    PRINT("DMA engine chained requests sample");
+
+    ret = dma_engine_init();
+    if (ret != 0)
+    {
+        ERROR("DMA engine initialization failed with status: %d", ret);
+        return;
+    }
+    chain_sem = osal_semaphore_create(&chain_sem_mem);
+
+    chain_req.ch_dir = DMA_MEM_TO_MEM_DMAC;
+    chain_req.prio = DMA_ENGINE_PRIO_NORMAL;
+    chain_req.num_xfers = 1U;
+    chain_req.src_width = DMA_ID_XFER_WIDTH8;
+    chain_req.dst_width = DMA_ID_XFER_WIDTH8;
+    chain_req.flags = 0U;
+    chain_req.callback = chain_job_done;
+
+    for (run = 0U; run < CHAIN_RUNS; run++)
+    {
+        if (chain_run(run) != 0)
+        {
+            ok = pdFALSE;
+        }
+    }
+    osal_semaphore_delete(chain_sem);
+
+    if (ok == pdTRUE)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("DMA engine chained requests sample completed.");
+}
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Benchmark of CPU and DMA memory copy bandwidth
+ */
+
+
+#include <string.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_cache.h"
+#include "socfpga_dma_memcpy.h"
+
+/**
+ * @defgroup dma_memcpy_bench DMA memcpy benchmark
+ * @ingroup samples
+ *
+ * Benchmark of the DMA memcpy offload
+ *
+ * @details
+ * @section dma_bench_desc Description
+ * This sample compares the bandwidth of memcpy and memset done by the CPU
+ * with the same operations offloaded to the DMA through dma_memcpy() and
+ * dma_memset(). Each size is run a few times with cold caches and the
+ * result is checked. The crossover size where the DMA becomes faster is a
+ * good value for dma_memop_set_threshold(). A copy is then run with
+ * dma_memcpy_async(), the task waits for its callback and calls
+ * dma_memop_sync() on the destination before checking it.
+ *
+ * @section dma_bench_param Configurable Parameters
+ * - The largest size can be configured by changing the value of @c BENCH_MAX_SIZE macro.
+ * - The number of runs per size can be configured by changing the value of @c BENCH_RUNS macro.
+ *
+ * @section dma_bench_result Expected Results
+ * - A table of the CPU and DMA bandwidth in MB/s for each size is printed.
+ * - The bandwidth of the asynchronous copy is printed.
+ * - Every copy and fill passes verification.
+ */
+
+#define BENCH_MIN_SIZE    1024U
+#define BENCH_MAX_SIZE    (256U * 1024U)
+#define BENCH_RUNS        4U
+
+static uint8_t bench_src[BENCH_MAX_SIZE] __attribute__((aligned(64)));
+static uint8_t bench_dst[BENCH_MAX_SIZE] __attribute__((aligned(64)));
+
+static osal_semaphore_def_t bench_sem_mem;
+static osal_semaphore_t bench_sem;
+static volatile int32_t bench_status;
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+/*
+ * @brief Bandwidth in MB/s of runs of size bytes taking ticks
+ */
+static uint32_t bench_mbps(size_t size, uint64_t ticks)
+{
+    if (ticks == 0UL)
+    {
+        return 0U;
+    }
+    return (uint32_t)(((uint64_t)size * BENCH_RUNS * bench_freq()) /
+           (ticks * 1000000UL));
+}
+
+/*
+ * @brief Evict both buffers from the caches so every run starts cold
+ */
+static void bench_cold_caches(void)
+{
+    cache_flush(bench_src, sizeof(bench_src));
+    cache_flush(bench_dst, sizeof(bench_dst));
+}
+
+/*
+ * @brief Completion of the asynchronous copy, from the DMA interrupt
+ */
+static void bench_async_done(void *cb_data, int32_t status)
+{
+    (void)cb_data;
+    bench_status = status;
+    (void)osal_semaphore_post(bench_sem);
+}
+
+/*
+ * @brief Asynchronous copy of the whole buffer, synced from the task once
+ * the callback has run
+ */
+static BaseType_t bench_async(void)
+{
+    uint64_t start;
+    uint64_t ticks;
+    int32_t ret;
+
+    bench_sem = osal_semaphore_create(&bench_sem_mem);
+    (void)memset(bench_dst, 0, sizeof(bench_dst));
+    bench_cold_caches();
+    bench_status = 0;
+    start = bench_now();
+    ret = dma_memcpy_async(bench_dst, bench_src, sizeof(bench_dst),
+            bench_async_done, NULL);
+    if (ret == 0)
+    {
+        (void)osal_semaphore_wait(bench_sem, OSAL_TIMEOUT_WAIT_FOREVER);
+        ret = bench_status;
+    }
+    ticks = bench_now() - start;
+
+    /* Lines prefetched while the DMA wrote the buffer are stale */
+    dma_memop_sync(bench_dst, sizeof(bench_dst));
+    osal_semaphore_delete(bench_sem);
+
+    if ((ret != 0) || (memcmp(bench_dst, bench_src, sizeof(bench_dst)) != 0))
+    {
+        ERROR("Asynchronous DMA copy failed");
+        return pdFALSE;
+    }
+    PRINT("Asynchronous copy of %u bytes: %u MB/s", (uint32_t)sizeof(bench_dst),
+            bench_mbps(sizeof(bench_dst), ticks * BENCH_RUNS));
+    return pdTRUE;
+}
+
+void dma_memcpy_bench_task(void)
+{
+    uint64_t cpu_ticks;
+    uint64_t dma_ticks;
+    uint64_t start;
+    size_t threshold;
+    size_t size;
+    uint32_t run;
+    uint32_t i;
+    int32_t ret;
+    BaseType_t ok = pdTRUE;
+
+    PRINT("DMA memcpy benchmark");
+
+    for (i = 0U; i < BENCH_MAX_SIZE; i++)
+    {
+        bench_src[i] = (uint8_t)(i * 7U);
+    }
+
+    /* Offload every size to measure the DMA on its own */
+    threshold = dma_memop_get_threshold();
+    dma_memop_set_threshold(0U);
+
+    PRINT("%10s %12s %12s %12s %12s", "size", "cpu cpy", "dma cpy",
+            "cpu set", "dma set");
+    for (size = BENCH_MIN_SIZE; size <= BENCH_MAX_SIZE; size *= 2U)
+    {
+        uint32_t cpy_cpu;
+        uint32_t cpy_dma;
+
+        cpu_ticks = 0UL;
+        dma_ticks = 0UL;
+        for (run = 0U; run < BENCH_RUNS; run++)
+        {
+            bench_cold_caches();
+            start = bench_now();
+            (void)memcpy(bench_dst, bench_src, size);
+            cpu_ticks += bench_now() - start;
+
+            (void)memset(bench_dst, 0, size);
+            bench_cold_caches();
+            start = bench_now();
+            ret = dma_memcpy(bench_dst, bench_src, size);
+            dma_ticks += bench_now() - start;
+            if ((ret != 0) || (memcmp(bench_dst, bench_src, size) != 0))
+            {
+                ERROR("DMA copy of %u bytes failed", (uint32_t)size);
+                ok = pdFALSE;
+            }
+        }
+        cpy_cpu = bench_mbps(size, cpu_ticks);
+        cpy_dma = bench_mbps(size, dma_ticks);
+
+        cpu_ticks = 0UL;
+        dma_ticks = 0UL;
+        for (run = 0U; run < BENCH_RUNS; run++)
+        {
+            bench_cold_caches();
+            start = bench_now();
+            (void)memset(bench_dst, 0xA5, size);
+            cpu_ticks += bench_now() - start;
+
+            bench_cold_caches();
+            start = bench_now();
+            ret = dma_memset(bench_dst, 0x5A, size);
+            dma_ticks += bench_now() - start;
+            for (i = 0U; (ret == 0) && (i < size); i++)
+            {
+                if (bench_dst[i] != 0x5AU)
+                {
+                    ret = -1;
+                }
+            }
+            if (ret != 0)
+            {
+                ERROR("DMA fill of %u bytes failed", (uint32_t)size);
+                ok = pdFALSE;
+            }
+        }
+
+        PRINT("%10u %7u MB/s %7u MB/s %7u MB/s %7u MB/s", (uint32_t)size, cpy_cpu,
+                cpy_dma, bench_mbps(size, cpu_ticks),
+                bench_mbps(size, dma_ticks));
+    }
+
+    if (bench_async() != pdTRUE)
+    {
+        ok = pdFALSE;
+    }
+    dma_memop_set_threshold(threshold);
+
+    if (ok == pdTRUE)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("DMA memcpy benchmark completed.");
+}
@@ -17,6 +17,10 @@
 #define TASK_PRIORITY    (configMAX_PRIORITIES - 2)
 
 void dma_task();
+void dma_memcpy_bench_task();
+void dma_engine_chain_task();
+void coherent_heap_bench_task();
+void cache_maint_bench_task();
 void run_samples( void *arg );
 
 void vApplicationTickHook( void )
@@ -64,6 +68,14 @@ void run_samples( void *arg )
 
     dma_task();
 
+    dma_memcpy_bench_task();
+
+    dma_engine_chain_task();
+
+    coherent_heap_bench_task();
+
+    cache_maint_bench_task();
+
     vTaskSuspend(NULL);
 }
 
@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Benchmark of the allocation latency of the FreeRTOS heap
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "osal_log.h"
+
+/**
+ * @defgroup heap_latency_bench Heap latency benchmark
+ * @ingroup samples
+ *
+ * Benchmark of the allocation latency of the FreeRTOS heap
+ *
+ * @details
+ * @section heap_bench_desc Description
+ * This sample runs the same random sequence of allocations and frees twice:
+ * once through pvPortMalloc() and vPortFree(), served by the slab heap this
+ * sample is built with, and once through newlib malloc() and free() with the
+ * scheduler suspended, which is what heap_3 does. The sizes are mostly small
+ * kernel and driver objects with some buffers of a few pages. The live set is
+ * kept large so the newlib free lists fragment. The worst and average time of
+ * an allocation and of a free are reported for both.
+ *
+ * @section heap_bench_param Configurable Parameters
+ * - The number of live blocks can be configured by changing the value of @c BENCH_SLOTS macro.
+ * - The number of operations can be configured by changing the value of @c BENCH_OPS macro.
+ *
+ * @section heap_bench_result Expected Results
+ * - A table of the worst and average latency of each heap is printed.
+ * - The worst case of the slab heap stays close to its average.
+ * - The content of every block passes verification.
+ */
+
+#define BENCH_SLOTS    512U
+#define BENCH_OPS      50000U
+
+typedef struct
+{
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*free)(void *ptr);
+} bench_heap_t;
+
+typedef struct
+{
+    uint64_t alloc_max;
+    uint64_t alloc_total;
+    uint64_t free_max;
+    uint64_t free_total;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failed;
+} bench_result_t;
+
+static void *bench_blocks[BENCH_SLOTS];
+static size_t bench_sizes[BENCH_SLOTS];
+static uint32_t bench_seed;
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+static uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+/*
+ * @brief Size of the next block, weighted towards small objects
+ */
+static size_t bench_pick_size(void)
+{
+    uint32_t pick = bench_rand() % 100U;
+
+    if (pick < 70U)
+    {
+        return 8U + (bench_rand() % 256U);
+    }
+    if (pick < 95U)
+    {
+        return 256U + (bench_rand() % 4096U);
+    }
+    return 8192U + (bench_rand() % (56U * 1024U));
+}
+
+/*
+ * @brief Tick count in nanoseconds
+ */
+static uint32_t bench_ns(uint64_t ticks)
+{
+    return (uint32_t)((ticks * 1000000000UL) / bench_freq());
+}
+
+static void *bench_newlib_alloc(size_t size)
+{
+    void *ptr;
+
+    vTaskSuspendAll();
+    ptr = malloc(size);
+    (void)xTaskResumeAll();
+    return ptr;
+}
+
+static void bench_newlib_free(void *ptr)
+{
+    vTaskSuspendAll();
+    free(ptr);
+    (void)xTaskResumeAll();
+}
+
+/*
+ * @brief Run the operation sequence on one heap
+ */
+static BaseType_t bench_run(const bench_heap_t *heap, bench_result_t *res)
+{
+    uint64_t ticks;
+    uint64_t start;
+    uint32_t slot;
+    uint32_t op;
+    BaseType_t ok = pdTRUE;
+
+    (void)memset(res, 0, sizeof(*res));
+    bench_seed = 0x9E3779B9U;
+
+    for (op = 0U; op < (BENCH_OPS + BENCH_SLOTS); op++)
+    {
+        slot = bench_rand() % BENCH_SLOTS;
+        if (op >= BENCH_OPS)
+        {
+            /* Drain what is left */
+            slot = op - BENCH_OPS;
+            if (bench_blocks[slot] == NULL)
+            {
+                continue;
+            }
+        }
+
+        if (bench_blocks[slot] != NULL)
+        {
+            if (((uint8_t *)bench_blocks[slot])[bench_sizes[slot] - 1U] !=
+                    (uint8_t)slot)
+            {
+                ERROR("%s: block %u was corrupted", heap->name, slot);
+                ok = pdFALSE;
+            }
+            start = bench_now();
+            heap->free(bench_blocks[slot]);
+            ticks = bench_now() - start;
+            bench_blocks[slot] = NULL;
+            res->free_total += ticks;
+            res->frees++;
+            if (ticks > res->free_max)
+            {
+                res->free_max = ticks;
+            }
+            continue;
+        }
+
+        bench_sizes[slot] = bench_pick_size();
+        start = bench_now();
+        bench_blocks[slot] = heap->alloc(bench_sizes[slot]);
+        ticks = bench_now() - start;
+        if (bench_blocks[slot] == NULL)
+        {
+            res->failed++;
+            continue;
+        }
+        res->alloc_total += ticks;
+        res->allocs++;
+        if (ticks > res->alloc_max)
+        {
+            res->alloc_max = ticks;
+        }
+        ((uint8_t *)bench_blocks[slot])[bench_sizes[slot] - 1U] = (uint8_t)slot;
+    }
+
+    if (res->failed != 0U)
+    {
+        ERROR("%s: %u allocations failed", heap->name, res->failed);
+        ok = pdFALSE;
+    }
+    return ok;
+}
+
+void heap_latency_bench_task(void)
+{
+    static const bench_heap_t heaps[] =
+    {
+        { "pvPortMalloc", pvPortMalloc, vPortFree },
+        { "newlib+suspend", bench_newlib_alloc, bench_newlib_free },
+    };
+    bench_result_t res;
+    uint32_t i;
+    BaseType_t ok = pdTRUE;
+
+    PRINT("Heap latency benchmark");
+
+    PRINT("%16s %12s %12s %12s %12s", "heap", "alloc max", "alloc avg",
+            "free max", "free avg");
+    for (i = 0U; i < (sizeof(heaps) / sizeof(heaps[0])); i++)
+    {
+        if (bench_run(&heaps[i], &res) == pdFALSE)
+        {
+            ok = pdFALSE;
+        }
+        PRINT("%16s %9u ns %9u ns %9u ns %9u ns", heaps[i].name,
+                bench_ns(res.alloc_max),
+                bench_ns(res.alloc_total / ((res.allocs != 0U) ? res.allocs : 1U)),
+                bench_ns(res.free_max),
+                bench_ns(res.free_total / ((res.frees != 0U) ? res.frees : 1U)));
+    }
+    PRINT("Free heap %u bytes, minimum ever %u bytes",
+            (uint32_t)xPortGetFreeHeapSize(),
+            (uint32_t)xPortGetMinimumEverFreeHeapSize());
+
+    if (ok == pdTRUE)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("Heap latency benchmark completed.");
+}
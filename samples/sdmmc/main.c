@@ -17,6 +17,9 @@
 #define TASK_PRIORITY    (configMAX_PRIORITIES - 2)
 void run_samples( void *arg );
 void sdmmc_task();
+void sdmmc_speed_bench_task(void);
+void sdmmc_iops_bench_task(void);
+void sdmmc_sg_bench_task(void);
 
 void vApplicationTickHook( void )
 {
@@ -62,6 +65,9 @@ void run_samples( void *arg )
     (void) arg;
 
     sdmmc_task();
+    sdmmc_speed_bench_task();
+    sdmmc_iops_bench_task();
+    sdmmc_sg_bench_task();
 
     vTaskSuspend(NULL);
 }
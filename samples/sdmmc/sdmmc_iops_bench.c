@@ -0,0 +1,276 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Random access benchmark of the SD/eMMC request queue
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_sdmmc.h"
+
+/**
+ * @defgroup sdmmc_iops_bench SD/eMMC request queue benchmark
+ * @ingroup samples
+ *
+ * Random access benchmark of the SD/eMMC request queue
+ *
+ * @details
+ * @section sdmmc_iops_desc Description
+ * This sample first measures the number of 4KB random reads and writes per
+ * second through the blocking transfer functions, one request at a time.
+ * As the block length is only set when it changes, each of these requests
+ * costs a single data command. It then opens the request queue of the
+ * driver and measures the same for growing numbers of requests in flight.
+ * Every completion callback submits the next request, so the queue stays
+ * full until the run ends. An eMMC device behind a host with a command queue
+ * engine gains from the deeper queues. On the software queue the gain is
+ * limited to the time saved between two requests.
+ *
+ * @section sdmmc_iops_pre Prerequisites
+ * - An SD card or eMMC device is present in the system
+ * - The content of the test area is overwritten
+ *
+ * @section sdmmc_iops_param Configurable Parameters
+ * - The first block of the test area can be configured by changing the value of @c BENCH_LBA macro.
+ * - The size of the test area can be configured by changing the value of @c BENCH_AREA_BLOCKS macro.
+ * - The number of requests of a run can be configured by changing the value of @c BENCH_REQS macro.
+ *
+ * @section sdmmc_iops_result Expected Results
+ * - The random read and write IOPS of the blocking functions are printed.
+ * - A table of the random read and write IOPS of each queue depth is printed.
+ * - Every request completes without error.
+ */
+
+#define BENCH_BLK_SIZE       512U
+#define BENCH_IO_SIZE        4096U
+#define BENCH_LBA            65536U
+#define BENCH_AREA_BLOCKS    (256U * 2048U)
+#define BENCH_REQS           4096U
+#define BENCH_MAX_DEPTH      32U
+
+static uint8_t bench_buf[BENCH_MAX_DEPTH][BENCH_IO_SIZE]
+__attribute__((aligned(64)));
+static sdmmc_request_t bench_req[BENCH_MAX_DEPTH];
+
+static osal_semaphore_def_t bench_sem_def;
+static osal_semaphore_t bench_sem;
+
+static volatile uint32_t bench_submitted;
+static volatile uint32_t bench_completed;
+static volatile uint32_t bench_failed;
+static uint32_t bench_seed;
+static uint32_t bench_is_write;
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+static uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+/*
+ * @brief Point a request at a random 4KB aligned place of the test area
+ */
+static void bench_prepare(sdmmc_request_t *preq)
+{
+    uint32_t slot = bench_rand() % (BENCH_AREA_BLOCKS / (BENCH_IO_SIZE /
+            BENCH_BLK_SIZE));
+
+    preq->addr = ((uint64_t)BENCH_LBA * BENCH_BLK_SIZE) +
+            ((uint64_t)slot * BENCH_IO_SIZE);
+    preq->number_of_blocks = BENCH_IO_SIZE / BENCH_BLK_SIZE;
+    preq->is_write = bench_is_write;
+}
+
+/*
+ * @brief Completion callback, keeps the queue full until the run ends
+ */
+static void bench_done(sdmmc_request_t *preq, int32_t status)
+{
+    if (status != 0)
+    {
+        bench_failed++;
+    }
+    bench_completed++;
+
+    if (bench_submitted < BENCH_REQS)
+    {
+        bench_submitted++;
+        bench_prepare(preq);
+        if (sdmmc_submit_request(preq) != 0)
+        {
+            bench_failed++;
+            bench_completed++;
+        }
+    }
+    if (bench_completed == BENCH_REQS)
+    {
+        (void)osal_semaphore_post(bench_sem);
+    }
+}
+
+/*
+ * @brief Run BENCH_REQS random requests with depth requests in flight
+ */
+static uint32_t bench_run(uint32_t depth, uint32_t is_write)
+{
+    uint64_t start;
+    uint64_t ticks;
+    uint32_t i;
+
+    bench_is_write = is_write;
+    bench_seed = 0x2545F491U;
+    bench_submitted = depth;
+    bench_completed = 0U;
+
+    start = bench_now();
+    for (i = 0U; i < depth; i++)
+    {
+        bench_req[i].buffer = (uint64_t *)bench_buf[i];
+        bench_req[i].call_back = bench_done;
+        bench_prepare(&bench_req[i]);
+        if (sdmmc_submit_request(&bench_req[i]) != 0)
+        {
+            ERROR("Request submission failed");
+            bench_failed++;
+            return 0U;
+        }
+    }
+    (void)osal_semaphore_wait(bench_sem, OSAL_TIMEOUT_WAIT_FOREVER);
+    ticks = bench_now() - start;
+
+    if (ticks == 0UL)
+    {
+        return 0U;
+    }
+    return (uint32_t)(((uint64_t)BENCH_REQS * bench_freq()) / ticks);
+}
+
+/*
+ * @brief Run BENCH_REQS random requests through the blocking functions
+ */
+static uint32_t bench_run_sync(uint32_t is_write)
+{
+    sdmmc_request_t *preq = &bench_req[0];
+    uint64_t start;
+    uint64_t ticks;
+    uint32_t i;
+    int32_t status;
+
+    bench_is_write = is_write;
+    bench_seed = 0x2545F491U;
+
+    start = bench_now();
+    for (i = 0U; i < BENCH_REQS; i++)
+    {
+        bench_prepare(preq);
+        if (is_write != 0U)
+        {
+            status = sdmmc_write_block_sync((uint64_t *)bench_buf[0],
+                    preq->addr, BENCH_BLK_SIZE, preq->number_of_blocks);
+        }
+        else
+        {
+            status = sdmmc_read_block_sync((uint64_t *)bench_buf[0],
+                    preq->addr, BENCH_BLK_SIZE, preq->number_of_blocks);
+        }
+        if (status != 0)
+        {
+            bench_failed++;
+        }
+    }
+    ticks = bench_now() - start;
+
+    if (ticks == 0UL)
+    {
+        return 0U;
+    }
+    return (uint32_t)(((uint64_t)BENCH_REQS * bench_freq()) / ticks);
+}
+
+void sdmmc_iops_bench_task(void)
+{
+    uint64_t sector_count;
+    uint32_t max_depth;
+    uint32_t depth;
+    uint32_t read_iops;
+    uint32_t write_iops;
+    int32_t status;
+
+    PRINT("SD/eMMC request queue benchmark");
+    bench_sem = osal_semaphore_create(&bench_sem_def);
+    bench_failed = 0U;
+    (void)memset(bench_buf, 0x5A, sizeof(bench_buf));
+
+    status = sdmmc_init_card(&sector_count);
+    if (status != 0)
+    {
+        ERROR("Card initialization failed with status: %d", status);
+        return;
+    }
+    write_iops = bench_run_sync(1U);
+    read_iops = bench_run_sync(0U);
+    PRINT("Blocking functions: %u 4K write IOPS, %u 4K read IOPS",
+            write_iops, read_iops);
+
+    status = sdmmc_queue_open(&max_depth);
+    if (status != 0)
+    {
+        ERROR("Opening the request queue failed with status: %d", status);
+        return;
+    }
+    if (max_depth > BENCH_MAX_DEPTH)
+    {
+        max_depth = BENCH_MAX_DEPTH;
+    }
+    PRINT("%s, up to %u requests in flight",
+            (sdmmc_queue_uses_cqe() == 1U) ? "Command queue engine" :
+            "Software queue", max_depth);
+
+    PRINT("%6s %14s %14s", "depth", "4K write IOPS", "4K read IOPS");
+    for (depth = 1U; depth <= max_depth; depth *= 2U)
+    {
+        write_iops = bench_run(depth, 1U);
+        read_iops = bench_run(depth, 0U);
+        PRINT("%6u %14u %14u", depth, write_iops, read_iops);
+    }
+
+    status = sdmmc_queue_close();
+    if (status != 0)
+    {
+        ERROR("Closing the request queue failed with status: %d", status);
+        bench_failed++;
+    }
+
+    if (bench_failed == 0U)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED, %u requests failed", bench_failed);
+    }
+    PRINT("SD/eMMC request queue benchmark completed.");
+}
@@ -0,0 +1,307 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Benchmark of scatter-gather and large SD/eMMC transfers
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_sdmmc.h"
+
+/**
+ * @defgroup sdmmc_sg_bench SD/eMMC scatter-gather benchmark
+ * @ingroup samples
+ *
+ * Benchmark of scatter-gather and large SD/eMMC transfers
+ *
+ * @details
+ * @section sdmmc_sg_desc Description
+ * This sample writes and reads back pages spread over a buffer, once with
+ * one blocking call per page and once as a single transfer from a list of
+ * the pages, and reports both throughputs. It then moves a transfer larger
+ * than a single command can carry, made of the same buffer listed many
+ * times, which the driver splits into several commands.
+ *
+ * @section sdmmc_sg_pre Prerequisites
+ * - An SD card or eMMC device is present in the system
+ * - The content of the test area is overwritten
+ *
+ * @section sdmmc_sg_param Configurable Parameters
+ * - The first block of the test area can be configured by changing the value of @c BENCH_LBA macro.
+ * - The number of pages can be configured by changing the value of @c BENCH_PAGES macro.
+ * - The size of the large transfer can be configured by changing the value of @c BENCH_LARGE_MB macro.
+ *
+ * @section sdmmc_sg_result Expected Results
+ * - The page by page and scatter-gather throughputs are printed.
+ * - The throughput of the large transfer is printed.
+ * - The data read back matches the data written.
+ */
+
+#define BENCH_BLK_SIZE     512U
+#define BENCH_LBA          65536U
+#define BENCH_PAGE_SIZE    4096U
+#define BENCH_PAGES        256U
+#define BENCH_CHUNK_SIZE   (1024U * 1024U)
+#define BENCH_LARGE_MB     48U
+
+/* Only every other page of the buffer is listed */
+static uint8_t bench_buf[2U * BENCH_PAGES * BENCH_PAGE_SIZE]
+__attribute__((aligned(64)));
+static sdmmc_sg_entry_t bench_sg[BENCH_PAGES];
+static sdmmc_sg_entry_t bench_large_sg[BENCH_LARGE_MB];
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+/*
+ * @brief Throughput in KB/s of bytes moved in ticks
+ */
+static uint32_t bench_kbps(uint64_t bytes, uint64_t ticks)
+{
+    if (ticks == 0UL)
+    {
+        return 0U;
+    }
+    return (uint32_t)((bytes * bench_freq()) / (ticks * 1024UL));
+}
+
+static uint8_t *bench_page(uint32_t page)
+{
+    return &bench_buf[2U * page * BENCH_PAGE_SIZE];
+}
+
+/*
+ * @brief Fill the listed pages with a pattern unique to the run
+ */
+static void bench_fill(uint32_t run)
+{
+    uint32_t *p;
+    uint32_t page;
+    uint32_t i;
+
+    for (page = 0U; page < BENCH_PAGES; page++)
+    {
+        p = (uint32_t *)bench_page(page);
+        for (i = 0U; i < (BENCH_PAGE_SIZE / sizeof(uint32_t)); i++)
+        {
+            p[i] = (run << 28U) ^ (page << 12U) ^ i;
+        }
+    }
+}
+
+static int32_t bench_check(uint32_t run)
+{
+    const uint32_t *p;
+    uint32_t page;
+    uint32_t i;
+
+    for (page = 0U; page < BENCH_PAGES; page++)
+    {
+        p = (const uint32_t *)bench_page(page);
+        for (i = 0U; i < (BENCH_PAGE_SIZE / sizeof(uint32_t)); i++)
+        {
+            if (p[i] != ((run << 28U) ^ (page << 12U) ^ i))
+            {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * @brief Write then read the pages, one call per page or one list
+ */
+static int32_t bench_pages(uint32_t run, uint32_t use_sg, uint64_t *wr_ticks,
+        uint64_t *rd_ticks)
+{
+    uint64_t addr = (uint64_t)BENCH_LBA * BENCH_BLK_SIZE;
+    uint64_t start;
+    uint32_t page;
+    int32_t status = 0;
+
+    bench_fill(run);
+    start = bench_now();
+    if (use_sg != 0U)
+    {
+        status = sdmmc_write_sg_sync(bench_sg, BENCH_PAGES, addr,
+                BENCH_BLK_SIZE);
+    }
+    for (page = 0U; (use_sg == 0U) && (page < BENCH_PAGES) && (status == 0);
+            page++)
+    {
+        status = sdmmc_write_block_sync((uint64_t *)bench_page(page),
+                addr + ((uint64_t)page * BENCH_PAGE_SIZE), BENCH_BLK_SIZE,
+                BENCH_PAGE_SIZE / BENCH_BLK_SIZE);
+    }
+    *wr_ticks = bench_now() - start;
+    if (status != 0)
+    {
+        ERROR("Write failed with status: %d", status);
+        return status;
+    }
+
+    (void)memset(bench_buf, 0, sizeof(bench_buf));
+    start = bench_now();
+    if (use_sg != 0U)
+    {
+        status = sdmmc_read_sg_sync(bench_sg, BENCH_PAGES, addr,
+                BENCH_BLK_SIZE);
+    }
+    for (page = 0U; (use_sg == 0U) && (page < BENCH_PAGES) && (status == 0);
+            page++)
+    {
+        status = sdmmc_read_block_sync((uint64_t *)bench_page(page),
+                addr + ((uint64_t)page * BENCH_PAGE_SIZE), BENCH_BLK_SIZE,
+                BENCH_PAGE_SIZE / BENCH_BLK_SIZE);
+    }
+    *rd_ticks = bench_now() - start;
+    if (status != 0)
+    {
+        ERROR("Read failed with status: %d", status);
+        return status;
+    }
+    if (bench_check(run) != 0)
+    {
+        ERROR("Data mismatch");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * @brief One transfer of BENCH_LARGE_MB, the same megabyte listed many times
+ */
+static int32_t bench_large(uint64_t *wr_ticks, uint64_t *rd_ticks)
+{
+    uint64_t addr = (uint64_t)BENCH_LBA * BENCH_BLK_SIZE;
+    uint64_t start;
+    uint32_t i;
+    int32_t status;
+
+    for (i = 0U; i < BENCH_LARGE_MB; i++)
+    {
+        bench_large_sg[i].buffer = (uint64_t *)bench_buf;
+        bench_large_sg[i].length = BENCH_CHUNK_SIZE;
+    }
+    for (i = 0U; i < (BENCH_CHUNK_SIZE / sizeof(uint32_t)); i++)
+    {
+        ((uint32_t *)bench_buf)[i] = 0xC0DE0000U ^ i;
+    }
+
+    start = bench_now();
+    status = sdmmc_write_sg_sync(bench_large_sg, BENCH_LARGE_MB, addr,
+            BENCH_BLK_SIZE);
+    *wr_ticks = bench_now() - start;
+    if (status != 0)
+    {
+        ERROR("Large write failed with status: %d", status);
+        return status;
+    }
+
+    (void)memset(bench_buf, 0, BENCH_CHUNK_SIZE);
+    start = bench_now();
+    status = sdmmc_read_sg_sync(bench_large_sg, BENCH_LARGE_MB, addr,
+            BENCH_BLK_SIZE);
+    *rd_ticks = bench_now() - start;
+    if (status != 0)
+    {
+        ERROR("Large read failed with status: %d", status);
+        return status;
+    }
+
+    /*every megabyte held the same data, the last one read is checked*/
+    for (i = 0U; i < (BENCH_CHUNK_SIZE / sizeof(uint32_t)); i++)
+    {
+        if (((uint32_t *)bench_buf)[i] != (0xC0DE0000U ^ i))
+        {
+            ERROR("Data mismatch in the large transfer");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sdmmc_sg_bench_task(void)
+{
+    uint64_t sector_count;
+    uint64_t wr_ticks;
+    uint64_t rd_ticks;
+    uint64_t bytes = (uint64_t)BENCH_PAGES * BENCH_PAGE_SIZE;
+    uint32_t page;
+    int32_t status;
+    int32_t failed = 0;
+
+    PRINT("SD/eMMC scatter-gather benchmark");
+
+    status = sdmmc_init_card(&sector_count);
+    if (status != 0)
+    {
+        ERROR("Card initialization failed with status: %d", status);
+        return;
+    }
+    for (page = 0U; page < BENCH_PAGES; page++)
+    {
+        bench_sg[page].buffer = (uint64_t *)bench_page(page);
+        bench_sg[page].length = BENCH_PAGE_SIZE;
+    }
+
+    PRINT("%16s %12s %12s", "transfer", "write KB/s", "read KB/s");
+    if (bench_pages(1U, 0U, &wr_ticks, &rd_ticks) == 0)
+    {
+        PRINT("%16s %12u %12u", "page by page", bench_kbps(bytes, wr_ticks),
+                bench_kbps(bytes, rd_ticks));
+    }
+    else
+    {
+        failed = 1;
+    }
+    if (bench_pages(2U, 1U, &wr_ticks, &rd_ticks) == 0)
+    {
+        PRINT("%16s %12u %12u", "scatter-gather",
+                bench_kbps(bytes, wr_ticks), bench_kbps(bytes, rd_ticks));
+    }
+    else
+    {
+        failed = 1;
+    }
+
+    bytes = (uint64_t)BENCH_LARGE_MB * BENCH_CHUNK_SIZE;
+    if (bench_large(&wr_ticks, &rd_ticks) == 0)
+    {
+        PRINT("%13uMB %12u %12u", BENCH_LARGE_MB,
+                bench_kbps(bytes, wr_ticks), bench_kbps(bytes, rd_ticks));
+    }
+    else
+    {
+        failed = 1;
+    }
+
+    if (failed == 0)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("SD/eMMC scatter-gather benchmark completed.");
+}
@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Sequential throughput benchmark of the SD/eMMC bus timings
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_sdmmc.h"
+#include "socfpga_cache.h"
+
+/**
+ * @defgroup sdmmc_speed_bench SD/eMMC bus timing benchmark
+ * @ingroup samples
+ *
+ * Sequential throughput benchmark of the SD/eMMC bus timings
+ *
+ * @details
+ * @section sdmmc_bench_desc Description
+ * This sample initializes the card once for each bus timing, from Default
+ * speed up to SDR104 or HS400, by limiting the timing the driver may select.
+ * In each mode it writes a test area sequentially in large transfers, reads
+ * it back and reports both throughputs. A mode the host or the card does not
+ * support, or which the driver had to fall back from, is reported as skipped.
+ *
+ * @section sdmmc_bench_pre Prerequisites
+ * - An SD card or eMMC device is present in the system
+ * - The content of the test area is overwritten
+ *
+ * @section sdmmc_bench_param Configurable Parameters
+ * - The first block of the test area can be configured by changing the value of @c BENCH_LBA macro.
+ * - The size of a transfer can be configured by changing the value of @c BENCH_XFER_SIZE macro.
+ * - The number of transfers can be configured by changing the value of @c BENCH_XFERS macro.
+ *
+ * @section sdmmc_bench_result Expected Results
+ * - A table of the write and read throughput of each mode is printed.
+ * - The data read back matches the data written in every mode.
+ */
+
+#define BENCH_BLK_SIZE     512U
+#define BENCH_LBA          65536U
+#define BENCH_XFER_SIZE    (1024U * 1024U)
+#define BENCH_XFERS        16U
+
+static uint8_t bench_buf[BENCH_XFER_SIZE] __attribute__((aligned(64)));
+
+static const char *const bench_timing_name[] =
+{
+    "DS", "HS", "SDR50", "SDR104", "HS200", "HS400"
+};
+
+static inline uint64_t bench_now(void)
+{
+    uint64_t count;
+
+    __asm__ volatile ("MRS %0, CNTVCT_EL0" : "=r" (count));
+    return count;
+}
+
+static inline uint64_t bench_freq(void)
+{
+    uint64_t freq;
+
+    __asm__ volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+/*
+ * @brief Throughput in KB/s of bytes moved in ticks
+ */
+static uint32_t bench_kbps(uint64_t bytes, uint64_t ticks)
+{
+    if (ticks == 0UL)
+    {
+        return 0U;
+    }
+    return (uint32_t)((bytes * bench_freq()) / (ticks * 1024UL));
+}
+
+/*
+ * @brief Fill the buffer with a pattern unique to the transfer and the mode
+ */
+static void bench_fill(uint32_t xfer, uint32_t timing)
+{
+    uint32_t *p = (uint32_t *)bench_buf;
+    uint32_t i;
+
+    for (i = 0U; i < (BENCH_XFER_SIZE / sizeof(uint32_t)); i++)
+    {
+        p[i] = (timing << 28U) ^ (xfer << 20U) ^ i;
+    }
+}
+
+static int32_t bench_check(uint32_t xfer, uint32_t timing)
+{
+    const uint32_t *p = (const uint32_t *)bench_buf;
+    uint32_t i;
+
+    for (i = 0U; i < (BENCH_XFER_SIZE / sizeof(uint32_t)); i++)
+    {
+        if (p[i] != ((timing << 28U) ^ (xfer << 20U) ^ i))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * @brief Sequential write then read of the test area in the current mode
+ */
+static int32_t bench_run(uint32_t timing, uint64_t *wr_ticks,
+        uint64_t *rd_ticks)
+{
+    uint64_t addr;
+    uint64_t start;
+    uint32_t xfer;
+    int32_t status;
+
+    *wr_ticks = 0UL;
+    *rd_ticks = 0UL;
+    for (xfer = 0U; xfer < BENCH_XFERS; xfer++)
+    {
+        addr = ((uint64_t)BENCH_LBA * BENCH_BLK_SIZE) +
+                ((uint64_t)xfer * BENCH_XFER_SIZE);
+        bench_fill(xfer, timing);
+        cache_force_write_back(bench_buf, BENCH_XFER_SIZE);
+
+        start = bench_now();
+        status = sdmmc_write_block_sync((uint64_t *)bench_buf, addr,
+                BENCH_BLK_SIZE, BENCH_XFER_SIZE / BENCH_BLK_SIZE);
+        *wr_ticks += bench_now() - start;
+        if (status != 0)
+        {
+            ERROR("Write failed with status: %d", status);
+            return status;
+        }
+    }
+
+    for (xfer = 0U; xfer < BENCH_XFERS; xfer++)
+    {
+        addr = ((uint64_t)BENCH_LBA * BENCH_BLK_SIZE) +
+                ((uint64_t)xfer * BENCH_XFER_SIZE);
+        (void)memset(bench_buf, 0, BENCH_XFER_SIZE);
+        cache_flush(bench_buf, BENCH_XFER_SIZE);
+
+        start = bench_now();
+        status = sdmmc_read_block_sync((uint64_t *)bench_buf, addr,
+                BENCH_BLK_SIZE, BENCH_XFER_SIZE / BENCH_BLK_SIZE);
+        *rd_ticks += bench_now() - start;
+        if (status != 0)
+        {
+            ERROR("Read failed with status: %d", status);
+            return status;
+        }
+        if (bench_check(xfer, timing) != 0)
+        {
+            ERROR("Data mismatch in transfer %u", xfer);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sdmmc_speed_bench_task(void)
+{
+    uint64_t sector_count;
+    uint64_t wr_ticks;
+    uint64_t rd_ticks;
+    uint64_t bytes = (uint64_t)BENCH_XFER_SIZE * BENCH_XFERS;
+    uint32_t timing;
+    int32_t status;
+    int32_t failed = 0;
+
+    PRINT("SD/eMMC bus timing benchmark");
+    PRINT("%8s %12s %12s", "mode", "write KB/s", "read KB/s");
+
+    for (timing = (uint32_t)SDMMC_TIMING_DS;
+            timing < (uint32_t)SDMMC_TIMING_AUTO; timing++)
+    {
+        (void)sdmmc_set_timing_limit((sdmmc_timing_t)timing);
+        status = sdmmc_init_card(&sector_count);
+        if (status != 0)
+        {
+            ERROR("Card initialization failed with status: %d", status);
+            failed = 1;
+            break;
+        }
+        if ((uint32_t)sdmmc_get_timing() != timing)
+        {
+            PRINT("%8s %12s %12s", bench_timing_name[timing], "skipped", "-");
+            continue;
+        }
+
+        if (bench_run(timing, &wr_ticks, &rd_ticks) != 0)
+        {
+            failed = 1;
+            continue;
+        }
+        PRINT("%8s %12u %12u", bench_timing_name[timing],
+                bench_kbps(bytes, wr_ticks), bench_kbps(bytes, rd_ticks));
+    }
+
+    /*leave the card in the fastest mode*/
+    (void)sdmmc_set_timing_limit(SDMMC_TIMING_AUTO);
+    (void)sdmmc_init_card(&sector_count);
+
+    if (failed == 0)
+    {
+        PRINT("Verification PASSED");
+    }
+    else
+    {
+        ERROR("Verification FAILED");
+    }
+    PRINT("SD/eMMC bus timing benchmark completed.");
+}
@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host benchmark of the get and release cycle of the free buffer ring
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "SocfpgaBufferRing.h"
+
+#define BENCH_COUNT      64U
+#define BENCH_BUF_SIZE   64U
+#define BENCH_CYCLES     10000000U
+
+static uint8_t buffers[BENCH_COUNT * BENCH_BUF_SIZE];
+static uint8_t *slots[BENCH_COUNT + 1U];
+static BufferRing_t ring;
+
+static uint64_t bench_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000UL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * @brief Take batch buffers then release them, until cycles buffers went
+ * through the ring
+ *
+ * @return Nanoseconds per get and release pair, negative on a failure
+ */
+static double bench_run(uint32_t cycles, uint32_t batch)
+{
+    uint8_t *taken[BENCH_COUNT];
+    uint64_t start;
+    uint32_t done;
+    uint32_t i;
+
+    prvInitBufferRing(&ring, slots, BENCH_COUNT, buffers, BENCH_BUF_SIZE);
+    start = bench_now();
+    for (done = 0U; done < cycles; done += batch)
+    {
+        for (i = 0U; i < batch; i++)
+        {
+            taken[i] = prvBufferRingGet(&ring);
+        }
+        for (i = 0U; i < batch; i++)
+        {
+            if (prvBufferRingPut(&ring, taken[i]) != pdPASS)
+            {
+                return -1.0;
+            }
+        }
+    }
+    return (double)(bench_now() - start) / done;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t cycles = BENCH_CYCLES;
+    uint32_t batch;
+    double ns;
+
+    if (argc > 1)
+    {
+        cycles = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    printf("%10s %16s\n", "batch", "ns/get+release");
+    for (batch = 1U; batch <= BENCH_COUNT; batch *= 4U)
+    {
+        ns = bench_run(cycles, batch);
+        if (ns < 0.0)
+        {
+            printf("Release with a batch of %u buffers failed\n", batch);
+            return 1;
+        }
+        printf("%10u %16.2f\n", batch, ns);
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-in for FreeRTOS.h, enough to build the buffer ring
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef long BaseType_t;
+
+#define pdFAIL    ((BaseType_t)0)
+#define pdPASS    ((BaseType_t)1)
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host unit tests of the free buffer ring of the network interface
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "SocfpgaBufferRing.h"
+
+#define RING_COUNT      8U
+#define RING_BUF_SIZE   16U
+#define SPSC_ROUNDS     200000U
+
+#define CHECK(cond)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(cond))                                                \
+        {                                                           \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #cond);                                         \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static uint32_t failures;
+
+static uint8_t buffers[RING_COUNT * RING_BUF_SIZE];
+static uint8_t *slots[RING_COUNT + 1U];
+static BufferRing_t ring;
+
+/*
+ * @brief A fresh ring hands out every buffer once, in order, then is empty
+ */
+static void test_init(void)
+{
+    uint32_t i;
+
+    prvInitBufferRing(&ring, slots, RING_COUNT, buffers, RING_BUF_SIZE);
+    for (i = 0U; i < RING_COUNT; i++)
+    {
+        CHECK(prvBufferRingGet(&ring) == &buffers[i * RING_BUF_SIZE]);
+    }
+    CHECK(prvBufferRingGet(&ring) == NULL);
+    CHECK(prvBufferRingGet(&ring) == NULL);
+}
+
+/*
+ * @brief A full ring refuses a buffer and stays full, an empty one hands
+ * out nothing and stays empty
+ */
+static void test_full_empty(void)
+{
+    uint8_t *taken[RING_COUNT];
+    uint32_t i;
+
+    prvInitBufferRing(&ring, slots, RING_COUNT, buffers, RING_BUF_SIZE);
+    CHECK(prvBufferRingPut(&ring, buffers) == pdFAIL);
+
+    for (i = 0U; i < RING_COUNT; i++)
+    {
+        taken[i] = prvBufferRingGet(&ring);
+        CHECK(taken[i] != NULL);
+    }
+    CHECK(prvBufferRingGet(&ring) == NULL);
+
+    for (i = 0U; i < RING_COUNT; i++)
+    {
+        CHECK(prvBufferRingPut(&ring, taken[i]) == pdPASS);
+    }
+    CHECK(prvBufferRingPut(&ring, taken[0]) == pdFAIL);
+
+    for (i = 0U; i < RING_COUNT; i++)
+    {
+        CHECK(prvBufferRingGet(&ring) == taken[i]);
+    }
+    CHECK(prvBufferRingGet(&ring) == NULL);
+}
+
+/*
+ * @brief Both indices wrap many times with the ring going from empty to
+ * full at every offset, buffers come back out in the order they went in
+ */
+static void test_wraparound(void)
+{
+    uint8_t *taken[RING_COUNT];
+    uint32_t offset;
+    uint32_t round;
+    uint32_t i;
+
+    prvInitBufferRing(&ring, slots, RING_COUNT, buffers, RING_BUF_SIZE);
+    for (round = 0U; round < (3U * (RING_COUNT + 1U)); round++)
+    {
+        /* Shift both indices by one slot per round */
+        taken[0] = prvBufferRingGet(&ring);
+        CHECK(taken[0] != NULL);
+        CHECK(prvBufferRingPut(&ring, taken[0]) == pdPASS);
+
+        offset = atomic_load(&ring.ulHeadIndex);
+        CHECK(offset < ring.ulSlots);
+
+        for (i = 0U; i < RING_COUNT; i++)
+        {
+            taken[i] = prvBufferRingGet(&ring);
+            CHECK(taken[i] != NULL);
+        }
+        CHECK(prvBufferRingGet(&ring) == NULL);
+        CHECK(atomic_load(&ring.ulHeadIndex) ==
+                ((offset + RING_COUNT) % ring.ulSlots));
+
+        /* Returned in reverse, they come back out in that order */
+        for (i = RING_COUNT; i > 0U; i--)
+        {
+            CHECK(prvBufferRingPut(&ring, taken[i - 1U]) == pdPASS);
+        }
+        CHECK(prvBufferRingPut(&ring, taken[0]) == pdFAIL);
+        for (i = RING_COUNT; i > 0U; i--)
+        {
+            CHECK(prvBufferRingGet(&ring) == taken[i - 1U]);
+        }
+        for (i = 0U; i < RING_COUNT; i++)
+        {
+            CHECK(prvBufferRingPut(&ring, taken[i]) == pdPASS);
+        }
+    }
+}
+
+static void *spsc_producer(void *arg)
+{
+    uintptr_t value = 1U;
+
+    (void)arg;
+    while (value <= SPSC_ROUNDS)
+    {
+        if (prvBufferRingPut(&ring, (uint8_t *)value) == pdPASS)
+        {
+            value++;
+        }
+        else
+        {
+            /* Let the consumer run on a single core host */
+            (void)sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/*
+ * @brief With the producer on another thread the consumer sees every value
+ * once and in order
+ */
+static void test_spsc(void)
+{
+    pthread_t producer;
+    uintptr_t expected = 1U;
+    uint32_t mismatches = 0U;
+    uint8_t *buf;
+
+    prvInitBufferRing(&ring, slots, RING_COUNT, buffers, RING_BUF_SIZE);
+    while (prvBufferRingGet(&ring) != NULL)
+    {
+    }
+
+    CHECK(pthread_create(&producer, NULL, spsc_producer, NULL) == 0);
+    while (expected <= SPSC_ROUNDS)
+    {
+        buf = prvBufferRingGet(&ring);
+        if (buf != NULL)
+        {
+            if ((uintptr_t)buf != expected)
+            {
+                mismatches++;
+            }
+            expected++;
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+    CHECK(pthread_join(producer, NULL) == 0);
+    CHECK(mismatches == 0U);
+    CHECK(prvBufferRingGet(&ring) == NULL);
+}
+
+int main(void)
+{
+    test_init();
+    test_full_empty();
+    test_wraparound();
+    test_spsc();
+
+    if (failures != 0U)
+    {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
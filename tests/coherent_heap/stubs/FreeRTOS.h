@@ -0,0 +1,27 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-in for FreeRTOS.h, enough to build the coherent heap
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define configUSE_SLAB_HEAP            1
+#define configUSE_MALLOC_FAILED_HOOK   0
+#define configCOHERENT_MAX_GRANULES    4
+#define configUNIQUE_INTERRUPT_PRIORITIES    16
+
+#define configASSERT(x)                assert(x)
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+#include "portmacro.h"
+
+#endif
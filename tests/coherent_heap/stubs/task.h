@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-in for task.h, the scheduler is not running in the tests
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#define vTaskSuspendAll()
+#define xTaskResumeAll()    ( ( BaseType_t ) 0 )
+
+#endif
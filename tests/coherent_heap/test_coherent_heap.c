@@ -0,0 +1,399 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host unit tests of the coherent memory allocator in heap_3_extra.c
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "socfpga_cache.h"
+
+#define GRANULE        0x200000UL
+#define PAGE           0x10000UL
+#define NUM_SMALL      1024U
+#define MAX_CALLS      16U
+
+#define CHECK(cond)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(cond))                                                \
+        {                                                           \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #cond);                                         \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+typedef enum
+{
+    CALL_UNCACHE,
+    CALL_CACHE,
+    CALL_FLUSH
+} call_type_t;
+
+typedef struct
+{
+    call_type_t type;
+    uintptr_t addr;
+    size_t size;
+} call_t;
+
+static uint32_t failures;
+
+/* Granules with caching turned off, as the MMU would see them */
+static int32_t uncached_granules;
+static uint32_t flushed_bytes;
+
+/* Calls to the page table and cache stubs, in order */
+static call_t calls[MAX_CALLS];
+static uint32_t num_calls;
+
+static void log_call(call_type_t type, void *addr, size_t size)
+{
+    if (num_calls < MAX_CALLS)
+    {
+        calls[num_calls].type = type;
+        calls[num_calls].addr = (uintptr_t)addr;
+        calls[num_calls].size = size;
+    }
+    num_calls++;
+}
+
+void config_page_caching(void *addr, int mode)
+{
+    CHECK(((uintptr_t)addr % GRANULE) == 0U);
+    uncached_granules += (mode == 0) ? 1 : -1;
+    log_call((mode == 0) ? CALL_UNCACHE : CALL_CACHE, addr, GRANULE);
+}
+
+void cache_flush(void *addr, size_t sz)
+{
+    flushed_bytes += (uint32_t)sz;
+    log_call(CALL_FLUSH, addr, sz);
+}
+
+static int is_aligned(const void *p, size_t align)
+{
+    return ((uintptr_t)p % align) == 0U;
+}
+
+static CoherentHeapStats_t get_stats(void)
+{
+    CoherentHeapStats_t stats;
+
+    vPortGetCoherentHeapStats(&stats);
+    return stats;
+}
+
+/*
+ * @brief Every granule taken from the heap is uncached and flushed
+ */
+static void check_granules(void)
+{
+    CoherentHeapStats_t stats = get_stats();
+
+    CHECK((size_t)uncached_granules == stats.xNumberOfGranules);
+    CHECK((stats.xNumberOfGranules * GRANULE) == stats.xCoherentBytes);
+}
+
+/*
+ * @brief Every granule of a new block was made uncached before it was
+ * flushed, and is flushed whole
+ */
+static void check_uncached_then_flushed(const void *p, size_t granules)
+{
+    uintptr_t base = (uintptr_t)p & ~(GRANULE - 1U);
+    uintptr_t granule;
+    uint32_t uncached_at;
+    uint32_t flushed_at;
+    uint32_t i;
+
+    CHECK(num_calls <= MAX_CALLS);
+    for (granule = base; granule < (base + (granules * GRANULE));
+            granule += GRANULE)
+    {
+        uncached_at = MAX_CALLS;
+        flushed_at = MAX_CALLS;
+        for (i = 0U; (i < num_calls) && (i < MAX_CALLS); i++)
+        {
+            if ((calls[i].type == CALL_UNCACHE) && (calls[i].addr == granule) &&
+                    (uncached_at == MAX_CALLS))
+            {
+                uncached_at = i;
+            }
+            if ((calls[i].type == CALL_FLUSH) && (calls[i].addr <= granule) &&
+                    ((calls[i].addr + calls[i].size) >= (granule + GRANULE)) &&
+                    (flushed_at == MAX_CALLS))
+            {
+                flushed_at = i;
+            }
+        }
+        CHECK(uncached_at != MAX_CALLS);
+        CHECK(flushed_at != MAX_CALLS);
+        CHECK(uncached_at < flushed_at);
+    }
+}
+
+/*
+ * @brief A new granule is uncached before its lines are flushed, a flush
+ * done first could be refilled through the cached mapping
+ */
+static void test_uncache_order(void)
+{
+    void *p;
+
+    num_calls = 0U;
+    p = pvPortMallocCoherent(64);
+    CHECK(p != NULL);
+    CHECK(get_stats().xNumberOfGranules == 1U);
+    check_uncached_then_flushed(p, 1U);
+
+    /* The granule stays, it is the only empty one */
+    vPortFreeCoherent(p);
+    CHECK(get_stats().xNumberOfGranules == 1U);
+}
+
+static void test_invalid(void)
+{
+    CHECK(pvPortMallocCoherent(0) == NULL);
+    CHECK(pvPortMallocCoherentAligned(48, 64) == NULL);
+    CHECK(pvPortMallocCoherentAligned(2U * GRANULE, 64) == NULL);
+    CHECK(pvPortMallocCoherent((configCOHERENT_MAX_GRANULES * GRANULE) + 1U)
+            == NULL);
+    CHECK(get_stats().xNumberOfSuccessfulAllocations == 0U);
+    vPortFreeCoherent(NULL);
+    CHECK(get_stats().xNumberOfSuccessfulFrees == 0U);
+}
+
+/*
+ * @brief Size classes round up to a power of two and align to it
+ */
+static void test_small_classes(void)
+{
+    static const size_t sizes[] = { 1, 63, 64, 65, 100, 1000, 4096, 5000,
+            32768 };
+    static const size_t rounded[] = { 64, 64, 64, 128, 128, 1024, 4096, 8192,
+            32768 };
+    void *p[sizeof(sizes) / sizeof(sizes[0])];
+    size_t total = 0;
+    uint32_t i;
+
+    for (i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+    {
+        p[i] = pvPortMallocCoherent(sizes[i]);
+        CHECK(p[i] != NULL);
+        CHECK(is_aligned(p[i], rounded[i]));
+        (void)memset(p[i], (int)i, sizes[i]);
+        total += rounded[i];
+    }
+    CHECK(get_stats().xAllocatedBytes == total);
+    CHECK(get_stats().xNumberOfGranules == 1U);
+    check_granules();
+
+    for (i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+    {
+        CHECK(((uint8_t *)p[i])[sizes[i] - 1U] == (uint8_t)i);
+        vPortFreeCoherent(p[i]);
+    }
+    CHECK(get_stats().xAllocatedBytes == 0U);
+}
+
+static void test_aligned(void)
+{
+    void *p = pvPortMallocCoherentAligned(4096, 10);
+    void *q = pvPortMallocCoherentAligned(PAGE, 64);
+
+    CHECK(p != NULL);
+    CHECK(is_aligned(p, 4096));
+    CHECK(q != NULL);
+    CHECK(is_aligned(q, PAGE));
+    CHECK(get_stats().xAllocatedBytes == (4096U + PAGE));
+    vPortFreeCoherent(p);
+    vPortFreeCoherent(q);
+    CHECK(get_stats().xAllocatedBytes == 0U);
+}
+
+/*
+ * @brief Blocks of a class come in address order and do not overlap
+ */
+static void test_small_blocks(void)
+{
+    static uint8_t *p[NUM_SMALL];
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0U; i < NUM_SMALL; i++)
+    {
+        p[i] = pvPortMallocCoherent(256);
+        CHECK(p[i] != NULL);
+        CHECK(is_aligned(p[i], 256));
+        (void)memset(p[i], (int)(i & 0xFFU), 256);
+    }
+    for (i = 1U; i < (PAGE / 256U); i++)
+    {
+        CHECK(p[i] == (p[i - 1U] + 256));
+    }
+    for (i = 0U; i < NUM_SMALL; i++)
+    {
+        for (j = 0U; j < 256U; j++)
+        {
+            if (p[i][j] != (uint8_t)(i & 0xFFU))
+            {
+                CHECK(p[i][j] == (uint8_t)(i & 0xFFU));
+                break;
+            }
+        }
+    }
+    CHECK(get_stats().xAllocatedBytes == (NUM_SMALL * 256U));
+
+    /* A freed block is the next one handed out */
+    vPortFreeCoherent(p[7]);
+    CHECK(pvPortMallocCoherent(200) == p[7]);
+
+    for (i = 0U; i < NUM_SMALL; i++)
+    {
+        vPortFreeCoherent(p[i]);
+    }
+    CHECK(get_stats().xAllocatedBytes == 0U);
+    CHECK(get_stats().xNumberOfGranules == 1U);
+}
+
+/*
+ * @brief Pages of an emptied size class serve other sizes
+ */
+static void test_page_reuse(void)
+{
+    static void *p[GRANULE / PAGE];
+    void *big;
+    uint32_t i;
+
+    for (i = 0U; i < (GRANULE / PAGE); i++)
+    {
+        p[i] = pvPortMallocCoherent(PAGE / 2U);
+        CHECK(p[i] != NULL);
+    }
+    for (i = 0U; i < (GRANULE / PAGE); i++)
+    {
+        vPortFreeCoherent(p[i]);
+    }
+
+    /* The whole granule is free again, a full granule run fits in it */
+    big = pvPortMallocCoherent(GRANULE);
+    CHECK(big != NULL);
+    CHECK(is_aligned(big, GRANULE));
+    CHECK(get_stats().xNumberOfGranules == 1U);
+    vPortFreeCoherent(big);
+    CHECK(get_stats().xAllocatedBytes == 0U);
+}
+
+static void test_page_runs(void)
+{
+    void *p64 = pvPortMallocCoherent(PAGE);
+    void *p128 = pvPortMallocCoherent(PAGE + 1U);
+    void *p1m = pvPortMallocCoherent(GRANULE / 2U);
+    void *p2m;
+
+    CHECK(is_aligned(p64, PAGE));
+    CHECK(is_aligned(p128, 2U * PAGE));
+    CHECK(is_aligned(p1m, GRANULE / 2U));
+    CHECK(get_stats().xAllocatedBytes == ((3U * PAGE) + (GRANULE / 2U)));
+
+    /* Does not fit next to the others, takes a second granule */
+    p2m = pvPortMallocCoherent(GRANULE);
+    CHECK(p2m != NULL);
+    CHECK(is_aligned(p2m, GRANULE));
+    CHECK(get_stats().xNumberOfGranules == 2U);
+    check_granules();
+
+    vPortFreeCoherent(p64);
+    vPortFreeCoherent(p128);
+    vPortFreeCoherent(p1m);
+    vPortFreeCoherent(p2m);
+    CHECK(get_stats().xAllocatedBytes == 0U);
+
+    /* One empty granule is kept, the other goes back to the heap */
+    CHECK(get_stats().xNumberOfGranules == 1U);
+    check_granules();
+}
+
+/*
+ * @brief Blocks over a granule get granules of their own
+ */
+static void test_large(void)
+{
+    CoherentHeapStats_t stats;
+    void *p;
+
+    num_calls = 0U;
+    p = pvPortMallocCoherent(GRANULE + 1U);
+    stats = get_stats();
+
+    CHECK(p != NULL);
+    CHECK(is_aligned(p, GRANULE));
+    CHECK(stats.xAllocatedBytes == (2U * GRANULE));
+    CHECK(stats.xNumberOfGranules == 3U);
+    check_granules();
+    check_uncached_then_flushed(p, 2U);
+    (void)memset(p, 0xA5, GRANULE + 1U);
+
+    vPortFreeCoherent(p);
+    CHECK(get_stats().xAllocatedBytes == 0U);
+    CHECK(get_stats().xNumberOfGranules == 1U);
+    check_granules();
+}
+
+/*
+ * @brief Allocations fail once every granule entry is in use
+ */
+static void test_exhaustion(void)
+{
+    void *p[configCOHERENT_MAX_GRANULES];
+    uint32_t i;
+
+    for (i = 0U; i < configCOHERENT_MAX_GRANULES; i++)
+    {
+        p[i] = pvPortMallocCoherent(GRANULE);
+        CHECK(p[i] != NULL);
+    }
+    CHECK(pvPortMallocCoherent(64) == NULL);
+    CHECK(pvPortMallocCoherent(GRANULE + 1U) == NULL);
+
+    vPortFreeCoherent(p[0]);
+    CHECK(pvPortMallocCoherent(64) != NULL);
+    CHECK(get_stats().xMaxAllocatedBytes
+            == (configCOHERENT_MAX_GRANULES * GRANULE));
+    check_granules();
+}
+
+int main(void)
+{
+    CoherentHeapStats_t stats;
+
+    test_invalid();
+    test_uncache_order();
+    test_small_classes();
+    test_aligned();
+    test_small_blocks();
+    test_page_reuse();
+    test_page_runs();
+    test_large();
+    test_exhaustion();
+
+    stats = get_stats();
+    CHECK(stats.xNumberOfSuccessfulAllocations
+            == (stats.xNumberOfSuccessfulFrees + configCOHERENT_MAX_GRANULES));
+    CHECK(flushed_bytes != 0U);
+
+    if (failures != 0U)
+    {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
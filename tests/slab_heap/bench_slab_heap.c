@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host benchmark of the allocation latency of the slab heap against heap_3
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* heap_3 calls the allocator directly, not through the counting stubs */
+#undef free
+
+#define BENCH_LIVE       4096U
+#define BENCH_OPS        1000000U
+#define BENCH_MIN_SHIFT  4U
+#define BENCH_MAX_SHIFT  14U
+
+typedef struct
+{
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*release)(void *ptr);
+} bench_heap_t;
+
+static void *live[BENCH_LIVE];
+static uint32_t latency[BENCH_OPS];
+
+static uint64_t bench_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000UL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * @brief heap_3 as the port runs it, the C library allocator with the
+ * scheduler suspended
+ */
+static void *heap3_malloc(size_t size)
+{
+    void *ptr;
+
+    vTaskSuspendAll();
+    {
+        ptr = malloc(size);
+    }
+    (void)xTaskResumeAll();
+    return ptr;
+}
+
+static void heap3_free(void *ptr)
+{
+    vTaskSuspendAll();
+    {
+        free(ptr);
+    }
+    (void)xTaskResumeAll();
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * @brief Random allocations and frees over a set of live blocks of 16 bytes
+ * to 16 KB, the same sequence for every heap
+ *
+ * @return Number of allocations timed, 0 when one failed
+ */
+static uint32_t bench_run(const bench_heap_t *heap, uint32_t ops)
+{
+    uint32_t seed = 12345U;
+    uint32_t allocs = 0U;
+    uint32_t failed = 0U;
+    uint32_t slot;
+    uint32_t shift;
+    uint64_t start;
+    uint32_t op;
+    size_t size;
+
+    for (op = 0U; op < ops; op++)
+    {
+        seed = (seed * 1103515245U) + 12345U;
+        slot = (seed >> 8) % BENCH_LIVE;
+        if (live[slot] != NULL)
+        {
+            heap->release(live[slot]);
+            live[slot] = NULL;
+            continue;
+        }
+
+        shift = BENCH_MIN_SHIFT + ((seed >> 20) % (BENCH_MAX_SHIFT - BENCH_MIN_SHIFT + 1U));
+        size = ((size_t)1 << shift) - ((seed >> 4) % ((size_t)1 << (shift - 1U)));
+
+        start = bench_now();
+        live[slot] = heap->alloc(size);
+        latency[allocs] = (uint32_t)(bench_now() - start);
+        allocs++;
+        if (live[slot] == NULL)
+        {
+            failed++;
+        }
+    }
+
+    for (slot = 0U; slot < BENCH_LIVE; slot++)
+    {
+        heap->release(live[slot]);
+        live[slot] = NULL;
+    }
+    return (failed == 0U) ? allocs : 0U;
+}
+
+int main(int argc, char *argv[])
+{
+    static const bench_heap_t heaps[] =
+    {
+        { "heap_slab", pvPortMalloc, vPortFree },
+        { "heap_3",    heap3_malloc, heap3_free },
+    };
+    uint32_t ops = BENCH_OPS;
+    uint64_t total;
+    uint32_t allocs;
+    uint32_t h;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        ops = (uint32_t)strtoul(argv[1], NULL, 0);
+        if (ops > BENCH_OPS)
+        {
+            ops = BENCH_OPS;
+        }
+    }
+
+    printf("%10s %10s %10s %10s %10s   (ns per allocation)\n", "heap",
+            "mean", "p99", "p99.9", "max");
+    for (h = 0U; h < (sizeof(heaps) / sizeof(heaps[0])); h++)
+    {
+        /* The first pass faults the memory in */
+        (void)bench_run(&heaps[h], ops);
+        allocs = bench_run(&heaps[h], ops);
+        if (allocs == 0U)
+        {
+            printf("%s ran out of memory\n", heaps[h].name);
+            return 1;
+        }
+
+        total = 0UL;
+        for (i = 0U; i < allocs; i++)
+        {
+            total += latency[i];
+        }
+        qsort(latency, allocs, sizeof(latency[0]), compare_u32);
+        printf("%10s %10.1f %10u %10u %10u\n", heaps[h].name,
+                (double)total / allocs, latency[(allocs * 99U) / 100U],
+                latency[(allocs * 999U) / 1000U], latency[allocs - 1U]);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-in for FreeRTOS.h, enough to build the slab heap
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define configUSE_SLAB_HEAP                  1
+#define configSUPPORT_DYNAMIC_ALLOCATION     1
+#define configTOTAL_HEAP_SIZE                ( 16U * 1024U * 1024U )
+#define configUSE_MALLOC_FAILED_HOOK         0
+#define configSLAB_MAX_RUN_SIZE              ( 256U * 1024U )
+#define configUNIQUE_INTERRUPT_PRIORITIES    16
+
+#define configASSERT(x)                      assert(x)
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+#define pdFALSE                              ( ( BaseType_t ) 0 )
+#define pdTRUE                               ( ( BaseType_t ) 1 )
+
+#include "portmacro.h"
+
+typedef struct xHeapStats
+{
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+void * pvPortMalloc( size_t xWantedSize );
+void * pvPortAlignedAlloc( size_t xAlignment, size_t xWantedSize );
+void vPortFree( void * pv );
+void vPortGetHeapStats( HeapStats_t * pxHeapStats );
+
+/* The newlib calls of the heap go to newlib_stubs.c, which counts them */
+void * stub_aligned_alloc( size_t alignment, size_t size );
+void stub_free( void * ptr );
+
+#define aligned_alloc    stub_aligned_alloc
+#define free             stub_free
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-ins for the newlib allocator and the kernel calls of the slab
+ * heap. This file does not include FreeRTOS.h, so it calls the host
+ * allocator itself.
+ */
+
+#include <stdlib.h>
+
+#include "newlib_stubs.h"
+
+typedef long BaseType_t;
+
+uint32_t stub_aligned_alloc_calls;
+uint32_t stub_free_calls;
+void *stub_last_free;
+
+uint32_t stub_critical_sections;
+int32_t stub_critical_nesting;
+uint32_t stub_suspensions;
+int32_t stub_suspend_nesting;
+
+void stub_reset_counters(void)
+{
+    stub_aligned_alloc_calls = 0U;
+    stub_free_calls = 0U;
+    stub_last_free = NULL;
+    stub_critical_sections = 0U;
+    stub_suspensions = 0U;
+}
+
+void *stub_aligned_alloc(size_t alignment, size_t size)
+{
+    stub_aligned_alloc_calls++;
+    return aligned_alloc(alignment, size);
+}
+
+void stub_free(void *ptr)
+{
+    stub_free_calls++;
+    stub_last_free = ptr;
+    free(ptr);
+}
+
+void vPortEnterCritical(void)
+{
+    stub_critical_sections++;
+    stub_critical_nesting++;
+}
+
+void vPortExitCritical(void)
+{
+    stub_critical_nesting--;
+}
+
+void vTaskSuspendAll(void)
+{
+    stub_suspensions++;
+    stub_suspend_nesting++;
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    stub_suspend_nesting--;
+    return 0;
+}
+
+size_t get_remaining_heap_size(void)
+{
+    return 0U;
+}
+
+size_t get_smallest_ever_remaining_heap_size(void)
+{
+    return 0U;
+}
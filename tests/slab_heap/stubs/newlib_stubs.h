@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Counters of the host stand-ins for newlib and the kernel
+ */
+
+#ifndef NEWLIB_STUBS_H
+#define NEWLIB_STUBS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Calls the heap made to newlib */
+extern uint32_t stub_aligned_alloc_calls;
+extern uint32_t stub_free_calls;
+extern void *stub_last_free;
+
+/* Critical sections and scheduler suspensions, with their current depth */
+extern uint32_t stub_critical_sections;
+extern int32_t stub_critical_nesting;
+extern uint32_t stub_suspensions;
+extern int32_t stub_suspend_nesting;
+
+void stub_reset_counters(void);
+
+#endif
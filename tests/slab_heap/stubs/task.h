@@ -0,0 +1,19 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stand-in for task.h, the scheduler is not running in the tests and
+ * newlib_stubs.c counts the critical sections and suspensions
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+void vTaskSuspendAll( void );
+BaseType_t xTaskResumeAll( void );
+
+#define taskENTER_CRITICAL()    portENTER_CRITICAL()
+#define taskEXIT_CRITICAL()     portEXIT_CRITICAL()
+
+#endif
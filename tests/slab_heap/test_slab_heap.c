@@ -0,0 +1,263 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host unit tests of the slab heap in heap_slab.c
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "newlib_stubs.h"
+
+#define PAGE           16384U
+#define POOL           configTOTAL_HEAP_SIZE
+#define POOL_ORDER     10U         /* the pool is a single run of 2^10 pages */
+#define SMALL          64U
+#define SMALL_BLOCKS   (PAGE / SMALL)
+
+#define CHECK(cond)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(cond))                                                \
+        {                                                           \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #cond);                                         \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static uint32_t failures;
+
+static void *blocks[SMALL_BLOCKS];
+
+static int is_aligned(const void *p, size_t align)
+{
+    return ((uintptr_t)p % align) == 0U;
+}
+
+static HeapStats_t stats(void)
+{
+    HeapStats_t s;
+
+    vPortGetHeapStats(&s);
+    return s;
+}
+
+static size_t free_runs(void)
+{
+    return stats().xNumberOfFreeBlocks;
+}
+
+/*
+ * @brief The pool is back to a single free run
+ */
+static void check_pristine(void)
+{
+    HeapStats_t s = stats();
+
+    CHECK(s.xAvailableHeapSpaceInBytes == POOL);
+    CHECK(s.xSizeOfLargestFreeBlockInBytes == POOL);
+    CHECK(s.xNumberOfFreeBlocks == 1U);
+}
+
+/*
+ * @brief Runs are split off the smallest free run that fits and merge back
+ * with their buddy once both are free, in any order
+ */
+static void test_buddy(void)
+{
+    uint8_t *page[4];
+    uint8_t *run;
+    HeapStats_t s;
+    uint32_t i;
+
+    check_pristine();
+
+    /* One page splits the pool down to order 0, one run per order is left */
+    page[0] = pvPortAlignedAlloc(PAGE, PAGE);
+    CHECK(is_aligned(page[0], PAGE));
+    s = stats();
+    CHECK(s.xNumberOfFreeBlocks == POOL_ORDER);
+    CHECK(s.xSizeOfLargestFreeBlockInBytes == (POOL / 2U));
+    CHECK(s.xSizeOfSmallestFreeBlockInBytes == PAGE);
+    CHECK(s.xAvailableHeapSpaceInBytes == (POOL - PAGE));
+
+    /* The next pages are its buddy, then the split of the order 1 run */
+    for (i = 1U; i < 4U; i++)
+    {
+        page[i] = pvPortAlignedAlloc(PAGE, PAGE);
+        CHECK(page[i] == (page[0] + (i * PAGE)));
+    }
+    CHECK(free_runs() == (POOL_ORDER - 2U));
+
+    /* No merge while the buddy is in use */
+    vPortFree(page[1]);
+    CHECK(free_runs() == (POOL_ORDER - 1U));
+    vPortFree(page[3]);
+    CHECK(free_runs() == POOL_ORDER);
+
+    /* Pages 0 and 1 merge, their order 1 buddy is still in use */
+    vPortFree(page[0]);
+    CHECK(free_runs() == POOL_ORDER);
+    CHECK(stats().xSizeOfSmallestFreeBlockInBytes == PAGE);
+
+    /* The last page merges every run back into the pool */
+    vPortFree(page[2]);
+    check_pristine();
+
+    /* Sizes round up to a power of two of pages, split off the start of
+     * the pool again */
+    run = pvPortMalloc((3U * PAGE) - 1U);
+    CHECK(run == page[0]);
+    s = stats();
+    CHECK(s.xAvailableHeapSpaceInBytes == (POOL - (4U * PAGE)));
+    CHECK(s.xNumberOfFreeBlocks == (POOL_ORDER - 2U));
+    CHECK(s.xSizeOfSmallestFreeBlockInBytes == (4U * PAGE));
+    vPortFree(run);
+    check_pristine();
+}
+
+/*
+ * @brief Blocks of a class share a page until it is full, freed blocks are
+ * handed out again before a new page is taken, and an empty page goes back
+ * to the pool
+ */
+static void test_class_reuse(void)
+{
+    uint8_t *first_page;
+    uint8_t *other;
+    uint8_t *block;
+    uint32_t i;
+
+    for (i = 0U; i < SMALL_BLOCKS; i++)
+    {
+        blocks[i] = pvPortMalloc(SMALL);
+        CHECK(is_aligned(blocks[i], SMALL));
+    }
+    first_page = blocks[0];
+    CHECK(is_aligned(first_page, PAGE));
+    for (i = 1U; i < SMALL_BLOCKS; i++)
+    {
+        CHECK(blocks[i] == (first_page + (i * SMALL)));
+    }
+    CHECK(stats().xAvailableHeapSpaceInBytes == (POOL - PAGE));
+    CHECK(free_runs() == POOL_ORDER);
+
+    /* The page is full, the next block takes a new one */
+    other = pvPortMalloc(SMALL);
+    CHECK((other < first_page) || (other >= (first_page + PAGE)));
+    CHECK(free_runs() == (POOL_ORDER - 1U));
+
+    /* Freed blocks of the full page are reused, last freed first */
+    vPortFree(blocks[10]);
+    vPortFree(blocks[20]);
+    block = pvPortMalloc(SMALL);
+    CHECK(block == blocks[20]);
+    block = pvPortMalloc(SMALL - 8U);
+    CHECK(block == blocks[10]);
+    CHECK(free_runs() == (POOL_ORDER - 1U));
+
+    /* The second page is empty again and goes back to the pool */
+    vPortFree(other);
+    CHECK(free_runs() == POOL_ORDER);
+
+    /* Another class does not share the page of the first one */
+    block = pvPortMalloc(SMALL + 1U);
+    CHECK(is_aligned(block, 2U * SMALL));
+    CHECK((block < first_page) || (block >= (first_page + PAGE)));
+    CHECK(stats().xAvailableHeapSpaceInBytes == (POOL - PAGE - (2U * SMALL)));
+    vPortFree(block);
+
+    /* The smallest class is 16 bytes */
+    block = pvPortMalloc(1U);
+    CHECK(is_aligned(block, 16U));
+    CHECK(stats().xAvailableHeapSpaceInBytes == (POOL - PAGE - 16U));
+    vPortFree(block);
+
+    for (i = 0U; i < SMALL_BLOCKS; i++)
+    {
+        vPortFree(blocks[i]);
+    }
+    check_pristine();
+}
+
+/*
+ * @brief Blocks the pool does not serve come from newlib with the scheduler
+ * suspended, vPortFree() gives them back to newlib and only them
+ */
+static void test_newlib_routing(void)
+{
+    uint8_t *small;
+    uint8_t *run;
+    uint8_t *large;
+    uint8_t *aligned;
+
+    stub_reset_counters();
+
+    small = pvPortMalloc(100U);
+    run = pvPortMalloc(configSLAB_MAX_RUN_SIZE);
+    CHECK((small != NULL) && (run != NULL));
+    CHECK(stub_aligned_alloc_calls == 0U);
+    CHECK(stub_suspensions == 0U);
+    CHECK(stub_critical_sections != 0U);
+    CHECK(stub_critical_nesting == 0);
+    CHECK(stats().xAvailableHeapSpaceInBytes ==
+            (POOL - 128U - configSLAB_MAX_RUN_SIZE));
+
+    vPortFree(small);
+    vPortFree(run);
+    CHECK(stub_free_calls == 0U);
+    CHECK(stub_suspensions == 0U);
+    check_pristine();
+
+    /* Above the largest run */
+    large = pvPortMalloc(configSLAB_MAX_RUN_SIZE + 1U);
+    CHECK(large != NULL);
+    CHECK(stub_aligned_alloc_calls == 1U);
+    CHECK(stub_suspensions == 1U);
+    CHECK(stub_suspend_nesting == 0);
+    CHECK(stats().xAvailableHeapSpaceInBytes == POOL);
+    (void)memset(large, 0xA5, configSLAB_MAX_RUN_SIZE + 1U);
+
+    vPortFree(large);
+    CHECK(stub_free_calls == 1U);
+    CHECK(stub_last_free == large);
+    CHECK(stub_suspensions == 2U);
+    CHECK(stub_suspend_nesting == 0);
+
+    /* Aligned to more than a page */
+    aligned = pvPortAlignedAlloc(2U * PAGE, 64U);
+    CHECK(is_aligned(aligned, 2U * PAGE));
+    CHECK(stub_aligned_alloc_calls == 2U);
+    vPortFree(aligned);
+    CHECK(stub_free_calls == 2U);
+    CHECK(stub_last_free == aligned);
+
+    /* Nothing to free, nothing to allocate */
+    vPortFree(NULL);
+    CHECK(pvPortMalloc(0U) == NULL);
+    CHECK(pvPortAlignedAlloc(24U, 64U) == NULL);
+    CHECK(stub_aligned_alloc_calls == 2U);
+    CHECK(stub_free_calls == 2U);
+    CHECK(stub_critical_nesting == 0);
+    check_pristine();
+}
+
+int main(void)
+{
+    test_buddy();
+    test_class_reuse();
+    test_newlib_routing();
+
+    if (failures != 0U)
+    {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host benchmark of XGMAC transmit bursts against frame by frame transmit
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xgmac_ring_model.h"
+
+#define BENCH_FRAME_SIZE    64U
+#define BENCH_BURST         32U
+#define BENCH_ROUNDS        20000U
+
+static uint8_t frames[BENCH_BURST][BENCH_FRAME_SIZE];
+static xgmac_tx_buf_t bufs[BENCH_BURST];
+
+static uint64_t bench_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000UL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * @brief Queue rounds of BENCH_BURST frames, burst at a time or one frame
+ * per call, the model DMA sends and the driver reaps them between rounds
+ *
+ * @return Nanoseconds spent queuing, -1 when a frame was not queued
+ */
+static int64_t bench_run(uint32_t rounds, uint32_t burst)
+{
+    xgmac_handle_t hxgmac;
+    uint64_t ticks = 0UL;
+    uint64_t start;
+    uint32_t round;
+    uint32_t i;
+    int32_t queued;
+
+    hxgmac = ring_model_init(BENCH_BURST);
+    for (round = 0U; round < rounds; round++)
+    {
+        for (i = 0U; i < BENCH_BURST; i++)
+        {
+            (void)memset(&bufs[i], 0, sizeof(bufs[i]));
+            bufs[i].buf = frames[i];
+            bufs[i].size = BENCH_FRAME_SIZE;
+        }
+
+        start = bench_now();
+        for (i = 0U; i < BENCH_BURST; i += burst)
+        {
+            queued = xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, &bufs[i],
+                    burst);
+            if (queued != (int32_t)burst)
+            {
+                return -1;
+            }
+        }
+        ticks += bench_now() - start;
+
+        (void)ring_model_complete(BENCH_BURST);
+        (void)ring_model_reap(NULL, 0U);
+    }
+    return (int64_t)ticks;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = BENCH_ROUNDS;
+    uint32_t frames_sent;
+    uint32_t burst;
+    int64_t ns;
+
+    if (argc > 1)
+    {
+        rounds = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    frames_sent = rounds * BENCH_BURST;
+
+    printf("%10s %12s %16s\n", "burst", "ns/frame", "tail writes/frame");
+    for (burst = 1U; burst <= BENCH_BURST; burst *= 2U)
+    {
+        ns = bench_run(rounds, burst);
+        if (ns < 0)
+        {
+            printf("Burst of %u frames failed\n", burst);
+            return 1;
+        }
+        printf("%10u %12.1f %16.3f\n", burst, (double)ns / frames_sent,
+                (double)ring_model_tail_writes() / frames_sent);
+    }
+    return 0;
+}
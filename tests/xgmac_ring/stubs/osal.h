@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stub of the OS abstraction layer for the XGMAC ring tests
+ */
+
+#ifndef __OSAL_H__
+#define __OSAL_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint64_t TickType_t;
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdFAIL                      (pdFALSE)
+#define pdPASS                      (pdTRUE)
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+#define OSAL_TIMEOUT_WAIT_FOREVER   (UINT64_MAX)
+#define configASSERT(x)             assert(x)
+
+void *pvPortMallocCoherentAligned(size_t xAlignment, size_t xWantedSize);
+
+/* Semaphores never block, a wait on an empty one fails right away. Without
+ * a definition they are allocated, as the driver does not delete them. */
+typedef struct
+{
+    UBaseType_t count;
+    UBaseType_t max_count;
+} osal_semaphore_def_t;
+
+typedef osal_semaphore_def_t osal_mutex_def_t;
+typedef osal_semaphore_def_t *osal_semaphore_t;
+typedef osal_semaphore_def_t *osal_mutex_t;
+
+static inline osal_semaphore_t osal_semaphore_counting_create(
+        osal_semaphore_def_t *semdef, UBaseType_t uxMaxCount,
+        UBaseType_t uxInitialCount)
+{
+    if (semdef == NULL)
+    {
+        semdef = (osal_semaphore_def_t *)calloc(1, sizeof(*semdef));
+        if (semdef == NULL)
+        {
+            return NULL;
+        }
+    }
+    semdef->count = uxInitialCount;
+    semdef->max_count = uxMaxCount;
+    return semdef;
+}
+
+static inline osal_mutex_t osal_mutex_create(osal_mutex_def_t *mdef)
+{
+    return osal_semaphore_counting_create(mdef, 1U, 1U);
+}
+
+static inline bool osal_semaphore_wait(osal_semaphore_t sem_hdl, uint64_t msec)
+{
+    (void)msec;
+    if (sem_hdl->count == 0U)
+    {
+        return false;
+    }
+    sem_hdl->count--;
+    return true;
+}
+
+static inline bool osal_semaphore_post(osal_semaphore_t sem_hdl)
+{
+    if (sem_hdl->count == sem_hdl->max_count)
+    {
+        return false;
+    }
+    sem_hdl->count++;
+    return true;
+}
+
+static inline UBaseType_t uxSemaphoreGetCount(osal_semaphore_t sem_hdl)
+{
+    return sem_hdl->count;
+}
+
+static inline void osal_task_delay(uint32_t msec)
+{
+    (void)msec;
+}
+
+#endif /* __OSAL_H__ */
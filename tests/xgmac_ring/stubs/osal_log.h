@@ -0,0 +1,21 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host stub of the logging macros for the XGMAC ring tests
+ */
+
+#ifndef __OSAL_LOG__
+#define __OSAL_LOG__
+
+#include <stdio.h>
+
+#define PRINT(...)
+#define CRITICAL(...)
+#define ERROR(...)
+#define WARN(...)
+#define INFO(...)
+#define DEBUG(...)
+
+#endif /* __OSAL_LOG__ */
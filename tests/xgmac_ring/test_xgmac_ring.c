@@ -0,0 +1,359 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Host unit tests of the XGMAC transmit burst and completion path
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "socfpga_xgmac_ll.h"
+#include "xgmac_ring_model.h"
+
+#define FRAME_SIZE      100U
+#define TSO_HDR_LEN     54U
+#define TSO_TCP_LEN     20U
+#define TSO_PAYLOAD     40000U
+#define TSO_DESCS       5U          /* context, header and 3 payload chunks */
+#define SG_SEGS         3U
+
+#define CHECK(cond)                                                 \
+    do                                                              \
+    {                                                               \
+        if (!(cond))                                                \
+        {                                                           \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #cond);                                         \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static uint32_t failures;
+
+static uint8_t frames[XGMAC_NUM_TX_DESC][FRAME_SIZE];
+static uint8_t tso_frame[TSO_HDR_LEN + TSO_PAYLOAD];
+static xgmac_tx_buf_t bufs[XGMAC_NUM_TX_DESC];
+static xgmac_tx_seg_t segs[SG_SEGS];
+
+static void single_buf(xgmac_tx_buf_t *pbuf, uint32_t index)
+{
+    (void)memset(pbuf, 0, sizeof(*pbuf));
+    pbuf->buf = frames[index];
+    pbuf->size = FRAME_SIZE;
+    pbuf->release_buf = 1U;
+}
+
+static void tso_buf(xgmac_tx_buf_t *pbuf)
+{
+    (void)memset(pbuf, 0, sizeof(*pbuf));
+    pbuf->buf = tso_frame;
+    pbuf->size = sizeof(tso_frame);
+    pbuf->release_buf = 1U;
+    pbuf->tso_hdr_len = TSO_HDR_LEN;
+    pbuf->tso_tcp_hdr_len = TSO_TCP_LEN;
+    pbuf->tso_mss = 1448U;
+}
+
+static void sg_buf(xgmac_tx_buf_t *pbuf)
+{
+    uint32_t i;
+
+    for (i = 0U; i < SG_SEGS; i++)
+    {
+        segs[i].buf = frames[i];
+        segs[i].size = FRAME_SIZE;
+    }
+    (void)memset(pbuf, 0, sizeof(*pbuf));
+    pbuf->buf = frames[0];
+    pbuf->release_buf = 1U;
+    pbuf->segs = segs;
+    pbuf->num_segs = SG_SEGS;
+}
+
+/*
+ * @brief Descriptors from first to last requesting the completion interrupt
+ */
+static uint32_t count_ioc(uint32_t first, uint32_t last)
+{
+    uint32_t count = 0U;
+    uint32_t i;
+
+    for (i = first; i <= last; i++)
+    {
+        if ((ring_model_desc(i)->des2 & TDES2_NORM_RD_IOC_MASK) != 0U)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * @brief A burst fills one descriptor per frame and writes the tail once,
+ * after the barrier
+ */
+static void test_burst(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(1U);
+    xgmac_buf_desc_t *pdesc;
+    uint32_t i;
+
+    for (i = 0U; i < 4U; i++)
+    {
+        single_buf(&bufs[i], i);
+    }
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 4U) == 4);
+    CHECK(ring_model_head() == 4U);
+    CHECK(ring_model_free() == (XGMAC_NUM_TX_DESC - 4U));
+    CHECK(ring_model_tail_writes() == 1U);
+    CHECK(ring_model_tail_value() == ring_model_desc_addr(4U));
+    CHECK(ring_model_barriers_at_tail() == 1U);
+
+    for (i = 0U; i < 4U; i++)
+    {
+        pdesc = ring_model_desc(i);
+        CHECK(pdesc->des0 == (uint32_t)(uintptr_t)frames[i]);
+        CHECK((pdesc->des2 & TDES2_NORM_RD_HL_B1L_MASL) == FRAME_SIZE);
+        CHECK((pdesc->des3 & (TDES3_NORM_RD_OWN_MASK | TDES3_NORM_RD_FD_MASK |
+                TDES3_NORM_RD_LD_MASK)) == (TDES3_NORM_RD_OWN_MASK |
+                TDES3_NORM_RD_FD_MASK | TDES3_NORM_RD_LD_MASK));
+    }
+
+    /* Only the last descriptor of the burst interrupts */
+    CHECK(count_ioc(0U, 3U) == 1U);
+    CHECK((ring_model_desc(3U)->des2 & TDES2_NORM_RD_IOC_MASK) != 0U);
+
+    /* A single frame is a burst of one */
+    single_buf(&bufs[0], 4U);
+    CHECK(xgmac_dma_transmit(hxgmac, MODEL_CHNL, &bufs[0]) == 0);
+    CHECK(ring_model_tail_writes() == 2U);
+    CHECK(ring_model_tail_value() == ring_model_desc_addr(5U));
+}
+
+/*
+ * @brief With coalescing, the interrupt is requested on the last
+ * descriptor of the burst that reaches the frame count
+ */
+static void test_coalesce(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(8U);
+    uint32_t i;
+
+    for (i = 0U; i < 4U; i++)
+    {
+        single_buf(&bufs[i], i);
+    }
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 4U) == 4);
+    CHECK(count_ioc(0U, 3U) == 0U);
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 4U) == 4);
+    CHECK(count_ioc(4U, 7U) == 1U);
+    CHECK((ring_model_desc(7U)->des2 & TDES2_NORM_RD_IOC_MASK) != 0U);
+    CHECK(ring_model_tail_writes() == 2U);
+}
+
+/*
+ * @brief TSO and gathered frames take their own descriptor counts, FD and
+ * LD mark the frame ends
+ */
+static void test_desc_counts(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(1U);
+    xgmac_buf_desc_t *pdesc;
+    uint32_t i;
+
+    tso_buf(&bufs[0]);
+    sg_buf(&bufs[1]);
+    single_buf(&bufs[2], 8U);
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 3U) == 3);
+    CHECK(ring_model_head() == (TSO_DESCS + SG_SEGS + 1U));
+    CHECK(ring_model_free() == (XGMAC_NUM_TX_DESC - TSO_DESCS - SG_SEGS - 1U));
+    CHECK(ring_model_tail_writes() == 1U);
+    CHECK(ring_model_tail_value() == ring_model_desc_addr(TSO_DESCS + SG_SEGS + 1U));
+
+    /* TSO: context, headers, then the payload in buffer length chunks */
+    pdesc = ring_model_desc(0U);
+    CHECK((pdesc->des3 & TDES3_NORM_RD_CTXT_MASK) != 0U);
+    CHECK((pdesc->des2 & XGMAC_TDES2_CTXT_MSS_MASK) == 1448U);
+    pdesc = ring_model_desc(1U);
+    CHECK((pdesc->des3 & (TDES3_NORM_RD_FD_MASK | TDES3_NORM_RD_TSE_MASK)) ==
+            (TDES3_NORM_RD_FD_MASK | TDES3_NORM_RD_TSE_MASK));
+    CHECK((pdesc->des2 & TDES2_NORM_RD_HL_B1L_MASL) == TSO_HDR_LEN);
+    for (i = 2U; i < TSO_DESCS; i++)
+    {
+        pdesc = ring_model_desc(i);
+        CHECK(pdesc->des0 == (uint32_t)(uintptr_t)&tso_frame[TSO_HDR_LEN +
+                ((i - 2U) * XGMAC_TDES_MAX_BUF_LEN)]);
+        CHECK(((pdesc->des3 & TDES3_NORM_RD_LD_MASK) != 0U) ==
+                (i == (TSO_DESCS - 1U)));
+    }
+
+    /* Gathered: one descriptor per segment, the frame length on the first */
+    pdesc = ring_model_desc(TSO_DESCS);
+    CHECK((pdesc->des3 & TDES3_NORM_RD_FD_MASK) != 0U);
+    CHECK((pdesc->des3 & TDES3_NORM_RD_FL_TPL_MASK) == (SG_SEGS * FRAME_SIZE));
+    for (i = 0U; i < SG_SEGS; i++)
+    {
+        pdesc = ring_model_desc(TSO_DESCS + i);
+        CHECK(pdesc->des0 == (uint32_t)(uintptr_t)frames[i]);
+        CHECK(((pdesc->des3 & TDES3_NORM_RD_LD_MASK) != 0U) ==
+                (i == (SG_SEGS - 1U)));
+    }
+
+    /* One interrupt for the whole burst, on its last descriptor */
+    CHECK(count_ioc(0U, TSO_DESCS + SG_SEGS) == 1U);
+    CHECK((ring_model_desc(TSO_DESCS + SG_SEGS)->des2 &
+            TDES2_NORM_RD_IOC_MASK) != 0U);
+
+    /* Invalid frames are refused before anything is queued */
+    single_buf(&bufs[0], 0U);
+    bufs[0].size = 1500U + XGMAC_FRAME_OVERHEAD + 1U;
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 1U) == -EINVAL);
+    sg_buf(&bufs[0]);
+    bufs[0].tso_mss = 1448U;
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 1U) == -EINVAL);
+    CHECK(ring_model_tail_writes() == 1U);
+}
+
+/*
+ * @brief Only the first frame of a burst may wait for descriptors, the
+ * burst is trimmed to the frames whose descriptors are all free
+ */
+static void test_trim(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(1U);
+    uint32_t fill = XGMAC_NUM_TX_DESC - 12U;
+    uint32_t i;
+
+    for (i = 0U; i < fill; i++)
+    {
+        single_buf(&bufs[i], i);
+    }
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, fill) == (int32_t)fill);
+    CHECK(ring_model_free() == 12U);
+
+    /* 12 free: two TSO frames of 5 fit, the third does not */
+    for (i = 0U; i < 3U; i++)
+    {
+        tso_buf(&bufs[i]);
+    }
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 3U) == 2);
+    CHECK(ring_model_free() == 2U);
+    CHECK(ring_model_tail_writes() == 2U);
+    CHECK(ring_model_tail_value() == ring_model_desc_addr(fill + (2U * TSO_DESCS)));
+    CHECK(count_ioc(fill, fill + (2U * TSO_DESCS) - 1U) == 1U);
+
+    /* A frame that does not fit gives back its partial reservation */
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 1U) == -EIO);
+    CHECK(ring_model_free() == 2U);
+    CHECK(ring_model_tail_writes() == 2U);
+
+    single_buf(&bufs[0], 0U);
+    single_buf(&bufs[1], 1U);
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 2U) == 2);
+    CHECK(ring_model_free() == 0U);
+    CHECK(ring_model_head() == 0U);
+    CHECK(ring_model_tail_value() == ring_model_desc_addr(0U));
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 1U) == -EIO);
+}
+
+/*
+ * @brief Completions are reaped in ring order up to the first descriptor
+ * still owned by the DMA, a frame is released with its last descriptor
+ */
+static void test_reap(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(1U);
+    uint8_t *released[TSO_DESCS];
+    xgmac_irq_stats_t stats;
+    uint32_t i;
+
+    for (i = 0U; i < 3U; i++)
+    {
+        single_buf(&bufs[i], i);
+    }
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 3U) == 3);
+    CHECK(ring_model_reap(NULL, 0U) == 0U);
+
+    CHECK(ring_model_complete(2U) == 2U);
+    CHECK(ring_model_reap(released, 3U) == 2U);
+    CHECK(released[0] == frames[0]);
+    CHECK(released[1] == frames[1]);
+    CHECK(ring_model_tail() == 2U);
+    CHECK(ring_model_free() == (XGMAC_NUM_TX_DESC - 1U));
+
+    CHECK(ring_model_complete(8U) == 1U);
+    CHECK(ring_model_reap(released, 3U) == 1U);
+    CHECK(released[0] == frames[2]);
+    CHECK(ring_model_free() == XGMAC_NUM_TX_DESC);
+
+    /* A TSO frame spans its descriptors, it is released and counted once */
+    tso_buf(&bufs[0]);
+    CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 1U) == 1);
+    CHECK(ring_model_complete(TSO_DESCS - 1U) == (TSO_DESCS - 1U));
+    CHECK(ring_model_reap(released, TSO_DESCS) == (TSO_DESCS - 1U));
+    for (i = 0U; i < (TSO_DESCS - 1U); i++)
+    {
+        CHECK(released[i] == NULL);
+    }
+    CHECK(ring_model_complete(1U) == 1U);
+    CHECK(ring_model_reap(released, TSO_DESCS) == 1U);
+    CHECK(released[0] == tso_frame);
+
+    CHECK(xgmac_ioctl(hxgmac, XGMAC_GET_IRQ_STATS, &stats) == 0);
+    CHECK(stats.tx_packets == 4U);
+}
+
+/*
+ * @brief The ring wraps around with bursts, completions and reaps running
+ * behind each other
+ */
+static void test_wrap(void)
+{
+    xgmac_handle_t hxgmac = ring_model_init(1U);
+    uint32_t queued = 0U;
+    uint32_t reaped = 0U;
+    uint32_t round;
+    uint32_t i;
+
+    for (i = 0U; i < 7U; i++)
+    {
+        single_buf(&bufs[i], i);
+    }
+    for (round = 0U; round < 300U; round++)
+    {
+        /* The DMA finishes the previous burst while the next one is queued */
+        (void)ring_model_complete(7U);
+        CHECK(xgmac_dma_transmit_burst(hxgmac, MODEL_CHNL, bufs, 7U) == 7);
+        queued += 7U;
+        reaped += ring_model_reap(NULL, 0U);
+        CHECK(ring_model_free() == (XGMAC_NUM_TX_DESC - (queued - reaped)));
+    }
+    (void)ring_model_complete(XGMAC_NUM_TX_DESC);
+    reaped += ring_model_reap(NULL, 0U);
+    CHECK(queued == reaped);
+    CHECK(queued > XGMAC_NUM_TX_DESC);
+    CHECK(ring_model_head() == ring_model_tail());
+    CHECK(ring_model_tail_writes() == 300U);
+}
+
+int main(void)
+{
+    test_burst();
+    test_coalesce();
+    test_desc_counts();
+    test_trim();
+    test_reap();
+    test_wrap();
+
+    if (failures != 0U)
+    {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * In-memory model of an XGMAC transmit descriptor ring for host tests.
+ *
+ * The driver is built into this file so the model can reach the channel
+ * state. DMA channel registers and the barrier are replaced by stubs that
+ * record the tail pointer writes, the descriptors live in host memory.
+ */
+
+#include <stdint.h>
+
+#include "xgmac_ring_model.h"
+
+static void reg_write(int32_t base, uint32_t chnl, uint32_t offset,
+        uint32_t data);
+
+static uint32_t barriers;
+
+#define WR_DMA_CHNL_REG32(base, chnl, offset, data) \
+    reg_write((base), (chnl), (offset), (data))
+#define RD_DMA_CHNL_REG32(base, chnl, offset) \
+    ((void)(base), (void)(chnl), (void)(offset), 0U)
+#define XGMAC_DMA_BARRIER()    (barriers++)
+
+#include "socfpga_xgmac.c"
+
+static struct xgmac_desc_t model_dev;
+static uint32_t tail_writes;
+static uint32_t tail_value;
+static uint32_t barriers_at_tail;
+
+/* Next descriptor the modelled DMA processes */
+static uint32_t dma_index;
+
+static void reg_write(int32_t base, uint32_t chnl, uint32_t offset,
+        uint32_t data)
+{
+    (void)base;
+    if ((chnl == MODEL_CHNL) && (offset == XGMAC_DMA_CH_TXDESC_TAIL_LPOINTER))
+    {
+        tail_writes++;
+        tail_value = data;
+        barriers_at_tail = barriers;
+    }
+}
+
+/* Platform services the driver links against */
+void cache_force_write_back(void *addr, size_t sz)
+{
+    (void)addr;
+    (void)sz;
+}
+
+void cache_force_invalidate(void *addr, size_t sz)
+{
+    (void)addr;
+    (void)sz;
+}
+
+void *pvPortMallocCoherentAligned(size_t xAlignment, size_t xWantedSize)
+{
+    return aligned_alloc(xAlignment, (xWantedSize + xAlignment - 1U) &
+            ~(xAlignment - 1U));
+}
+
+socfpga_interrupt_err_t interrupt_register_isr(socfpga_hpu_interrupt_t id,
+        socfpga_interrupt_callback_t callback, void *user_data)
+{
+    (void)id;
+    (void)callback;
+    (void)user_data;
+    return ERR_OK;
+}
+
+socfpga_interrupt_err_t interrupt_enable(socfpga_hpu_interrupt_t id,
+        uint8_t priority)
+{
+    (void)id;
+    (void)priority;
+    return ERR_OK;
+}
+
+xgmac_handle_t ring_model_init(uint16_t tx_frames)
+{
+    struct xgmac_chnl_desc_t *pchnl = &model_dev.chnl[MODEL_CHNL];
+
+    /* The driver creates the semaphores once, refill them on a reset */
+    (void)dma_set_descriptors(&model_dev);
+    pchnl->tx_sem->count = XGMAC_NUM_TX_DESC;
+    pchnl->tx_mutex->count = 1U;
+
+    model_dev.csum_mode = XGMAC_CSUM_BY_HW;
+    model_dev.tso_enabled = true;
+    model_dev.ts_enabled = false;
+    model_dev.mtu = 1500U;
+    model_dev.coalesce.tx_frames = tx_frames;
+    (void)memset(&model_dev.irq_stats, 0, sizeof(model_dev.irq_stats));
+
+    tail_writes = 0U;
+    tail_value = 0U;
+    barriers = 0U;
+    barriers_at_tail = 0U;
+    dma_index = 0U;
+    return &model_dev;
+}
+
+xgmac_buf_desc_t *ring_model_desc(uint32_t index)
+{
+    return &model_dev.chnl[MODEL_CHNL].tx_bd_ring[index % XGMAC_NUM_TX_DESC];
+}
+
+uint32_t ring_model_desc_addr(uint32_t index)
+{
+    return (uint32_t)(uintptr_t)ring_model_desc(index);
+}
+
+uint32_t ring_model_head(void)
+{
+    return (uint32_t)model_dev.chnl[MODEL_CHNL].tx_desc_head;
+}
+
+uint32_t ring_model_tail(void)
+{
+    return (uint32_t)model_dev.chnl[MODEL_CHNL].tx_desc_tail;
+}
+
+uint32_t ring_model_free(void)
+{
+    return (uint32_t)uxSemaphoreGetCount(model_dev.chnl[MODEL_CHNL].tx_sem);
+}
+
+uint32_t ring_model_tail_writes(void)
+{
+    return tail_writes;
+}
+
+uint32_t ring_model_tail_value(void)
+{
+    return tail_value;
+}
+
+uint32_t ring_model_barriers_at_tail(void)
+{
+    return barriers_at_tail;
+}
+
+uint32_t ring_model_complete(uint32_t count)
+{
+    xgmac_buf_desc_t *pdesc;
+    uint32_t done = 0U;
+
+    /* The DMA stops at the tail pointer and at descriptors it does not own */
+    while ((done < count) && (ring_model_desc_addr(dma_index) != tail_value))
+    {
+        pdesc = ring_model_desc(dma_index);
+        if ((pdesc->des3 & TDES3_NORM_RD_OWN_MASK) == 0U)
+        {
+            break;
+        }
+
+        /* Write-back format, OWN cleared and LD/CTXT where they were */
+        pdesc->des3 &= (TDES3_NORM_WR_LD_MASK | TDES3_NORM_WR_CTXT_MASK);
+        dma_index = (dma_index + 1U) % XGMAC_NUM_TX_DESC;
+        done++;
+    }
+    return done;
+}
+
+uint32_t ring_model_reap(uint8_t **released, uint32_t max)
+{
+    uint8_t *buf;
+    uint32_t reaped = 0U;
+
+    for (;;)
+    {
+        buf = NULL;
+        if (xgmac_dma_tx_done(&model_dev, MODEL_CHNL, &buf) != 0)
+        {
+            break;
+        }
+        if ((released != NULL) && (reaped < max))
+        {
+            released[reaped] = buf;
+        }
+        reaped++;
+    }
+    return reaped;
+}
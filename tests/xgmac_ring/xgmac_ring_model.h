@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * In-memory model of an XGMAC transmit descriptor ring for host tests
+ */
+
+#ifndef __XGMAC_RING_MODEL_H__
+#define __XGMAC_RING_MODEL_H__
+
+#include <stdint.h>
+#include "socfpga_xgmac.h"
+
+/* Channel every test runs on */
+#define MODEL_CHNL    0U
+
+/*
+ * @brief Reset the driver state of the channel to a freshly initialized
+ * instance, with TSO enabled and an MTU of 1500 bytes
+ *
+ * @param[in] tx_frames Frames per transmit complete interrupt
+ *
+ * @return The instance
+ */
+xgmac_handle_t ring_model_init(uint16_t tx_frames);
+
+/*
+ * @brief Descriptor at an index of the transmit ring
+ */
+xgmac_buf_desc_t *ring_model_desc(uint32_t index);
+
+/*
+ * @brief Value the tail pointer register takes for a ring index
+ */
+uint32_t ring_model_desc_addr(uint32_t index);
+
+/*
+ * @brief Next descriptor the driver fills
+ */
+uint32_t ring_model_head(void);
+
+/*
+ * @brief Next descriptor the driver reaps
+ */
+uint32_t ring_model_tail(void);
+
+/*
+ * @brief Descriptors free for new frames
+ */
+uint32_t ring_model_free(void);
+
+/*
+ * @brief Writes to the tail pointer register since the model was reset
+ */
+uint32_t ring_model_tail_writes(void);
+
+/*
+ * @brief Last value written to the tail pointer register
+ */
+uint32_t ring_model_tail_value(void);
+
+/*
+ * @brief Barriers issued before the last tail pointer write
+ */
+uint32_t ring_model_barriers_at_tail(void);
+
+/*
+ * @brief Act as the DMA: give back up to count descriptors it owns, in ring
+ * order from the last one it gave back, the way the DMA writes them back
+ *
+ * @return Number of descriptors given back
+ */
+uint32_t ring_model_complete(uint32_t count);
+
+/*
+ * @brief Reap completed descriptors with xgmac_dma_tx_done() until it
+ * reports none
+ *
+ * @param[out] released Buffers returned for release, may be NULL
+ * @param[in]  max      Entries of released
+ *
+ * @return Number of descriptors reaped
+ */
+uint32_t ring_model_reap(uint8_t **released, uint32_t max);
+
+#endif /* __XGMAC_RING_MODEL_H__ */